@@ -19,16 +19,20 @@
 #include "../../Source/Core/Audio/BuiltIn/MetronomeSynth.cpp"
 #include "../../Source/Core/Audio/BuiltIn/SoundFontSynthAudioPlugin.cpp"
 #include "../../Source/Core/Audio/Instruments/Instrument.cpp"
+#include "../../Source/Core/Audio/Instruments/MidiMessageQueue.cpp"
 #include "../../Source/Core/Audio/Instruments/OrchestraPit.cpp"
 #include "../../Source/Core/Audio/Instruments/PluginScanner.cpp"
 #include "../../Source/Core/Audio/Instruments/SerializablePluginDescription.cpp"
 #include "../../Source/Core/Audio/Monitoring/AudioMonitor.cpp"
+#include "../../Source/Core/Audio/Monitoring/AudioLoadMeter.cpp"
 #include "../../Source/Core/Audio/Monitoring/SpectrumAnalyzer.cpp"
 #include "../../Source/Core/Audio/Transport/MidiRecorder.cpp"
 #include "../../Source/Core/Audio/Transport/PlayerThread.cpp"
 #include "../../Source/Core/Audio/Transport/RendererThread.cpp"
 #include "../../Source/Core/Audio/Transport/Transport.cpp"
+#include "../../Source/Core/Audio/Transport/TransportState.cpp"
 #include "../../Source/Core/Audio/AudioCore.cpp"
+#include "../../Source/Core/Audio/RealtimeAudit.cpp"
 #include "../../Source/Core/Configuration/Resources/Models/Arpeggiator.cpp"
 #include "../../Source/Core/Configuration/Resources/Models/Chord.cpp"
 #include "../../Source/Core/Configuration/Resources/Models/ColourScheme.cpp"
@@ -71,7 +75,9 @@
 #include "../../Source/Core/Midi/Sequences/PianoSequence.cpp"
 #include "../../Source/Core/Midi/Sequences/TimeSignaturesSequence.cpp"
 #include "../../Source/Core/Midi/Sequences/TimeSignaturesAggregator.cpp"
+#include "../../Source/Core/Midi/Sequences/NoteTransforms.cpp"
 #include "../../Source/Core/Midi/MidiTrack.cpp"
+#include "../../Source/Core/Midi/BeatRangeTree.cpp"
 #include "../../Source/Core/Network/Requests/BackendRequest.cpp"
 #include "../../Source/Core/Network/Requests/UserConfigSyncThread.cpp"
 #include "../../Source/Core/Network/Requests/ProjectCloneThread.cpp"
@@ -106,6 +112,7 @@
 #include "../../Source/Core/Tree/VersionControlNode.cpp"
 #include "../../Source/Core/Undo/Actions/AnnotationEventActions.cpp"
 #include "../../Source/Core/Undo/Actions/AutomationTrackActions.cpp"
+#include "../../Source/Core/Undo/Actions/CompactNotes.cpp"
 #include "../../Source/Core/Undo/Actions/AutomationEventActions.cpp"
 #include "../../Source/Core/Undo/Actions/KeySignatureEventActions.cpp"
 #include "../../Source/Core/Undo/Actions/MidiTrackActions.cpp"
@@ -122,6 +129,7 @@
 #include "../../Source/Core/VCS/DiffLogic/ProjectInfoDiffLogic.cpp"
 #include "../../Source/Core/VCS/DiffLogic/ProjectTimelineDiffLogic.cpp"
 #include "../../Source/Core/VCS/Delta.cpp"
+#include "../../Source/Core/VCS/BlobStorage.cpp"
 #include "../../Source/Core/VCS/Diff.cpp"
 #include "../../Source/Core/VCS/Head.cpp"
 #include "../../Source/Core/VCS/RemoteCache.cpp"
@@ -131,12 +139,14 @@
 #include "../../Source/Core/VCS/StashesRepository.cpp"
 #include "../../Source/Core/VCS/VersionControl.cpp"
 #include "../../Source/Core/Workspace/NavigationHistory.cpp"
+#include "../../Source/Core/Workspace/ProjectLoader.cpp"
 #include "../../Source/Core/Workspace/RecentProjectInfo.cpp"
 #include "../../Source/Core/Workspace/SyncedConfigurationInfo.cpp"
 #include "../../Source/Core/Workspace/UserSessionInfo.cpp"
 #include "../../Source/Core/Workspace/UserProfile.cpp"
 #include "../../Source/Core/Workspace/Workspace.cpp"
 #include "../../Source/Core/App.cpp"
+#include "../../Source/Core/ProjectBenchmarks.cpp"
 #include "../../Source/UI/Common/AudioMonitors/SpectrogramAudioMonitorComponent.cpp"
 #include "../../Source/UI/Common/AudioMonitors/WaveformAudioMonitorComponent.cpp"
 #include "../../Source/UI/Common/Origami/Origami.cpp"
@@ -205,6 +215,7 @@
 #include "../../Source/UI/Pages/Instruments/OrchestraPitPage.cpp"
 #include "../../Source/UI/Pages/Project/ProjectPage.cpp"
 #include "../../Source/UI/Pages/Settings/AudioSettings.cpp"
+#include "../../Source/UI/Pages/Settings/AudioLoadSettings.cpp"
 #include "../../Source/UI/Pages/Settings/ComponentsList.cpp"
 #include "../../Source/UI/Pages/Settings/SettingsFrameWrapper.cpp"
 #include "../../Source/UI/Pages/Settings/SettingsPage.cpp"
@@ -216,11 +227,10 @@
 #include "../../Source/UI/Pages/Settings/TranslationSettingsItem.cpp"
 #include "../../Source/UI/Pages/Settings/UserInterfaceSettings.cpp"
 #include "../../Source/UI/Pages/VCS/HistoryComponent.cpp"
-#include "../../Source/UI/Pages/VCS/RevisionComponent.cpp"
-#include "../../Source/UI/Pages/VCS/RevisionConnectorComponent.cpp"
 #include "../../Source/UI/Pages/VCS/RevisionItemComponent.cpp"
 #include "../../Source/UI/Pages/VCS/RevisionTooltipComponent.cpp"
 #include "../../Source/UI/Pages/VCS/RevisionTreeComponent.cpp"
+#include "../../Source/UI/Pages/VCS/RevisionTreeLayout.cpp"
 #include "../../Source/UI/Pages/VCS/StageComponent.cpp"
 #include "../../Source/UI/Pages/VCS/VersionControlEditor.cpp"
 #include "../../Source/UI/Popups/CommandPalette.cpp"
@@ -261,6 +271,7 @@
 #include "../../Source/UI/Sequencer/PianoRoll/NoteNameGuidesBar.cpp"
 #include "../../Source/UI/Sequencer/PianoRoll/NoteResizerLeft.cpp"
 #include "../../Source/UI/Sequencer/PianoRoll/NoteResizerRight.cpp"
+#include "../../Source/UI/Sequencer/PianoRoll/NotesPaintBatch.cpp"
 #include "../../Source/UI/Sequencer/PianoRoll/PianoRoll.cpp"
 #include "../../Source/UI/Sequencer/Sidebars/SequencerSidebarLeft.cpp"
 #include "../../Source/UI/Sequencer/Sidebars/SequencerSidebarRight.cpp"
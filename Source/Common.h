@@ -68,6 +68,14 @@ struct StringHash
     }
 };
 
+struct UuidHash
+{
+    inline HashCode operator()(const juce::Uuid &key) const noexcept
+    {
+        return static_cast<HashCode>(key.hash());
+    }
+};
+
 struct IdentifierHash
 {
     inline HashCode operator()(const juce::Identifier &key) const noexcept
@@ -147,6 +155,9 @@ namespace juce
     {
         // declare an additional category for all our tests 
         static const String helio { "Helio" };
+
+        // performance benchmarks, only run in the benchmarks build
+        static const String helioBenchmarks { "Helio benchmarks" };
     }
 }
 #endif
@@ -26,6 +26,7 @@
 #include "XmlSerializer.h"
 #include "SerializationKeys.h"
 #include "SerializablePluginDescription.h"
+#include "CompactNotes.h"
 
 #include "MainLayout.h"
 #include "ScaledComponentProxy.h"
@@ -214,26 +215,46 @@ private:
 // Clipboard
 //===----------------------------------------------------------------------===//
 
+Clipboard::Clipboard() = default;
+Clipboard::~Clipboard() = default;
+
 String Clipboard::getCurrentContentAsString() const
 {
-    if (this->clipboard.isValid())
+    const auto &data = this->getData();
+    if (data.isValid())
     {
         String text;
         static XmlSerializer serializer;
-        serializer.saveToString(text, this->clipboard);
+        serializer.saveToString(text, data);
         return text;
     }
 
     return {};
 }
 
-const SerializedData &Clipboard::getData() const noexcept
+const SerializedData &Clipboard::getData() const
 {
+    if (!this->clipboard.isValid() && this->hasNotes())
+    {
+        SerializedData trackRoot(Serialization::Clipboard::track);
+        trackRoot.setProperty(Serialization::Clipboard::trackId, this->notesTrackId);
+
+        for (const auto &note : this->notes->getNotes(nullptr))
+        {
+            trackRoot.appendChild(note.serialize());
+        }
+
+        this->clipboard = SerializedData(Serialization::Clipboard::clipboard);
+        this->clipboard.setProperty(Serialization::Clipboard::firstBeat, this->notesFirstBeat);
+        this->clipboard.appendChild(trackRoot);
+    }
+
     return this->clipboard;
 }
 
 void Clipboard::copy(const SerializedData &data, bool mirrorToSystemClipboard /*= false*/)
 {
+    this->notes = nullptr;
     this->clipboard = data;
 
     if (mirrorToSystemClipboard)
@@ -242,6 +263,35 @@ void Clipboard::copy(const SerializedData &data, bool mirrorToSystemClipboard /*
     }
 }
 
+void Clipboard::copyNotes(const Array<Note> &notesToCopy, const String &trackId)
+{
+    this->clipboard = SerializedData();
+    this->notes = make<CompactNotes>(notesToCopy);
+    this->notesTrackId = trackId;
+
+    this->notesFirstBeat = FLT_MAX;
+    for (const auto &note : notesToCopy)
+    {
+        this->notesFirstBeat = jmin(this->notesFirstBeat, note.getBeat());
+    }
+}
+
+bool Clipboard::hasNotes() const noexcept
+{
+    return this->notes != nullptr && !this->notes->isEmpty();
+}
+
+const CompactNotes &Clipboard::getNotes() const noexcept
+{
+    jassert(this->notes != nullptr);
+    return *this->notes;
+}
+
+float Clipboard::getNotesFirstBeat() const noexcept
+{
+    return this->notesFirstBeat;
+}
+
 
 //===----------------------------------------------------------------------===//
 // App
@@ -505,6 +555,40 @@ void App::setTitleBarComponent(WeakReference<Component> component)
 // JUCEApplication
 //===----------------------------------------------------------------------===//
 
+#if JUCE_UNIT_TESTS
+
+static void runUnitTestsAndQuit(const String &category)
+{
+    DBG("===");
+
+    UnitTestRunner runner;
+
+    // we don't want to run JUCE's unit tests, just the ones in our category:
+    runner.runTestsInCategory(category,
+        Random::getSystemRandom().nextInt64());
+
+    for (int i = 0; i < runner.getNumResults(); ++i)
+    {
+        if (runner.getResult(i)->failures > 0)
+        {
+            throw new std::exception();
+        }
+    }
+
+    App::quit();
+
+    // a hack to allow messages get cleaned up to avoid leaks:
+    const auto endTime = Time::currentTimeMillis() + 50;
+    while (Time::currentTimeMillis() < endTime)
+    {
+        Thread::sleep(1);
+    }
+
+    DBG("===");
+}
+
+#endif
+
 void App::initialise(const String &commandLine)
 {
     if (commandLine.isNotEmpty() &&
@@ -530,36 +614,22 @@ void App::initialise(const String &commandLine)
         this->theme = move(helioTheme);
         LookAndFeel::setDefaultLookAndFeel(this->theme.get());
 
-#if JUCE_UNIT_TESTS
-
-        DBG("===");
+#if JUCE_UNIT_TESTS && HELIO_BENCHMARKS
 
-        // for unit tests, we want the app and config/resources initialized
-        // (we don't need a window, workspace and network services though)
-        UnitTestRunner runner;
-
-        // we don't want to run JUCE's unit tests, just the ones in our category:
-        runner.runTestsInCategory(UnitTestCategories::helio,
-            Random::getSystemRandom().nextInt64());
-
-        for (int i = 0; i < runner.getNumResults(); ++i)
+        // benchmarks also need the workspace with the built-in instruments
+        // to play and render projects (but still no window, audio devices,
+        // saved workspace and network services):
+        this->workspace = make<class Workspace>();
+        this->workspace->initHeadless([]()
         {
-            if (runner.getResult(i)->failures > 0)
-            {
-                throw new std::exception();
-            }
-        }
+            runUnitTestsAndQuit(UnitTestCategories::helioBenchmarks);
+        });
 
-        this->quit();
+#elif JUCE_UNIT_TESTS
 
-        // a hack to allow messages get cleaned up to avoid leaks:
-        const auto endTime = Time::currentTimeMillis() + 50;
-        while (Time::currentTimeMillis() < endTime)
-        {
-            Thread::sleep(1);
-        }
-
-        DBG("===");
+        // for unit tests, we want the app and config/resources initialized
+        // (we don't need a window, workspace and network services though)
+        runUnitTestsAndQuit(UnitTestCategories::helio);
 
 #else
 
@@ -18,6 +18,8 @@
 #pragma once
 
 class Config;
+class CompactNotes;
+class Note;
 class Network;
 class Workspace;
 class MainWindow;
@@ -31,14 +33,29 @@ class Clipboard final
 {
 public:
 
-    Clipboard() = default;
+    Clipboard();
+    ~Clipboard();
+
     void copy(const SerializedData &data, bool mirrorToSystemClipboard = false);
-    const SerializedData &getData() const noexcept;
+    const SerializedData &getData() const;
+
+    // the copied notes are kept packed, as they are, so that copy-pasting
+    // large selections doesn't need a serialization round trip;
+    // the serialized data is only created, if someone asks for it
+    void copyNotes(const Array<Note> &notes, const String &trackId);
+
+    bool hasNotes() const noexcept;
+    const CompactNotes &getNotes() const noexcept;
+    float getNotesFirstBeat() const noexcept;
 
 private:
 
     String getCurrentContentAsString() const;
-    SerializedData clipboard;
+    mutable SerializedData clipboard;
+
+    UniquePointer<CompactNotes> notes;
+    String notesTrackId;
+    float notesFirstBeat = 0.f;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Clipboard)
     JUCE_PREVENT_HEAP_ALLOCATION
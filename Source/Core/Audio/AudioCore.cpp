@@ -23,6 +23,7 @@
 #include "MetronomeSynthAudioPlugin.h"
 #include "SerializationKeys.h"
 #include "AudioMonitor.h"
+#include "JsonSerializer.h"
 
 void AudioCore::initAudioFormats(AudioPluginFormatManager &formatManager)
 {
@@ -196,14 +197,14 @@ void AudioCore::addInstrumentToMidiDevice(Instrument *instrument,
     int periodSize, Scale::Ptr chromaticMapping)
 {
     this->addFilteredMidiInputCallback(
-        &instrument->getProcessorPlayer().getMidiMessageCollector(),
+        &instrument->getProcessorPlayer().getMidiMessageQueue(),
         periodSize, chromaticMapping);
 }
 
 void AudioCore::removeInstrumentFromMidiDevice(Instrument *instrument)
 {
     this->removeFilteredMidiInputCallback(
-        &instrument->getProcessorPlayer().getMidiMessageCollector());
+        &instrument->getProcessorPlayer().getMidiMessageQueue());
 }
 
 void AudioCore::addInstrumentToAudioDevice(Instrument *instrument)
@@ -257,6 +258,46 @@ void AudioCore::setActiveMidiPlayer(const String &instrumentId,
     this->lastActiveMidiPlayer.chromaticMapping = chromaticMapping;
 }
 
+//===----------------------------------------------------------------------===//
+// Diagnostics
+//===----------------------------------------------------------------------===//
+
+SerializedData AudioCore::getLoadStatistics(bool withRecentBlocks) const
+{
+    using namespace Serialization::Audio;
+
+    SerializedData tree(Load::audioLoad);
+    tree.setProperty(Load::appVersion, App::getAppReadableVersion());
+    tree.setProperty(Load::timestamp, Time::getCurrentTime().toISO8601(true));
+    tree.appendChild(this->serializeDeviceManager());
+
+    tree.setProperty(Load::deviceCpuUsage, this->deviceManager.getCpuUsage());
+    if (auto *device = this->deviceManager.getCurrentAudioDevice())
+    {
+        // -1 if the device can't tell
+        tree.setProperty(Load::deviceXruns, device->getXRunCount());
+    }
+
+    for (auto *i : this->instruments)
+    {
+        SerializedData instrumentNode(instrument);
+        instrumentNode.setProperty(instrumentId, i->getIdAndHash());
+        instrumentNode.setProperty(instrumentName, i->getName());
+        instrumentNode.setProperty(Load::numDroppedMidiMessages,
+            i->getProcessorPlayer().getMidiMessageQueue().getNumDroppedMessages());
+        instrumentNode.appendChild(i->getProcessorPlayer().
+            getLoadMeter().getStatistics(withRecentBlocks).serialize());
+        tree.appendChild(instrumentNode);
+    }
+
+    return tree;
+}
+
+Result AudioCore::saveLoadStatistics(const File &file) const
+{
+    return JsonSerializer().saveToFile(file, this->getLoadStatistics(true));
+}
+
 //===----------------------------------------------------------------------===//
 // OrchestraPit
 //===----------------------------------------------------------------------===//
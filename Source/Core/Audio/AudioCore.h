@@ -128,6 +128,15 @@ public:
     bool isFilteringMidiInput() const noexcept;
     void setFilteringMidiInput(bool isOn) noexcept;
 
+    //===------------------------------------------------------------------===//
+    // Diagnostics
+    //===------------------------------------------------------------------===//
+
+    // the device info and the load statistics of each instrument's
+    // audio callback, optionally with the timings of recent blocks
+    SerializedData getLoadStatistics(bool withRecentBlocks) const;
+    Result saveLoadStatistics(const File &file) const;
+
     //===------------------------------------------------------------------===//
     // Serializable
     //===------------------------------------------------------------------===//
@@ -251,6 +260,9 @@ private:
                     this->getMappedKey(message.getNoteNumber()), message.getVelocity());
             }
 
+            // the recorder relies on the timestamps set by the device
+            mappedMessage.setTimeStamp(message.getTimeStamp());
+
             this->targetInstrumentCallback->handleIncomingMidiMessage(source, mappedMessage);
             jassert(this->targetInstrumentCallback != nullptr);
         }
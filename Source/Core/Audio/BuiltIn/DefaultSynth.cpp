@@ -18,27 +18,147 @@
 #include "Common.h"
 #include "DefaultSynth.h"
 
+//===----------------------------------------------------------------------===//
+// Envelope
+//===----------------------------------------------------------------------===//
+
+DefaultSynth::Envelope::Envelope()
+{
+    this->setSampleRate(44100.0);
+}
+
+void DefaultSynth::Envelope::setSampleRate(double sampleRate) noexcept
+{
+    jassert(sampleRate > 0.0);
+    this->sampleRate = sampleRate;
+    this->attackRate = float(1.0 / (attackTime * sampleRate));
+    this->decayRate = float((1.0 - sustainLevel) / (decayTime * sampleRate));
+}
+
+void DefaultSynth::Envelope::noteOn() noexcept
+{
+    this->stage = Stage::attack;
+}
+
+void DefaultSynth::Envelope::noteOff() noexcept
+{
+    if (this->stage == Stage::idle)
+    {
+        return;
+    }
+
+    if (this->level <= 0.f)
+    {
+        this->reset();
+        return;
+    }
+
+    // the release takes the same time from whatever level it starts
+    this->releaseRate = float(this->level / (releaseTime * this->sampleRate));
+    this->stage = Stage::release;
+}
+
+void DefaultSynth::Envelope::reset() noexcept
+{
+    this->stage = Stage::idle;
+    this->level = 0.f;
+}
+
+void DefaultSynth::Envelope::render(float *gains, int numSamples) noexcept
+{
+    int i = 0;
+    while (i < numSamples)
+    {
+        if (this->stage == Stage::idle)
+        {
+            FloatVectorOperations::clear(gains + i, numSamples - i);
+            return;
+        }
+
+        if (this->stage == Stage::sustain)
+        {
+            FloatVectorOperations::fill(gains + i, this->level, numSamples - i);
+            return;
+        }
+
+        float rate = 0.f;
+        float target = 0.f;
+        switch (this->stage)
+        {
+        case Stage::attack:
+            rate = this->attackRate;
+            target = 1.f;
+            break;
+        case Stage::decay:
+            rate = -this->decayRate;
+            target = sustainLevel;
+            break;
+        default:
+            rate = -this->releaseRate;
+            target = 0.f;
+            break;
+        }
+
+        const auto samplesToTarget = jmax(1,
+            int(std::ceil((target - this->level) / rate)));
+
+        const auto numRampSamples = jmin(numSamples - i, samplesToTarget);
+
+        const auto startLevel = this->level;
+        for (int j = 0; j < numRampSamples; ++j)
+        {
+            gains[i + j] = startLevel + rate * float(j + 1);
+        }
+
+        i += numRampSamples;
+
+        if (numRampSamples < samplesToTarget)
+        {
+            this->level += rate * float(numRampSamples);
+            continue;
+        }
+
+        // reached the end of the stage
+        this->level = target;
+        gains[i - 1] = target;
+
+        switch (this->stage)
+        {
+        case Stage::attack:
+            this->stage = Stage::decay;
+            break;
+        case Stage::decay:
+            this->stage = Stage::sustain;
+            break;
+        default:
+            this->reset();
+            break;
+        }
+    }
+}
+
 //===----------------------------------------------------------------------===//
 // Voice
 //===----------------------------------------------------------------------===//
 
-DefaultSynth::Voice::Voice()
+const float *DefaultSynth::Voice::getSineTable() noexcept
 {
-    ADSR::Parameters ap;
-    ap.attack = 0.001f;
-    ap.decay = 1.0f;
-    ap.sustain = 0.2f;
-    ap.release = 0.5f;
-    this->adsr.setParameters(ap);
+    struct SineTable final
+    {
+        SineTable()
+        {
+            for (int i = 0; i <= sineTableSize; ++i)
+            {
+                this->values[i] = float(std::sin(MathConstants<double>::twoPi *
+                    double(i) / double(sineTableSize)));
+            }
+        }
 
-    Reverb::Parameters rp;
-    rp.roomSize = 0.0f;
-    rp.damping = 0.0f;
-    rp.wetLevel = 0.23f;
-    rp.dryLevel = 0.73f;
-    rp.width = 0.0f;
-    rp.freezeMode = 0.4f;
-    this->reverb.setParameters(rp);
+        float values[sineTableSize + 1];
+    };
+
+    static const SineTable table;
+    return table.values;
 }
 
 bool DefaultSynth::Voice::canPlaySound(SynthesiserSound *)
@@ -50,8 +170,7 @@ void DefaultSynth::Voice::setCurrentPlaybackSampleRate(double sampleRate)
 {
     if (sampleRate > 0)
     {
-        this->adsr.setSampleRate(sampleRate);
-        this->reverb.setSampleRate(sampleRate);
+        this->envelope.setSampleRate(sampleRate);
         SynthesiserVoice::setCurrentPlaybackSampleRate(sampleRate);
     }
 }
@@ -62,48 +181,73 @@ void DefaultSynth::Voice::startNote(int midiNoteNumber, float velocity, Synthesi
     const int realNoteNumber = midiNoteNumber +
         Globals::twelveToneKeyboardSize * (channel - 1);
 
-    this->currentAngle = 0.0;
-    this->level = velocity * 0.15;
+    this->phase = 0.0;
+    this->level = velocity * 0.15f;
 
     const auto cyclesPerSecond = this->getNoteInHertz(realNoteNumber);
-    const auto cyclesPerSample = cyclesPerSecond / this->getSampleRate();
+    this->phaseDelta = cyclesPerSecond / this->getSampleRate();
 
-    this->angleDelta = cyclesPerSample * MathConstants<double>::twoPi;
-
-    this->adsr.noteOn();
+    this->envelope.noteOn();
 }
 
 void DefaultSynth::Voice::stopNote(float, bool allowTailOff)
 {
     if (allowTailOff)
     {
-        this->adsr.noteOff();
+        this->envelope.noteOff();
     }
     else
     {
         this->clearCurrentNote();
-        this->adsr.reset();
-        this->reverb.reset();
+        this->envelope.reset();
     }
 }
 
 void DefaultSynth::Voice::renderNextBlock(AudioBuffer<float> &outputBuffer, int startSample, int numSamples)
 {
-    if (this->adsr.isActive())
+    if (!this->envelope.isActive() || outputBuffer.getNumChannels() == 0)
+    {
+        return;
+    }
+
+    const auto *table = Voice::getSineTable();
+
+    float samples[Voice::renderChunkSize];
+    float gains[Voice::renderChunkSize];
+
+    while (numSamples > 0)
     {
-        while (--numSamples >= 0)
+        const auto chunkSize = jmin(numSamples, Voice::renderChunkSize);
+
+        for (int i = 0; i < chunkSize; ++i)
         {
-            const auto amplitude = this->adsr.getNextSample();
-            auto currentSample = (float)(std::sin(currentAngle) * level * amplitude);
-            this->reverb.processMono(&currentSample, 1);
+            const auto position = this->phase * double(sineTableSize);
+            const auto index = int(position);
+            const auto fraction = float(position - double(index));
+            samples[i] = table[index] + fraction * (table[index + 1] - table[index]);
 
-            for (auto i = outputBuffer.getNumChannels(); i --> 0 ;)
+            this->phase += this->phaseDelta;
+            if (this->phase >= 1.0)
             {
-                outputBuffer.addSample(i, startSample, currentSample);
+                this->phase -= std::floor(this->phase);
             }
+        }
 
-            this->currentAngle += this->angleDelta;
-            ++startSample;
+        this->envelope.render(gains, chunkSize);
+        FloatVectorOperations::multiply(gains, this->level, chunkSize);
+        FloatVectorOperations::multiply(samples, gains, chunkSize);
+
+        // the synth mixes everything into the first channel,
+        // see DefaultSynth::renderVoices
+        outputBuffer.addFrom(0, startSample, samples, chunkSize);
+
+        startSample += chunkSize;
+        numSamples -= chunkSize;
+
+        if (!this->envelope.isActive())
+        {
+            this->clearCurrentNote();
+            break;
         }
     }
 }
@@ -152,6 +296,44 @@ DefaultSynth::DefaultSynth()
     }
 
     this->addSound(new DefaultSynth::Sound());
+
+    Reverb::Parameters rp;
+    rp.roomSize = 0.0f;
+    rp.damping = 0.0f;
+    rp.wetLevel = 0.23f;
+    rp.dryLevel = 0.73f;
+    rp.width = 0.0f;
+    rp.freezeMode = 0.4f;
+    this->reverb.setParameters(rp);
+}
+
+void DefaultSynth::setCurrentPlaybackSampleRate(double sampleRate)
+{
+    if (sampleRate > 0)
+    {
+        this->reverb.setSampleRate(sampleRate);
+    }
+
+    Synthesiser::setCurrentPlaybackSampleRate(sampleRate);
+}
+
+void DefaultSynth::renderVoices(AudioBuffer<float> &outputAudio, int startSample, int numSamples)
+{
+    if (outputAudio.getNumChannels() == 0)
+    {
+        return;
+    }
+
+    Synthesiser::renderVoices(outputAudio, startSample, numSamples);
+
+    // the reverb is mono and linear enough, so processing the mix once
+    // sounds the same as processing each voice on its own, as it used to be
+    this->reverb.processMono(outputAudio.getWritePointer(0, startSample), numSamples);
+
+    for (int i = 1; i < outputAudio.getNumChannels(); ++i)
+    {
+        outputAudio.addFrom(i, startSample, outputAudio, 0, startSample, numSamples);
+    }
 }
 
 void DefaultSynth::setPeriodSizeAndRange(int periodSize, double periodRange)
@@ -166,6 +348,8 @@ void DefaultSynth::setPeriodSizeAndRange(int periodSize, double periodRange)
             voice->setPeriodRange(periodRange);
         }
     }
+
+    this->reverb.reset();
 }
 
 // the built-in synth doesn't have pedals.
@@ -174,3 +358,72 @@ void DefaultSynth::handleSustainPedal(int midiChannel, bool isDown) {}
 // seriously, just want to make sure that once I send a note-off event,
 // the BuiltInSynthVoice shuts up regardless of controller states
 void DefaultSynth::handleSostenutoPedal(int midiChannel, bool isDown) {}
+
+#if JUCE_UNIT_TESTS
+
+class DefaultSynthTests final : public UnitTest
+{
+public:
+
+    DefaultSynthTests() : UnitTest("Default synth tests", UnitTestCategories::helio) {}
+
+    void runTest() override
+    {
+        beginTest("Rendered pitch follows the temperament");
+
+        // middle C is 440 Hz for the default synth,
+        // and one period up is the period range times that
+        const auto middleC = Temperament::periodNumForMiddleC;
+        expectPitch(12, 2.0, middleC * 12 + 12, 880.0);
+        expectPitch(19, 2.0, middleC * 19 + 19, 880.0);
+        expectPitch(13, 3.0, middleC * 13 + 13, 1320.0);
+        expectPitch(31, 2.0, middleC * 31 - 31, 220.0);
+    }
+
+private:
+
+    void expectPitch(int periodSize, double periodRange, int key, double expectedHertz)
+    {
+        constexpr auto sampleRate = 48000;
+        constexpr auto blockSize = 512;
+
+        DefaultSynth synth;
+        synth.setCurrentPlaybackSampleRate(double(sampleRate));
+        synth.setPeriodSizeAndRange(periodSize, periodRange);
+
+        AudioBuffer<float> block(2, blockSize);
+        MidiBuffer midi;
+        midi.addEvent(MidiMessage::noteOn(1, key, 1.f), 0);
+
+        // skip the attack and most of the decay, and count
+        // the upward zero crossings of the next second
+        int numCrossings = 0;
+        float previousSample = 0.f;
+        for (int offset = 0; offset < sampleRate * 2; offset += blockSize)
+        {
+            block.clear();
+            synth.renderNextBlock(block, midi, 0, blockSize);
+            midi.clear();
+
+            for (int i = 0; i < blockSize; ++i)
+            {
+                const auto sample = block.getSample(0, i);
+                expectEquals(block.getSample(1, i), sample);
+                const auto isCounted = offset + i >= sampleRate && offset + i < sampleRate * 2;
+                if (isCounted && previousSample < 0.f && sample >= 0.f)
+                {
+                    numCrossings++;
+                }
+
+                previousSample = sample;
+            }
+        }
+
+        expect(std::abs(numCrossings - expectedHertz) <= 1.0,
+            "Expected " + String(expectedHertz) + " Hz, got " + String(numCrossings));
+    }
+};
+
+static DefaultSynthTests defaultSynthTests;
+
+#endif
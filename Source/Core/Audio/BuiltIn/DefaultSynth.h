@@ -25,6 +25,8 @@ public:
 
     DefaultSynth();
 
+    void setCurrentPlaybackSampleRate(double sampleRate) override;
+
     // what we want here is to make all built-in temperaments
     // work out of the box with the built-in instrument, so that
     // all features are easily previewed even before the user
@@ -45,11 +47,57 @@ protected:
         bool appliesToChannel(int midiChannel) override { return true; }
     };
 
+    // a piecewise linear ADSR, which renders its gains by blocks,
+    // one ramp per stage, instead of stepping the state for each sample
+    class Envelope final
+    {
+    public:
+
+        Envelope();
+
+        void setSampleRate(double sampleRate) noexcept;
+        void noteOn() noexcept;
+        void noteOff() noexcept;
+        void reset() noexcept;
+
+        bool isActive() const noexcept
+        {
+            return this->stage != Stage::idle;
+        }
+
+        void render(float *gains, int numSamples) noexcept;
+
+    private:
+
+        enum class Stage : int8
+        {
+            idle,
+            attack,
+            decay,
+            sustain,
+            release
+        };
+
+        Stage stage = Stage::idle;
+        float level = 0.f;
+
+        double sampleRate = 44100.0;
+
+        float attackRate = 0.f;
+        float decayRate = 0.f;
+        float releaseRate = 0.f;
+
+        static constexpr auto attackTime = 0.001f;
+        static constexpr auto decayTime = 1.f;
+        static constexpr auto sustainLevel = 0.2f;
+        static constexpr auto releaseTime = 0.5f;
+    };
+
     class Voice final : public SynthesiserVoice
     {
     public:
 
-        Voice();
+        Voice() = default;
 
         bool canPlaySound(SynthesiserSound *) override;
         void setCurrentPlaybackSampleRate(double sampleRate) override;
@@ -66,25 +114,41 @@ protected:
 
     private:
 
-        double currentAngle = 0.0;
-        double angleDelta = 0.0;
-        double level = 0.0;
+        // the phase is kept in cycles, not radians, and in double precision,
+        // so that the pitch stays exact for any temperament over long notes
+        double phase = 0.0;
+        double phaseDelta = 0.0;
+        float level = 0.f;
 
         int periodSize = Globals::twelveTonePeriodSize;
         double periodRange = 2.0;
         int middleC = Temperament::periodNumForMiddleC * Globals::twelveTonePeriodSize;
 
-        ADSR adsr;
-        Reverb reverb;
+        Envelope envelope;
+
+        // voices render in chunks of this size on the stack,
+        // so that nothing is allocated in the audio thread
+        static constexpr auto renderChunkSize = 256;
+
+        // a single sine cycle, linearly interpolated, with one guard point
+        static constexpr auto sineTableSize = 2048;
+        static const float *getSineTable() noexcept;
 
         double getNoteInHertz(int noteNumber, double frequencyOfA = 440.0) noexcept;
         int getCurrentChannel() const noexcept;
     };
 
+    // all voices are mixed into the first channel, which then goes
+    // through a single shared reverb and gets copied to other channels
+    void renderVoices(AudioBuffer<float> &outputAudio, int startSample, int numSamples) override;
+    using Synthesiser::renderVoices;
+
     void handleSustainPedal(int midiChannel, bool isDown) override;
     void handleSostenutoPedal(int midiChannel, bool isDown) override;
 
     static constexpr auto numVoices = 16;
 
+    Reverb reverb;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DefaultSynth)
 };
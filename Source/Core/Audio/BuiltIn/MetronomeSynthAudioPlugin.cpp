@@ -57,7 +57,7 @@ public:
                 const auto key = MetronomeSynth::getKeyForSyllable(syllable);
                 MidiMessage noteOn(MidiMessage::noteOn(1, key, 1.f));
                 noteOn.setTimeStamp(Time::getMillisecondCounterHiRes() * 0.001);
-                metronome->getProcessorPlayer().getMidiMessageCollector().addMessageToQueue(noteOn);
+                metronome->getProcessorPlayer().getMidiMessageQueue().addMessageToQueue(noteOn);
             };
             this->addAndMakeVisible(syllableIcon.get());
             this->syllableIcons.add(syllableIcon.release());
@@ -25,6 +25,7 @@
 #include "MetronomeSynthAudioPlugin.h"
 #include "BuiltInSynthsPluginFormat.h"
 #include "KeyboardMapping.h"
+#include "RealtimeAudit.h"
 
 Instrument::Instrument(AudioPluginFormatManager &formatManager, const String &name) :
     formatManager(formatManager),
@@ -821,18 +822,30 @@ void Instrument::AudioCallback::setProcessor(AudioProcessor *const newOne)
     }
 }
 
+// must not allocate: all buffers are sized in prepareToPlay;
+// this callback's own lock is only taken by the message thread to swap
+// or prepare the processor, so it is just tried here, and the block is
+// skipped rather than late; but the processor's callback lock is also taken
+// for state loads, suspendProcessing and graph rebuilds, and skipping blocks
+// for those would be audible, so that one is waited for
 void Instrument::AudioCallback::audioDeviceIOCallback(const float** const inputChannelData,
     const int numInputChannels, float **const outputChannelData,
     const int numOutputChannels, const int numSamples)
 {
+    const RealtimeAudit::ScopedSection realtimeSection;
+    const AudioLoadMeter::ScopedBlock measuredBlock(this->loadMeter, numSamples);
+
     jassert(this->sampleRate > 0 && this->blockSize > 0);
 
     this->incomingMidi.clear();
-    this->messageCollector.removeNextBlockOfMessages(this->incomingMidi, numSamples);
+    this->messageQueue.removeNextBlockOfMessages(this->incomingMidi, numSamples);
     int totalNumChans = 0;
 
     if (numInputChannels > numOutputChannels)
     {
+        // only allocates if the device gives a larger block than it said
+        jassert(numInputChannels - numOutputChannels <= this->tempBuffer.getNumChannels());
+        jassert(numSamples <= this->tempBuffer.getNumSamples());
         this->tempBuffer.setSize(numInputChannels - numOutputChannels, numSamples, false, false, true);
 
         for (int i = 0; i < numOutputChannels; ++i)
@@ -866,18 +879,19 @@ void Instrument::AudioCallback::audioDeviceIOCallback(const float** const inputC
         }
     }
 
-    AudioBuffer<float> buffer(this->channels, totalNumChans, numSamples);
+    // doesn't allocate for up to 32 channels
+    this->buffer.setDataToReferTo(this->channels, totalNumChans, numSamples);
 
     {
-        const ScopedLock sl(this->lock);
+        const ScopedTryLock sl(this->lock);
 
-        if (this->processor != nullptr)
+        if (sl.isLocked() && this->processor != nullptr)
         {
             const ScopedLock sl2(this->processor->getCallbackLock());
 
             if (!this->processor->isSuspended())
             {
-                this->processor->processBlock(buffer, this->incomingMidi);
+                this->processor->processBlock(this->buffer, this->incomingMidi);
                 return;
             }
         }
@@ -891,11 +905,15 @@ void Instrument::AudioCallback::audioDeviceIOCallback(const float** const inputC
 
 void Instrument::AudioCallback::audioDeviceAboutToStart(AudioIODevice *const device)
 {
-    const auto newSampleRate = device->getCurrentSampleRate();
-    const auto newBlockSize = device->getCurrentBufferSizeSamples();
-    const auto numChansIn = device->getActiveInputChannels().countNumberOfSetBits();
-    const auto numChansOut = device->getActiveOutputChannels().countNumberOfSetBits();
+    this->prepareToPlay(device->getCurrentSampleRate(),
+        device->getCurrentBufferSizeSamples(),
+        device->getActiveInputChannels().countNumberOfSetBits(),
+        device->getActiveOutputChannels().countNumberOfSetBits());
+}
 
+void Instrument::AudioCallback::prepareToPlay(double newSampleRate,
+    int newBlockSize, int numChansIn, int numChansOut)
+{
     const ScopedLock sl(this->lock);
 
     this->sampleRate = newSampleRate;
@@ -903,9 +921,15 @@ void Instrument::AudioCallback::audioDeviceAboutToStart(AudioIODevice *const dev
     this->numInputChans = numChansIn;
     this->numOutputChans = numChansOut;
 
-    this->messageCollector.reset(sampleRate);
+    this->messageQueue.reset(sampleRate);
+    this->loadMeter.reset(sampleRate);
     this->channels.calloc(jmax(numChansIn, numChansOut) + 2);
 
+    // everything the audio callback needs is allocated here
+    this->tempBuffer.setSize(jmax(1, numChansIn), newBlockSize);
+    this->incomingMidi.ensureSize(MidiMessageQueue::capacity *
+        (MidiMessageQueue::maxMessageSize + sizeof(int32) + sizeof(uint16)));
+
     if (this->processor != nullptr)
     {
         if (this->isPrepared)
@@ -936,5 +960,5 @@ void Instrument::AudioCallback::audioDeviceStopped()
 
 void Instrument::AudioCallback::handleIncomingMidiMessage(MidiInput *, const MidiMessage &message)
 {
-    this->messageCollector.addMessageToQueue(message);
+    this->messageQueue.addMessageToQueue(message);
 }
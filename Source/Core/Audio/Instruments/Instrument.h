@@ -19,6 +19,9 @@
 
 class KeyboardMapping;
 
+#include "MidiMessageQueue.h"
+#include "AudioLoadMeter.h"
+
 class Instrument final :
     public Serializable,
     public ChangeBroadcaster // notifies InstrumentEditor
@@ -50,7 +53,13 @@ public:
         AudioCallback() = default;
 
         void setProcessor(AudioProcessor *processor);
-        MidiMessageCollector &getMidiMessageCollector() noexcept { return messageCollector; }
+        MidiMessageQueue &getMidiMessageQueue() noexcept { return messageQueue; }
+        const AudioLoadMeter &getLoadMeter() const noexcept { return loadMeter; }
+
+        // sizes all the buffers, so that the callback never allocates;
+        // called by audioDeviceAboutToStart, or directly for offline use
+        void prepareToPlay(double sampleRate, int blockSize,
+            int numInputChannels, int numOutputChannels);
 
         void audioDeviceIOCallback(const float **, int, float **, int, int) override;
         void audioDeviceAboutToStart(AudioIODevice *) override;
@@ -68,10 +77,13 @@ public:
         int numInputChans = 0;
         int numOutputChans = 0;
         HeapBlock<float *> channels;
+        AudioBuffer<float> buffer;
         AudioBuffer<float> tempBuffer;
 
         MidiBuffer incomingMidi;
-        MidiMessageCollector messageCollector;
+        MidiMessageQueue messageQueue;
+
+        AudioLoadMeter loadMeter;
 
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AudioCallback)
     };
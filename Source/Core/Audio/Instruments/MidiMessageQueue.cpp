@@ -0,0 +1,275 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "Common.h"
+#include "MidiMessageQueue.h"
+
+MidiMessageQueue::MidiMessageQueue()
+{
+    static_assert(isPowerOfTwo(MidiMessageQueue::capacity),
+        "The queue capacity must be a power of two");
+
+    for (uint32 i = 0; i < MidiMessageQueue::capacity; ++i)
+    {
+        this->cells[i].sequence = i;
+    }
+}
+
+void MidiMessageQueue::reset(double newSampleRate)
+{
+    jassert(newSampleRate > 0.0);
+
+    MidiBuffer discarded;
+    this->removeNextBlockOfMessages(discarded, 1);
+
+    this->sampleRate = newSampleRate;
+    this->lastCallbackTimeMs = Time::getMillisecondCounterHiRes();
+    this->numDroppedMessages = 0;
+}
+
+void MidiMessageQueue::addMessageToQueue(const MidiMessage &message) noexcept
+{
+    // the messages need to be timestamped, see MidiInput for details
+    jassert(message.getTimeStamp() != 0.0);
+
+    const auto size = message.getRawDataSize();
+    if (size > MidiMessageQueue::maxMessageSize)
+    {
+        ++this->numDroppedMessages;
+        return;
+    }
+
+    constexpr auto mask = uint32(MidiMessageQueue::capacity - 1);
+
+    Cell *cell = nullptr;
+    auto position = this->writePosition.get();
+    while (true)
+    {
+        cell = &this->cells[position & mask];
+        const auto difference = int32(cell->sequence.get() - position);
+        if (difference == 0)
+        {
+            // the cell is free, try to claim it
+            if (this->writePosition.compareAndSetBool(position + 1, position))
+            {
+                break;
+            }
+
+            position = this->writePosition.get();
+        }
+        else if (difference < 0)
+        {
+            // the audio thread is behind by the whole queue
+            ++this->numDroppedMessages;
+            return;
+        }
+        else
+        {
+            // another writer has just claimed it
+            position = this->writePosition.get();
+        }
+    }
+
+    cell->timeStampMs = message.getTimeStamp() * 1000.0;
+    cell->size = size;
+    memcpy(cell->data, message.getRawData(), size_t(size));
+    cell->sequence = position + 1;
+}
+
+// mostly the same logic as in MidiMessageCollector, without the lock:
+// if the messages came in over a longer period than the block length,
+// they are squeezed in, otherwise they are put towards the block end
+void MidiMessageQueue::removeNextBlockOfMessages(MidiBuffer &destBuffer, int numSamples) noexcept
+{
+    const auto timeNowMs = Time::getMillisecondCounterHiRes();
+    const auto previousCallbackTimeMs = this->lastCallbackTimeMs.get();
+    this->lastCallbackTimeMs = timeNowMs;
+
+    const auto samplesPerMs = this->sampleRate.get() * 0.001;
+    int numSourceSamples = jmax(1, roundToInt((timeNowMs - previousCallbackTimeMs) * samplesPerMs));
+    int startSample = 0;
+    int scale = 0;
+
+    const bool shouldSqueeze = numSourceSamples > numSamples;
+    if (shouldSqueeze)
+    {
+        const int maxBlockLengthToUse = numSamples << 5;
+        if (numSourceSamples > maxBlockLengthToUse)
+        {
+            startSample = numSourceSamples - maxBlockLengthToUse;
+            numSourceSamples = maxBlockLengthToUse;
+        }
+
+        scale = (numSamples << 10) / numSourceSamples;
+    }
+    else
+    {
+        startSample = numSamples - numSourceSamples;
+    }
+
+    constexpr auto mask = uint32(MidiMessageQueue::capacity - 1);
+
+    while (true)
+    {
+        auto &cell = this->cells[this->readPosition & mask];
+        if (cell.sequence.get() != this->readPosition + 1)
+        {
+            break; // empty, or the next message is still being written
+        }
+
+        const auto samplePosition = int(jlimit(double(-numSamples),
+            double(startSample + numSourceSamples),
+            (cell.timeStampMs - previousCallbackTimeMs) * samplesPerMs));
+
+        // unlike the collector, this never skips the older messages,
+        // so that a late note-off doesn't leave the note hanging
+        const auto blockPosition = shouldSqueeze ?
+            ((jmax(samplePosition, startSample) - startSample) * scale) >> 10 :
+            samplePosition + startSample;
+
+        destBuffer.addEvent(cell.data, cell.size, jlimit(0, numSamples - 1, blockPosition));
+
+        cell.sequence = this->readPosition + MidiMessageQueue::capacity;
+        ++this->readPosition;
+    }
+}
+
+int MidiMessageQueue::getNumDroppedMessages() const noexcept
+{
+    return this->numDroppedMessages.get();
+}
+
+//===----------------------------------------------------------------------===//
+// MidiInputCallback
+//===----------------------------------------------------------------------===//
+
+void MidiMessageQueue::handleIncomingMidiMessage(MidiInput *, const MidiMessage &message)
+{
+    this->addMessageToQueue(message);
+}
+
+//===----------------------------------------------------------------------===//
+// Tests
+//===----------------------------------------------------------------------===//
+
+#if JUCE_UNIT_TESTS
+
+class MidiMessageQueueTests final : public UnitTest
+{
+public:
+
+    MidiMessageQueueTests() : UnitTest("Midi message queue tests", UnitTestCategories::helio) {}
+
+    void runTest() override
+    {
+        beginTest("Adding from multiple threads");
+
+        struct Writer final : public Thread
+        {
+            Writer(MidiMessageQueue &queue, int channel) :
+                Thread("MidiMessageQueueTests"), queue(queue), channel(channel) {}
+
+            void run() override
+            {
+                for (int i = 0; i < numMessages; ++i)
+                {
+                    auto message = MidiMessage::controllerEvent(this->channel, 1, i % 128);
+                    message.setTimeStamp(Time::getMillisecondCounterHiRes() * 0.001);
+                    this->queue.addMessageToQueue(message);
+                }
+            }
+
+            static constexpr auto numMessages = 1000;
+
+            MidiMessageQueue &queue;
+            const int channel;
+        };
+
+        auto queue = make<MidiMessageQueue>();
+        queue->reset(44100.0);
+
+        OwnedArray<Writer> writers;
+        for (int channel = 1; channel <= 4; ++channel)
+        {
+            writers.add(new Writer(*queue, channel))->startThread();
+        }
+
+        // the reader keeps draining while the writers are still adding
+        MidiBuffer buffer;
+        buffer.ensureSize(MidiMessageQueue::capacity * 4);
+        int lastValues[5] = { -1, -1, -1, -1, -1 };
+        int numReceived = 0;
+        int numOutOfOrder = 0;
+
+        const auto receive = [&]()
+        {
+            buffer.clear();
+            queue->removeNextBlockOfMessages(buffer, 512);
+            for (const auto meta : buffer)
+            {
+                const auto message = meta.getMessage();
+                auto &lastValue = lastValues[message.getChannel()];
+                numOutOfOrder += (message.getControllerValue() != (lastValue + 1) % 128) ? 1 : 0;
+                lastValue = message.getControllerValue();
+                numReceived++;
+            }
+        };
+
+        for (auto *writer : writers)
+        {
+            while (writer->isThreadRunning())
+            {
+                receive();
+            }
+        }
+
+        receive();
+
+        expectEquals(numReceived + queue->getNumDroppedMessages(), Writer::numMessages * 4);
+        expectEquals(numOutOfOrder, 0);
+
+        beginTest("Overflow");
+
+        queue->reset(44100.0);
+        for (int i = 0; i < MidiMessageQueue::capacity + 10; ++i)
+        {
+            auto message = MidiMessage::noteOn(1, 60, 1.f);
+            message.setTimeStamp(Time::getMillisecondCounterHiRes() * 0.001);
+            queue->addMessageToQueue(message);
+        }
+
+        expectEquals(queue->getNumDroppedMessages(), 10);
+
+        buffer.clear();
+        queue->removeNextBlockOfMessages(buffer, 512);
+        expectEquals(buffer.getNumEvents(), MidiMessageQueue::capacity);
+
+        // the queue is reusable after the overflow
+        auto message = MidiMessage::noteOff(1, 60);
+        message.setTimeStamp(Time::getMillisecondCounterHiRes() * 0.001);
+        queue->addMessageToQueue(message);
+
+        buffer.clear();
+        queue->removeNextBlockOfMessages(buffer, 512);
+        expectEquals(buffer.getNumEvents(), 1);
+    }
+};
+
+static MidiMessageQueueTests midiMessageQueueTests;
+
+#endif
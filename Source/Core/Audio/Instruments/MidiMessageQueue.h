@@ -0,0 +1,84 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+// A replacement for JUCE's MidiMessageCollector, which takes a lock
+// shared with the audio callback for every message added; this one
+// is a fixed-capacity ring buffer, which any number of threads
+// (the players, the note previews, the midi input) can add to
+// without ever blocking the audio thread, the only reader;
+// the messages keep their timestamps, which are converted to sample
+// positions when the block is read, all relative to the previous
+// audio callback time, so that the order is kept within the block;
+// the messages which don't fit are dropped and counted
+
+class MidiMessageQueue final : public MidiInputCallback
+{
+public:
+
+    MidiMessageQueue();
+
+    // called when the audio device is (re)started,
+    // while the audio thread isn't reading the queue
+    void reset(double sampleRate);
+
+    // any thread, never blocks; the message timestamp is expected
+    // to be in seconds, on the Time::getMillisecondCounterHiRes() clock
+    void addMessageToQueue(const MidiMessage &message) noexcept;
+
+    // the audio thread only, doesn't allocate as long as
+    // the buffer has enough space preallocated
+    void removeNextBlockOfMessages(MidiBuffer &destBuffer, int numSamples) noexcept;
+
+    // since the last reset
+    int getNumDroppedMessages() const noexcept;
+
+    //===------------------------------------------------------------------===//
+    // MidiInputCallback
+    //===------------------------------------------------------------------===//
+
+    void handleIncomingMidiMessage(MidiInput *, const MidiMessage &message) override;
+
+    static constexpr auto capacity = 4096; // must be a power of two
+    static constexpr auto maxMessageSize = 16; // larger sysex messages are dropped
+
+private:
+
+    struct Cell final
+    {
+        // equals the write position when the cell is free to write,
+        // and the write position + 1 when the message is ready to read
+        Atomic<uint32> sequence = 0;
+        double timeStampMs = 0.0;
+        int size = 0;
+        uint8 data[maxMessageSize];
+    };
+
+    Cell cells[capacity];
+
+    Atomic<uint32> writePosition = 0;
+    uint32 readPosition = 0; // the reader's only
+
+    Atomic<double> sampleRate = 0.0;
+    Atomic<double> lastCallbackTimeMs = 0.0;
+
+    Atomic<int> numDroppedMessages = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MidiMessageQueue)
+};
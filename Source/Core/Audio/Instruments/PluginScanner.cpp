@@ -74,6 +74,12 @@ bool PluginScanner::hasInstruments() const
 
 void PluginScanner::removePlugin(const PluginDescription &description)
 {
+    {
+        // make sure the removed plugin will be re-checked on the next scan
+        const ScopedLock lock(this->scanCacheLock);
+        this->scanCache.erase(description.fileOrIdentifier);
+    }
+
     this->pluginsList.removeType(description);
     this->sendChangeMessage();
 }
@@ -88,6 +94,26 @@ bool PluginScanner::isWorking() const
     return this->working.get();
 }
 
+float PluginScanner::getScanProgress() const noexcept
+{
+    const auto total = this->numFilesToScan.get();
+    if (total == 0)
+    {
+        return this->isWorking() ? 0.f : 1.f;
+    }
+
+    return jlimit(0.f, 1.f, float(this->numFilesScanned.get()) / float(total));
+}
+
+int PluginScanner::getConfiguredNumScanProcesses()
+{
+    // the checker processes mostly wait for disk and plugin initialization,
+    // but some plugins are heavy on startup, so let's not go crazy here
+    const auto defaultNumProcesses = jlimit(1, 8, SystemStats::getNumCpus() - 1);
+    const int numProcesses = App::Config().getProperty(Serialization::Config::pluginScanProcesses, defaultNumProcesses);
+    return jlimit(1, 32, numProcesses);
+}
+
 void PluginScanner::cancelRunningScan()
 {
     if (!this->isWorking())
@@ -113,6 +139,8 @@ void PluginScanner::runInitialScan()
         this->startThread(0);
     }
 
+    this->numScanProcesses = PluginScanner::getConfiguredNumScanProcesses();
+
     // prepare search paths, prepare specific files to scan,
     // clear the existing list and resume search thread
 
@@ -162,6 +190,8 @@ void PluginScanner::scanFolderAndAddResults(const File &dir)
         this->startThread(0);
     }
 
+    this->numScanProcesses = PluginScanner::getConfiguredNumScanProcesses();
+
     // prepare search paths and resume search thread
 
     this->filesToScan.clearQuick();
@@ -201,11 +231,18 @@ void PluginScanner::run()
         // plugins list might have changed while waiting:
         this->sendChangeMessage();
 
+        const auto scanStartTime = Time::getMillisecondCounterHiRes();
+
+        this->pruneScanCache();
+
         for (int i = 0; i < formatManager.getNumFormats(); ++i)
         {
             auto *format = formatManager.getFormat(i);
             const auto foundPlugins = format->searchPathsForPlugins(this->searchPath, true, true);
-            this->filesToScan.addArray(foundPlugins);
+            for (const auto &pluginPath : foundPlugins)
+            {
+                this->filesToScan.addIfNotAlreadyThere(pluginPath);
+            }
 
             if (this->cancelled.get())
             {
@@ -214,11 +251,89 @@ void PluginScanner::run()
             }
         }
 
+        // skip the binaries which haven't changed since the last scan:
+        FlatHashSet<String, StringHash> knownFiles;
+        for (const auto &description : this->getPlugins())
+        {
+            knownFiles.insert(description.fileOrIdentifier);
+        }
+
+        StringArray changedFiles;
+        for (const auto &pluginPath : this->filesToScan)
+        {
+            if (!this->isCachedAndUpToDate(pluginPath, knownFiles))
+            {
+                changedFiles.add(pluginPath);
+            }
+        }
+
+        const auto numCachedFiles = this->filesToScan.size() - changedFiles.size();
+        this->numFilesToScan = changedFiles.size();
+        this->numFilesScanned = 0;
+
         try
         {
+#if SAFE_SCAN
+
+            // each plugin is checked in a separate process, so that it can't
+            // crash the app, and up to numScanProcesses checkers run at once;
+            // the checker reads the plugin path from the temp file and then
+            // deletes it, and writes back the found plugin types, if any
+
+            struct ScanJob final
+            {
+                String pluginPath;
+                File tempFile;
+                ChildProcess process;
+                double startTime = 0.0;
+            };
+
+            static constexpr auto scanJobTimeoutMs = 60000.0;
+            static constexpr auto scanJobPollingMs = 5;
+
             const auto myPath(File::getSpecialLocation(File::currentExecutableFile).getFullPathName());
 
-            for (const auto &pluginPath : this->filesToScan)
+            OwnedArray<ScanJob> runningJobs;
+            int nextFileIndex = 0;
+
+            const auto finishJob = [this](ScanJob *job, bool hasTimedOut)
+            {
+                Array<PluginDescription> typesFound;
+
+                if (hasTimedOut)
+                {
+                    DBG("Plugin check timed out: " + job->pluginPath);
+                    job->process.kill();
+                }
+                else if (job->tempFile.existsAsFile())
+                {
+                    try
+                    {
+                        const auto tree(DocumentHelpers::load<XmlSerializer>(job->tempFile));
+                        if (tree.isValid())
+                        {
+                            forEachChildWithType(tree, e, Serialization::Audio::plugin)
+                            {
+                                SerializablePluginDescription pluginDescription;
+                                pluginDescription.deserialize(e);
+                                typesFound.add(pluginDescription);
+                            }
+                        }
+                    }
+                    catch (...) {}
+                }
+
+                job->tempFile.deleteFile();
+
+                // a crashed plugin is cached too (with zero types found),
+                // so that it will not slow down the next scans, unless
+                // the binary gets updated; a timed out one is not cached,
+                // since it might have been just too slow under the load,
+                // so it will be retried next time
+                this->addScanResults(job->pluginPath, typesFound, !hasTimedOut);
+            };
+
+            while (!this->threadShouldExit())
             {
                 if (this->cancelled.get())
                 {
@@ -226,57 +341,70 @@ void PluginScanner::run()
                     break;
                 }
 
-#if SAFE_SCAN
-                DBG("Safe scanning: " + pluginPath);
+                while (runningJobs.size() < this->numScanProcesses.get() &&
+                    nextFileIndex < changedFiles.size())
+                {
+                    auto job = make<ScanJob>();
+                    job->pluginPath = changedFiles[nextFileIndex++];
 
-                const Uuid tempFileName;
-                const File tempFile(DocumentHelpers::getTempSlot(tempFileName.toString()));
-                tempFile.appendText(pluginPath, false, false);
+                    DBG("Safe scanning: " + job->pluginPath);
 
-                Thread::sleep(50);
+                    const auto tempFileName = Uuid().toString();
+                    job->tempFile = DocumentHelpers::getTempSlot(tempFileName);
+                    job->tempFile.replaceWithText(job->pluginPath, false, false);
+                    job->startTime = Time::getMillisecondCounterHiRes();
 
-                ChildProcess checkerProcess;
-                const String commandLine(myPath + " " + tempFileName.toString());
-                checkerProcess.start(commandLine);
+                    if (job->process.start(myPath + " " + tempFileName))
+                    {
+                        runningJobs.add(job.release());
+                    }
+                    else
+                    {
+                        job->tempFile.deleteFile();
+                        this->numFilesScanned += 1;
+                    }
+                }
 
-                if (!checkerProcess.waitForProcessToFinish(60000))
+                if (runningJobs.isEmpty())
                 {
-                    checkerProcess.kill();
+                    break;
                 }
-                else
+
+                const auto now = Time::getMillisecondCounterHiRes();
+                for (int i = runningJobs.size() - 1; i >= 0; --i)
                 {
-                    if (this->cancelled.get())
+                    auto *job = runningJobs.getUnchecked(i);
+                    const auto hasTimedOut = (now - job->startTime) > scanJobTimeoutMs;
+                    if (hasTimedOut || !job->process.isRunning())
                     {
-                        DBG("Plugin scanning canceled");
-                        tempFile.deleteFile();
-                        break;
+                        finishJob(job, hasTimedOut);
+                        runningJobs.remove(i);
                     }
+                }
 
-                    Thread::sleep(50);
+                Thread::sleep(scanJobPollingMs);
+            }
 
-                    if (tempFile.existsAsFile())
-                    {
-                        try
-                        {
-                            const auto tree(DocumentHelpers::load<XmlSerializer>(tempFile));
-                            if (tree.isValid())
-                            {
-                                forEachChildWithType(tree, e, Serialization::Audio::plugin)
-                                {
-                                    SerializablePluginDescription pluginDescription;
-                                    pluginDescription.deserialize(e);
-                                    this->pluginsList.addType(pluginDescription);
-                                }
-                                    
-                                this->sendChangeMessage();
-                            }
-                        }
-                        catch (...) {}
-                    }
-                }
+            // cancelled, or the app is quitting: whatever is still
+            // running should not outlive the scan and litter temp files
+            for (auto *job : runningJobs)
+            {
+                job->process.kill();
+                job->tempFile.deleteFile();
+            }
+
+            runningJobs.clear();
 
-                tempFile.deleteFile();
 #else
+
+            for (const auto &pluginPath : changedFiles)
+            {
+                if (this->cancelled.get())
+                {
+                    DBG("Plugin scanning canceled");
+                    break;
+                }
+
                 DBG("Unsafe scanning: " + pluginPath);
 
                 KnownPluginList knownPluginList;
@@ -293,26 +421,38 @@ void PluginScanner::run()
                 catch (...) {}
                     
                 // at this point we are still alive and plugin haven't crashed the app
-                if (typesFound.size() != 0)
+                Array<PluginDescription> results;
+                for (const auto *type : typesFound)
                 {
-                    for (auto *type : typesFound)
-                    {
-                        this->pluginsList.addType(*type);
-                    }
+                    results.add(*type);
                 }
-                    
-                this->sendChangeMessage();
+
+                this->addScanResults(pluginPath, results);
                 Thread::sleep(150);
-#endif
             }
+
+#endif
         }
         catch (...) {}
 
         {
+            {
+                const ScopedLock lock(this->scanCacheLock);
+                this->lastScanStats.numFilesChecked = this->numFilesScanned.get();
+                this->lastScanStats.numFilesCached = numCachedFiles;
+                this->lastScanStats.durationMs =
+                    roundToInt(Time::getMillisecondCounterHiRes() - scanStartTime);
+
+                DBG("Plugin scan finished in " + String(this->lastScanStats.durationMs) + " ms, " +
+                    String(this->lastScanStats.numFilesChecked) + " files checked, " +
+                    String(this->lastScanStats.numFilesCached) + " skipped as cached");
+            }
+
             this->cancelled = false;
             this->working = false;
-            
-            DBG("Done scanning for audio plugins");
+            this->numFilesToScan = 0;
+            this->numFilesScanned = 0;
+
             this->sendChangeMessage();
         }
         
@@ -320,6 +460,120 @@ void PluginScanner::run()
     }
 }
 
+void PluginScanner::addScanResults(const String &pluginPath,
+    const Array<PluginDescription> &typesFound, bool shouldUpdateCache)
+{
+    for (const auto &type : typesFound)
+    {
+        this->pluginsList.addType(type);
+    }
+
+    if (shouldUpdateCache)
+    {
+        this->updateScanCache(pluginPath, typesFound.size());
+    }
+
+    this->numFilesScanned += 1;
+
+    this->sendChangeMessage();
+}
+
+//===----------------------------------------------------------------------===//
+// Scan cache
+//===----------------------------------------------------------------------===//
+
+bool PluginScanner::isCachedAndUpToDate(const String &pluginPath,
+    const FlatHashSet<String, StringHash> &knownFiles) const
+{
+    // built-in instruments are identified by ids, not by files,
+    // and it's cheap to check them anyway:
+    if (!File::isAbsolutePath(pluginPath))
+    {
+        return false;
+    }
+
+    const File file(pluginPath);
+    if (!file.exists())
+    {
+        return false;
+    }
+
+    ScannedFileInfo info;
+
+    {
+        const ScopedLock lock(this->scanCacheLock);
+        const auto found = this->scanCache.find(pluginPath);
+        if (found == this->scanCache.end())
+        {
+            return false;
+        }
+
+        info = found->second;
+    }
+
+    if (info.modificationTime != file.getLastModificationTime().toMilliseconds() ||
+        info.size != file.getSize())
+    {
+        return false;
+    }
+
+    if (info.numTypesFound == 0)
+    {
+        return true; // not a plugin, or a broken one, and it hasn't changed
+    }
+
+    // the types found before should still be in the list,
+    // otherwise the plugin needs to be re-scanned
+    return knownFiles.find(pluginPath) != knownFiles.end();
+}
+
+void PluginScanner::pruneScanCache()
+{
+    StringArray cachedPaths;
+
+    {
+        const ScopedLock lock(this->scanCacheLock);
+        for (const auto &it : this->scanCache)
+        {
+            cachedPaths.add(it.first);
+        }
+    }
+
+    // the file checks are done without holding the lock
+    StringArray missingPaths;
+    for (const auto &pluginPath : cachedPaths)
+    {
+        if (!File::isAbsolutePath(pluginPath) || !File(pluginPath).exists())
+        {
+            missingPaths.add(pluginPath);
+        }
+    }
+
+    const ScopedLock lock(this->scanCacheLock);
+    for (const auto &pluginPath : missingPaths)
+    {
+        this->scanCache.erase(pluginPath);
+    }
+}
+
+void PluginScanner::updateScanCache(const String &pluginPath, int numTypesFound)
+{
+    if (!File::isAbsolutePath(pluginPath))
+    {
+        return;
+    }
+
+    const File file(pluginPath);
+
+    ScannedFileInfo info;
+    info.modificationTime = file.getLastModificationTime().toMilliseconds();
+    info.size = file.getSize();
+    info.numTypesFound = numTypesFound;
+
+    const ScopedLock lock(this->scanCacheLock);
+    this->scanCache[pluginPath] = info;
+}
+
 FileSearchPath PluginScanner::getCommonFolders()
 {
     FileSearchPath folders;
@@ -398,6 +652,28 @@ SerializedData PluginScanner::serialize() const
         tree.appendChild(pd.serialize());
     }
 
+    SerializedData cacheNode(Serialization::Audio::pluginsScanCache);
+
+    {
+        const ScopedLock lock(this->scanCacheLock);
+
+        cacheNode.setProperty(Serialization::Audio::lastScanNumChecked, this->lastScanStats.numFilesChecked);
+        cacheNode.setProperty(Serialization::Audio::lastScanNumCached, this->lastScanStats.numFilesCached);
+        cacheNode.setProperty(Serialization::Audio::lastScanDurationMs, this->lastScanStats.durationMs);
+
+        for (const auto &it : this->scanCache)
+        {
+            SerializedData fileNode(Serialization::Audio::scannedFile);
+            fileNode.setProperty(Serialization::Audio::scannedFilePath, it.first);
+            fileNode.setProperty(Serialization::Audio::scannedFileModTime, String::toHexString(it.second.modificationTime));
+            fileNode.setProperty(Serialization::Audio::scannedFileSize, String::toHexString(it.second.size));
+            fileNode.setProperty(Serialization::Audio::scannedFileNumTypes, it.second.numTypesFound);
+            cacheNode.appendChild(fileNode);
+        }
+    }
+
+    tree.appendChild(cacheNode);
+
     return tree;
 }
 
@@ -410,7 +686,7 @@ void PluginScanner::deserialize(const SerializedData &data)
 
     if (!root.isValid()) { return; }
     
-    for (const auto &child : root)
+    forEachChildWithType(root, child, Serialization::Audio::plugin)
     {
         SerializablePluginDescription pluginDescription;
         pluginDescription.deserialize(child);
@@ -420,11 +696,36 @@ void PluginScanner::deserialize(const SerializedData &data)
         }
     }
 
+    const auto cacheNode = root.getChildWithName(Serialization::Audio::pluginsScanCache);
+    if (cacheNode.isValid())
+    {
+        const ScopedLock lock(this->scanCacheLock);
+
+        this->lastScanStats.numFilesChecked = cacheNode.getProperty(Serialization::Audio::lastScanNumChecked);
+        this->lastScanStats.numFilesCached = cacheNode.getProperty(Serialization::Audio::lastScanNumCached);
+        this->lastScanStats.durationMs = cacheNode.getProperty(Serialization::Audio::lastScanDurationMs);
+
+        forEachChildWithType(cacheNode, fileNode, Serialization::Audio::scannedFile)
+        {
+            ScannedFileInfo info;
+            info.modificationTime = fileNode.getProperty(Serialization::Audio::scannedFileModTime).toString().getHexValue64();
+            info.size = fileNode.getProperty(Serialization::Audio::scannedFileSize).toString().getHexValue64();
+            info.numTypesFound = fileNode.getProperty(Serialization::Audio::scannedFileNumTypes);
+            this->scanCache[fileNode.getProperty(Serialization::Audio::scannedFilePath).toString()] = info;
+        }
+    }
+
     this->sendChangeMessage();
 }
 
 void PluginScanner::reset()
 {
+    {
+        const ScopedLock lock(this->scanCacheLock);
+        this->scanCache.clear();
+        this->lastScanStats = {};
+    }
+
     this->pluginsList.clear();
     this->sendChangeMessage();
 }
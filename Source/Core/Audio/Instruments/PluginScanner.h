@@ -49,6 +49,9 @@ public:
     void scanFolderAndAddResults(const File &dir);
     void cancelRunningScan();
 
+    // 0..1, updated as the scan results arrive
+    float getScanProgress() const noexcept;
+
     //===------------------------------------------------------------------===//
     // Serializable
     //===------------------------------------------------------------------===//
@@ -70,10 +73,54 @@ private:
     Atomic<bool> working = false;
     Atomic<bool> cancelled = false;
 
+    Atomic<int> numFilesToScan = 0;
+    Atomic<int> numFilesScanned = 0;
+
     // paths and files to be checked in a search thread:
     FileSearchPath searchPath;
     StringArray filesToScan;
 
+    // how many checker processes can run simultaneously
+    Atomic<int> numScanProcesses = 1;
+    static int getConfiguredNumScanProcesses();
+
+    //===------------------------------------------------------------------===//
+    // Scan cache
+    //===------------------------------------------------------------------===//
+
+    // the files which have been checked already, keyed by path,
+    // so that only new or changed binaries are re-scanned:
+    struct ScannedFileInfo final
+    {
+        int64 modificationTime = 0;
+        int64 size = 0;
+        int numTypesFound = 0;
+    };
+
+    FlatHashMap<String, ScannedFileInfo, StringHash> scanCache;
+
+    // the stats of the last finished scan, logged
+    // at the end of each scan and saved along with the cache
+    struct ScanStats final
+    {
+        int numFilesChecked = 0;
+        int numFilesCached = 0;
+        int durationMs = 0;
+    };
+
+    ScanStats lastScanStats;
+    CriticalSection scanCacheLock;
+
+    // removes the entries for the files which don't exist anymore
+    void pruneScanCache();
+
+    bool isCachedAndUpToDate(const String &pluginPath,
+        const FlatHashSet<String, StringHash> &knownFiles) const;
+    void updateScanCache(const String &pluginPath, int numTypesFound);
+
+    void addScanResults(const String &pluginPath,
+        const Array<PluginDescription> &typesFound, bool shouldUpdateCache = true);
+
     FileSearchPath getCommonFolders();
     void scanPossibleSubfolders(const StringArray &possibleSubfolders,
         const File &currentSystemFolder, FileSearchPath &foldersOut);
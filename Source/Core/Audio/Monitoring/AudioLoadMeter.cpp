@@ -0,0 +1,259 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "Common.h"
+#include "AudioLoadMeter.h"
+#include "SerializationKeys.h"
+
+void AudioLoadMeter::reset(double sampleRate) noexcept
+{
+    this->samplesPerMs = sampleRate / 1000.0;
+    this->numBlocks = 0;
+    this->numOverruns = 0;
+}
+
+AudioLoadMeter::ScopedBlock::ScopedBlock(AudioLoadMeter &meter, int numSamples) noexcept :
+    meter(meter),
+    numSamples(numSamples),
+    startTimeMs(Time::getMillisecondCounterHiRes()) {}
+
+AudioLoadMeter::ScopedBlock::~ScopedBlock() noexcept
+{
+    this->meter.addBlock(this->startTimeMs,
+        Time::getMillisecondCounterHiRes(), this->numSamples);
+}
+
+void AudioLoadMeter::addBlock(double startTimeMs, double endTimeMs, int numSamples) noexcept
+{
+    const auto samplesPerMs = this->samplesPerMs.get();
+    if (samplesPerMs <= 0.0 || numSamples <= 0)
+    {
+        return;
+    }
+
+    const auto elapsedMs = endTimeMs - startTimeMs;
+    const auto budgetMs = double(numSamples) / samplesPerMs;
+    const auto load = float(elapsedMs / budgetMs);
+
+    // only this thread writes, so there's no need for read-modify-write
+    const auto blockIndex = this->numBlocks.get();
+    auto &record = this->history[blockIndex % AudioLoadMeter::historySize];
+    record.startTimeMs = startTimeMs;
+    record.elapsedMs = elapsedMs;
+    record.load = load;
+
+    if (load > 1.f)
+    {
+        this->numOverruns = this->numOverruns.get() + 1;
+    }
+
+    // publishes the record
+    this->numBlocks = blockIndex + 1;
+}
+
+AudioLoadMeter::Statistics AudioLoadMeter::getStatistics(bool withRecentBlocks) const
+{
+    Statistics result;
+
+    const auto endIndex = this->numBlocks.get();
+    const auto startIndex = jmax(int64(0), endIndex - AudioLoadMeter::historySize);
+
+    Block blocks[AudioLoadMeter::historySize];
+    for (auto i = startIndex; i < endIndex; ++i)
+    {
+        const auto &record = this->history[i % AudioLoadMeter::historySize];
+        auto &block = blocks[i - startIndex];
+        block.startTimeMs = record.startTimeMs.get();
+        block.elapsedMs = record.elapsedMs.get();
+        block.load = record.load.get();
+    }
+
+    result.numBlocks = this->numBlocks.get();
+    result.numOverruns = this->numOverruns.get();
+
+    // the writer might have lapped the reader, then the oldest
+    // copied records are not reliable, up to the one being written now;
+    // if the meter was reset meanwhile, the copied ones are still fine
+    const auto firstValidIndex = jlimit(startIndex, endIndex,
+        result.numBlocks + 1 - AudioLoadMeter::historySize);
+
+    const auto numValidBlocks = int(endIndex - firstValidIndex);
+    if (numValidBlocks == 0)
+    {
+        return result;
+    }
+
+    if (withRecentBlocks)
+    {
+        result.recentBlocks.ensureStorageAllocated(numValidBlocks);
+    }
+
+    double loadSum = 0.0;
+    for (auto i = firstValidIndex; i < endIndex; ++i)
+    {
+        const auto &block = blocks[i - startIndex];
+        loadSum += block.load;
+        result.peakLoad = jmax(result.peakLoad, block.load);
+
+        const auto bin = jlimit(0, AudioLoadMeter::numHistogramBins - 1,
+            int(block.load * float(AudioLoadMeter::numHistogramBins - 1)));
+        result.histogram[bin]++;
+
+        if (withRecentBlocks)
+        {
+            result.recentBlocks.add(block);
+        }
+    }
+
+    result.averageLoad = float(loadSum / double(numValidBlocks));
+    return result;
+}
+
+SerializedData AudioLoadMeter::Statistics::serialize() const
+{
+    using namespace Serialization::Audio;
+
+    SerializedData tree(Load::audioLoad);
+    tree.setProperty(Load::numBlocks, this->numBlocks);
+    tree.setProperty(Load::numOverruns, this->numOverruns);
+    tree.setProperty(Load::averageLoad, this->averageLoad);
+    tree.setProperty(Load::peakLoad, this->peakLoad);
+
+    for (int i = 0; i < AudioLoadMeter::numHistogramBins; ++i)
+    {
+        SerializedData bin(Load::histogramBin);
+        // the last bin has no upper bound
+        const auto maxLoad = (i == AudioLoadMeter::numHistogramBins - 1) ?
+            var() : var(float(i + 1) / float(AudioLoadMeter::numHistogramBins - 1));
+        bin.setProperty(Load::histogramBinMaxLoad, maxLoad);
+        bin.setProperty(Load::histogramBinCount, this->histogram[i]);
+        tree.appendChild(bin);
+    }
+
+    for (const auto &block : this->recentBlocks)
+    {
+        SerializedData blockNode(Load::block);
+        blockNode.setProperty(Load::blockStartTime, block.startTimeMs);
+        blockNode.setProperty(Load::blockElapsedTime, block.elapsedMs);
+        blockNode.setProperty(Load::blockLoad, block.load);
+        tree.appendChild(blockNode);
+    }
+
+    return tree;
+}
+
+//===----------------------------------------------------------------------===//
+// Tests
+//===----------------------------------------------------------------------===//
+
+#if JUCE_UNIT_TESTS
+
+class AudioLoadMeterTests final : public UnitTest
+{
+public:
+
+    AudioLoadMeterTests() : UnitTest("Audio load meter tests", UnitTestCategories::helio) {}
+
+    void runTest() override
+    {
+        beginTest("Load, overruns and histogram");
+
+        // 1 sample per millisecond makes the numbers easy
+        AudioLoadMeter meter;
+        meter.reset(1000.0);
+
+        const auto noStatistics = meter.getStatistics(true);
+        expectEquals(noStatistics.numBlocks, int64(0));
+        expectEquals(noStatistics.recentBlocks.size(), 0);
+
+        meter.addBlock(0.0, 5.0, 10); // 50%
+        meter.addBlock(10.0, 12.5, 10); // 25%
+        meter.addBlock(20.0, 35.0, 10); // 150%
+
+        const auto statistics = meter.getStatistics(true);
+        expectEquals(statistics.numBlocks, int64(3));
+        expectEquals(statistics.numOverruns, int64(1));
+        expectWithinAbsoluteError(statistics.peakLoad, 1.5f, 0.001f);
+        expectWithinAbsoluteError(statistics.averageLoad, 0.75f, 0.001f);
+        expectEquals(statistics.histogram[2], 1);
+        expectEquals(statistics.histogram[5], 1);
+        expectEquals(statistics.histogram[AudioLoadMeter::numHistogramBins - 1], 1);
+        expectEquals(statistics.recentBlocks.size(), 3);
+        expectEquals(statistics.recentBlocks.getLast().startTimeMs, 20.0);
+
+        beginTest("Rolling window");
+
+        for (int i = 0; i < AudioLoadMeter::historySize; ++i)
+        {
+            meter.addBlock(100.0 + i, 100.0 + i + 1.0, 10); // 10%
+        }
+
+        // the overrun is out of the window, but still counted
+        const auto rolled = meter.getStatistics(false);
+        expectEquals(rolled.numBlocks, int64(AudioLoadMeter::historySize + 3));
+        expectEquals(rolled.numOverruns, int64(1));
+        expectWithinAbsoluteError(rolled.peakLoad, 0.1f, 0.001f);
+        expectEquals(rolled.recentBlocks.size(), 0);
+
+        // the reader assumes the newest slot might be being written
+        expectEquals(rolled.histogram[1], AudioLoadMeter::historySize - 1);
+
+        beginTest("Concurrent reading");
+
+        struct Writer final : public Thread
+        {
+            explicit Writer(AudioLoadMeter &meter) :
+                Thread("AudioLoadMeterTests"), meter(meter) {}
+
+            void run() override
+            {
+                for (int i = 0; i < AudioLoadMeter::historySize * 64 && !this->threadShouldExit(); ++i)
+                {
+                    // each block's start time encodes its load
+                    this->meter.addBlock(double(i % 10), double(i % 10) * 1.1, 10);
+                }
+            }
+
+            AudioLoadMeter &meter;
+        };
+
+        meter.reset(1000.0);
+        Writer writer(meter);
+        writer.startThread();
+
+        int numInconsistentReads = 0;
+        while (writer.isThreadRunning())
+        {
+            const auto concurrent = meter.getStatistics(true);
+            for (const auto &block : concurrent.recentBlocks)
+            {
+                const auto expectedLoad = float(block.startTimeMs * 0.01);
+                if (std::abs(block.load - expectedLoad) > 0.0001f)
+                {
+                    numInconsistentReads++;
+                }
+            }
+        }
+
+        expectEquals(numInconsistentReads, 0);
+    }
+};
+
+static AudioLoadMeterTests audioLoadMeterTests;
+
+#endif
@@ -0,0 +1,110 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+// Measures how much of its time budget an audio callback takes per block:
+// each meter is written only by the audio device thread running the callback,
+// into a fixed-size ring of recent blocks, and can be read from any thread;
+// the statistics are computed by readers over that rolling window
+
+class AudioLoadMeter final
+{
+public:
+
+    AudioLoadMeter() = default;
+
+    // must not be called while the callback is running,
+    // i.e. it's meant for audioDeviceAboutToStart
+    void reset(double sampleRate) noexcept;
+
+    class ScopedBlock final
+    {
+    public:
+
+        ScopedBlock(AudioLoadMeter &meter, int numSamples) noexcept;
+        ~ScopedBlock() noexcept;
+
+    private:
+
+        AudioLoadMeter &meter;
+        const int numSamples;
+        const double startTimeMs;
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedBlock)
+    };
+
+    static constexpr auto historySize = 2048;
+
+    // 10% each, the last one is for the blocks
+    // which took more time than their duration
+    static constexpr auto numHistogramBins = 11;
+
+    struct Block final
+    {
+        // the high-resolution millisecond counter at the block start
+        double startTimeMs = 0.0;
+        double elapsedMs = 0.0;
+        // the time the block took relative to its duration, 1 == 100%
+        float load = 0.f;
+    };
+
+    struct Statistics final
+    {
+        int64 numBlocks = 0;
+        // the blocks which took longer than their duration,
+        // since the last reset, not only over the recent window
+        int64 numOverruns = 0;
+
+        // over the recent window
+        float averageLoad = 0.f;
+        float peakLoad = 0.f;
+        int histogram[numHistogramBins] = {};
+
+        // only filled when requested
+        Array<Block> recentBlocks;
+
+        SerializedData serialize() const;
+    };
+
+    Statistics getStatistics(bool withRecentBlocks) const;
+
+private:
+
+    void addBlock(double startTimeMs, double endTimeMs, int numSamples) noexcept;
+
+    Atomic<double> samplesPerMs = 0.0;
+
+    // the blocks are just overwritten in a ring, so a reader copies them
+    // and then drops the ones which might have been overwritten meanwhile
+    struct BlockRecord final
+    {
+        Atomic<double> startTimeMs = 0.0;
+        Atomic<double> elapsedMs = 0.0;
+        Atomic<float> load = 0.f;
+    };
+
+    BlockRecord history[historySize];
+
+    Atomic<int64> numBlocks = 0;
+    Atomic<int64> numOverruns = 0;
+
+    friend class AudioLoadMeterTests;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AudioLoadMeter)
+};
@@ -18,51 +18,18 @@
 #include "Common.h"
 #include "AudioMonitor.h"
 #include "AudioCore.h"
+#include "RealtimeAudit.h"
 
-class ClippingWarningAsyncCallback final : public AsyncUpdater
-{
-public:
-    
-    explicit ClippingWarningAsyncCallback(AudioMonitor &parentSpectrumCallback) :
-        audioMonitor(parentSpectrumCallback) {}
-    
-    void handleAsyncUpdate() override
-    {
-        this->audioMonitor.getListeners().
-            call(&AudioMonitor::ClippingListener::onClippingWarning);
-    }
-
-private:
-    
-    AudioMonitor &audioMonitor;
-    
-    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ClippingWarningAsyncCallback)
-};
-
-class OversaturationWarningAsyncCallback final : public AsyncUpdater
+AudioMonitor::AudioMonitor() : fft()
 {
-public:
-    
-    explicit OversaturationWarningAsyncCallback(AudioMonitor &parentSpectrumCallback) :
-        audioMonitor(parentSpectrumCallback) {}
-    
-    void handleAsyncUpdate() override
-    {
-        this->audioMonitor.getListeners().
-            call(&AudioMonitor::ClippingListener::onOversaturationWarning);
-    }
-    
-private:
-    
-    AudioMonitor &audioMonitor;
-
-    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OversaturationWarningAsyncCallback)
-};
+    // the audio thread only raises the flags, since posting
+    // a message from there would allocate and take a lock
+    this->startTimerHz(AudioMonitor::warningsPollingRate);
+}
 
-AudioMonitor::AudioMonitor() : fft()
+AudioMonitor::~AudioMonitor()
 {
-    this->asyncClippingWarning = make<ClippingWarningAsyncCallback>(*this);
-    this->asyncOversaturationWarning = make<OversaturationWarningAsyncCallback>(*this);
+    this->stopTimer();
 }
 
 //===----------------------------------------------------------------------===//
@@ -77,6 +44,8 @@ void AudioMonitor::audioDeviceAboutToStart(AudioIODevice *device)
 void AudioMonitor::audioDeviceIOCallback(const float **inputChannelData, int numInputChannels,
     float **outputChannelData, int numOutputChannels, int numSamples)
 {
+    const RealtimeAudit::ScopedSection realtimeSection;
+
     const int minNumChannels = jmin(AudioMonitor::numChannels, numOutputChannels);
     
     for (int channel = 0; channel < minNumChannels; ++channel)
@@ -103,13 +72,13 @@ void AudioMonitor::audioDeviceIOCallback(const float **inputChannelData, int num
         
         if (pcmPeak > AudioMonitor::clipThreshold)
         {
-            this->asyncClippingWarning->triggerAsyncUpdate();
+            this->hasClippingWarning = true;
         }
         
         if (pcmPeak > AudioMonitor::oversaturationThreshold &&
             (pcmPeak / rootMeanSquare) > AudioMonitor::oversaturationRate)
         {
-            this->asyncOversaturationWarning->triggerAsyncUpdate();
+            this->hasOversaturationWarning = true;
         }
     }
 
@@ -163,6 +132,19 @@ ListenerList<AudioMonitor::ClippingListener> &AudioMonitor::getListeners() noexc
     return this->clippingListeners;
 }
 
+void AudioMonitor::timerCallback()
+{
+    if (this->hasClippingWarning.compareAndSetBool(false, true))
+    {
+        this->clippingListeners.call(&ClippingListener::onClippingWarning);
+    }
+
+    if (this->hasOversaturationWarning.compareAndSetBool(false, true))
+    {
+        this->clippingListeners.call(&ClippingListener::onOversaturationWarning);
+    }
+}
+
 //===----------------------------------------------------------------------===//
 // Volume data
 //===----------------------------------------------------------------------===//
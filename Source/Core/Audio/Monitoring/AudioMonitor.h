@@ -19,11 +19,12 @@
 
 #include "SpectrumAnalyzer.h"
 
-class AudioMonitor final : public AudioIODeviceCallback
+class AudioMonitor final : public AudioIODeviceCallback, private Timer
 {
 public:
     
     AudioMonitor();
+    ~AudioMonitor() override;
 
     //===------------------------------------------------------------------===//
     // AudioIODeviceCallback
@@ -87,8 +88,12 @@ private:
 
     ListenerList<ClippingListener> clippingListeners;
 
-    UniquePointer<AsyncUpdater> asyncClippingWarning;
-    UniquePointer<AsyncUpdater> asyncOversaturationWarning;
+    // raised by the audio thread, and picked up by the timer
+    Atomic<bool> hasClippingWarning = false;
+    Atomic<bool> hasOversaturationWarning = false;
+
+    static constexpr auto warningsPollingRate = 10;
+    void timerCallback() override;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AudioMonitor)
     JUCE_DECLARE_WEAK_REFERENCEABLE(AudioMonitor)
@@ -0,0 +1,388 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "Common.h"
+#include "RealtimeAudit.h"
+
+#if HELIO_REALTIME_AUDIT
+
+#if JUCE_LINUX
+#   include <dlfcn.h>
+#endif
+
+#if JUCE_LINUX || JUCE_MAC
+#   include <execinfo.h>
+#   define REALTIME_AUDIT_HAS_BACKTRACE 1
+#else
+#   define REALTIME_AUDIT_HAS_BACKTRACE 0
+#endif
+
+// everything here can be called from inside malloc,
+// so it only uses static storage and plain atomics
+
+enum class RealtimeViolationType : int8
+{
+    Allocation,
+    Deallocation,
+    Lock
+};
+
+struct RealtimeViolation final
+{
+    RealtimeViolationType type;
+    int numFrames;
+    static constexpr auto maxFrames = 32;
+    void *frames[maxFrames];
+};
+
+static constexpr auto maxRecordedRealtimeViolations = 16;
+static RealtimeViolation recordedRealtimeViolations[maxRecordedRealtimeViolations];
+static std::atomic<int> numRealtimeViolations { 0 };
+
+static thread_local int realtimeSectionDepth = 0;
+static thread_local bool isRecordingRealtimeViolation = false;
+static thread_local int numThreadRealtimeViolations = 0;
+
+static void recordRealtimeViolation(RealtimeViolationType type) noexcept
+{
+    if (realtimeSectionDepth == 0 || isRecordingRealtimeViolation)
+    {
+        return;
+    }
+
+    // backtrace() itself may allocate
+    isRecordingRealtimeViolation = true;
+
+    ++numThreadRealtimeViolations;
+    const auto index = numRealtimeViolations.fetch_add(1);
+    if (index < maxRecordedRealtimeViolations)
+    {
+        auto &violation = recordedRealtimeViolations[index];
+        violation.type = type;
+#if REALTIME_AUDIT_HAS_BACKTRACE
+        violation.numFrames = backtrace(violation.frames, RealtimeViolation::maxFrames);
+#else
+        violation.numFrames = 0;
+#endif
+    }
+
+    isRecordingRealtimeViolation = false;
+}
+
+#if REALTIME_AUDIT_HAS_BACKTRACE
+// the first call loads the unwinder library, which allocates,
+// so let's make it before any realtime section starts
+static const int realtimeAuditBacktraceWarmUp = []()
+{
+    void *frames[1];
+    return backtrace(frames, 1);
+}();
+#endif
+
+RealtimeAudit::ScopedSection::ScopedSection() noexcept
+{
+    ++realtimeSectionDepth;
+}
+
+RealtimeAudit::ScopedSection::~ScopedSection() noexcept
+{
+    --realtimeSectionDepth;
+}
+
+int RealtimeAudit::getNumViolations() noexcept
+{
+    return numRealtimeViolations.load();
+}
+
+int RealtimeAudit::getNumViolationsOnThisThread() noexcept
+{
+    return numThreadRealtimeViolations;
+}
+
+int RealtimeAudit::reportViolations()
+{
+    jassert(realtimeSectionDepth == 0);
+
+    const auto numViolations = numRealtimeViolations.exchange(0);
+    const auto numRecorded = jmin(numViolations, maxRecordedRealtimeViolations);
+
+    for (int i = 0; i < numRecorded; ++i)
+    {
+        const auto &violation = recordedRealtimeViolations[i];
+
+        String description;
+        switch (violation.type)
+        {
+        case RealtimeViolationType::Allocation:
+            description = "Realtime audit: memory allocation";
+            break;
+        case RealtimeViolationType::Deallocation:
+            description = "Realtime audit: memory deallocation";
+            break;
+        case RealtimeViolationType::Lock:
+            description = "Realtime audit: blocking lock";
+            break;
+        default:
+            break;
+        }
+
+#if REALTIME_AUDIT_HAS_BACKTRACE
+        if (auto **symbols = backtrace_symbols(violation.frames, violation.numFrames))
+        {
+            for (int j = 0; j < violation.numFrames; ++j)
+            {
+                description << newLine << "    " << symbols[j];
+            }
+
+            ::free(symbols);
+        }
+#endif
+
+        DBG(description);
+    }
+
+    if (numViolations > numRecorded)
+    {
+        DBG("Realtime audit: " + String(numViolations - numRecorded) + " more violations");
+    }
+
+    return numViolations;
+}
+
+//===----------------------------------------------------------------------===//
+// Hooks
+//===----------------------------------------------------------------------===//
+
+#if JUCE_LINUX
+
+// glibc exports its implementations under these names, so the whole
+// malloc family can be replaced here, including the allocations
+// which don't go through operator new, like HeapBlock's;
+// the mutexes are only reported when they are actually contended
+
+extern "C" void *__libc_malloc(size_t size);
+extern "C" void *__libc_calloc(size_t count, size_t size);
+extern "C" void *__libc_realloc(void *ptr, size_t size);
+extern "C" void __libc_free(void *ptr);
+
+// since glibc 2.34, __pthread_mutex_* are only compat symbols which can't
+// be linked against, so the next definitions are looked up at runtime instead;
+// dlsym may allocate, so this is done before any realtime section starts,
+// and lazily for the locks taken during static initialization
+
+using RealtimeAuditMutexFunction = int (*)(pthread_mutex_t *);
+
+static std::atomic<RealtimeAuditMutexFunction> nextMutexLock { nullptr };
+static std::atomic<RealtimeAuditMutexFunction> nextMutexTryLock { nullptr };
+
+static RealtimeAuditMutexFunction getNextMutexFunction(
+    std::atomic<RealtimeAuditMutexFunction> &cached, const char *name) noexcept
+{
+    auto function = cached.load();
+    if (function == nullptr)
+    {
+        // racing here is fine, the result is always the same
+        function = reinterpret_cast<RealtimeAuditMutexFunction>(dlsym(RTLD_NEXT, name));
+        cached.store(function);
+    }
+
+    return function;
+}
+
+static const bool realtimeAuditMutexFunctionsWarmUp = []()
+{
+    return getNextMutexFunction(nextMutexLock, "pthread_mutex_lock") != nullptr &&
+        getNextMutexFunction(nextMutexTryLock, "pthread_mutex_trylock") != nullptr;
+}();
+
+extern "C" void *malloc(size_t size) noexcept
+{
+    recordRealtimeViolation(RealtimeViolationType::Allocation);
+    return __libc_malloc(size);
+}
+
+extern "C" void *calloc(size_t count, size_t size) noexcept
+{
+    recordRealtimeViolation(RealtimeViolationType::Allocation);
+    return __libc_calloc(count, size);
+}
+
+extern "C" void *realloc(void *ptr, size_t size) noexcept
+{
+    recordRealtimeViolation(RealtimeViolationType::Allocation);
+    return __libc_realloc(ptr, size);
+}
+
+extern "C" void free(void *ptr) noexcept
+{
+    if (ptr != nullptr)
+    {
+        recordRealtimeViolation(RealtimeViolationType::Deallocation);
+    }
+
+    __libc_free(ptr);
+}
+
+extern "C" int pthread_mutex_lock(pthread_mutex_t *mutex) noexcept
+{
+    if (realtimeSectionDepth > 0)
+    {
+        if (getNextMutexFunction(nextMutexTryLock, "pthread_mutex_trylock")(mutex) == 0)
+        {
+            return 0;
+        }
+
+        recordRealtimeViolation(RealtimeViolationType::Lock);
+    }
+
+    return getNextMutexFunction(nextMutexLock, "pthread_mutex_lock")(mutex);
+}
+
+#else
+
+// elsewhere, only the C++ allocations can be caught portably,
+// and the locks are not audited at all
+
+void *operator new(size_t size)
+{
+    recordRealtimeViolation(RealtimeViolationType::Allocation);
+    if (auto *ptr = std::malloc(size))
+    {
+        return ptr;
+    }
+
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t size)
+{
+    recordRealtimeViolation(RealtimeViolationType::Allocation);
+    if (auto *ptr = std::malloc(size))
+    {
+        return ptr;
+    }
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept
+{
+    if (ptr != nullptr)
+    {
+        recordRealtimeViolation(RealtimeViolationType::Deallocation);
+    }
+
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+    if (ptr != nullptr)
+    {
+        recordRealtimeViolation(RealtimeViolationType::Deallocation);
+    }
+
+    std::free(ptr);
+}
+
+#endif
+
+#else
+
+int RealtimeAudit::getNumViolations() noexcept { return 0; }
+int RealtimeAudit::getNumViolationsOnThisThread() noexcept { return 0; }
+int RealtimeAudit::reportViolations() { return 0; }
+
+#endif
+
+//===----------------------------------------------------------------------===//
+// Tests
+//===----------------------------------------------------------------------===//
+
+#if JUCE_UNIT_TESTS && HELIO_REALTIME_AUDIT
+
+#include "Instrument.h"
+#include "DefaultSynthAudioPlugin.h"
+
+class RealtimeAuditTests final : public UnitTest
+{
+public:
+
+    RealtimeAuditTests() : UnitTest("Realtime audit tests", UnitTestCategories::helio) {}
+
+    void runTest() override
+    {
+        beginTest("Allocations in realtime sections");
+
+        // the audio device might be running meanwhile,
+        // so only this thread's violations are checked here
+        const auto numViolationsBefore = RealtimeAudit::getNumViolationsOnThisThread();
+
+        int numAllocatedItems = 0;
+        {
+            const RealtimeAudit::ScopedSection realtimeSection;
+            Array<int> allocated;
+            allocated.add(1);
+            numAllocatedItems = allocated.size();
+        }
+
+        expectEquals(numAllocatedItems, 1);
+
+        // one allocation and one deallocation at least
+        expect(RealtimeAudit::getNumViolationsOnThisThread() - numViolationsBefore >= 2);
+        expect(RealtimeAudit::reportViolations() >= 2);
+
+        beginTest("Instrument audio callback is allocation and lock free");
+
+        constexpr auto blockSize = 512;
+        constexpr auto numBlocks = 16;
+
+        DefaultSynthAudioPlugin synth;
+        Instrument::AudioCallback callback;
+        callback.prepareToPlay(44100.0, blockSize, 0, 2);
+        callback.setProcessor(&synth);
+
+        AudioBuffer<float> output(2, blockSize);
+        float *outputChannels[] = { output.getWritePointer(0), output.getWritePointer(1) };
+
+        auto &queue = callback.getMidiMessageQueue();
+        const auto numCallbackViolationsBefore = RealtimeAudit::getNumViolationsOnThisThread();
+
+        for (int i = 0; i < numBlocks; ++i)
+        {
+            // queuing is done by other threads, so it's outside the sections,
+            // and the queue itself is preallocated
+            const auto key = 60 + i % 12;
+            queue.addMessageToQueue(MidiMessage::noteOn(1, key, uint8(100))
+                .withTimeStamp(Time::getMillisecondCounterHiRes() * 0.001));
+            queue.addMessageToQueue(MidiMessage::noteOff(1, key)
+                .withTimeStamp(Time::getMillisecondCounterHiRes() * 0.001));
+
+            callback.audioDeviceIOCallback(nullptr, 0, outputChannels, 2, blockSize);
+        }
+
+        expectEquals(RealtimeAudit::getNumViolationsOnThisThread() - numCallbackViolationsBefore, 0);
+        RealtimeAudit::reportViolations();
+
+        callback.setProcessor(nullptr);
+    }
+};
+
+static RealtimeAuditTests realtimeAuditTests;
+
+#endif
@@ -0,0 +1,59 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#if !defined HELIO_REALTIME_AUDIT
+#   define HELIO_REALTIME_AUDIT 0
+#endif
+
+// A debugging aid for the audio thread code paths: with HELIO_REALTIME_AUDIT
+// enabled, each memory allocation or deallocation made inside a realtime
+// section, and each lock which would block there, is recorded with its
+// call stack, to be reported later from a non-realtime thread;
+// without it, the sections compile to nothing
+
+struct RealtimeAudit final
+{
+    // marks the current thread as realtime for the section lifetime
+    class ScopedSection final
+    {
+    public:
+
+#if HELIO_REALTIME_AUDIT
+        ScopedSection() noexcept;
+        ~ScopedSection() noexcept;
+#else
+        ScopedSection() noexcept {}
+#endif
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedSection)
+    };
+
+    // since the last report
+    static int getNumViolations() noexcept;
+
+    // made by the calling thread since it started, not affected by reports;
+    // use this to check a code path while other realtime threads are running
+    static int getNumViolationsOnThisThread() noexcept;
+
+    // logs the recorded call stacks and clears them,
+    // returns the number of violations reported;
+    // must not be called from a realtime section
+    static int reportViolations();
+};
@@ -24,24 +24,22 @@
 #include "MidiTrack.h"
 #include "PianoTrackNode.h"
 #include "PianoSequence.h"
+#include "AutomationTrackNode.h"
+#include "AutomationSequence.h"
 
 #include "PatternRoll.h"
 #include "SequencerOperations.h"
 #include "PianoTrackActions.h"
+#include "AutomationTrackActions.h"
 #include "UndoStack.h"
 
 #include "Workspace.h"
 #include "AudioCore.h"
 #include "ColourIDs.h"
 
-// todo for the future: handle pedal and more automation events
-
 MidiRecorder::MidiRecorder(ProjectNode &project) :
     project(project)
 {
-    this->lastUpdateTime = Time::getMillisecondCounterHiRes();
-    this->lastCorrectPosition = this->getTransport().getSeekBeat();
-
     this->getTransport().addTransportListener(this);
 }
 
@@ -63,38 +61,26 @@ void MidiRecorder::setTargetScope(const Clip *clip, const String &instrumentId)
     {
         if (this->activeTrack != nullptr)
         {
-            this->finaliseAllHoldingNotes();
+            this->releaseAllHoldingNotes(float(this->getEstimatedPosition()));
         }
 
         this->activeTrack = track;
         this->activeClip = clip;
+        this->automationTracks.clear();
         this->shouldCheckpoint = true;
     }
 }
 
-void MidiRecorder::onSeek(float beatPosition, double, double) noexcept
+void MidiRecorder::onRewind(float, float)
 {
-    // handle the loop rewind:
-    if (this->isPlaying.get() &&
-        beatPosition < this->lastCorrectPosition.get())
+    if (this->isRecording.get())
     {
-        // this callback clearly comes from the player thread,
-        // and we are going to do some changes, which the UI
-        // will reflect immediately, so let's lock the message thread:
-        MessageManagerLock mml(Thread::getCurrentThread());
-        jassert(mml.lockWasGained());
-
-        this->finaliseAllHoldingNotes();
+        // the messages received before the rewind are still
+        // timestamped with the old positions, and the ones received
+        // after it will release the held notes when handled:
+        this->handleAsyncUpdate();
+        this->handleRewindIfNeeded(this->getTransport().getPlaybackState().read().numRewinds);
     }
-
-    this->lastCorrectPosition = beatPosition;
-    this->lastUpdateTime = Time::getMillisecondCounterHiRes();
-}
-
-void MidiRecorder::onTempoChanged(double msPerQuarter) noexcept
-{
-    this->msPerQuarterNote = jmax(msPerQuarter, 0.01);
-    this->lastUpdateTime = Time::getMillisecondCounterHiRes();
 }
 
 void MidiRecorder::onRecord()
@@ -103,6 +89,7 @@ void MidiRecorder::onRecord()
     {
         this->isRecording = true;
         this->shouldCheckpoint = true;
+        this->numHandledRewinds = this->getTransport().getPlaybackState().read().numRewinds;
 
         auto temperament = this->project.getProjectInfo()->getTemperament();
         auto &audioCore = App::Workspace().getAudioCore();
@@ -121,7 +108,7 @@ void MidiRecorder::onPlay() noexcept
     if (!this->isPlaying.get())
     {
         this->isPlaying = true;
-        this->lastUpdateTime = Time::getMillisecondCounterHiRes();
+        this->numHandledRewinds = this->getTransport().getPlaybackState().read().numRewinds;
 
         if (this->isRecording.get())
         {
@@ -141,16 +128,18 @@ void MidiRecorder::onStop()
 
         this->isRecording = false;
 
-        // fixme handle buffers?
-        jassert(this->noteOnsBuffer.isEmpty());
-        jassert(this->noteOffsBuffer.isEmpty());
+        // no more writers at this point, so just flush what's left,
+        // the notes still being held will end at the stop position
+        this->cancelPendingUpdate();
+        this->handleAsyncUpdate();
+        this->releaseAllHoldingNotes(float(this->getEstimatedPosition()));
 
-        this->holdingNotes.clear();
+        this->recordedAutomation.clear();
+        this->lastAutomationValues.clear();
+        this->automationTracks.clear();
     }
 
     this->isPlaying = false;
-    this->lastUpdateTime = 0.0;
-    this->msPerQuarterNote = Globals::Defaults::msPerBeat;
 }
 
 static SerializedData createPianoTrackTemplate(const String &name,
@@ -172,13 +161,46 @@ static SerializedData createPianoTrackTemplate(const String &name,
     return newNode->serialize();
 }
 
+static SerializedData createRecordedAutomationTrackTemplate(const String &name,
+    int controllerNumber, const String &instrumentId, String &outTrackId)
+{
+    auto newNode = make<AutomationTrackNode>(name);
+
+    // unlike the default automation track template,
+    // this one has no events, the recorded ones will be added:
+    const Clip clip(newNode->getPattern());
+    newNode->getPattern()->insert(clip, false);
+
+    newNode->setTrackInstrumentId(instrumentId, false, dontSendNotification);
+    newNode->setTrackColour(Colours::royalblue, false, dontSendNotification);
+    newNode->setTrackControllerNumber(controllerNumber, dontSendNotification);
+
+    outTrackId = newNode->getTrackId();
+    return newNode->serialize();
+}
+
+static String getRecordedControllerName(int controllerNumber)
+{
+    if (controllerNumber == MidiTrack::pitchWheelController)
+    {
+        return "Pitch Wheel";
+    }
+    else if (controllerNumber == MidiTrack::channelPressureController)
+    {
+        return "Channel Pressure";
+    }
+
+    const String controllerName(MidiMessage::getControllerName(controllerNumber));
+    return controllerName.isNotEmpty() ? controllerName : "CC " + String(controllerNumber);
+}
+
 // called from the message thread, so we can insert new midi events
 // (note that the track selection may change during recording);
 // the main recording logic goes here:
 void MidiRecorder::handleAsyncUpdate()
 {
-    if (this->noteOnsBuffer.isEmpty() &&
-        this->noteOffsBuffer.isEmpty())
+    const auto numReady = this->messagesQueueFifo.getNumReady();
+    if (numReady == 0)
     {
         // nothing to do
         return;
@@ -188,7 +210,7 @@ void MidiRecorder::handleAsyncUpdate()
     // yet have received some midi events;
     // we do it before inserting any events,
     // so that the first note doesn't sound twice
-    if (!this->isPlaying.get())
+    if (this->isRecording.get() && !this->isPlaying.get())
     {
         this->getTransport().startPlayback();
     }
@@ -206,205 +228,361 @@ void MidiRecorder::handleAsyncUpdate()
         this->shouldCheckpoint = false;
     }
 
-    // if something is selected (can be both rolls), simply insert messages,
-    // if nothing is selected (pattern roll), first create a new track and select it
-    // if multiple tracks are selected (also pattern roll) - same as ^
-    if (this->activeTrack == nullptr)
-    {
-        const auto newName =
-            SequencerOperations::generateNextNameForNewTrack("Recording",
-                this->project.getAllTrackNames());
+    // the messages are queued in the order they were received,
+    // so note-offs never precede their note-ons here
+    int start1, size1, start2, size2;
+    this->messagesQueueFifo.prepareToRead(numReady, start1, size1, start2, size2);
 
-        // lastValidInstrumentId may be empty at this point:
-        if (this->lastValidInstrumentId.isEmpty())
+    const auto handleMessages = [this](const RecordedMessage *messages, int numMessages)
+    {
+        for (int i = 0; i < numMessages; ++i)
         {
-            const auto instruments = App::Workspace().getAudioCore().getInstrumentsExceptInternal();
-            if (!instruments.isEmpty())
-            {
-                this->lastValidInstrumentId = instruments.getFirst()->getIdAndHash();
-            }
+            const auto &recorded = messages[i];
+            const MidiMessage message(recorded.data, recorded.size);
+            const auto beat = float(recorded.beat);
+
+            this->handleRewindIfNeeded(recorded.numRewinds);
+            this->recordMessage(message, beat);
         }
+    };
 
-        String outTrackId;
-        const auto trackTemplate = createPianoTrackTemplate(newName,
-            this->lastCorrectPosition.get(), this->lastValidInstrumentId, outTrackId);
+    handleMessages(this->messagesQueue + start1, size1);
+    handleMessages(this->messagesQueue + start2, size2);
+    this->messagesQueueFifo.finishedRead(size1 + size2);
 
-        this->project.getUndoStack()->perform(
-            new PianoTrackInsertAction(this->project,
-                &this->project, trackTemplate, newName));
+    this->insertReleasedNotes();
+    this->insertRecordedAutomation();
+    this->showHoldingNotes(float(this->getEstimatedPosition()));
+}
 
-        this->activeTrack = this->project.findTrackById<MidiTrackNode>(outTrackId);
-        this->activeClip = this->activeTrack->getPattern()->getUnchecked(0);
-        this->shouldCheckpoint = false;
+void MidiRecorder::recordMessage(const MidiMessage &message, float beat)
+{
+    jassert(MidiRecorder::isRecordable(message));
+
+    if (message.isNoteOn())
+    {
+        this->startHoldingNote(message.getNoteNumber(),
+            float(message.getVelocity()) / 128.f, beat);
     }
-    
-    // handle note offs and fill unhandledNoteOffs
-    while (!this->noteOffsBuffer.isEmpty())
+    else if (message.isNoteOff())
     {
-        const auto last = this->noteOffsBuffer.size() - 1;
-        const auto i = this->noteOffsBuffer.removeAndReturn(last);
-        const bool wasHandled = this->finaliseHoldingNote(i.getNoteNumber());
-        if (!wasHandled)
-        {
-            this->unhandledNoteOffs.add(i);
-        }
+        this->releaseHoldingNote(message.getNoteNumber(), beat);
     }
-
-    // handle note ons
-    while (!this->noteOnsBuffer.isEmpty())
+    else if (message.isController())
     {
-        const auto last = this->noteOnsBuffer.size() - 1;
-        const auto i = this->noteOnsBuffer.removeAndReturn(last);
-        this->startHoldingNote(i);
+        this->recordAutomationEvent(message.getControllerNumber(),
+            float(message.getControllerValue()) / 127.f, beat);
     }
-
-    // handle unhandledNoteOffs and clean
-    for (const auto &i : this->unhandledNoteOffs)
+    else if (message.isPitchWheel())
     {
-        this->finaliseHoldingNote(i.getNoteNumber());
+        this->recordAutomationEvent(MidiTrack::pitchWheelController,
+            float(message.getPitchWheelValue()) / 16383.f, beat);
+    }
+    else if (message.isChannelPressure())
+    {
+        this->recordAutomationEvent(MidiTrack::channelPressureController,
+            float(message.getChannelPressureValue()) / 127.f, beat);
     }
-
-    this->unhandledNoteOffs.clearQuick();
 }
 
-struct SortMidiMessagesByTimestamp final
+bool MidiRecorder::isRecordable(const MidiMessage &message) noexcept
 {
-    static int compareElements(const MidiMessage &first, const MidiMessage &second)
+    if (message.isController())
     {
-        return int(first.getTimeStamp() - second.getTimeStamp());
+        // bank select is a part of the program change, not a curve to record,
+        // and the channel mode messages, like all notes off, are commands
+        const auto controllerNumber = message.getControllerNumber();
+        return controllerNumber != 0 && controllerNumber != 32 && controllerNumber < 120;
     }
-};
 
-static SortMidiMessagesByTimestamp tsSort;
+    // the polyphonic aftertouch is skipped: there's no per-key automation,
+    // and mixing it into the channel pressure would make a mess of it
+    return message.isNoteOnOrOff() || message.isPitchWheel() || message.isChannelPressure();
+}
 
-// called from the high-priority system thread:
+// called from the high-priority system thread, must not block or allocate:
 void MidiRecorder::handleIncomingMidiMessage(MidiInput *, const MidiMessage &message)
 {
-    if (message.isNoteOn())
+    if (!MidiRecorder::isRecordable(message))
     {
-        this->noteOnsBuffer.addSorted(tsSort,
-            message.withTimeStamp(this->getEstimatedPosition()));
+        return;
     }
-    else if (message.isNoteOff())
+
+    jassert(message.getRawDataSize() <= 3);
+
+    // the device timestamps are in seconds, on the same
+    // hi-res clock which the player thread schedules events with
+    const auto timeMs = message.getTimeStamp() > 0.0 ?
+        message.getTimeStamp() * 1000.0 : Time::getMillisecondCounterHiRes();
+
+    const auto state = this->getTransport().getPlaybackState().read();
+
     {
-        this->noteOffsBuffer.addSorted(tsSort,
-            message.withTimeStamp(this->getEstimatedPosition()));
+        const SpinLock::ScopedLockType lock(this->messagesQueueWriteLock);
+
+        int start1, size1, start2, size2;
+        this->messagesQueueFifo.prepareToWrite(1, start1, size1, start2, size2);
+        if (size1 + size2 == 0)
+        {
+            // the message thread is way too busy
+            DBG("Recording queue overflow, dropping a midi message");
+        }
+        else
+        {
+            auto &recorded = this->messagesQueue[size1 > 0 ? start1 : start2];
+            recorded.size = jmin(message.getRawDataSize(), 3);
+            memcpy(recorded.data, message.getRawData(), size_t(recorded.size));
+            recorded.beat = state.getEstimatedBeat(timeMs);
+            recorded.numRewinds = state.numRewinds;
+            this->messagesQueueFifo.finishedWrite(1);
+        }
     }
 
     this->triggerAsyncUpdate();
 }
 
-// current beat, estimated since the last known
-// midi event, including the tempo change events:
 double MidiRecorder::getEstimatedPosition() const
 {
-    if (!this->isPlaying.get())
-    {
-        return this->lastCorrectPosition.get();
-    }
-
-    const double timeOffsetMs = Time::getMillisecondCounterHiRes() - this->lastUpdateTime.get();
-    const double positionOffset = timeOffsetMs / this->msPerQuarterNote.get();
-    const double estimatedPosition = this->lastCorrectPosition.get() + positionOffset;
-    return estimatedPosition;
+    return this->getTransport().getPlaybackState().read()
+        .getEstimatedBeat(Time::getMillisecondCounterHiRes());
 }
 
 void MidiRecorder::timerCallback()
 {
-    if (this->activeTrack != nullptr)
-    {
-        this->updateLengthsOfHoldingNotes();
-    }
+    this->showHoldingNotes(float(this->getEstimatedPosition()));
 }
 
 //===----------------------------------------------------------------------===//
 // Helpers
 //===----------------------------------------------------------------------===//
 
-void MidiRecorder::startHoldingNote(MidiMessage message)
+void MidiRecorder::createActiveTrack()
 {
+    jassert(this->activeTrack == nullptr);
+
+    // if something is selected (can be both rolls), simply insert messages,
+    // if nothing is selected (pattern roll), first create a new track and select it
+    // if multiple tracks are selected (also pattern roll) - same as ^
+    const auto newName =
+        SequencerOperations::generateNextNameForNewTrack("Recording",
+            this->project.getAllTrackNames());
+
+    // lastValidInstrumentId may be empty at this point:
+    if (this->lastValidInstrumentId.isEmpty())
+    {
+        const auto instruments = App::Workspace().getAudioCore().getInstrumentsExceptInternal();
+        if (!instruments.isEmpty())
+        {
+            this->lastValidInstrumentId = instruments.getFirst()->getIdAndHash();
+        }
+    }
+
+    String outTrackId;
+    const auto trackTemplate = createPianoTrackTemplate(newName,
+        this->getTransport().getPlaybackState().read().beat,
+        this->lastValidInstrumentId, outTrackId);
+
+    this->project.getUndoStack()->perform(
+        new PianoTrackInsertAction(this->project,
+            &this->project, trackTemplate, newName));
+
+    this->activeTrack = this->project.findTrackById<MidiTrackNode>(outTrackId);
+    this->activeClip = this->activeTrack->getPattern()->getUnchecked(0);
+}
+
+void MidiRecorder::handleRewindIfNeeded(uint32 numRewinds)
+{
+    // the counter only grows, and the messages from several midi inputs
+    // may come tagged out of order, so an older one must not be handled again
+    if (numRewinds > this->numHandledRewinds)
+    {
+        this->numHandledRewinds = numRewinds;
+        this->releaseAllHoldingNotes(this->getTransport().getPlaybackState().read().lastRewindBeat);
+    }
+}
+
+void MidiRecorder::startHoldingNote(int key, float velocity, float beat)
+{
+    if (this->activeTrack == nullptr)
+    {
+        this->createActiveTrack();
+    }
+
     jassert(this->activeClip != nullptr);
     jassert(this->activeTrack != nullptr);
 
-    const auto key = message.getNoteNumber();
-    
     if (this->holdingNotes.contains(key))
     {
         DBG("Found weird note-on/note-off order");
-        this->finaliseHoldingNote(key);
+        this->releaseHoldingNote(key, beat);
     }
 
-    const Note noteParams(this->activeTrack->getSequence(),
+    const Note note(this->activeTrack->getSequence(),
         key - this->activeClip->getKey(),
-        roundBeat(float(message.getTimeStamp()) - this->activeClip->getBeat()),
-        Globals::minNoteLength,
-        float(message.getVelocity()) / 128.f);
+        roundBeat(beat - this->activeClip->getBeat()),
+        Globals::minNoteLength, velocity);
 
-    this->getPianoSequence()->insert(noteParams, true);
-    this->holdingNotes[key] = noteParams;
+    this->holdingNotes[key] = note;
 }
 
-void MidiRecorder::updateLengthsOfHoldingNotes() const
+bool MidiRecorder::releaseHoldingNote(int key, float beat)
 {
+    const auto found = this->holdingNotes.find(key);
+    if (found == this->holdingNotes.end())
+    {
+        return false;
+    }
+
     jassert(this->activeClip != nullptr);
-    jassert(this->activeTrack != nullptr);
+    const auto &note = found->second;
+    const auto length = roundBeat(beat - this->activeClip->getBeat() - note.getBeat());
+    this->releasedNotes.add(note.withLength(jmax(Globals::minNoteLength, length)));
+    this->holdingNotes.erase(found);
+    return true;
+}
+
+void MidiRecorder::releaseAllHoldingNotes(float beat)
+{
+    if (this->activeTrack != nullptr) // a user cleared selection before hitting stop
+    {
+        for (const auto &i : this->holdingNotes)
+        {
+            const auto length = roundBeat(beat - this->activeClip->getBeat() - i.second.getBeat());
+            this->releasedNotes.add(i.second.withLength(jmax(Globals::minNoteLength, length)));
+        }
 
-    if (this->holdingNotes.empty())
+        this->insertReleasedNotes();
+    }
+
+    this->holdingNotes.clear();
+    this->showHoldingNotes(beat);
+}
+
+void MidiRecorder::insertReleasedNotes()
+{
+    if (this->releasedNotes.isEmpty())
     {
-        //DBG("Skip 1");
         return;
     }
 
-    const auto currentBeat =
-        float(this->getEstimatedPosition() - this->activeClip->getBeat());
+    if (this->activeTrack != nullptr)
+    {
+        this->getPianoSequence()->insertGroup(this->releasedNotes, true);
+    }
 
-    Array<Note> groupBefore;
-    Array<Note> groupAfter;
+    this->releasedNotes.clearQuick();
+}
 
-    for (const auto &i : this->holdingNotes)
+void MidiRecorder::showHoldingNotes(float beat)
+{
+    if (this->activeClip == nullptr ||
+        (this->holdingNotes.empty() && !this->isShowingHoldingNotes))
     {
-        const auto newLength = roundBeat(currentBeat - i.second.getBeat());
-        if (i.second.getLength() == newLength)
-        {
-            //DBG("Skip 2");
-            return;
-        }
+        return;
+    }
+
+    const auto clipBeat = beat - this->activeClip->getBeat();
 
-        groupBefore.add(i.second);
-        groupAfter.add(i.second.withLength(newLength));
+    Array<Note> notes;
+    for (const auto &i : this->holdingNotes)
+    {
+        const auto length = roundBeat(clipBeat - i.second.getBeat());
+        notes.add(i.second.withLength(jmax(Globals::minNoteLength, length)));
     }
 
-    this->getPianoSequence()->changeGroup(groupBefore, groupAfter, true);
+    this->project.broadcastChangeRecordingNotes(*this->activeClip, notes);
+    this->isShowingHoldingNotes = !notes.isEmpty();
 }
 
-void MidiRecorder::finaliseAllHoldingNotes()
+void MidiRecorder::recordAutomationEvent(int controllerNumber,
+    float controllerValue, float beat)
 {
-    if (this->activeTrack != nullptr) // a user cleared selection before hitting stop
+    const auto lastValue = this->lastAutomationValues.find(controllerNumber);
+    if (lastValue != this->lastAutomationValues.end() &&
+        lastValue->second == controllerValue)
     {
-        this->updateLengthsOfHoldingNotes();
+        return; // knobs tend to send the same values over and over
     }
 
-    this->holdingNotes.clear();
+    auto *track = this->findOrCreateAutomationTrack(controllerNumber);
+    if (track == nullptr)
+    {
+        return;
+    }
+
+    this->lastAutomationValues[controllerNumber] = controllerValue;
+
+    const auto *clip = track->getPattern()->getUnchecked(0);
+    const auto eventBeat = roundBeat(beat - clip->getBeat());
+
+    auto &events = this->recordedAutomation[controllerNumber];
+    if (!events.isEmpty() && events.getLast().getBeat() == eventBeat)
+    {
+        // only the latest value at the same beat matters
+        events.setUnchecked(events.size() - 1,
+            events.getLast().withControllerValue(controllerValue));
+        return;
+    }
+
+    events.add(AutomationEvent(track->getSequence(), eventBeat, controllerValue));
 }
 
-bool MidiRecorder::finaliseHoldingNote(int key)
+void MidiRecorder::insertRecordedAutomation()
 {
-    jassert(this->activeClip != nullptr);
-    jassert(this->activeTrack != nullptr);
+    for (auto &i : this->recordedAutomation)
+    {
+        if (i.second.isEmpty())
+        {
+            continue;
+        }
 
-    const auto currentBeat =
-        float(this->getEstimatedPosition() - this->activeClip->getBeat());
+        auto *track = this->automationTracks[i.first].get();
+        if (track != nullptr)
+        {
+            auto *sequence = static_cast<AutomationSequence *>(track->getSequence());
+            sequence->insertGroup(i.second, true);
+        }
 
-    if (this->holdingNotes.contains(key))
+        i.second.clearQuick();
+    }
+}
+
+MidiTrack *MidiRecorder::findOrCreateAutomationTrack(int controllerNumber)
+{
+    if (auto *cachedTrack = this->automationTracks[controllerNumber].get())
+    {
+        return cachedTrack;
+    }
+
+    const auto instrumentId = this->activeTrack != nullptr ?
+        this->activeTrack->getTrackInstrumentId() : this->lastValidInstrumentId;
+
+    for (auto *track : this->project.getTracks())
     {
-        const auto &note = this->holdingNotes[key];
-        const auto newLength = roundBeat(currentBeat - note.getBeat());
-        this->getPianoSequence()->change(note, note.withLength(newLength), true);
-        this->holdingNotes.erase(key);
-        return true;
+        if (dynamic_cast<AutomationTrackNode *>(track) != nullptr &&
+            track->getTrackControllerNumber() == controllerNumber &&
+            track->getTrackInstrumentId() == instrumentId)
+        {
+            this->automationTracks[controllerNumber] = track;
+            return track;
+        }
     }
 
-    return false;
+    const auto newName =
+        SequencerOperations::generateNextNameForNewTrack(getRecordedControllerName(controllerNumber),
+            this->project.getAllTrackNames());
+
+    String outTrackId;
+    const auto trackTemplate = createRecordedAutomationTrackTemplate(newName,
+        controllerNumber, instrumentId, outTrackId);
+
+    this->project.getUndoStack()->perform(
+        new AutomationTrackInsertAction(this->project,
+            &this->project, trackTemplate, newName));
+
+    auto *newTrack = this->project.findTrackById<AutomationTrackNode>(outTrackId);
+    this->automationTracks[controllerNumber] = newTrack;
+    return newTrack;
 }
 
 PianoSequence *MidiRecorder::getPianoSequence() const
@@ -416,3 +594,83 @@ Transport &MidiRecorder::getTransport() const noexcept
 {
     return this->project.getTransport();
 }
+
+//===----------------------------------------------------------------------===//
+// Tests
+//===----------------------------------------------------------------------===//
+
+#if JUCE_UNIT_TESTS
+
+#include "DocumentHelpers.h"
+
+class MidiRecorderTests final : public UnitTest
+{
+public:
+
+    MidiRecorderTests() : UnitTest("Midi recorder tests", UnitTestCategories::helio) {}
+
+    void runTest() override
+    {
+        beginTest("Skips bank select, channel mode messages and polyphonic aftertouch");
+
+        expect(MidiRecorder::isRecordable(MidiMessage::noteOn(1, 60, uint8(100))));
+        expect(MidiRecorder::isRecordable(MidiMessage::noteOff(1, 60)));
+        expect(MidiRecorder::isRecordable(MidiMessage::controllerEvent(1, 1, 64)));
+        expect(MidiRecorder::isRecordable(MidiMessage::controllerEvent(1, 64, 127)));
+        expect(MidiRecorder::isRecordable(MidiMessage::controllerEvent(1, 119, 1)));
+        expect(MidiRecorder::isRecordable(MidiMessage::pitchWheel(1, 8192)));
+        expect(MidiRecorder::isRecordable(MidiMessage::channelPressureChange(1, 50)));
+
+        expect(!MidiRecorder::isRecordable(MidiMessage::controllerEvent(1, 0, 1)));
+        expect(!MidiRecorder::isRecordable(MidiMessage::controllerEvent(1, 32, 1)));
+        for (int controllerNumber = 120; controllerNumber < 128; ++controllerNumber)
+        {
+            expect(!MidiRecorder::isRecordable(MidiMessage::controllerEvent(1, controllerNumber, 0)));
+        }
+
+        expect(!MidiRecorder::isRecordable(MidiMessage::aftertouchChange(1, 60, 50)));
+        expect(!MidiRecorder::isRecordable(MidiMessage::programChange(1, 5)));
+
+        beginTest("Records controllers, pitch wheel and pressure into automation tracks");
+
+        const String instrumentId("test-instrument");
+        const auto projectFile = DocumentHelpers::getTempSlot("MidiRecorderTests.helio");
+
+        {
+            auto project = make<ProjectNode>(projectFile);
+
+            auto *pianoTrack = new PianoTrackNode("Piano");
+            pianoTrack->getPattern()->insert(Clip(pianoTrack->getPattern()), false);
+            pianoTrack->setTrackInstrumentId(instrumentId, false, dontSendNotification);
+            project->addChildNode(pianoTrack, -1, false);
+
+            MidiRecorder recorder(*project);
+            recorder.setTargetScope(pianoTrack->getPattern()->getUnchecked(0), instrumentId);
+
+            recorder.recordMessage(MidiMessage::controllerEvent(1, 1, 10), 0.f);
+            recorder.recordMessage(MidiMessage::controllerEvent(1, 1, 10), 1.f); // repeated, skipped
+            recorder.recordMessage(MidiMessage::controllerEvent(1, 1, 20), 2.f);
+            recorder.recordMessage(MidiMessage::pitchWheel(1, 0), 1.f);
+            recorder.recordMessage(MidiMessage::channelPressureChange(1, 64), 1.f);
+            recorder.insertRecordedAutomation();
+
+            FlatHashMap<int, int> numEventsByController;
+            for (const auto *track : project->findChildrenOfType<AutomationTrackNode>())
+            {
+                expectEquals(track->getTrackInstrumentId(), instrumentId);
+                numEventsByController[track->getTrackControllerNumber()] += track->getSequence()->size();
+            }
+
+            expectEquals(int(numEventsByController.size()), 3);
+            expectEquals(numEventsByController[1], 2);
+            expectEquals(numEventsByController[MidiTrack::pitchWheelController], 1);
+            expectEquals(numEventsByController[MidiTrack::channelPressureController], 1);
+        }
+
+        projectFile.deleteFile();
+    }
+};
+
+static MidiRecorderTests midiRecorderTests;
+
+#endif
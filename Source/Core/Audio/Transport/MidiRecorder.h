@@ -24,6 +24,7 @@ class Transport;
 
 #include "Clip.h"
 #include "Note.h"
+#include "AutomationEvent.h"
 #include "TransportListener.h"
 
 class MidiRecorder final : public MidiInputCallback,
@@ -52,11 +53,12 @@ private:
     // TransportListener
     //===------------------------------------------------------------------===//
 
-    void onTempoChanged(double) noexcept override;
+    void onTempoChanged(double) noexcept override {}
     void onTotalTimeChanged(double) noexcept override {}
     void onLoopModeChanged(bool, float, float) override {}
 
-    void onSeek(float, double, double) noexcept override;
+    void onSeek(float, double, double) noexcept override {}
+    void onRewind(float, float) override;
     void onPlay() noexcept override;
     void onRecord() override;
     void onStop() override;
@@ -83,29 +85,72 @@ private:
     String lastValidInstrumentId;
 
     PianoSequence *getPianoSequence() const;
+    void createActiveTrack();
+
+    // the midi input thread only timestamps incoming messages
+    // and pushes them into this lock-free queue, which is
+    // drained on the message thread in handleAsyncUpdate:
+    struct RecordedMessage final
+    {
+        uint8 data[3];
+        int size;
+        double beat;
+        // the loop rewinds counter at the time of receiving,
+        // so that the messages received after the rewind
+        // are not mixed up with the notes still being held
+        uint32 numRewinds;
+    };
+
+    static constexpr auto messagesQueueSize = 1024;
+    RecordedMessage messagesQueue[messagesQueueSize];
+    AbstractFifo messagesQueueFifo { messagesQueueSize };
+
+    // the fifo is single-producer, but some backends
+    // may call back from different threads for different devices
+    SpinLock messagesQueueWriteLock;
+
+    // the notes being held are not added to the sequence until released,
+    // the rolls only show them as an overlay; the released notes
+    // are added in one batch per update, so that neither the undo stack,
+    // nor the playback caches are touched at every timer tick
+    FlatHashMap<int, Note> holdingNotes;
+    Array<Note> releasedNotes;
+    bool isShowingHoldingNotes = false;
 
-    Array<MidiMessage, CriticalSection> noteOnsBuffer;
-    Array<MidiMessage, CriticalSection> noteOffsBuffer;
-    Array<MidiMessage> unhandledNoteOffs;
+    // the notes held at the loop end are released there
+    uint32 numHandledRewinds = 0;
+    void handleRewindIfNeeded(uint32 numRewinds);
 
-    FlatHashMap<int, Note> holdingNotes;
-    void startHoldingNote(MidiMessage message);
-    void updateLengthsOfHoldingNotes() const;
-    void finaliseAllHoldingNotes();
-    bool finaliseHoldingNote(int key);
+    void recordMessage(const MidiMessage &message, float beat);
+    static bool isRecordable(const MidiMessage &message) noexcept;
+
+    void startHoldingNote(int key, float velocity, float beat);
+    bool releaseHoldingNote(int key, float beat);
+    void releaseAllHoldingNotes(float beat);
+    void insertReleasedNotes();
+    void showHoldingNotes(float beat);
+
+    // controllers, pitch wheel and pressure go to the automation tracks
+    // of the same instrument, which are created when missing
+    FlatHashMap<int, Array<AutomationEvent>> recordedAutomation;
+    FlatHashMap<int, float> lastAutomationValues;
+    FlatHashMap<int, WeakReference<MidiTrack>> automationTracks;
 
+    void recordAutomationEvent(int controllerNumber, float controllerValue, float beat);
+    void insertRecordedAutomation();
+    MidiTrack *findOrCreateAutomationTrack(int controllerNumber);
+
+    // estimated from the transport's lock-free playback state
     double getEstimatedPosition() const;
 
     // no need for updating too often, I guess:
     static constexpr auto updateTimeHz = 15;
 
-    Atomic<float> lastCorrectPosition = 0.f;
-    Atomic<double> lastUpdateTime = 0.0;
-    Atomic<double> msPerQuarterNote = Globals::Defaults::msPerBeat;
-
     Atomic<bool> isPlaying = false;
     Atomic<bool> isRecording = false;
     Atomic<bool> shouldCheckpoint = false;
 
+    friend class MidiRecorderTests;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MidiRecorder)
 };
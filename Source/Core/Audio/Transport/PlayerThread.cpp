@@ -44,11 +44,39 @@ void PlayerThread::run()
     Array<Instrument *> uniqueInstruments;
     uniqueInstruments.addArray(this->sequences.getUniqueInstruments());
 
-    auto broadcastSeek = [this](Atomic<float> &beat)
+    // the listeners are not called from here, instead, the transport
+    // polls this state at the display rate on the message thread:
+    auto &state = this->transport.playbackState;
+
+    auto updatePosition = [this, &state](const Atomic<float> &beat)
     {
-        this->transport.broadcastSeek(beat.get(),
+        state.seek(beat.get(),
             this->context->startBeatTimeMs,
-            this->context->totalTimeMs);
+            this->context->totalTimeMs,
+            Time::getMillisecondCounterHiRes());
+    };
+
+    auto postEvent = [this, &state](TransportState::Event::Type type)
+    {
+        TransportState::Event event;
+        event.type = type;
+        event.playbackId = this->context->playbackId;
+        event.fromBeat = this->context->endBeat;
+        event.toBeat = this->context->rewindBeat;
+
+        if (!state.postEvent(event))
+        {
+            DBG("Transport events queue overflow, dropping an event");
+        }
+    };
+
+    auto rewind = [this, &state, &postEvent]()
+    {
+        state.rewind(this->context->endBeat,
+            this->context->rewindBeat,
+            Time::getMillisecondCounterHiRes());
+
+        postEvent(TransportState::Event::Type::Rewound);
     };
 
     const bool isLooped = this->context->playbackLoopMode;
@@ -56,7 +84,7 @@ void PlayerThread::run()
     this->sequences.seekToTime(this->context->startBeat);
 
     Atomic<float> previousEventBeat = this->context->startBeat;
-    broadcastSeek(previousEventBeat);
+    updatePosition(previousEventBeat);
 
     // This hack is here to keep track of still playing events
     // to be able to send noteOff's when playback interrupts.
@@ -64,10 +92,14 @@ void PlayerThread::run()
     {
         int key;
         int channel;
-        MidiMessageCollector *listener;
+        MidiMessageQueue *listener;
     };
     // (some plugins just don't understand allNotesOff message)
-    Array<HoldingNote> holdingNotes;
+    // the storage is allocated once here, and the minimum allocated size
+    // keeps removals from shrinking it on the way:
+    static constexpr auto numPreallocatedHoldingNotes = 128;
+    Array<HoldingNote, DummyCriticalSection, numPreallocatedHoldingNotes> holdingNotes;
+    holdingNotes.ensureStorageAllocated(numPreallocatedHoldingNotes);
     
     // Some shorthands:
     auto sendMidiStart = [&uniqueInstruments]()
@@ -76,7 +108,7 @@ void PlayerThread::run()
         {
             MidiMessage startPlayback(MidiMessage::midiStart());
             startPlayback.setTimeStamp(Time::getMillisecondCounterHiRes() * 0.001);
-            instrument->getProcessorPlayer().getMidiMessageCollector().addMessageToQueue(startPlayback);
+            instrument->getProcessorPlayer().getMidiMessageQueue().addMessageToQueue(startPlayback);
         }
     };
 
@@ -96,7 +128,7 @@ void PlayerThread::run()
                 {
                     MidiMessage m(MidiMessage::controllerEvent(channel, cc, state));
                     m.setTimeStamp(Time::getMillisecondCounterHiRes() * 0.001);
-                    instrument->getProcessorPlayer().getMidiMessageCollector().addMessageToQueue(m);
+                    instrument->getProcessorPlayer().getMidiMessageQueue().addMessageToQueue(m);
                 }
             }
         }
@@ -117,7 +149,7 @@ void PlayerThread::run()
         for (auto &instrument : uniqueInstruments)
         {
             instrument->getProcessorPlayer()
-                .getMidiMessageCollector().addMessageToQueue(stopPlayback);
+                .getMidiMessageQueue().addMessageToQueue(stopPlayback);
         }
         
         // Wait until all plugins process the messages in their queues
@@ -130,7 +162,7 @@ void PlayerThread::run()
         for (auto &instrument : uniqueInstruments)
         {
             instrument->getProcessorPlayer().
-                getMidiMessageCollector().addMessageToQueue(tempoEvent);
+                getMidiMessageQueue().addMessageToQueue(tempoEvent);
         }
     };
 
@@ -174,7 +206,7 @@ void PlayerThread::run()
             {
                 this->sequences.seekToTime(this->context->rewindBeat);
                 previousEventBeat = this->context->rewindBeat;
-                broadcastSeek(previousEventBeat);
+                rewind();
                 continue;
             }
             else
@@ -191,9 +223,8 @@ void PlayerThread::run()
                     return; // the transport have already stopped
                 }
 
-                this->transport.allNotesControllersAndSoundOff();
-                this->transport.stopRecording();
-                this->transport.stopPlayback();
+                // the transport will stop on the message thread
+                postEvent(TransportState::Event::Type::Finished);
                 return;
             }
         }
@@ -235,14 +266,14 @@ void PlayerThread::run()
                 return;
             }
 
-            broadcastSeek(previousEventBeat);
+            updatePosition(previousEventBeat);
         }
         
         if (shouldRewind)
         {
             this->sequences.seekToTime(this->context->rewindBeat);
             previousEventBeat = this->context->rewindBeat;
-            broadcastSeek(previousEventBeat);
+            rewind();
         }
         else
         {
@@ -254,7 +285,7 @@ void PlayerThread::run()
             if (wrapper.message.isTempoMetaEvent())
             {
                 currentTempo = wrapper.message.getTempoSecondsPerQuarterNote() * 1000.f;
-                this->transport.broadcastTempoChanged(currentTempo.get());
+                state.setTempo(currentTempo.get(), Time::getMillisecondCounterHiRes());
 
                 // Sends this to everybody (need to do that for drum-machines) - TODO test
                 sendTempoChangeToEverybody(wrapper.message);
@@ -43,7 +43,8 @@ public:
         }
     }
 
-    void startPlayback(float startBeat, float rewindBeat, float endBeat, bool loopMode)
+    void startPlayback(float startBeat, float rewindBeat,
+        float endBeat, bool loopMode, uint32 playbackId)
     {
         if (this->currentPlayer->isThreadRunning())
         {
@@ -55,9 +56,16 @@ public:
         playbackContext->endBeat = endBeat;
         playbackContext->rewindBeat = rewindBeat;
         playbackContext->playbackLoopMode = loopMode;
+        playbackContext->playbackId = playbackId;
+
+        // the position and tempo are valid from now on,
+        // even before the player thread actually starts
+        this->transport.playbackState.start(startBeat,
+            playbackContext->startBeatTempo,
+            playbackContext->startBeatTimeMs,
+            playbackContext->totalTimeMs,
+            Time::getMillisecondCounterHiRes());
 
-        // let listeners know about the tempo before the playback starts
-        this->transport.broadcastTempoChanged(playbackContext->startBeatTempo);
         this->currentPlayer->startPlayback(playbackContext);
     }
 
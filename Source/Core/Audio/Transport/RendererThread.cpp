@@ -126,7 +126,7 @@ struct RenderBuffer final
 
 void RendererThread::run()
 {
-    auto sequences = this->transport.buildPlaybackCache(false);
+    auto sequences = this->transport.buildPlaybackCache();
     constexpr auto bufferSize = 512;
 
     // assuming that number of channels and sample rate is equal for all instruments
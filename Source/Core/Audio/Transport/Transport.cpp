@@ -51,6 +51,8 @@ Transport::Transport(ProjectNode &project, OrchestraPit &orchestraPit, SleepTime
 
 Transport::~Transport()
 {
+    this->stopTimer();
+
     App::Config().getUiFlags()->removeListener(this);
 
     this->orchestra.removeOrchestraListener(this);
@@ -123,6 +125,11 @@ void Transport::setSeekBeat(float beatPosition)
     this->seekBeat = beatPosition;
 }
 
+const TransportState &Transport::getPlaybackState() const noexcept
+{
+    return this->playbackState;
+}
+
 //===----------------------------------------------------------------------===//
 // Transport
 //===----------------------------------------------------------------------===//
@@ -132,6 +139,11 @@ void Transport::seekToBeat(float beatPosition)
     const auto currentTimeMs = this->findTimeAt(this->projectFirstBeat.get());
     const auto totalTimeMs = this->findTimeAt(this->projectLastBeat.get());
     this->setSeekBeat(beatPosition);
+
+    this->playbackState.seek(beatPosition, currentTimeMs, totalTimeMs,
+        Time::getMillisecondCounterHiRes());
+    this->lastFrameState = this->playbackState.read();
+
     this->broadcastSeek(beatPosition, currentTimeMs, totalTimeMs);
 }
 
@@ -140,24 +152,25 @@ void Transport::probeSoundAtBeat(float targetBeat, const MidiSequence *limitToSe
     this->sleepTimer.setAwake();
     this->rebuildPlaybackCacheIfNeeded();
     
-    const auto sequencesToProbe = this->playbackCache.getAllFor(limitToSequence);
+    const auto instancesToProbe = this->playbackCache.getAllFor(limitToSequence);
     
-    for (const auto &seq : sequencesToProbe)
+    for (const auto &instance : instancesToProbe)
     {
-        for (int j = 0; j < seq->midiMessages.getNumEvents(); ++j)
+        const auto &midiMessages = instance.sequence->midiMessages;
+        for (int j = 0; j < midiMessages.getNumEvents(); ++j)
         {
-            auto *noteOnHolder = seq->midiMessages.getEventPointer(j);
+            auto *noteOnHolder = midiMessages.getEventPointer(j);
             
             if (auto *noteOffHolder = noteOnHolder->noteOffObject)
             {
-                const auto noteOnBeat = noteOnHolder->message.getTimeStamp();
-                const auto noteOffBeat = noteOffHolder->message.getTimeStamp();
+                const auto noteOnBeat = noteOnHolder->message.getTimeStamp() + instance.beatOffset;
+                const auto noteOffBeat = noteOffHolder->message.getTimeStamp() + instance.beatOffset;
                 
                 if (noteOnBeat <= targetBeat && noteOffBeat > targetBeat)
                 {
                     MidiMessage messageTimestampedAsNow(noteOnHolder->message);
                     messageTimestampedAsNow.setTimeStamp(TIME_NOW);
-                    seq->listener->addMessageToQueue(messageTimestampedAsNow);
+                    instance.sequence->listener->addMessageToQueue(messageTimestampedAsNow);
                 }
             }
         }
@@ -180,7 +193,10 @@ void Transport::startPlayback(float start)
     this->sleepTimer.setAwake();
     this->rebuildPlaybackCacheIfNeeded();
 
-    this->stopPlayback();
+    this->stopPlayback(); // also handles the previous player's pending events
+
+    // so that nothing posted by the previous player can match this one:
+    this->playbackId++;
 
     if (this->loopMode.get())
     {
@@ -188,15 +204,16 @@ void Transport::startPlayback(float start)
         const auto end = this->loopEndBeat.get();
 
         this->player->startPlayback((start >= end) ? loopStart : start,
-            loopStart, end, true);
+            loopStart, end, true, this->playbackId);
     }
     else
     {
         this->player->startPlayback(start,
-            this->getSeekBeat(), this->getProjectLastBeat(), false);
+            this->getSeekBeat(), this->getProjectLastBeat(), false, this->playbackId);
     }
 
     this->broadcastPlay();
+    this->startTimerHz(Transport::frameRateHz);
 }
 
 void Transport::startPlaybackFragment(float startBeat, float endBeat, bool looped)
@@ -206,22 +223,46 @@ void Transport::startPlaybackFragment(float startBeat, float endBeat, bool loope
     
     this->stopPlayback();
 
-    this->player->startPlayback(startBeat, startBeat, endBeat, looped);
+    this->playbackId++; // see the comment in startPlayback
+    this->player->startPlayback(startBeat, startBeat, endBeat, looped, this->playbackId);
     this->broadcastPlay();
+    this->startTimerHz(Transport::frameRateHz);
 }
 
 void Transport::stopPlayback()
 {
-    if (this->player->isPlaying())
+    const bool wasPlaying = this->player->isPlaying();
+    if (wasPlaying)
+    {
+        this->player->stopPlayback();
+    }
+
+    // the player might have finished on its own and posted the events
+    // which are not handled yet, so they are handled before the playback id
+    // is changed, instead of being dropped as stale; after that, the stopped
+    // player can't post anything else
+    this->handlePendingPlaybackEvents();
+
+    if (wasPlaying && this->isTimerRunning())
     {
-        this->broadcastStop();
-        this->player->stopPlayback(); // after broadcastStop so that MM can be locked
-        this->allNotesControllersAndSoundOff();
-        this->seekToBeat(this->getSeekBeat());
-        this->sleepTimer.setCanSleepAfter(Transport::soundSleepDelayMs);
+        this->finishPlayback();
     }
 }
 
+void Transport::finishPlayback()
+{
+    this->stopTimer();
+    this->playbackId++;
+
+    // the listeners may still want the estimated stop position
+    this->broadcastStop();
+    this->playbackState.stop();
+
+    this->allNotesControllersAndSoundOff();
+    this->seekToBeat(this->getSeekBeat());
+    this->sleepTimer.setCanSleepAfter(Transport::soundSleepDelayMs);
+}
+
 void Transport::toggleStartStopPlayback()
 {
     this->isPlaying() ? this->stopPlaybackAndRecording() : this->startPlayback();
@@ -237,6 +278,71 @@ bool Transport::isPlayingAndRecording() const
     return this->isPlaying() && this->isRecording();
 }
 
+//===----------------------------------------------------------------------===//
+// Playback state polling
+//===----------------------------------------------------------------------===//
+
+void Transport::timerCallback()
+{
+    this->handlePendingPlaybackEvents();
+
+    if (!this->isTimerRunning())
+    {
+        return; // the playback has just finished
+    }
+
+    const auto state = this->playbackState.read();
+    if (state.sequence != this->lastFrameState.sequence)
+    {
+        if (state.msPerQuarterNote != this->lastFrameState.msPerQuarterNote)
+        {
+            this->broadcastTempoChanged(state.msPerQuarterNote);
+        }
+
+        if (state.beat != this->lastFrameState.beat ||
+            state.timeMs != this->lastFrameState.timeMs)
+        {
+            this->broadcastSeek(state.beat, state.currentTimeMs, state.totalTimeMs);
+        }
+
+        this->lastFrameState = state;
+    }
+
+    this->broadcastPlaybackFrame(state.getEstimatedBeat(Time::getMillisecondCounterHiRes()));
+}
+
+void Transport::handlePendingPlaybackEvents()
+{
+    TransportState::Event event;
+    while (this->playbackState.popEvent(event))
+    {
+        this->handlePlaybackEvent(event);
+    }
+}
+
+void Transport::handlePlaybackEvent(const TransportState::Event &event)
+{
+    if (event.playbackId != this->playbackId)
+    {
+        return; // posted by the player which has been stopped since
+    }
+
+    switch (event.type)
+    {
+    case TransportState::Event::Type::Rewound:
+        this->broadcastRewind(event.fromBeat, event.toBeat);
+        break;
+    case TransportState::Event::Type::Finished:
+        // the player only finishes after the recording has stopped,
+        // but the flag might have been set again meanwhile
+        this->midiRecordingMode = false;
+        this->finishPlayback();
+        break;
+    default:
+        break;
+    }
+}
+
 //===----------------------------------------------------------------------===//
 // Recording MIDI
 //===----------------------------------------------------------------------===//
@@ -429,7 +535,7 @@ void Transport::NotePreviewTimer::cancelAllPendingPreviews(bool sendRemainingNot
                 MidiMessage message(MidiMessage::noteOff(mapped.channel, mapped.key));
                 message.setTimeStamp(TIME_NOW);
                 preview.instrument->getProcessorPlayer()
-                    .getMidiMessageCollector().addMessageToQueue(message);
+                    .getMidiMessageQueue().addMessageToQueue(message);
             }
 
             preview.instrument = nullptr;
@@ -456,7 +562,7 @@ void Transport::NotePreviewTimer::previewNote(WeakReference<Instrument> instrume
         MidiMessage message(MidiMessage::noteOff(mapped.channel, mapped.key));
         message.setTimeStamp(TIME_NOW);
         preview.instrument->getProcessorPlayer()
-            .getMidiMessageCollector().addMessageToQueue(message);
+            .getMidiMessageQueue().addMessageToQueue(message);
     }
 
     preview.volume = volume;
@@ -495,7 +601,7 @@ void Transport::NotePreviewTimer::timerCallback()
                 MidiMessage message(MidiMessage::noteOn(mapped.channel, mapped.key, preview.volume));
                 message.setTimeStamp(time);
                 preview.instrument->getProcessorPlayer()
-                    .getMidiMessageCollector().addMessageToQueue(message);
+                    .getMidiMessageQueue().addMessageToQueue(message);
             }
         }
         else if (preview.noteOffTimeoutMs > 0)
@@ -510,7 +616,7 @@ void Transport::NotePreviewTimer::timerCallback()
                 MidiMessage message(MidiMessage::noteOff(mapped.channel, mapped.key));
                 message.setTimeStamp(time);
                 preview.instrument->getProcessorPlayer()
-                    .getMidiMessageCollector().addMessageToQueue(message);
+                    .getMidiMessageQueue().addMessageToQueue(message);
             }
         }
     }
@@ -558,13 +664,13 @@ void Transport::previewKey(WeakReference<Instrument> instrument,
 
 static void stopSoundForInstrument(Instrument *instrument)
 {
-    auto &collector = instrument->getProcessorPlayer().getMidiMessageCollector();
+    auto &queue = instrument->getProcessorPlayer().getMidiMessageQueue();
 
     for (int i = 1; i < Globals::numChannels; ++i)
     {
-        collector.addMessageToQueue(MidiMessage::allControllersOff(i).withTimeStamp(TIME_NOW));
-        collector.addMessageToQueue(MidiMessage::allNotesOff(i).withTimeStamp(TIME_NOW));
-        collector.addMessageToQueue(MidiMessage::allSoundOff(i).withTimeStamp(TIME_NOW));
+        queue.addMessageToQueue(MidiMessage::allControllersOff(i).withTimeStamp(TIME_NOW));
+        queue.addMessageToQueue(MidiMessage::allNotesOff(i).withTimeStamp(TIME_NOW));
+        queue.addMessageToQueue(MidiMessage::allSoundOff(i).withTimeStamp(TIME_NOW));
     }
 }
 
@@ -602,19 +708,19 @@ void Transport::allNotesControllersAndSoundOff() const
         const MidiMessage soundOff(MidiMessage::allSoundOff(i).withTimeStamp(TIME_NOW));
         const MidiMessage controllersOff(MidiMessage::allControllersOff(i).withTimeStamp(TIME_NOW));
         
-        Array<const MidiMessageCollector *> uniqueMessageCollectors;
+        Array<const MidiMessageQueue *> uniqueMessageQueues;
         
         for (int l = 0; l < this->tracksCache.size(); ++l)
         {
             const auto &trackId = this->tracksCache.getUnchecked(l)->getTrackId();
-            auto *collector = &this->instrumentLinks[trackId]->getProcessorPlayer().getMidiMessageCollector();
+            auto *queue = &this->instrumentLinks[trackId]->getProcessorPlayer().getMidiMessageQueue();
             
-            if (! uniqueMessageCollectors.contains(collector))
+            if (! uniqueMessageQueues.contains(queue))
             {
-                collector->addMessageToQueue(notesOff);
-                collector->addMessageToQueue(controllersOff);
-                collector->addMessageToQueue(soundOff);
-                uniqueMessageCollectors.add(collector);
+                queue->addMessageToQueue(notesOff);
+                queue->addMessageToQueue(controllersOff);
+                queue->addMessageToQueue(soundOff);
+                uniqueMessageQueues.add(queue);
             }
         }
     }
@@ -628,11 +734,9 @@ void Transport::allNotesControllersAndSoundOff() const
 
 void Transport::onMetronomeFlagChanged(bool enabled)
 {
-    // metronome events are the part of playback cache,
-    // so we will have to rebuild it when the playback starts:
+    // metronome clicks are generated on the fly by the playback cache,
+    // which checks this flag, so toggling works even during playback:
     this->isMetronomeEnabled = enabled;
-    this->stopPlaybackAndRecording();
-    this->playbackCacheIsOutdated = true;
 }
 
 //===----------------------------------------------------------------------===//
@@ -641,12 +745,9 @@ void Transport::onMetronomeFlagChanged(bool enabled)
 
 void Transport::onTimeSignaturesUpdated()
 {
-    // almost same logic as in onMetronomeFlagChanged:
-    if (this->isMetronomeEnabled)
-    {
-        // this->stopPlaybackAndRecording(); // that's kinda too intrusive
-        this->playbackCacheIsOutdated = true;
-    }
+    // only the metronome depends on time signatures,
+    // and rebuilding it is cheap, no need to touch the rest of the cache
+    this->metronomeCacheIsOutdated = true;
 }
 
 //===----------------------------------------------------------------------===//
@@ -849,6 +950,7 @@ void Transport::onChangeProjectBeatRange(float firstBeat, float lastBeat)
 
     this->projectFirstBeat = firstBeat;
     this->projectLastBeat = lastBeat;
+    this->metronomeCacheIsOutdated = true;
     
     // real track total time changed
     const auto realLengthMs = this->findTimeAt(lastBeat);
@@ -872,7 +974,7 @@ double Transport::findTimeAt(float targetBeat) const
     double tempo = Globals::Defaults::msPerBeat;
 
     this->playbackCache.seekToStart();
-    while (this->playbackCache.getNextMessage(cached))
+    while (this->playbackCache.getNextMessage(cached, false))
     {
         if (cached.message.isTempoMetaEvent())
         {
@@ -884,7 +986,7 @@ double Transport::findTimeAt(float targetBeat) const
     double prevTimestamp = this->projectFirstBeat.get();
 
     this->playbackCache.seekToStart();
-    while (this->playbackCache.getNextMessage(cached))
+    while (this->playbackCache.getNextMessage(cached, false))
     {
         const auto nextTimestamp = cached.message.getTimeStamp();
 
@@ -920,7 +1022,7 @@ Transport::PlaybackContext::Ptr Transport::fillPlaybackContextAt(float targetBea
     double tempo = Globals::Defaults::msPerBeat;
 
     this->playbackCache.seekToStart();
-    while (this->playbackCache.getNextMessage(cached))
+    while (this->playbackCache.getNextMessage(cached, false))
     {
         if (cached.message.isTempoMetaEvent())
         {
@@ -943,7 +1045,7 @@ Transport::PlaybackContext::Ptr Transport::fillPlaybackContextAt(float targetBea
     bool startBeatPassed = false;
 
     this->playbackCache.seekToStart();
-    while (this->playbackCache.getNextMessage(cached))
+    while (this->playbackCache.getNextMessage(cached, false))
     {
         const auto nextTimestamp = cached.message.getTimeStamp();
         const auto nextEventTimeDelta = tempo * (nextTimestamp - prevTimestamp);
@@ -996,12 +1098,41 @@ void Transport::rebuildPlaybackCacheIfNeeded() const
 {
     if (this->playbackCacheIsOutdated.get())
     {
-        this->playbackCache = this->buildPlaybackCache(this->isMetronomeEnabled);
+        this->playbackCache = this->buildPlaybackCache();
         this->playbackCacheIsOutdated = false;
+        this->metronomeCacheIsOutdated = true;
+    }
+
+    if (this->metronomeCacheIsOutdated.get())
+    {
+        this->playbackCache.setMetronome(this->buildMetronome());
+        this->metronomeCacheIsOutdated = false;
     }
 }
 
-TransportPlaybackCache Transport::buildPlaybackCache(bool withMetronome) const
+CachedMetronome::Ptr Transport::buildMetronome() const
+{
+    auto *instrument = this->orchestra.getMetronomeInstrument();
+    if (instrument == nullptr)
+    {
+        return nullptr;
+    }
+
+    const auto *timeSignatures = dynamic_cast<TimeSignaturesSequence *>(this->project
+        .getTimeline()->getTimeSignaturesAggregator()->getSequence());
+
+    jassert(timeSignatures != nullptr);
+    if (timeSignatures == nullptr)
+    {
+        return nullptr;
+    }
+
+    return CachedMetronome::createFrom(instrument, this->isMetronomeEnabled,
+        timeSignatures->getMetronomeRanges(this->projectFirstBeat.get(),
+            this->projectLastBeat.get()));
+}
+
+TransportPlaybackCache Transport::buildPlaybackCache() const
 {
     TransportPlaybackCache result;
     
@@ -1022,26 +1153,48 @@ TransportPlaybackCache Transport::buildPlaybackCache(bool withMetronome) const
         const auto instrument = this->instrumentLinks[track->getTrackId()];
         const auto &keyMap = *instrument->getKeyboardMapping();
 
-        auto cached = CachedMidiSequence::createFrom(instrument, track->getSequence());
-
         if (track->getPattern() != nullptr)
         {
+            // the sequence is exported once for all clips which only differ
+            // in position, e.g. the repeats of the same pattern, and each clip
+            // only adds a lightweight instance with its beat offset
+            Array<Clip> exportedClips;
+            ReferenceCountedArray<CachedMidiSequence> exportedSequences;
+
             for (const auto *clip : track->getPattern()->getClips())
             {
-                cached->track->exportMidi(cached->midiMessages, *clip,
-                    keyMap, hasSoloClips, withMetronome,
-                    this->projectFirstBeat.get(), this->projectLastBeat.get());
+                CachedMidiSequence::Ptr cached;
+                for (int i = 0; i < exportedClips.size(); ++i)
+                {
+                    if (exportedClips.getReference(i).hasSameContentAs(*clip))
+                    {
+                        cached = exportedSequences.getUnchecked(i);
+                        break;
+                    }
+                }
+
+                if (cached == nullptr)
+                {
+                    cached = CachedMidiSequence::createFrom(instrument, track->getSequence());
+                    cached->track->exportMidi(cached->midiMessages, clip->withBeat(0.f),
+                        keyMap, hasSoloClips);
+
+                    exportedClips.add(*clip);
+                    exportedSequences.add(cached);
+                }
+
+                result.addInstance(cached, clip->getBeat());
             }
         }
         else
         {
             static Clip noTransform;
+            auto cached = CachedMidiSequence::createFrom(instrument, track->getSequence());
             cached->track->exportMidi(cached->midiMessages, noTransform,
-                keyMap, hasSoloClips, withMetronome,
-                this->projectFirstBeat.get(), this->projectLastBeat.get());
-        }
+                keyMap, hasSoloClips);
 
-        result.addWrapper(cached);
+            result.addInstance(cached, 0.0);
+        }
     }
 
     return result;
@@ -1113,6 +1266,16 @@ void Transport::broadcastSeek(float beat, double currentTimeMs, double totalTime
         beat, currentTimeMs, totalTimeMs);
 }
 
+void Transport::broadcastRewind(float fromBeat, float toBeat)
+{
+    this->transportListeners.call(&TransportListener::onRewind, fromBeat, toBeat);
+}
+
+void Transport::broadcastPlaybackFrame(double estimatedBeat)
+{
+    this->transportListeners.call(&TransportListener::onPlaybackFrame, estimatedBeat);
+}
+
 void Transport::broadcastTempoChanged(double newTempo)
 {
     this->transportListeners.call(&TransportListener::onTempoChanged, newTempo);
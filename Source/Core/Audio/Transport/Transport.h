@@ -25,6 +25,7 @@ class PlayerThreadPool;
 class RendererThread;
 
 #include "TransportListener.h"
+#include "TransportState.h"
 #include "TransportPlaybackCache.h"
 #include "TimeSignaturesAggregator.h"
 #include "OrchestraListener.h"
@@ -38,7 +39,8 @@ class Transport final : public Serializable,
     public ProjectListener,
     public OrchestraListener,
     public TimeSignaturesAggregator::Listener,
-    public UserInterfaceFlags::Listener // needs the metronome on/off flag changes
+    public UserInterfaceFlags::Listener, // needs the metronome on/off flag changes
+    private Timer // polls the playback state for all listeners at the display rate
 {
 public:
 
@@ -87,6 +89,10 @@ public:
     float getPlaybackLoopStart() const noexcept;
     float getPlaybackLoopEnd() const noexcept;
 
+    // the position and tempo as last reported by the player,
+    // safe to read from any thread, including the realtime ones
+    const TransportState &getPlaybackState() const noexcept;
+
     float getRenderingPercentsComplete() const;
     const Array<float, CriticalSection> &getRenderingWaveformThumbnail() const;
 
@@ -118,6 +124,9 @@ public:
 
         bool playbackLoopMode = false;
 
+        // passed back with the player's events
+        uint32 playbackId = 0;
+
         // computed CC values: -1 if not found in any track,
         // otherwise, the controller value at the time of playback start;
         // CC numbers 102119 are undefined, and numbers 120-127 are
@@ -227,10 +236,13 @@ private:
     void broadcastTotalTimeChanged(double timeMs);
     void broadcastLoopModeChanged(bool hasLoop, float startBeat, float endBeat);
     void broadcastSeek(float newBeat, double currentTimeMs, double totalTimeMs);
+    void broadcastRewind(float fromBeat, float toBeat);
+    void broadcastPlaybackFrame(double estimatedBeat);
 
     friend class PlayerThread;
     friend class PlayerThreadPool;
     friend class RendererThread;
+    friend class ProjectBenchmarks;
 
 private:
     
@@ -243,12 +255,34 @@ private:
     UniquePointer<PlayerThreadPool> player;
     UniquePointer<RendererThread> renderer;
 
+private:
+
+    // written by the player thread, polled here at the display rate,
+    // the player's events are also handled here, on the message thread:
+    TransportState playbackState;
+    TransportState::Snapshot lastFrameState;
+    static constexpr auto frameRateHz = 60;
+
+    void timerCallback() override;
+    void handlePendingPlaybackEvents();
+    void handlePlaybackEvent(const TransportState::Event &event);
+
+    // incremented at each stop, so that the events
+    // posted by the stopped players can be told apart
+    uint32 playbackId = 0;
+
+    // sends the stop notifications, shuts up the instruments
+    // and brings the playhead back to the seek position
+    void finishPlayback();
+
 private:
 
     mutable TransportPlaybackCache playbackCache;
     mutable Atomic<bool> playbackCacheIsOutdated = true;
+    mutable Atomic<bool> metronomeCacheIsOutdated = true;
     void rebuildPlaybackCacheIfNeeded() const;
-    TransportPlaybackCache buildPlaybackCache(bool withMetronome) const;
+    TransportPlaybackCache buildPlaybackCache() const;
+    CachedMetronome::Ptr buildMetronome() const;
 
     // linksCache is <track id : instrument>
     mutable Array<const MidiTrack *> tracksCache;
@@ -309,7 +343,7 @@ private:
     Atomic<float> loopStartBeat = 0.f;
     Atomic<float> loopEndBeat = Globals::Defaults::projectLength;
 
-    bool isMetronomeEnabled = App::Config().getUiFlags()->isMetronomeEnabled();
+    Atomic<bool> isMetronomeEnabled = App::Config().getUiFlags()->isMetronomeEnabled();
 
     ListenerList<TransportListener> transportListeners;
 
@@ -23,13 +23,23 @@ public:
     
     virtual ~TransportListener() = default;
 
-    // expect that any data in these three methods could come
-    // from a separate thread (PlayerThread most likely)
+    // all callbacks come from the message thread; while playing,
+    // the transport polls the player's state once per frame,
+    // so seeks and tempo changes are reported with up to a frame delay;
+    // the threads which need the exact position, should read
+    // the lock-free Transport::getPlaybackState() instead
     virtual void onSeek(float beatPosition, double currentTimeMs, double totalTimeMs) = 0;
     virtual void onTempoChanged(double msPerQuarter) = 0;
     virtual void onTotalTimeChanged(double timeMs) = 0;
     virtual void onLoopModeChanged(bool hasLoop, float startBeat, float endBeat) = 0;
 
+    // called at the display rate while playing, with the beat
+    // extrapolated from the last known position at the current tempo
+    virtual void onPlaybackFrame(double estimatedBeat) {}
+
+    // the looped playback has jumped back to the loop start
+    virtual void onRewind(float fromBeat, float toBeat) {}
+
     // these ones will be called with message manager locked
     virtual void onPlay() = 0;
     virtual void onStop() = 0;
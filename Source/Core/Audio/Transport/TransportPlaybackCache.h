@@ -18,14 +18,16 @@
 #pragma once
 
 #include "Instrument.h"
+#include "TimeSignaturesSequence.h"
 
 class MidiSequence;
 
+// The sequence is exported once at zero beat offset
+// and is shared between all clips which only differ in position
 struct CachedMidiSequence final : public ReferenceCountedObject
 {
     MidiMessageSequence midiMessages;
-    int currentIndex;
-    MidiMessageCollector *listener;
+    MidiMessageQueue *listener;
     Instrument *instrument;
     const MidiSequence *track;
 
@@ -36,17 +38,150 @@ struct CachedMidiSequence final : public ReferenceCountedObject
         jassert(instrument != nullptr);
         CachedMidiSequence::Ptr wrapper(new CachedMidiSequence());
         wrapper->track = track;
-        wrapper->currentIndex = 0;
         wrapper->instrument = instrument;
-        wrapper->listener = &instrument->getProcessorPlayer().getMidiMessageCollector();
+        wrapper->listener = &instrument->getProcessorPlayer().getMidiMessageQueue();
         return wrapper;
     }
 };
 
+// A lightweight view of the shared sequence for each clip,
+// which the playback cache merges with the others on the fly
+struct CachedMidiSequenceInstance final
+{
+    CachedMidiSequence::Ptr sequence;
+    double beatOffset = 0.0;
+    int currentIndex = 0;
+
+    inline bool hasNextMessage() const noexcept
+    {
+        return this->currentIndex < this->sequence->midiMessages.getNumEvents();
+    }
+
+    inline const MidiMessage &getNextMessage() const noexcept
+    {
+        return this->sequence->midiMessages.getEventPointer(this->currentIndex)->message;
+    }
+
+    inline double getNextTimeStamp() const noexcept
+    {
+        return this->getNextMessage().getTimeStamp() + this->beatOffset;
+    }
+};
+
+// The metronome is not materialized in the cache: its clicks are generated
+// on the fly from a short list of time signature ranges, so it takes
+// no memory regardless of the project length, and toggling it
+// doesn't require rebuilding the rest of the playback cache
+struct CachedMetronome final : public ReferenceCountedObject
+{
+    Array<TimeSignaturesSequence::MetronomeRange> ranges;
+    int currentRange = 0;
+    int currentClick = 0;
+
+    // points to the transport's flag, which outlives all playback caches,
+    // so that the metronome can be toggled while the player is running
+    const Atomic<bool> *enabledFlag = nullptr;
+    bool wasEnabled = false; // only used by the iterating thread
+
+    MidiMessageQueue *listener;
+    Instrument *instrument;
+
+    using Ptr = ReferenceCountedObjectPtr<CachedMetronome>;
+
+    static Ptr createFrom(Instrument *instrument, const Atomic<bool> &enabledFlag,
+        Array<TimeSignaturesSequence::MetronomeRange> &&ranges)
+    {
+        jassert(instrument != nullptr);
+        CachedMetronome::Ptr metronome(new CachedMetronome());
+        metronome->ranges = move(ranges);
+        metronome->enabledFlag = &enabledFlag;
+        metronome->instrument = instrument;
+        metronome->listener = &instrument->getProcessorPlayer().getMidiMessageQueue();
+        metronome->seekToStart();
+        return metronome;
+    }
+
+    inline bool isEnabled() const noexcept
+    {
+        return this->enabledFlag != nullptr && this->enabledFlag->get();
+    }
+
+    inline bool hasNextClick() const noexcept
+    {
+        return this->currentRange < this->ranges.size();
+    }
+
+    inline double getNextClickBeat() const noexcept
+    {
+        const auto &range = this->ranges.getReference(this->currentRange);
+        return double(range.startBeat) + double(range.stepBeats) * this->currentClick;
+    }
+
+    MidiMessage getNextClick() const
+    {
+        const auto &range = this->ranges.getReference(this->currentRange);
+        const auto key = range.keys.getUnchecked(this->currentClick % range.keys.size());
+
+        constexpr auto metronomeChannel = 1;    // doesn't matter which one
+        constexpr auto metronomeVelocity = 1.f; // also will be ignored
+
+        // for simplicity, not emitting note-offs for the built-in metronome,
+        // Synthesiser class automatically stops/starts the voices when the same note repeats
+        MidiMessage click(MidiMessage::noteOn(metronomeChannel, key, metronomeVelocity));
+        click.setTimeStamp(this->getNextClickBeat());
+        return click;
+    }
+
+    void skipClick() noexcept
+    {
+        this->currentClick++;
+        this->skipFinishedRanges();
+    }
+
+    void seekToTime(double position) noexcept
+    {
+        this->currentClick = 0;
+        for (this->currentRange = 0; this->currentRange < this->ranges.size(); ++this->currentRange)
+        {
+            const auto &range = this->ranges.getReference(this->currentRange);
+            if (position < range.endBeat)
+            {
+                if (position > range.startBeat)
+                {
+                    this->currentClick = int(std::ceil((position - range.startBeat) / range.stepBeats));
+                }
+
+                break;
+            }
+        }
+
+        this->skipFinishedRanges();
+    }
+
+    void seekToStart() noexcept
+    {
+        this->currentRange = 0;
+        this->currentClick = 0;
+        this->skipFinishedRanges();
+    }
+
+private:
+
+    void skipFinishedRanges() noexcept
+    {
+        while (this->hasNextClick() &&
+            this->getNextClickBeat() >= this->ranges.getReference(this->currentRange).endBeat)
+        {
+            this->currentRange++;
+            this->currentClick = 0;
+        }
+    }
+};
+
 struct CachedMidiMessage final : public ReferenceCountedObject
 {
     MidiMessage message;
-    MidiMessageCollector *listener;
+    MidiMessageQueue *listener;
     Instrument *instrument;
     using Ptr = ReferenceCountedObjectPtr<CachedMidiMessage>;
 };
@@ -56,7 +191,17 @@ class TransportPlaybackCache final
 private:
     
     Array<Instrument *, CriticalSection> uniqueInstruments;
-    ReferenceCountedArray<CachedMidiSequence, CriticalSection> sequences;
+    Array<CachedMidiSequenceInstance> instances;
+
+    // the indices of instances which have messages left, kept as a heap
+    // ordered by their next timestamps, so that picking the next message
+    // takes logarithmic time in the number of clips, not linear
+    Array<int> queue;
+
+    CachedMetronome::Ptr metronome;
+
+    // the last returned timestamp, used to catch up the re-enabled metronome
+    double lastTimeStamp = 0.0;
 
 public:
     
@@ -64,46 +209,68 @@ public:
 
     TransportPlaybackCache(const TransportPlaybackCache &other) noexcept
     {
-        this->sequences.addArray(other.sequences);
+        this->instances.addArray(other.instances);
         this->uniqueInstruments.addArray(other.uniqueInstruments);
+        this->queue.addArray(other.queue);
+        this->metronome = other.metronome;
     }
 
     TransportPlaybackCache(TransportPlaybackCache &&other) noexcept
     {
-        this->sequences.swapWith(other.sequences);
+        this->instances.swapWith(other.instances);
         this->uniqueInstruments.swapWith(other.uniqueInstruments);
+        this->queue.swapWith(other.queue);
+        this->metronome = move(other.metronome);
     }
 
     TransportPlaybackCache &operator= (TransportPlaybackCache &&other) noexcept
     {
-        this->sequences.swapWith(other.sequences);
+        this->instances.swapWith(other.instances);
         this->uniqueInstruments.swapWith(other.uniqueInstruments);
+        this->queue.swapWith(other.queue);
+        this->metronome = move(other.metronome);
         return *this;
     }
 
     inline Array<Instrument *, CriticalSection> getUniqueInstruments() const noexcept
     {
+        if (this->metronome != nullptr)
+        {
+            Array<Instrument *, CriticalSection> result(this->uniqueInstruments);
+            result.addIfNotAlreadyThere(this->metronome->instrument);
+            return result;
+        }
+
         return this->uniqueInstruments;
     }
     
-    void addWrapper(CachedMidiSequence::Ptr newWrapper) noexcept
+    void addInstance(CachedMidiSequence::Ptr sequence, double beatOffset) noexcept
     {
-        if (newWrapper->midiMessages.getNumEvents() > 0)
+        if (sequence->midiMessages.getNumEvents() > 0)
         {
-            this->uniqueInstruments.addIfNotAlreadyThere(newWrapper->instrument);
-            this->sequences.add(newWrapper);
+            this->uniqueInstruments.addIfNotAlreadyThere(sequence->instrument);
+            this->instances.add({ sequence, beatOffset, 0 });
+            this->queue.add(this->instances.size() - 1);
+            std::push_heap(this->queue.begin(), this->queue.end(), QueueOrder{ this->instances });
         }
     }
     
+    void setMetronome(CachedMetronome::Ptr newMetronome) noexcept
+    {
+        this->metronome = newMetronome;
+    }
+
     inline void clear()
     {
         this->uniqueInstruments.clearQuick();
-        this->sequences.clearQuick();
+        this->instances.clearQuick();
+        this->queue.clearQuick();
+        this->metronome = nullptr;
     }
     
     inline bool isEmpty() const
     {
-        return this->sequences.isEmpty();
+        return this->instances.isEmpty();
     }
     
     double getSampleRate() const
@@ -114,7 +281,8 @@ public:
         }
 
         // TODO: something more reasonable?
-        return this->sequences[0]->instrument->getProcessorGraph()->getSampleRate();
+        return this->instances.getReference(0).sequence->
+            instrument->getProcessorGraph()->getSampleRate();
     }
 
     int getNumOutputChannels() const
@@ -125,7 +293,8 @@ public:
         }
 
         // TODO: something more reasonable?
-        return this->sequences[0]->instrument->getProcessorGraph()->getTotalNumOutputChannels();
+        return this->instances.getReference(0).sequence->
+            instrument->getProcessorGraph()->getTotalNumOutputChannels();
     }
 
     int getNumInputChannels() const
@@ -136,18 +305,18 @@ public:
         }
 
         // TODO: something more reasonable?
-        return this->sequences[0]->instrument->getProcessorGraph()->getTotalNumInputChannels();
+        return this->instances.getReference(0).sequence->
+            instrument->getProcessorGraph()->getTotalNumInputChannels();
     }
 
-    ReferenceCountedArray<CachedMidiSequence> getAllFor(const MidiSequence *midiTrack)
+    Array<CachedMidiSequenceInstance> getAllFor(const MidiSequence *midiTrack) const
     {
-        ReferenceCountedArray<CachedMidiSequence> result;
-        for (int i = 0; i < this->sequences.size(); ++i)
+        Array<CachedMidiSequenceInstance> result;
+        for (const auto &instance : this->instances)
         {
-            CachedMidiSequence::Ptr seq(this->sequences[i]);
-            if (midiTrack == nullptr || midiTrack == seq->track)
+            if (midiTrack == nullptr || midiTrack == instance.sequence->track)
             {
-                result.add(seq);
+                result.add(instance);
             }
         }
         
@@ -156,73 +325,141 @@ public:
 
     void seekToTime(double position)
     {
-        for (auto *wrapper : this->sequences)
+        for (auto &instance : this->instances)
         {
-            wrapper->currentIndex = this->getNextIndexAtTime(wrapper->midiMessages, (position - DBL_MIN));
+            instance.currentIndex = this->getNextIndexAtTime(instance.sequence->midiMessages,
+                (position - DBL_MIN) - instance.beatOffset);
         }
+
+        this->rebuildQueue();
+
+        if (this->metronome != nullptr)
+        {
+            this->metronome->seekToTime(position);
+        }
+
+        this->lastTimeStamp = position;
     }
     
     void seekToStart()
     {
-        for (auto *wrapper : this->sequences)
+        for (auto &instance : this->instances)
+        {
+            instance.currentIndex = 0;
+        }
+
+        this->rebuildQueue();
+
+        if (this->metronome != nullptr)
         {
-            wrapper->currentIndex = 0;
+            this->metronome->seekToStart();
         }
+
+        this->lastTimeStamp = 0.0;
     }
     
-    bool getNextMessage(CachedMidiMessage &target)
+    // the metronome clicks don't affect the timing, so the methods
+    // which only need the tempo events may skip generating them
+    bool getNextMessage(CachedMidiMessage &target, bool includeMetronome = true)
     {
-        double minTimeStamp = DBL_MAX;
-        int targetSequenceIndex = -1;
+        const auto minTimeStamp = this->queue.isEmpty() ? DBL_MAX :
+            this->instances.getReference(this->queue.getFirst()).getNextTimeStamp();
 
-        for (int i = 0; i < this->sequences.size(); ++i)
+        if (includeMetronome && this->metronome != nullptr)
         {
-            const auto *wrapper = this->sequences.getObjectPointer(i);
-            if (wrapper->currentIndex < wrapper->midiMessages.getNumEvents())
+            auto *m = this->metronome.get();
+            const auto isEnabled = m->isEnabled();
+            if (isEnabled && !m->wasEnabled)
             {
-                const auto &message = wrapper->midiMessages.getEventPointer(wrapper->currentIndex)->message;
+                // toggled on since the last call, so skip the clicks we've missed
+                m->seekToTime(this->lastTimeStamp);
+            }
 
-                if (message.getTimeStamp() < minTimeStamp)
-                {
-                    minTimeStamp = message.getTimeStamp();
-                    targetSequenceIndex = i;
-                }
+            m->wasEnabled = isEnabled;
+
+            if (isEnabled && m->hasNextClick() &&
+                m->getNextClickBeat() <= minTimeStamp)
+            {
+                target.message = m->getNextClick();
+                target.listener = m->listener;
+                target.instrument = m->instrument;
+                this->lastTimeStamp = target.message.getTimeStamp();
+                m->skipClick();
+                return true;
             }
         }
 
-        if (targetSequenceIndex < 0)
+        if (this->queue.isEmpty())
         {
             return false;
         }
 
-        auto *foundWrapper = this->sequences.getObjectPointer(targetSequenceIndex);
-        jassert(foundWrapper->currentIndex < foundWrapper->midiMessages.getNumEvents());
+        const QueueOrder queueOrder{ this->instances };
+        std::pop_heap(this->queue.begin(), this->queue.end(), queueOrder);
 
-        auto &foundMessage = foundWrapper->midiMessages.getEventPointer(foundWrapper->currentIndex)->message;
-        foundWrapper->currentIndex++;
+        auto &instance = this->instances.getReference(this->queue.getLast());
+        jassert(instance.hasNextMessage());
 
-        target.message = foundMessage;
-        target.listener = foundWrapper->listener;
-        target.instrument = foundWrapper->instrument;
+        target.message = instance.getNextMessage();
+        target.message.setTimeStamp(minTimeStamp);
+        target.listener = instance.sequence->listener;
+        target.instrument = instance.sequence->instrument;
+        this->lastTimeStamp = minTimeStamp;
+
+        instance.currentIndex++;
+
+        if (instance.hasNextMessage())
+        {
+            std::push_heap(this->queue.begin(), this->queue.end(), queueOrder);
+        }
+        else
+        {
+            this->queue.removeLast();
+        }
 
         return true;
     }
     
 private:
     
-    int getNextIndexAtTime(const MidiMessageSequence &sequence, double timeStamp) const
+    static int getNextIndexAtTime(const MidiMessageSequence &sequence, double timeStamp)
     {
-        int i = 0;
-        for (; i < sequence.getNumEvents(); ++i)
+        const auto *found = std::partition_point(sequence.begin(), sequence.end(),
+            [timeStamp](const MidiMessageSequence::MidiEventHolder *event)
+            {
+                return event->message.getTimeStamp() < timeStamp;
+            });
+
+        return int(found - sequence.begin());
+    }
+
+    // the heap functions expect the "less" predicate and keep the greatest
+    // element on top, so the earliest instance must compare as the greatest;
+    // the ties are resolved by the order of instances, i.e. tracks and clips
+    struct QueueOrder final
+    {
+        const Array<CachedMidiSequenceInstance> &instances;
+
+        inline bool operator()(int a, int b) const noexcept
         {
-            const double eventTs = sequence.getEventPointer(i)->message.getTimeStamp();
-            if (eventTs >= timeStamp)
+            const auto timeStampA = this->instances.getReference(a).getNextTimeStamp();
+            const auto timeStampB = this->instances.getReference(b).getNextTimeStamp();
+            return timeStampA > timeStampB || (timeStampA == timeStampB && a > b);
+        }
+    };
+
+    void rebuildQueue()
+    {
+        this->queue.clearQuick();
+        for (int i = 0; i < this->instances.size(); ++i)
+        {
+            if (this->instances.getReference(i).hasNextMessage())
             {
-                break;
+                this->queue.add(i);
             }
         }
-        
-        return i;
+
+        std::make_heap(this->queue.begin(), this->queue.end(), QueueOrder{ this->instances });
     }
 
     JUCE_LEAK_DETECTOR(TransportPlaybackCache)
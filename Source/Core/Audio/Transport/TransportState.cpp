@@ -0,0 +1,274 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "Common.h"
+#include "TransportState.h"
+
+double TransportState::Snapshot::getEstimatedBeat(double atTimeMs) const noexcept
+{
+    if (!this->isPlaying)
+    {
+        return this->beat;
+    }
+
+    const auto timeOffsetMs = jmax(0.0, atTimeMs - this->timeMs);
+    return this->beat + timeOffsetMs / this->msPerQuarterNote;
+}
+
+TransportState::Snapshot TransportState::read() const noexcept
+{
+    Snapshot snapshot;
+
+    while (true)
+    {
+        const auto sequenceBefore = this->sequence.get();
+        if ((sequenceBefore & 1) != 0)
+        {
+            continue; // the write takes just a few stores
+        }
+
+        snapshot.beat = this->beat.get();
+        snapshot.timeMs = this->timeMs.get();
+        snapshot.msPerQuarterNote = this->msPerQuarterNote.get();
+        snapshot.currentTimeMs = this->currentTimeMs.get();
+        snapshot.totalTimeMs = this->totalTimeMs.get();
+        snapshot.numRewinds = this->numRewinds.get();
+        snapshot.lastRewindBeat = this->lastRewindBeat.get();
+        snapshot.isPlaying = this->isPlaying.get();
+
+        if (this->sequence.get() == sequenceBefore)
+        {
+            snapshot.sequence = sequenceBefore;
+            return snapshot;
+        }
+    }
+}
+
+void TransportState::start(float newBeat, double newMsPerQuarterNote,
+    double newCurrentTimeMs, double newTotalTimeMs, double newTimeMs) noexcept
+{
+    this->beginWrite();
+    this->beat = newBeat;
+    this->timeMs = newTimeMs;
+    this->msPerQuarterNote = jmax(newMsPerQuarterNote, 0.01);
+    this->currentTimeMs = newCurrentTimeMs;
+    this->totalTimeMs = newTotalTimeMs;
+    this->isPlaying = true;
+    this->endWrite();
+}
+
+void TransportState::stop() noexcept
+{
+    this->beginWrite();
+    this->isPlaying = false;
+    this->msPerQuarterNote = Globals::Defaults::msPerBeat;
+    this->endWrite();
+}
+
+void TransportState::seek(float newBeat,
+    double newCurrentTimeMs, double newTotalTimeMs, double newTimeMs) noexcept
+{
+    this->beginWrite();
+    this->beat = newBeat;
+    this->timeMs = newTimeMs;
+    this->currentTimeMs = newCurrentTimeMs;
+    this->totalTimeMs = newTotalTimeMs;
+    this->endWrite();
+}
+
+void TransportState::rewind(float fromBeat, float toBeat, double newTimeMs) noexcept
+{
+    this->beginWrite();
+    this->beat = toBeat;
+    this->timeMs = newTimeMs;
+    this->lastRewindBeat = fromBeat;
+    this->numRewinds = this->numRewinds.get() + 1;
+    this->endWrite();
+}
+
+void TransportState::setTempo(double newMsPerQuarterNote, double newTimeMs) noexcept
+{
+    this->beginWrite();
+
+    // keep the estimated position continuous
+    if (this->isPlaying.get())
+    {
+        const auto timeOffsetMs = jmax(0.0, newTimeMs - this->timeMs.get());
+        this->beat = float(this->beat.get() + timeOffsetMs / this->msPerQuarterNote.get());
+        this->timeMs = newTimeMs;
+    }
+
+    this->msPerQuarterNote = jmax(newMsPerQuarterNote, 0.01);
+    this->endWrite();
+}
+
+void TransportState::beginWrite() noexcept
+{
+    while (true)
+    {
+        const auto sequenceBefore = this->sequence.get();
+        if ((sequenceBefore & 1) == 0 &&
+            this->sequence.compareAndSetBool(sequenceBefore + 1, sequenceBefore))
+        {
+            return;
+        }
+    }
+}
+
+void TransportState::endWrite() noexcept
+{
+    ++this->sequence;
+}
+
+//===----------------------------------------------------------------------===//
+// Discrete events
+//===----------------------------------------------------------------------===//
+
+bool TransportState::postEvent(const Event &event) noexcept
+{
+    const SpinLock::ScopedLockType lock(this->eventsQueueWriteLock);
+
+    int start1, size1, start2, size2;
+    this->eventsQueueFifo.prepareToWrite(1, start1, size1, start2, size2);
+    if (size1 + size2 == 0)
+    {
+        return false;
+    }
+
+    this->eventsQueue[size1 > 0 ? start1 : start2] = event;
+    this->eventsQueueFifo.finishedWrite(1);
+    return true;
+}
+
+bool TransportState::popEvent(Event &outEvent) noexcept
+{
+    int start1, size1, start2, size2;
+    this->eventsQueueFifo.prepareToRead(1, start1, size1, start2, size2);
+    if (size1 + size2 == 0)
+    {
+        return false;
+    }
+
+    outEvent = this->eventsQueue[size1 > 0 ? start1 : start2];
+    this->eventsQueueFifo.finishedRead(1);
+    return true;
+}
+
+//===----------------------------------------------------------------------===//
+// Tests
+//===----------------------------------------------------------------------===//
+
+#if JUCE_UNIT_TESTS
+
+class TransportStateTests final : public UnitTest
+{
+public:
+
+    TransportStateTests() : UnitTest("Transport state tests", UnitTestCategories::helio) {}
+
+    void runTest() override
+    {
+        beginTest("Position estimation");
+
+        TransportState state;
+        state.start(4.f, 500.0, 0.0, 0.0, 1000.0);
+        expectWithinAbsoluteError(state.read().getEstimatedBeat(2000.0), 6.0, 0.0001);
+        expectWithinAbsoluteError(state.read().getEstimatedBeat(500.0), 4.0, 0.0001);
+
+        // the tempo change keeps the position where it was estimated
+        state.setTempo(250.0, 2000.0);
+        expectWithinAbsoluteError(state.read().getEstimatedBeat(2000.0), 6.0, 0.0001);
+        expectWithinAbsoluteError(state.read().getEstimatedBeat(2500.0), 8.0, 0.0001);
+
+        state.rewind(8.f, 4.f, 2500.0);
+        expectEquals(state.read().numRewinds, uint32(1));
+        expectWithinAbsoluteError(state.read().getEstimatedBeat(2500.0), 4.0, 0.0001);
+
+        state.stop();
+        expect(!state.read().isPlaying);
+        expectWithinAbsoluteError(state.read().getEstimatedBeat(5000.0), 4.0, 0.0001);
+
+        beginTest("Consistent snapshots while writing");
+
+        struct Writer final : public Thread
+        {
+            explicit Writer(TransportState &state) :
+                Thread("TransportStateTests"), state(state) {}
+
+            void run() override
+            {
+                for (int i = 0; i < 100000 && !this->threadShouldExit(); ++i)
+                {
+                    // all values are kept equal, so a torn read would be visible
+                    this->state.seek(float(i), double(i), double(i), double(i));
+                }
+            }
+
+            TransportState &state;
+        };
+
+        TransportState sharedState;
+        Writer writer(sharedState);
+        writer.startThread();
+
+        int numInconsistentReads = 0;
+        uint32 lastSequence = 0;
+        while (writer.isThreadRunning())
+        {
+            const auto snapshot = sharedState.read();
+            const bool isTorn = double(snapshot.beat) != snapshot.timeMs ||
+                snapshot.currentTimeMs != snapshot.totalTimeMs ||
+                snapshot.timeMs != snapshot.totalTimeMs;
+            const bool isOutOfOrder = snapshot.sequence < lastSequence ||
+                (snapshot.sequence & 1) != 0;
+
+            numInconsistentReads += (isTorn || isOutOfOrder) ? 1 : 0;
+            lastSequence = snapshot.sequence;
+        }
+
+        expectEquals(numInconsistentReads, 0);
+        expectEquals(double(sharedState.read().beat), 99999.0);
+
+        beginTest("Events queue");
+
+        TransportState::Event event;
+        expect(!state.popEvent(event));
+
+        for (uint32 i = 0; i < 100; ++i)
+        {
+            TransportState::Event rewound;
+            rewound.type = TransportState::Event::Type::Rewound;
+            rewound.playbackId = i;
+            state.postEvent(rewound);
+        }
+
+        // the queue drops the overflowing events
+        uint32 numEvents = 0;
+        while (state.popEvent(event))
+        {
+            expectEquals(event.playbackId, numEvents);
+            numEvents++;
+        }
+
+        expect(numEvents > 0 && numEvents < 100);
+    }
+};
+
+static TransportStateTests transportStateTests;
+
+#endif
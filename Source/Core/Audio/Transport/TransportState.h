@@ -0,0 +1,121 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+// The playback position, tempo and flags, as last reported by the player;
+// written by the player thread and by the transport, and read by anyone,
+// including the midi input thread, without taking any locks:
+// the writers make the sequence counter odd while they are changing
+// the values, so that a reader can detect a torn read and just retry;
+// the discrete events (loop rewinds and reaching the end of playback)
+// come through a separate fifo, drained on the message thread
+
+class TransportState final
+{
+public:
+
+    TransportState() = default;
+
+    struct Snapshot final
+    {
+        float beat = 0.f;
+        double timeMs = 0.0; // hi-res timestamp of reaching the beat
+        double msPerQuarterNote = Globals::Defaults::msPerBeat;
+
+        double currentTimeMs = 0.0;
+        double totalTimeMs = 0.0;
+
+        uint32 numRewinds = 0;
+        float lastRewindBeat = 0.f;
+
+        bool isPlaying = false;
+        uint32 sequence = 0;
+
+        // the beat at the given time, extrapolated
+        // since the last known position at the current tempo
+        double getEstimatedBeat(double atTimeMs) const noexcept;
+    };
+
+    Snapshot read() const noexcept;
+
+    void start(float beat, double msPerQuarterNote,
+        double currentTimeMs, double totalTimeMs, double timeMs) noexcept;
+    void stop() noexcept;
+
+    void seek(float beat, double currentTimeMs,
+        double totalTimeMs, double timeMs) noexcept;
+    void rewind(float fromBeat, float toBeat, double timeMs) noexcept;
+    void setTempo(double msPerQuarterNote, double timeMs) noexcept;
+
+    //===------------------------------------------------------------------===//
+    // Discrete events
+    //===------------------------------------------------------------------===//
+
+    struct Event final
+    {
+        enum class Type : int8
+        {
+            Rewound,
+            Finished
+        };
+
+        Type type = Type::Finished;
+
+        // events from the players which have already been stopped are ignored
+        uint32 playbackId = 0;
+
+        float fromBeat = 0.f;
+        float toBeat = 0.f;
+    };
+
+    // returns false if the queue is full, never blocks the reader
+    bool postEvent(const Event &event) noexcept;
+
+    // the message thread is the only reader
+    bool popEvent(Event &outEvent) noexcept;
+
+private:
+
+    void beginWrite() noexcept;
+    void endWrite() noexcept;
+
+    Atomic<uint32> sequence = 0;
+
+    Atomic<float> beat = 0.f;
+    Atomic<double> timeMs = 0.0;
+    Atomic<double> msPerQuarterNote = Globals::Defaults::msPerBeat;
+
+    Atomic<double> currentTimeMs = 0.0;
+    Atomic<double> totalTimeMs = 0.0;
+
+    Atomic<uint32> numRewinds = 0;
+    Atomic<float> lastRewindBeat = 0.f;
+
+    Atomic<bool> isPlaying = false;
+
+    static constexpr auto eventsQueueSize = 64;
+    Event eventsQueue[eventsQueueSize];
+    AbstractFifo eventsQueueFifo { eventsQueueSize };
+
+    // the fifo is single-producer, but the player being stopped
+    // may still post its last event while the next one starts
+    SpinLock eventsQueueWriteLock;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TransportState)
+};
@@ -20,7 +20,7 @@
 
 struct CommandPaletteActionSortByMatch final
 {
-    static int compareElements(const CommandPaletteAction::Ptr first, const CommandPaletteAction::Ptr second)
+    static int compareElements(const CommandPaletteAction *first, const CommandPaletteAction *second)
     {
         // first, descending sort by match:
         const auto matchResult = second->getMatchScore() - first->getMatchScore();
@@ -64,9 +64,22 @@ CommandPaletteAction::CommandPaletteAction(String text, String hint, float order
     hint(move(hint)),
     order(order) {}
 
-void CommandPaletteAction::setMatch(int score, const uint8 *matches)
+void CommandPaletteAction::setMatch(int score, const uint8 *newMatches)
 {
     this->matchScore = score;
+    this->hasMatches = (newMatches != nullptr);
+
+    if (newMatches != nullptr)
+    {
+        memcpy(this->matches, newMatches, CommandPaletteAction::maxMatches);
+    }
+
+    this->glyphsOutdated = true;
+}
+
+void CommandPaletteAction::updateGlyphArrangement() const
+{
+    this->glyphsOutdated = false;
     this->highlightedMatch.clear();
 
     const Font fontNormal(Globals::UI::Fonts::L, Font::plain);
@@ -90,11 +103,12 @@ void CommandPaletteAction::setMatch(int score, const uint8 *matches)
         const auto thisX = xOffsets.getUnchecked(i);
 
         bool isMatchGlyph = false;
-        if (matches != nullptr && matches[nextMatch] == i)
+        if (this->hasMatches &&
+            nextMatch < CommandPaletteAction::maxMatches &&
+            this->matches[nextMatch] == i)
         {
             isMatchGlyph = true;
             nextMatch++;
-            jassert(nextMatch < 32);
         }
 
         const bool isWhitespace = t.isWhitespace();
@@ -111,8 +125,13 @@ int CommandPaletteAction::getMatchScore() const noexcept
     return this->matchScore;
 }
 
-const GlyphArrangement &CommandPaletteAction::getGlyphArrangement() const noexcept
+const GlyphArrangement &CommandPaletteAction::getGlyphArrangement() const
 {
+    if (this->glyphsOutdated)
+    {
+        this->updateGlyphArrangement();
+    }
+
     return this->highlightedMatch;
 }
 
@@ -153,7 +172,7 @@ bool CommandPaletteAction::isUnfiltered() const noexcept
 // https://www.forrestthewoods.com/blog/reverse_engineering_sublime_texts_fuzzy_match
 
 // Original code had a limit of 256, but I really expect it to be way lower:
-#define FUZZY_MAX_MATCHES (32)
+#define FUZZY_MAX_MATCHES (CommandPaletteAction::maxMatches)
 #define FUZZY_MAX_RECURSION (8)
 
 static bool fuzzyMatch(String::CharPointerType pattern, String::CharPointerType str,
@@ -166,47 +185,162 @@ static bool fuzzyMatch(String::CharPointerType pattern, String::CharPointerType
     return fuzzyMatch(pattern, str, outScore, str, nullptr, matches, 0, recursionCount);
 }
 
-void CommandPaletteActionsProvider::updateFilter(const String &pattern, bool skipPrefix)
+// marks the matched actions in a given range, and updates their match scores
+static void fuzzyMatchActions(String::CharPointerType pattern,
+    const CommandPaletteActionsProvider::Actions &actions, Range<int> range, bool *outMatched)
 {
-    this->filteredActions.clearQuick();
+    for (int i = range.getStart(); i < range.getEnd(); ++i)
+    {
+        auto *action = actions.getObjectPointerUnchecked(i);
+        if (action->isUnfiltered())
+        {
+            outMatched[i] = true;
+            continue;
+        }
+
+        int outScore = 0;
+        uint8 matches[FUZZY_MAX_MATCHES] = {};
+        outMatched[i] = fuzzyMatch(pattern, action->getName().getCharPointer(), outScore, matches);
+        if (outMatched[i])
+        {
+            action->setMatch(outScore, matches);
+        }
+    }
+}
+
+struct FuzzyMatchActionsJob final : public ThreadPoolJob
+{
+    FuzzyMatchActionsJob(String::CharPointerType pattern,
+        const CommandPaletteActionsProvider::Actions &actions, Range<int> range, bool *outMatched) :
+        ThreadPoolJob("Fuzzy match job"), pattern(pattern),
+        actions(actions), range(range), outMatched(outMatched) {}
+
+    JobStatus runJob() override
+    {
+        fuzzyMatchActions(this->pattern, this->actions, this->range, this->outMatched);
+        return jobHasFinished;
+    }
+
+    const String::CharPointerType pattern;
+    const CommandPaletteActionsProvider::Actions &actions;
+    const Range<int> range;
+    bool *outMatched;
+};
 
+void CommandPaletteActionsProvider::updateFilter(const String &pattern, bool skipPrefix)
+{
     auto patternPtr = pattern.getCharPointer();
     if (skipPrefix)
     {
         patternPtr.getAndAdvance();
     }
 
-    const auto updateFilteredListWith = [this, patternPtr](const Actions &actions)
+    // if the search text only grows, anything that matches it
+    // has also matched the previous search text
+    const String searchText(patternPtr);
+    const bool canNarrowDown = this->lastSearchText.isNotEmpty() &&
+        searchText.startsWith(this->lastSearchText) &&
+        this->hasSameActionsAsLastSearch();
+
+    if (!canNarrowDown)
     {
-        for (const auto &action : actions)
+        this->allActions.clearQuick();
+        this->allActions.addArray(this->additionalActions);
+        this->allActions.addArray(this->getActions());
+        this->candidates = this->allActions;
+    }
+
+    this->lastSearchText = searchText;
+
+    Array<bool> matched;
+    matched.insertMultiple(0, false, this->candidates.size());
+
+    if (this->candidates.size() < minActionsToMatchInParallel)
+    {
+        fuzzyMatchActions(patternPtr, this->candidates,
+            { 0, this->candidates.size() }, matched.getRawDataPointer());
+    }
+    else
+    {
+        const auto numJobs = SystemStats::getNumCpus();
+        const auto jobSize = this->candidates.size() / numJobs + 1;
+
+        // created once, so that the threads are not re-spawned on every keystroke
+        if (this->matchingPool == nullptr)
         {
-            if (action->isUnfiltered())
-            {
-                this->filteredActions.add(action);
-            }
-            else
-            {
-                int outScore = 0;
-                uint8 matches[FUZZY_MAX_MATCHES] = {};
-                const auto match = fuzzyMatch(patternPtr, action->getName().getCharPointer(), outScore, matches);
-                if (match)
-                {
-                    action->setMatch(outScore, matches);
-                    this->filteredActions.add(action);
-                }
-            }
+            this->matchingPool = make<ThreadPool>(numJobs);
         }
-    };
 
-    updateFilteredListWith(this->additionalActions);
-    updateFilteredListWith(this->getActions());
+        OwnedArray<FuzzyMatchActionsJob> jobs;
 
-    static CommandPaletteActionSortByMatch comparator;
-    this->filteredActions.sort(comparator);
+        for (int start = 0; start < this->candidates.size(); start += jobSize)
+        {
+            const Range<int> range(start, jmin(start + jobSize, this->candidates.size()));
+            auto *job = jobs.add(new FuzzyMatchActionsJob(patternPtr,
+                this->candidates, range, matched.getRawDataPointer()));
+            this->matchingPool->addJob(job, false);
+        }
+
+        for (auto *job : jobs)
+        {
+            this->matchingPool->waitForJobToFinish(job, -1);
+        }
+    }
+
+    Actions unfilteredActions;
+    Actions newCandidates;
+    this->filteredActions.clearQuick();
+
+    for (int i = 0; i < this->candidates.size(); ++i)
+    {
+        if (!matched.getUnchecked(i))
+        {
+            continue;
+        }
+
+        auto *action = this->candidates.getObjectPointerUnchecked(i);
+        newCandidates.add(action);
+
+        if (action->isUnfiltered())
+        {
+            unfilteredActions.add(action);
+        }
+        else
+        {
+            this->filteredActions.add(action);
+        }
+    }
+
+    this->candidates.swapWith(newCandidates);
+
+    // no need to sort all the matches, since only the best ones are listed
+    const auto numBestMatches = jmin(maxFilteredActions, this->filteredActions.size());
+    std::partial_sort(this->filteredActions.begin(),
+        this->filteredActions.begin() + numBestMatches,
+        this->filteredActions.end(),
+        [](const CommandPaletteAction *a, const CommandPaletteAction *b)
+        {
+            return CommandPaletteActionSortByMatch::compareElements(a, b) < 0;
+        });
+
+    this->filteredActions.removeRange(numBestMatches,
+        this->filteredActions.size() - numBestMatches);
+
+    // the unfiltered ones are always listed
+    if (!unfilteredActions.isEmpty())
+    {
+        this->filteredActions.addArray(unfilteredActions);
+        static CommandPaletteActionSortByMatch comparator;
+        this->filteredActions.sort(comparator);
+    }
 }
 
 void CommandPaletteActionsProvider::clearFilter()
 {
+    this->candidates.clearQuick();
+    this->allActions.clearQuick();
+    this->lastSearchText.clear();
+
     this->filteredActions.clearQuick();
     this->filteredActions.addArray(this->additionalActions);
     this->filteredActions.addArray(this->getActions());
@@ -219,6 +353,34 @@ void CommandPaletteActionsProvider::clearFilter()
     this->filteredActions.sort(comparator);
 }
 
+bool CommandPaletteActionsProvider::hasSameActionsAsLastSearch() const
+{
+    const auto &actions = this->getActions();
+    if (this->allActions.size() != this->additionalActions.size() + actions.size())
+    {
+        return false;
+    }
+
+    int i = 0;
+    for (const auto *action : this->additionalActions)
+    {
+        if (action != this->allActions.getObjectPointerUnchecked(i++))
+        {
+            return false;
+        }
+    }
+
+    for (const auto *action : actions)
+    {
+        if (action != this->allActions.getObjectPointerUnchecked(i++))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 static bool fuzzyMatch(String::CharPointerType pattern, String::CharPointerType str, int &outScore,
     String::CharPointerType strBegin, uint8 const *srcMatches, uint8 *matches, int nextMatch, int &recursionCount)
 {
@@ -374,3 +536,80 @@ static bool fuzzyMatch(String::CharPointerType pattern, String::CharPointerType
         return false;
     }
 }
+
+#if JUCE_UNIT_TESTS
+
+class CommandPaletteFilterTests final : public UnitTest
+{
+public:
+    CommandPaletteFilterTests() : UnitTest("Command palette filter tests", UnitTestCategories::helio) {}
+
+    struct TestActionsProvider final : public CommandPaletteActionsProvider
+    {
+        const Actions &getActions() const override { return this->actions; }
+        Actions actions;
+    };
+
+    void runTest() override
+    {
+        const StringArray words("Create", "Delete", "Move", "Note", "Track",
+            "Clip", "Key", "Time", "Signature", "Annotation");
+
+        Random random(1);
+        TestActionsProvider incremental;
+        TestActionsProvider direct;
+
+        // enough to be matched in parallel
+        for (int i = 0; i < CommandPaletteActionsProvider::minActionsToMatchInParallel * 2; ++i)
+        {
+            const auto name = words[random.nextInt(words.size())] + " " +
+                words[random.nextInt(words.size())] + " " + String(i);
+
+            auto action = CommandPaletteAction::action(name, {}, float(i));
+            incremental.actions.add(action);
+            direct.actions.add(action);
+        }
+
+        beginTest("Incremental filtering gives the same results as the full one");
+        {
+            incremental.updateFilter("c", false);
+            incremental.updateFilter("cl", false);
+            incremental.updateFilter("clip", false);
+            incremental.updateFilter("clip n", false);
+            direct.updateFilter("clip n", false);
+
+            const auto &results = incremental.getFilteredActions();
+            expectEquals(results.size(), CommandPaletteActionsProvider::maxFilteredActions);
+            expectEquals(results.size(), direct.getFilteredActions().size());
+
+            for (int i = 0; i < results.size(); ++i)
+            {
+                expect(results[i] == direct.getFilteredActions()[i]);
+
+                if (i > 0)
+                {
+                    expect(results[i - 1]->getMatchScore() >= results[i]->getMatchScore());
+                }
+            }
+        }
+
+        beginTest("Filtering starts over when actions change");
+        {
+            incremental.updateFilter("zzz", false);
+            expect(incremental.getFilteredActions().isEmpty());
+
+            incremental.actions.add(CommandPaletteAction::action("Zzz", {}, 0.f));
+            incremental.actions.add(CommandPaletteAction::action("Always", {}, 0.f)->unfiltered());
+            incremental.updateFilter("zzzz", false);
+            expectEquals(incremental.getFilteredActions().size(), 1);
+
+            incremental.updateFilter("zzz", false);
+            expectEquals(incremental.getFilteredActions().size(), 2);
+            expectEquals(incremental.getFilteredActions().getFirst()->getName(), String("Zzz"));
+        }
+    }
+};
+
+static CommandPaletteFilterTests commandPaletteFilterTests;
+
+#endif
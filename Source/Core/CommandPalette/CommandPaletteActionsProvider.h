@@ -35,10 +35,15 @@ public:
     Callback getCallback() const noexcept;
     bool isUnfiltered() const noexcept;
 
+    // only stores the matched character indices, so it's cheap,
+    // and it is safe to call for different actions in parallel;
+    // the glyphs are laid out when the action is first displayed
     void setMatch(int score, const uint8 *matches);
     int getMatchScore() const noexcept;
     float getOrder() const noexcept;
-    const GlyphArrangement &getGlyphArrangement() const noexcept;
+    const GlyphArrangement &getGlyphArrangement() const;
+
+    static constexpr auto maxMatches = 32;
 
 private:
 
@@ -54,8 +59,13 @@ private:
     bool shouldClosePalette = true;
     bool required = false;
 
-    GlyphArrangement highlightedMatch;
     int matchScore = 0;
+    bool hasMatches = false;
+    uint8 matches[maxMatches] = {};
+
+    void updateGlyphArrangement() const;
+    mutable GlyphArrangement highlightedMatch;
+    mutable bool glyphsOutdated = true;
 
     // actions will be sorted by match, as user is entering the search text,
     // but we may also need ordering for the full list or items with the same match;
@@ -100,6 +110,12 @@ public:
         this->additionalActions.swapWith(actions);
     }
 
+    // only the best matches are listed
+    static constexpr auto maxFilteredActions = 100;
+
+    // the sets larger than this are matched in parallel
+    static constexpr auto minActionsToMatchInParallel = 4096;
+
 protected:
 
     // each provider sets up its own actions:
@@ -114,9 +130,22 @@ private:
     const Prefix prefix = 0;
     const float priority = 0.f;
 
-    // all actions after applying a fuzzy search:
+    // the best matching actions after applying a fuzzy search:
     Actions filteredActions;
 
+    // all actions matching the last search text, and all actions
+    // at the time of the last full search: while the user keeps typing,
+    // only the previous matches need to be matched again,
+    // unless the actions themselves have changed meanwhile
+    Actions candidates;
+    Actions allActions;
+    String lastSearchText;
+
+    bool hasSameActionsAsLastSearch() const;
+
+    // only used for the large sets of actions, see minActionsToMatchInParallel
+    UniquePointer<ThreadPool> matchingPool;
+
     JUCE_DECLARE_WEAK_REFERENCEABLE(CommandPaletteActionsProvider)
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CommandPaletteActionsProvider)
 };
@@ -21,6 +21,21 @@
 #include "XmlSerializer.h"
 #include "SerializationKeys.h"
 
+struct ResourceLoadingJob final : public ThreadPoolJob
+{
+    explicit ResourceLoadingJob(ConfigurationResourceCollection &collection) :
+        ThreadPoolJob("Resource loading job"), collection(collection) {}
+
+    JobStatus runJob() override
+    {
+        this->hasLoadedAnything = this->collection.loadResources();
+        return jobHasFinished;
+    }
+
+    ConfigurationResourceCollection &collection;
+    bool hasLoadedAnything = false;
+};
+
 Config::Config(int timeoutToSaveMs) :
     fileLock("Config Lock"),
     saveTimeout(timeoutToSaveMs),
@@ -83,9 +98,33 @@ void Config::initResources()
         }
     }
 
+    // resource collections don't depend on each other, so they are
+    // loaded in parallel, and then notify listeners on this thread
+    OwnedArray<ResourceLoadingJob> jobs;
+    ThreadPool pool(jlimit(1, int(this->resources.size()), SystemStats::getNumCpus()));
+
+    for (auto &manager : this->resources)
+    {
+        manager.second->prepareToLoadResources();
+    }
+
     for (auto &manager : this->resources)
     {
-        manager.second->reloadResources();
+        auto *job = jobs.add(new ResourceLoadingJob(*manager.second));
+        pool.addJob(job, false);
+    }
+
+    for (auto *job : jobs)
+    {
+        pool.waitForJobToFinish(job, -1);
+    }
+
+    for (auto *job : jobs)
+    {
+        if (job->hasLoadedAnything)
+        {
+            job->collection.sendChangeMessage();
+        }
     }
 
     this->load(this->uiFlags.get(), Serialization::Config::activeUiFlags);
@@ -263,3 +302,61 @@ UserInterfaceFlags *Config::getUiFlags() const noexcept
 {
     return this->uiFlags.get();
 }
+
+//===----------------------------------------------------------------------===//
+// Tests
+//===----------------------------------------------------------------------===//
+
+#if JUCE_UNIT_TESTS
+
+class ConfigTests final : public UnitTest
+{
+public:
+    ConfigTests() : UnitTest("Config tests", UnitTestCategories::helio) {}
+
+    void runTest() override
+    {
+        beginTest("Resources loaded in parallel are the same as loaded one by one");
+        {
+            Config parallelConfig;
+            parallelConfig.initResources();
+
+            Config sequentialConfig;
+            for (auto &it : sequentialConfig.getAllResources())
+            {
+                it.second->reloadResources();
+            }
+
+            for (auto &it : parallelConfig.getAllResources())
+            {
+                const auto parallelResources = it.second->getAllResources();
+                const auto sequentialResources =
+                    sequentialConfig.getAllResources()[it.first]->getAllResources();
+
+                expect(!it.second->isEmpty());
+                expectEquals(parallelResources.size(), sequentialResources.size());
+
+                for (int i = 0; i < jmin(parallelResources.size(), sequentialResources.size()); ++i)
+                {
+                    expectEquals(parallelResources[i]->getResourceId(),
+                        sequentialResources[i]->getResourceId());
+                }
+            }
+
+            // the locale is picked on this thread, before loading
+            const auto parallelTranslation = parallelConfig.getTranslations()->getCurrent();
+            const auto sequentialTranslation = sequentialConfig.getTranslations()->getCurrent();
+            expect(parallelTranslation != nullptr);
+            expect(sequentialTranslation != nullptr);
+            if (parallelTranslation != nullptr && sequentialTranslation != nullptr)
+            {
+                expectEquals(parallelTranslation->getId(), sequentialTranslation->getId());
+                expectEquals(parallelTranslation->getId(), App::Config().getTranslations()->getCurrent()->getId());
+            }
+        }
+    }
+};
+
+static ConfigTests configTests;
+
+#endif
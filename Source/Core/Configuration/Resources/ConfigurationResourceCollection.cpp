@@ -20,6 +20,7 @@
 #include "JsonSerializer.h"
 #include "BinarySerializer.h"
 #include "DocumentHelpers.h"
+#include "SerializationKeys.h"
 
 // TODO: monitor user's file changes?
 
@@ -69,6 +70,12 @@ File ConfigurationResourceCollection::getDownloadedResourceFile() const
     return DocumentHelpers::getConfigSlot(assumedFileName);
 }
 
+File ConfigurationResourceCollection::getCachedResourceFile() const
+{
+    const String assumedFileName = this->resourceType + ".cache";
+    return DocumentHelpers::getConfigSlot(assumedFileName);
+}
+
 File ConfigurationResourceCollection::getUsersResourceFile() const
 {
     const String assumedFileName = this->resourceType + ".json";
@@ -113,7 +120,16 @@ void ConfigurationResourceCollection::reset()
 
 void ConfigurationResourceCollection::reloadResources()
 {
-    bool shouldBroadcastChange = false;
+    this->prepareToLoadResources();
+    if (this->loadResources())
+    {
+        this->sendChangeMessage();
+    }
+}
+
+bool ConfigurationResourceCollection::loadResources()
+{
+    bool hasLoadedAnything = false;
 
     // Reset and store an empty tree to append user objects to
     this->baseResources.clear();
@@ -123,62 +139,97 @@ void ConfigurationResourceCollection::reloadResources()
     // downloaded extends and overrides built-in one,
     // user's config extends and overrides the previous step
 
-#if DEBUG
-    auto startTime = Time::getMillisecondCounter();
-#endif
+    for (const auto &tree : this->loadBaseResourceTrees())
+    {
+        this->deserializeResources(tree, this->baseResources);
+        hasLoadedAnything = true;
+    }
 
-    const String builtInResource(this->getBuiltInResourceString());
-    if (builtInResource.isNotEmpty())
+    // Try to extend base config with user's settings
+    const File usersResource(this->getUsersResourceFile());
+
+    if (usersResource.existsAsFile())
     {
-        const auto tree(DocumentHelpers::load(builtInResource));
+        const auto tree(DocumentHelpers::load(usersResource));
         if (tree.isValid())
         {
-            this->deserializeResources(tree, this->baseResources);
-            shouldBroadcastChange = true;
+            this->deserializeResources(tree, this->userResources);
+            hasLoadedAnything = true;
         }
-
-        DBG("Loaded built-in " + this->resourceType.toString() + " in " + String(Time::getMillisecondCounter() - startTime) + " ms");
     }
 
-#if DEBUG
-    startTime = Time::getMillisecondCounter();
-#endif
+    return hasLoadedAnything;
+}
 
-    // Try to extend built-in config with downloaded one
+Array<SerializedData> ConfigurationResourceCollection::loadBaseResourceTrees() const
+{
+    const String builtInResource(this->getBuiltInResourceString());
     const File downloadedResource(this->getDownloadedResourceFile());
+
+    // the cache key changes whenever any of the sources does:
+    // the built-in resource is hashed, since it is in memory anyway,
+    // and for the downloaded file, its size and timestamp are enough
+    String cacheKey = String(ConfigurationResourceCollection::cacheVersion) + ":" +
+        String::toHexString(builtInResource.hashCode64());
+
     if (downloadedResource.existsAsFile())
     {
-        const auto tree(DocumentHelpers::load(downloadedResource));
-        if (tree.isValid())
+        cacheKey << ":" << String(downloadedResource.getSize()) <<
+            ":" << String(downloadedResource.getLastModificationTime().toMilliseconds());
+    }
+
+    Array<SerializedData> result;
+
+    const File cacheFile(this->getCachedResourceFile());
+    if (cacheFile.existsAsFile())
+    {
+        const auto cache(DocumentHelpers::load<BinarySerializer>(cacheFile));
+        if (cache.hasType(Serialization::Resources::cache) &&
+            cache.getProperty(Serialization::Resources::cacheKey).toString() == cacheKey)
         {
-            this->deserializeResources(tree, this->baseResources);
-            shouldBroadcastChange = true;
-        }
+            for (int i = 0; i < cache.getNumChildren(); ++i)
+            {
+                result.add(cache.getChild(i));
+            }
 
-        DBG("Loaded extended " + this->resourceType.toString() + " in " + String(Time::getMillisecondCounter() - startTime) + " ms");
+            return result;
+        }
     }
 
-#if DEBUG
-    startTime = Time::getMillisecondCounter();
-#endif
-
-    // Try to extend base config with user's settings
-    const File usersResource(this->getUsersResourceFile());
+    if (builtInResource.isNotEmpty())
+    {
+        const auto tree(DocumentHelpers::load(builtInResource));
+        if (tree.isValid())
+        {
+            result.add(tree);
+        }
+    }
 
-    if (usersResource.existsAsFile())
+    // Try to extend built-in config with downloaded one
+    if (downloadedResource.existsAsFile())
     {
-        const auto tree(DocumentHelpers::load(usersResource));
+        const auto tree(DocumentHelpers::load(downloadedResource));
         if (tree.isValid())
         {
-            this->deserializeResources(tree, this->userResources);
-            shouldBroadcastChange = true;
+            result.add(tree);
         }
+    }
 
-        DBG("Loaded user's " + this->resourceType.toString() + " in " + String(Time::getMillisecondCounter() - startTime) + " ms");
+    if (result.isEmpty())
+    {
+        return result;
     }
 
-    if (shouldBroadcastChange)
+    SerializedData cache(Serialization::Resources::cache);
+    cache.setProperty(Serialization::Resources::cacheKey, cacheKey);
+
+    for (const auto &tree : result)
     {
-        this->sendChangeMessage();
+        cache.appendChild(tree);
     }
+
+    BinarySerializer serializer;
+    serializer.saveToFile(cacheFile, cache);
+
+    return result;
 }
@@ -28,6 +28,15 @@ public:
 
     void reloadResources();
 
+    // loads everything without sending change messages, so that
+    // collections can be loaded in parallel at startup; returns
+    // true if any resources were loaded, which needs broadcasting
+    bool loadResources();
+
+    // called on the message thread before loadResources(), which may
+    // run on a worker thread, to pick up any app-wide settings it needs
+    virtual void prepareToLoadResources() {}
+
     inline bool isEmpty() const noexcept
     {
         return this->baseResources.size() == 0 && this->userResources.size() == 0;
@@ -116,6 +125,7 @@ protected:
 
     virtual File getDownloadedResourceFile() const;
     virtual File getUsersResourceFile() const;
+    virtual File getCachedResourceFile() const;
     virtual String getBuiltInResourceString() const;
     virtual const ConfigurationResource &getResourceComparator() const;
 
@@ -130,6 +140,14 @@ protected:
 
 private: 
 
+    // returns the parsed built-in and downloaded resource trees,
+    // either from the binary cache, if it is up to date, or by
+    // parsing the sources and then updating the cache
+    Array<SerializedData> loadBaseResourceTrees() const;
+
+    // bump this to invalidate all caches
+    static constexpr auto cacheVersion = 1;
+
     const Identifier resourceType;
     const DummyConfigurationResource comparator;
 
@@ -59,6 +59,23 @@ void Translation::deserialize(const SerializedData &data)
         Translations::wrapperMethodName + "(" +
         root.getProperty(Translations::pluralEquation, "1").toString() + ")";
 
+    this->dataToParse.add(root);
+}
+
+void Translation::parseIfNeeded()
+{
+    for (const auto &root : this->dataToParse)
+    {
+        this->parse(root);
+    }
+
+    this->dataToParse.clearQuick();
+}
+
+void Translation::parse(const SerializedData &root)
+{
+    using namespace Serialization;
+
     forEachChildWithType(root, pluralLiteral, Translations::pluralLiteral)
     {
         I18n::Key literalKey = I18n::Key(int64(pluralLiteral.getProperty(Translations::translationId)));
@@ -151,6 +168,7 @@ void Translation::reset()
 {
     this->singulars.clear();
     this->plurals.clear();
+    this->dataToParse.clearQuick();
 }
 
 //===----------------------------------------------------------------------===//
@@ -49,6 +49,13 @@ private:
     String name;
     String pluralEquation;
 
+    // only one or two translations out of many are actually used,
+    // so deserialize() just keeps the data, and the literals
+    // are parsed when the translation is about to be used
+    Array<SerializedData> dataToParse;
+    void parseIfNeeded();
+    void parse(const SerializedData &root);
+
     using SingularsMap = FlatHashMap<I18n::Key, String>;
     SingularsMap singulars;
 
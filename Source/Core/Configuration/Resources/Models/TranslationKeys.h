@@ -278,6 +278,14 @@ namespace I18n
         static constexpr auto audioDevice = constexprHash("settings::audio::device");
         static constexpr auto audioDriver = constexprHash("settings::audio::driver");
         static constexpr auto audioSampleRate = constexprHash("settings::audio::samplerate");
+        static constexpr auto audioLoad = constexprHash("settings::audio::load");
+        static constexpr auto audioLoadDevice = constexprHash("settings::audio::load::device");
+        static constexpr auto audioLoadXruns = constexprHash("settings::audio::load::xruns");
+        static constexpr auto audioLoadAverage = constexprHash("settings::audio::load::average");
+        static constexpr auto audioLoadPeak = constexprHash("settings::audio::load::peak");
+        static constexpr auto audioLoadOverruns = constexprHash("settings::audio::load::overruns");
+        static constexpr auto audioLoadDroppedMidi = constexprHash("settings::audio::load::droppedmidi");
+        static constexpr auto audioLoadSaveReport = constexprHash("settings::audio::load::save");
         static constexpr auto midiRecord = constexprHash("settings::midi::record");
         static constexpr auto midiOutput = constexprHash("settings::midi::output");
         static constexpr auto midiOutputNone = constexprHash("settings::midi::output::none");
@@ -84,7 +84,14 @@ void TranslationsCollection::loadLocaleWithId(const String &localeId)
 
     if (const auto translation = this->getResourceById<Translation>(localeId))
     {
-        this->currentTranslation = translation;
+        translation->parseIfNeeded();
+
+        {
+            const SpinLock::ScopedLockType sl(this->currentTranslationLock);
+            this->currentTranslation = translation;
+        }
+
+        this->configuredLocaleId = localeId;
         App::Config().setProperty(Serialization::Config::currentLocale, localeId);
         this->sendChangeMessage();
     }
@@ -160,6 +167,12 @@ String TranslationsCollection::translate(const String &baseLiteral, int64 target
 
 const static String fallbackTranslationId = "en";
 
+void TranslationsCollection::prepareToLoadResources()
+{
+    this->configuredLocaleId = App::Config().containsProperty(Serialization::Config::currentLocale) ?
+        App::Config().getProperty(Serialization::Config::currentLocale, fallbackTranslationId).toString() : String();
+}
+
 void TranslationsCollection::deserializeResources(const SerializedData &tree, Resources &outResources)
 {
     const auto root = tree.hasType(Serialization::Resources::translations) ?
@@ -202,6 +215,17 @@ void TranslationsCollection::deserializeResources(const SerializedData &tree, Re
 
     jassert(this->currentTranslation != nullptr);
     jassert(this->fallbackTranslation != nullptr);
+
+    // all other translations will be parsed on demand
+    if (this->currentTranslation != nullptr)
+    {
+        this->currentTranslation->parseIfNeeded();
+    }
+
+    if (this->fallbackTranslation != nullptr)
+    {
+        this->fallbackTranslation->parseIfNeeded();
+    }
 }
 
 void TranslationsCollection::reset()
@@ -218,9 +242,9 @@ void TranslationsCollection::reset()
 
 String TranslationsCollection::getSelectedLocaleId() const
 {
-    if (App::Config().containsProperty(Serialization::Config::currentLocale))
+    if (this->configuredLocaleId.isNotEmpty())
     {
-        return App::Config().getProperty(Serialization::Config::currentLocale, fallbackTranslationId);
+        return this->configuredLocaleId;
     }
     
     const String systemLocale =
@@ -51,6 +51,7 @@ public:
     
 private:
 
+    void prepareToLoadResources() override;
     void deserializeResources(const SerializedData &tree, Resources &outResources) override;
     void reset() override;
 
@@ -61,6 +62,10 @@ private:
     Translation::Ptr currentTranslation;
     Translation::Ptr fallbackTranslation;
 
+    // the locale set in the config, resolved on the message thread,
+    // since the resources themselves may be loaded on a worker thread
+    String configuredLocaleId;
+
     String getSelectedLocaleId() const;
     friend struct PluralEquationWrapper;
 
@@ -0,0 +1,193 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Common.h"
+#include "BeatRangeTree.h"
+
+void BeatRangeTree::set(const MidiTrack *track, float firstBeat, float lastBeat)
+{
+    auto found = this->slots.find(track);
+    if (found == this->slots.end())
+    {
+        const auto newSlot = int(this->slots.size());
+        if (newSlot >= this->capacity)
+        {
+            this->grow();
+        }
+
+        found = this->slots.emplace(track, newSlot).first;
+    }
+
+    const auto index = this->capacity + found->second;
+    if (this->firstBeats.getUnchecked(index) == firstBeat &&
+        this->lastBeats.getUnchecked(index) == lastBeat)
+    {
+        return;
+    }
+
+    this->firstBeats.set(index, firstBeat);
+    this->lastBeats.set(index, lastBeat);
+    this->updateParents(index);
+}
+
+void BeatRangeTree::clear()
+{
+    this->slots.clear();
+    this->firstBeats.fill(FLT_MAX);
+    this->lastBeats.fill(-FLT_MAX);
+}
+
+float BeatRangeTree::getFirstBeat() const noexcept
+{
+    return this->capacity > 0 ? this->firstBeats.getUnchecked(1) : FLT_MAX;
+}
+
+float BeatRangeTree::getLastBeat() const noexcept
+{
+    return this->capacity > 0 ? this->lastBeats.getUnchecked(1) : -FLT_MAX;
+}
+
+void BeatRangeTree::grow()
+{
+    const auto newCapacity = jmax(8, this->capacity * 2);
+
+    Array<float> newFirstBeats;
+    Array<float> newLastBeats;
+    newFirstBeats.insertMultiple(0, FLT_MAX, newCapacity * 2);
+    newLastBeats.insertMultiple(0, -FLT_MAX, newCapacity * 2);
+
+    for (int i = 0; i < this->capacity; ++i)
+    {
+        newFirstBeats.set(newCapacity + i, this->firstBeats.getUnchecked(this->capacity + i));
+        newLastBeats.set(newCapacity + i, this->lastBeats.getUnchecked(this->capacity + i));
+    }
+
+    for (int i = newCapacity - 1; i > 0; --i)
+    {
+        newFirstBeats.set(i, jmin(newFirstBeats.getUnchecked(i * 2),
+            newFirstBeats.getUnchecked(i * 2 + 1)));
+        newLastBeats.set(i, jmax(newLastBeats.getUnchecked(i * 2),
+            newLastBeats.getUnchecked(i * 2 + 1)));
+    }
+
+    this->firstBeats.swapWith(newFirstBeats);
+    this->lastBeats.swapWith(newLastBeats);
+    this->capacity = newCapacity;
+}
+
+void BeatRangeTree::updateParents(int index) noexcept
+{
+    for (int i = index / 2; i > 0; i /= 2)
+    {
+        const auto first = jmin(this->firstBeats.getUnchecked(i * 2),
+            this->firstBeats.getUnchecked(i * 2 + 1));
+        const auto last = jmax(this->lastBeats.getUnchecked(i * 2),
+            this->lastBeats.getUnchecked(i * 2 + 1));
+
+        if (this->firstBeats.getUnchecked(i) == first &&
+            this->lastBeats.getUnchecked(i) == last)
+        {
+            return; // the ones above won't change either
+        }
+
+        this->firstBeats.set(i, first);
+        this->lastBeats.set(i, last);
+    }
+}
+
+//===----------------------------------------------------------------------===//
+// Tests
+//===----------------------------------------------------------------------===//
+
+#if JUCE_UNIT_TESTS
+
+class BeatRangeTreeTests final : public UnitTest
+{
+public:
+
+    BeatRangeTreeTests() : UnitTest("Beat range tree tests", UnitTestCategories::helio) {}
+
+    void runTest() override
+    {
+        BeatRangeTree tree;
+        expectEquals(tree.getFirstBeat(), FLT_MAX);
+        expectEquals(tree.getLastBeat(), -FLT_MAX);
+
+        // the keys are never dereferenced, so fake pointers will do
+        const auto track = [](int i) { return reinterpret_cast<const MidiTrack *>(size_t(i + 1) * 16); };
+
+        beginTest("Ranges are aggregated across many tracks");
+
+        Random random(123);
+        Array<Range<float>> ranges;
+        for (int i = 0; i < 100; ++i)
+        {
+            const auto start = float(random.nextInt(1000)) - 100.f;
+            ranges.add({ start, start + float(random.nextInt(100)) });
+            tree.set(track(i), ranges.getLast().getStart(), ranges.getLast().getEnd());
+        }
+
+        const auto expectAggregates = [this, &ranges, &tree]()
+        {
+            float first = FLT_MAX;
+            float last = -FLT_MAX;
+            for (const auto &range : ranges)
+            {
+                first = jmin(first, range.getStart());
+                last = jmax(last, range.getEnd());
+            }
+
+            expectEquals(tree.getFirstBeat(), first);
+            expectEquals(tree.getLastBeat(), last);
+        };
+
+        expectAggregates();
+
+        beginTest("Changing one track updates the aggregates");
+
+        for (int i = 0; i < 1000; ++i)
+        {
+            const auto index = random.nextInt(ranges.size());
+            const auto start = float(random.nextInt(2000)) - 500.f;
+            ranges.set(index, { start, start + float(random.nextInt(100)) });
+            tree.set(track(index), ranges[index].getStart(), ranges[index].getEnd());
+            expectAggregates();
+        }
+
+        beginTest("Empty tracks don't affect the aggregates");
+
+        for (int i = 0; i < ranges.size(); ++i)
+        {
+            tree.set(track(i), FLT_MAX, -FLT_MAX);
+        }
+
+        expectEquals(tree.getFirstBeat(), FLT_MAX);
+        expectEquals(tree.getLastBeat(), -FLT_MAX);
+
+        tree.set(track(5), 1.f, 2.f);
+        expectEquals(tree.getFirstBeat(), 1.f);
+        expectEquals(tree.getLastBeat(), 2.f);
+
+        tree.clear();
+        expectEquals(tree.getFirstBeat(), FLT_MAX);
+        expectEquals(tree.getLastBeat(), -FLT_MAX);
+    }
+};
+
+static BeatRangeTreeTests beatRangeTreeTests;
+
+#endif
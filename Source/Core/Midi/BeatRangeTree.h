@@ -0,0 +1,58 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+class MidiTrack;
+
+// Keeps the beat ranges of all tracks in the leaves of a segment tree,
+// where each inner node holds the min first beat and the max last beat
+// of its children, so that when a single track's range changes,
+// the project range is updated in O(log n) instead of querying
+// all the sequences and patterns of the project again
+
+class BeatRangeTree final
+{
+public:
+
+    BeatRangeTree() = default;
+
+    // the tracks which don't affect the range, e.g. the empty ones,
+    // are expected to be set to { FLT_MAX, -FLT_MAX }
+    void set(const MidiTrack *track, float firstBeat, float lastBeat);
+    void clear();
+
+    // FLT_MAX and -FLT_MAX, if there are no non-empty tracks
+    float getFirstBeat() const noexcept;
+    float getLastBeat() const noexcept;
+
+private:
+
+    // track pointers are only used as keys here, and never dereferenced
+    FlatHashMap<const MidiTrack *, int> slots;
+
+    // the root is at index 1, the children of node i are at 2i and 2i + 1,
+    // and the leaves for the slots start at the index of capacity
+    Array<float> firstBeats;
+    Array<float> lastBeats;
+    int capacity = 0;
+
+    void grow();
+    void updateParents(int index) noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BeatRangeTree)
+};
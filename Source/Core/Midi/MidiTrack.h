@@ -119,6 +119,10 @@ public:
     {
         sustainPedalController = 64,
         tempoController = 81,
+        // not the real controllers: the messages of these types
+        // are stored in automation tracks as pseudo controller numbers
+        pitchWheelController = 128,
+        channelPressureController = 129,
     };
 
     bool isTempoTrack() const noexcept;
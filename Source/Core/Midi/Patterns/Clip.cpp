@@ -266,6 +266,14 @@ int Clip::compareElements(const Clip *const first, const Clip *const second)
     return Clip::compareElements(*first, *second);
 }
 
+bool Clip::hasSameContentAs(const Clip &other) const noexcept
+{
+    return this->key == other.key &&
+        this->velocity == other.velocity &&
+        this->mute == other.mute &&
+        this->solo == other.solo;
+}
+
 void Clip::applyChanges(const Clip &other)
 {
     jassert(this->id == other.id);
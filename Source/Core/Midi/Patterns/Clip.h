@@ -96,6 +96,10 @@ public:
 
     void applyChanges(const Clip &parameters);
 
+    // true if both clips export the same events, only shifted in time,
+    // so that the exported sequence can be shared between them
+    bool hasSameContentAs(const Clip &other) const noexcept;
+
 private:
 
     WeakReference<Pattern> pattern;
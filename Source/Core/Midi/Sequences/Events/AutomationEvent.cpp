@@ -60,19 +60,29 @@ float AutomationEvent::interpolateEvents(float cv1, float cv2, float factor, flo
 void AutomationEvent::exportMessages(MidiMessageSequence &outSequence,
     const Clip &clip, const KeyboardMapping &keyMap, double timeFactor) const noexcept
 {
-    MidiMessage cc;
     const bool isTempoTrack = this->getSequence()->getTrack()->isTempoTrack();
+    const auto controllerNumber = this->getTrackControllerNumber();
+    const auto channel = this->getTrackChannel();
 
-    if (isTempoTrack)
+    const auto createMessage = [isTempoTrack, controllerNumber, channel](float value)
     {
-        cc = MidiMessage::tempoMetaEvent(Transport::getTempoByControllerValue(this->controllerValue));
-    }
-    else
-    {
-        cc = MidiMessage::controllerEvent(this->getTrackChannel(),
-            this->getTrackControllerNumber(), int(this->controllerValue * 127));
-    }
+        if (isTempoTrack)
+        {
+            return MidiMessage::tempoMetaEvent(Transport::getTempoByControllerValue(value));
+        }
+        else if (controllerNumber == MidiTrack::pitchWheelController)
+        {
+            return MidiMessage::pitchWheel(channel, int(value * 16383));
+        }
+        else if (controllerNumber == MidiTrack::channelPressureController)
+        {
+            return MidiMessage::channelPressureChange(channel, int(value * 127));
+        }
+
+        return MidiMessage::controllerEvent(channel, controllerNumber, int(value * 127));
+    };
 
+    MidiMessage cc(createMessage(this->controllerValue));
     const double startTime = (this->beat + clip.getBeat()) * timeFactor;
     cc.setTimeStamp(startTime);
     outSequence.addEvent(cc);
@@ -98,19 +108,9 @@ void AutomationEvent::exportMessages(MidiMessageSequence &outSequence,
             if (controllerDelta > AutomationEvent::curveInterpolationThreshold)
             {
                 const double interpolatedTs = (interpolatedBeat + clip.getBeat()) * timeFactor;
-                if (isTempoTrack)
-                {
-                    MidiMessage ci(MidiMessage::tempoMetaEvent(Transport::getTempoByControllerValue(interpolatedValue)));
-                    ci.setTimeStamp(interpolatedTs);
-                    outSequence.addEvent(ci);
-                }
-                else
-                {
-                    MidiMessage ci(MidiMessage::controllerEvent(this->getTrackChannel(),
-                        this->getTrackControllerNumber(), int(interpolatedValue * 127)));
-                    ci.setTimeStamp(interpolatedTs);
-                    outSequence.addEvent(ci);
-                }
+                MidiMessage ci(createMessage(interpolatedValue));
+                ci.setTimeStamp(interpolatedTs);
+                outSequence.addEvent(ci);
 
                 lastAppliedValue = interpolatedValue;
             }
@@ -26,6 +26,13 @@ MidiEvent::MidiEvent(WeakReference<MidiSequence> owner, const MidiEvent &paramet
     beat(parameters.beat),
     id(parameters.id) {}
 
+MidiEvent::MidiEvent(WeakReference<MidiSequence> owner,
+    Type type, Id id, float beat) noexcept :
+    sequence(owner),
+    id(id),
+    type(type),
+    beat(beat) {}
+
 MidiEvent::MidiEvent(WeakReference<MidiSequence> owner, Type type, float beatVal) noexcept :
     sequence(owner),
     type(type),
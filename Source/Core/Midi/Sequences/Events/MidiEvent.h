@@ -53,6 +53,10 @@ public:
     // with custom parameters (assumes the id is already valid and unique)
     MidiEvent(WeakReference<MidiSequence> owner, const MidiEvent &parameters) noexcept;
 
+    // Doesn't create new id either, only used to restore the events
+    // from the compact undo records, which don't keep the whole objects
+    MidiEvent(WeakReference<MidiSequence> owner, Type type, Id id, float beat) noexcept;
+
     virtual void exportMessages(MidiMessageSequence &outSequence, const Clip &clip,
         const KeyboardMapping &keyMap, double timeFactor) const noexcept = 0;
 
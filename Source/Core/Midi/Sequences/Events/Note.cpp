@@ -38,6 +38,14 @@ Note::Note(WeakReference<MidiSequence> owner, const Note &parametersToCopy) noex
     velocity(parametersToCopy.velocity),
     tuplet(parametersToCopy.tuplet) {}
 
+Note::Note(WeakReference<MidiSequence> owner, Id id, Key keyVal, float beatVal,
+    float lengthVal, float velocityVal, Tuplet tupletVal) noexcept :
+    MidiEvent(owner, Type::Note, id, beatVal),
+    key(keyVal),
+    length(lengthVal),
+    velocity(velocityVal),
+    tuplet(tupletVal) {}
+
 void Note::exportMessages(MidiMessageSequence &outSequence, const Clip &clip,
     const KeyboardMapping &keyMap, double timeFactor) const noexcept
 {
@@ -39,6 +39,10 @@ public:
         Key keyVal = 0, float beatVal = 0.f,
         float lengthVal = 1.f, float velocityVal = 1.f) noexcept;
 
+    // Doesn't create new id, see the comment in MidiEvent
+    Note(WeakReference<MidiSequence> owner, Id id, Key keyVal, float beatVal,
+        float lengthVal, float velocityVal, Tuplet tupletVal) noexcept;
+
     void exportMessages(MidiMessageSequence &outSequence, const Clip &clip,
         const KeyboardMapping &keyMap, double timeFactor) const noexcept override;
     
@@ -26,17 +26,24 @@ struct EventIdGenerator final
 {
     static MidiEvent::Id generateId(int length = 2)
     {
-        jassert(length <= 4);
-        MidiEvent::Id id = 0;
         static Random r;
         r.setSeedRandomly();
+        return generateId(r, length);
+    }
+
+    static MidiEvent::Id generateId(Random &r, int length)
+    {
+        jassert(length <= 4);
+        MidiEvent::Id id = 0;
         static const char idChars[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
         for (int i = 0; i < length; ++i)
         {
-            id |= idChars[r.nextInt(62)] << (i * CHAR_BIT);
+            id |= idChars[r.nextInt(numIdChars)] << (i * CHAR_BIT);
         }
         return id;
     }
+
+    static constexpr auto numIdChars = 62;
 };
 
 MidiSequence::MidiSequence(MidiTrack &parentTrack,
@@ -92,9 +99,7 @@ void MidiSequence::clearUndoHistory()
 
 void MidiSequence::exportMidi(MidiMessageSequence &outSequence,
     const Clip &clip, const KeyboardMapping &keyMap,
-    bool soloPlaybackMode, bool exportMetronome,
-    float projectFirstBeat, float projectLastBeat,
-    double timeFactor /*= 1.0*/) const
+    bool soloPlaybackMode, double timeFactor /*= 1.0*/) const
 {
     if (this->midiEvents.isEmpty() || clip.isMuted())
     {
@@ -107,9 +112,8 @@ void MidiSequence::exportMidi(MidiMessageSequence &outSequence,
     // for example, automations should be exported all the time unless muted;
 
     // for now, PianoSequence overrides this method
-    // to make sure it skips all no-solo clips, when soloPlaybackMode is true,
-    // and TimeSignatureSequence overrides this method
-    // to emit the "virtual" metronome track, if needed
+    // to make sure it skips all no-solo clips, when soloPlaybackMode is true;
+    // the metronome is not exported here, see TimeSignaturesSequence::getMetronomeRanges
 
     for (const auto *event : this->midiEvents)
     {
@@ -217,6 +221,39 @@ MidiEvent::Id MidiSequence::createUniqueEventId() const noexcept
     return eventId;
 }
 
+Array<MidiEvent::Id> MidiSequence::createUniqueEventIds(int numIds) const
+{
+    Array<MidiEvent::Id> result;
+    result.ensureStorageAllocated(numIds);
+
+    // pick the shortest id length, which still leaves most of the ids
+    // of that length free, so that collisions are rare; unlike
+    // createUniqueEventId, this doesn't re-seed the random for each id
+    const auto numUsedIds = int64(this->usedEventIds.size()) + numIds;
+    int length = 2;
+    int64 numIdsOfLength = EventIdGenerator::numIdChars * EventIdGenerator::numIdChars;
+    while (length < 4 && numUsedIds * 4 > numIdsOfLength)
+    {
+        length++;
+        numIdsOfLength *= EventIdGenerator::numIdChars;
+    }
+
+    Random random;
+    for (int i = 0; i < numIds; ++i)
+    {
+        auto eventId = EventIdGenerator::generateId(random, length);
+        while (this->usedEventIds.contains(eventId))
+        {
+            eventId = EventIdGenerator::generateId(random, length);
+        }
+
+        this->usedEventIds.insert(eventId);
+        result.add(eventId);
+    }
+
+    return result;
+}
+
 //===----------------------------------------------------------------------===//
 // Helpers
 //===----------------------------------------------------------------------===//
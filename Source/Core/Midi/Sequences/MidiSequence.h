@@ -53,9 +53,7 @@ public:
     virtual void importMidi(const MidiMessageSequence &sequence, short timeFormat) = 0;
     virtual void exportMidi(MidiMessageSequence &outSequence,
         const Clip &clip, const KeyboardMapping &keyMap,
-        bool soloPlaybackMode, bool exportMetronome,
-        float projectFirstBeat, float projectLastBeat,
-        double timeFactor = 1.0) const;
+        bool soloPlaybackMode, double timeFactor = 1.0) const;
 
     //===------------------------------------------------------------------===//
     // Track editing
@@ -159,6 +157,7 @@ public:
     virtual void updateBeatRange(bool shouldNotifyIfChanged);
 
     MidiEvent::Id createUniqueEventId() const noexcept;
+    Array<MidiEvent::Id> createUniqueEventIds(int numIds) const;
     const String &getTrackId() const noexcept;
     int getChannel() const noexcept;
 
@@ -0,0 +1,520 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Common.h"
+#include "NoteTransforms.h"
+#include "PianoSequence.h"
+
+using SortedNotes = Array<const Note *>;
+
+template <typename Comparator>
+static SortedNotes sortNotes(const Array<Note> &notes, Comparator comparator)
+{
+    SortedNotes result;
+    result.ensureStorageAllocated(notes.size());
+
+    for (const auto &note : notes)
+    {
+        result.add(&note);
+    }
+
+    std::sort(result.begin(), result.end(), comparator);
+    return result;
+}
+
+static inline void changeNoteEnd(NoteTransforms::Result &result,
+    const Note &note, float newEndBeat)
+{
+    const auto newLength = jmax(Globals::minNoteLength, newEndBeat - note.getBeat());
+    if (newLength != note.getLength())
+    {
+        result.groupBefore.add(note);
+        result.groupAfter.add(note.withLength(newLength));
+    }
+}
+
+static const Note *findNote(const PianoSequence &sequence, const Note &note)
+{
+    const auto *found = std::lower_bound(sequence.begin(), sequence.end(), &note,
+        [](const MidiEvent *const a, const MidiEvent *const b)
+        {
+            return MidiEvent::compareElements(a, b) < 0;
+        });
+
+    if (found == sequence.end() || (*found)->getId() != note.getId())
+    {
+        return nullptr;
+    }
+
+    return static_cast<const Note *>(*found);
+}
+
+//===----------------------------------------------------------------------===//
+// Result
+//===----------------------------------------------------------------------===//
+
+bool NoteTransforms::Result::isEmpty() const noexcept
+{
+    return this->groupBefore.isEmpty() && this->removals.isEmpty();
+}
+
+bool NoteTransforms::Result::isValidFor(const PianoSequence &sequence) const
+{
+    const auto isUnchanged = [&sequence](const Note &note)
+    {
+        const auto *existingNote = findNote(sequence, note);
+        return existingNote != nullptr &&
+            existingNote->getBeat() == note.getBeat() &&
+            existingNote->getKey() == note.getKey() &&
+            existingNote->getLength() == note.getLength() &&
+            existingNote->getVelocity() == note.getVelocity() &&
+            existingNote->getTuplet() == note.getTuplet();
+    };
+
+    for (const auto &note : this->groupBefore)
+    {
+        if (!isUnchanged(note)) { return false; }
+    }
+
+    for (const auto &note : this->removals)
+    {
+        if (!isUnchanged(note)) { return false; }
+    }
+
+    return true;
+}
+
+bool NoteTransforms::Result::apply(PianoSequence &sequence,
+    bool &didCheckpoint, UndoActionId transactionId)
+{
+    jassert(this->groupBefore.size() == this->groupAfter.size());
+
+    if (this->isEmpty())
+    {
+        return false;
+    }
+
+    if (!didCheckpoint)
+    {
+        sequence.checkpoint(transactionId);
+        didCheckpoint = true;
+    }
+
+    if (!this->groupBefore.isEmpty())
+    {
+        sequence.changeGroup(this->groupBefore, this->groupAfter, true);
+    }
+
+    if (!this->removals.isEmpty())
+    {
+        sequence.removeGroup(this->removals, true);
+    }
+
+    return true;
+}
+
+//===----------------------------------------------------------------------===//
+// Transforms
+//===----------------------------------------------------------------------===//
+
+NoteTransforms::Result NoteTransforms::cleanupOverlaps(const Array<Note> &notes)
+{
+    Result result;
+
+    if (notes.size() < 2)
+    {
+        return result;
+    }
+
+    // within each key, the longest one of the notes
+    // starting from the same beat comes first and stays:
+    const auto sorted = sortNotes(notes, [](const Note *a, const Note *b)
+    {
+        if (a->getKey() != b->getKey()) { return a->getKey() < b->getKey(); }
+        if (a->getBeat() != b->getBeat()) { return a->getBeat() < b->getBeat(); }
+        if (a->getLength() != b->getLength()) { return a->getLength() > b->getLength(); }
+        return a->getId() < b->getId();
+    });
+
+    int keyStart = 0;
+    while (keyStart < sorted.size())
+    {
+        const auto key = sorted.getUnchecked(keyStart)->getKey();
+
+        int keyEnd = keyStart;
+        while (keyEnd < sorted.size() && sorted.getUnchecked(keyEnd)->getKey() == key)
+        {
+            keyEnd++;
+        }
+
+        // the max end beat of the notes overlapping each other
+        float overlapsEndBeat = -FLT_MAX;
+        const Note *previous = nullptr;
+
+        for (int i = keyStart; i < keyEnd; ++i)
+        {
+            const auto *note = sorted.getUnchecked(i);
+
+            if (previous != nullptr && previous->getBeat() == note->getBeat())
+            {
+                result.removals.add(*note);
+                continue;
+            }
+
+            if (previous != nullptr)
+            {
+                changeNoteEnd(result, *previous,
+                    jmin(note->getBeat(), overlapsEndBeat));
+            }
+
+            overlapsEndBeat = jmax(overlapsEndBeat, note->getBeat() + note->getLength());
+            previous = note;
+        }
+
+        if (previous != nullptr)
+        {
+            changeNoteEnd(result, *previous, overlapsEndBeat);
+        }
+
+        keyStart = keyEnd;
+    }
+
+    return result;
+}
+
+NoteTransforms::Result NoteTransforms::legato(const Array<Note> &notes, float overlap)
+{
+    Result result;
+
+    const auto sorted = sortNotes(notes, [](const Note *a, const Note *b)
+    {
+        if (a->getBeat() != b->getBeat()) { return a->getBeat() < b->getBeat(); }
+        if (a->getKey() != b->getKey()) { return a->getKey() < b->getKey(); }
+        return a->getId() < b->getId();
+    });
+
+    const auto findOnsetEnd = [&sorted](int onsetStart)
+    {
+        const auto beat = sorted.getUnchecked(onsetStart)->getBeat();
+        int onsetEnd = onsetStart;
+        while (onsetEnd < sorted.size() && sorted.getUnchecked(onsetEnd)->getBeat() == beat)
+        {
+            onsetEnd++;
+        }
+
+        return onsetEnd;
+    };
+
+    int onsetStart = 0;
+    int onsetEnd = sorted.isEmpty() ? 0 : findOnsetEnd(0);
+
+    // the notes of the last onset have nothing to extend to
+    while (onsetEnd < sorted.size())
+    {
+        const auto nextOnsetEnd = findOnsetEnd(onsetEnd);
+        const auto nextBeat = sorted.getUnchecked(onsetEnd)->getBeat();
+
+        for (int i = onsetStart; i < onsetEnd; ++i)
+        {
+            const auto *note = sorted.getUnchecked(i);
+
+            // notes within one onset are sorted by key
+            const auto *nextOnsetKeys = std::lower_bound(
+                sorted.begin() + onsetEnd, sorted.begin() + nextOnsetEnd, note->getKey(),
+                [](const Note *n, Note::Key key) { return n->getKey() < key; });
+
+            const bool hasSameKeyNext = nextOnsetKeys != sorted.begin() + nextOnsetEnd &&
+                (*nextOnsetKeys)->getKey() == note->getKey();
+
+            // leave a small gap between the notes of the same key,
+            // so that note on/off messages don't happen at the same time:
+            changeNoteEnd(result, *note, hasSameKeyNext ?
+                nextBeat - Globals::minNoteLength : nextBeat + overlap);
+        }
+
+        onsetStart = onsetEnd;
+        onsetEnd = nextOnsetEnd;
+    }
+
+    return result;
+}
+
+static inline void doQuantize(float &startBeat, float &length, float bar)
+{
+    // todo for the future:
+    // align with time signature events
+
+    jassert(bar != 0.f);
+    const float q = bar / float(Globals::beatsPerBar);
+    const auto endBeat = startBeat + length;
+
+    startBeat = roundf(startBeat * q) / q;
+    const auto endBeatRound = roundf(endBeat * q) / q;
+
+    // make sure the returned length is not too short:
+    const auto minQuantizedBeat = (1.f / bar) * float(Globals::beatsPerBar);
+    length = jmax(minQuantizedBeat, endBeatRound - startBeat);
+}
+
+struct NotePlacement final
+{
+    Note::Key key;
+    float beat;
+    float length;
+
+    inline bool operator== (const NotePlacement &other) const noexcept
+    {
+        return this->key == other.key &&
+            this->beat == other.beat &&
+            this->length == other.length;
+    }
+};
+
+struct NotePlacementHash final
+{
+    inline HashCode operator()(const NotePlacement &p) const noexcept
+    {
+        return static_cast<HashCode>(p.key) ^
+            (std::hash<float>()(p.beat) << 1) ^
+            (std::hash<float>()(p.length) << 2);
+    }
+};
+
+NoteTransforms::Result NoteTransforms::quantize(const Array<Note> &notes, float bar)
+{
+    Result result;
+
+    FlatHashSet<NotePlacement, NotePlacementHash> occupiedPlacements;
+    occupiedPlacements.reserve(notes.size());
+
+    Array<NotePlacement> quantized;
+    quantized.ensureStorageAllocated(notes.size());
+
+    for (const auto &note : notes)
+    {
+        NotePlacement placement{ note.getKey(), note.getBeat(), note.getLength() };
+        doQuantize(placement.beat, placement.length, bar);
+        quantized.add(placement);
+
+        if (placement.beat == note.getBeat() && placement.length == note.getLength())
+        {
+            occupiedPlacements.insert(placement);
+        }
+    }
+
+    // the notes which are not moved always stay, and the moved ones
+    // are removed, if they land exactly onto any other note:
+    for (int i = 0; i < notes.size(); ++i)
+    {
+        const auto &note = notes.getReference(i);
+        const auto &placement = quantized.getReference(i);
+
+        if (placement.beat == note.getBeat() && placement.length == note.getLength())
+        {
+            continue;
+        }
+
+        if (occupiedPlacements.contains(placement))
+        {
+            result.removals.add(note);
+            continue;
+        }
+
+        occupiedPlacements.insert(placement);
+        result.groupBefore.add(note);
+        result.groupAfter.add(note.withBeat(placement.beat).withLength(placement.length));
+    }
+
+    return result;
+}
+
+Array<Note> NoteTransforms::collectNotes(const PianoSequence &sequence)
+{
+    return NoteTransforms::collectNotes(sequence, -FLT_MAX, FLT_MAX);
+}
+
+Array<Note> NoteTransforms::collectNotes(const PianoSequence &sequence,
+    float startBeat, float endBeat)
+{
+    Array<Note> result;
+    result.ensureStorageAllocated(sequence.size());
+
+    for (const auto *event : sequence)
+    {
+        if (event->getBeat() >= endBeat)
+        {
+            break; // the sequence is sorted by beat
+        }
+
+        if (event->getBeat() >= startBeat)
+        {
+            result.add(*static_cast<const Note *>(event));
+        }
+    }
+
+    return result;
+}
+
+//===----------------------------------------------------------------------===//
+// Worker
+//===----------------------------------------------------------------------===//
+
+NoteTransforms::Worker::Worker() : Thread("NoteTransforms") {}
+
+NoteTransforms::Worker::~Worker()
+{
+    // the transforms are single sweeps over a sorted input,
+    // so the last one finishes quickly, no need to kill it
+    this->waitForThreadToExit(-1);
+    this->cancelPendingUpdate();
+}
+
+void NoteTransforms::Worker::transformAsync(PianoSequence &targetSequence,
+    Array<Note> &&notes, Transform targetTransform)
+{
+    this->nextSequence = &targetSequence;
+    this->nextInput = std::move(notes);
+    this->nextTransform = std::move(targetTransform);
+    this->startNextIfIdle();
+}
+
+void NoteTransforms::Worker::startNextIfIdle()
+{
+    // the previous job, if any, is not interrupted, but its result is dropped,
+    // since it would likely be invalidated by the new one anyway;
+    // the new job starts when the previous one is done, see handleAsyncUpdate
+    if (this->isThreadRunning() || this->isUpdatePending())
+    {
+        return;
+    }
+
+    this->sequence = this->nextSequence;
+    this->input = std::move(this->nextInput);
+    this->transform = std::move(this->nextTransform);
+
+    this->nextSequence = nullptr;
+    this->nextInput.clear();
+    this->nextTransform = nullptr;
+
+    this->startThread();
+}
+
+void NoteTransforms::Worker::run()
+{
+    this->result = this->transform(this->input);
+
+    // always notify, even if the result is stale, so that the next job can start
+    this->triggerAsyncUpdate();
+}
+
+void NoteTransforms::Worker::handleAsyncUpdate()
+{
+    // the thread has done its job by now and is just about to exit
+    this->waitForThreadToExit(Worker::threadExitTimeoutMs);
+
+    auto transformed = std::move(this->result);
+    this->result = {};
+
+    if (this->nextTransform != nullptr)
+    {
+        this->startNextIfIdle();
+        return;
+    }
+
+    if (this->sequence == nullptr || transformed.isEmpty())
+    {
+        return;
+    }
+
+    if (!transformed.isValidFor(*this->sequence))
+    {
+        DBG("Notes have changed while being transformed, skipping");
+        return;
+    }
+
+    bool didCheckpoint = false;
+    transformed.apply(*this->sequence, didCheckpoint);
+}
+
+//===----------------------------------------------------------------------===//
+// Tests
+//===----------------------------------------------------------------------===//
+
+#if JUCE_UNIT_TESTS
+
+class NoteTransformsTests final : public UnitTest
+{
+public:
+    NoteTransformsTests() : UnitTest("Note transforms tests", UnitTestCategories::helio) {}
+
+    void runTest() override
+    {
+        beginTest("Cleanup overlaps");
+        {
+            Array<Note> notes;
+            notes.add(Note(nullptr, 60, 0.f, 4.f));
+            notes.add(Note(nullptr, 60, 1.f, 1.f));
+            notes.add(Note(nullptr, 60, 1.f, 0.5f));
+            notes.add(Note(nullptr, 62, 0.f, 1.f));
+
+            const auto result = NoteTransforms::cleanupOverlaps(notes);
+
+            // the shorter duplicate at beat 1 is removed,
+            // the first note is trimmed up to the second one,
+            // which is then extended to where the first one ended
+            expectEquals(result.removals.size(), 1);
+            expectEquals(result.removals.getFirst().getLength(), 0.5f);
+            expectEquals(result.groupAfter.size(), 2);
+            expectEquals(result.groupAfter[0].getLength(), 1.f);
+            expectEquals(result.groupAfter[1].getLength(), 3.f);
+        }
+
+        beginTest("Legato");
+        {
+            Array<Note> notes;
+            notes.add(Note(nullptr, 64, 2.f, 0.5f));
+            notes.add(Note(nullptr, 60, 0.f, 0.5f));
+            notes.add(Note(nullptr, 62, 0.f, 0.5f));
+            notes.add(Note(nullptr, 60, 1.f, 0.5f));
+
+            const auto result = NoteTransforms::legato(notes, 0.f);
+
+            expectEquals(result.groupAfter.size(), 3);
+            expectEquals(result.groupAfter[0].getLength(), 1.f - Globals::minNoteLength);
+            expectEquals(result.groupAfter[1].getLength(), 1.f);
+            expectEquals(result.groupAfter[2].getLength(), 1.f);
+        }
+
+        beginTest("Quantize");
+        {
+            Array<Note> notes;
+            notes.add(Note(nullptr, 60, 1.f, 1.f));
+            notes.add(Note(nullptr, 60, 1.1f, 0.9f));
+            notes.add(Note(nullptr, 62, 2.9f, 1.f));
+
+            const auto result = NoteTransforms::quantize(notes, 4.f);
+
+            expectEquals(result.removals.size(), 1);
+            expectEquals(result.groupAfter.size(), 1);
+            expectEquals(result.groupAfter.getFirst().getBeat(), 3.f);
+        }
+    }
+};
+
+static NoteTransformsTests noteTransformsTests;
+
+#endif
@@ -0,0 +1,110 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+class PianoSequence;
+
+#include "Note.h"
+#include "UndoActionIDs.h"
+
+// Headless note transformations working on plain note arrays,
+// i.e. not depending on selected note components in the piano roll;
+// all of them sort the input once and then sweep it, so that they
+// are usable for whole tracks of tens of thousands of notes;
+// the transforms themselves don't modify anything, they only
+// compute a change set which is then applied as a single batch
+
+struct NoteTransforms final
+{
+    struct Result final
+    {
+        Array<Note> groupBefore;
+        Array<Note> groupAfter;
+        Array<Note> removals;
+
+        bool isEmpty() const noexcept;
+
+        // checks if all the notes to be changed or removed are still
+        // present in the sequence and haven't been edited meanwhile
+        bool isValidFor(const PianoSequence &sequence) const;
+
+        // returns true if made any changes
+        bool apply(PianoSequence &sequence, bool &didCheckpoint,
+            UndoActionId transactionId = UndoActionIDs::None);
+    };
+
+    using Transform = Function<Result(const Array<Note> &notes)>;
+
+    // removes the notes of the same key starting at the same beat,
+    // and trims the overlapping notes of the same key, so that each one
+    // ends where the next one starts, and the last one ends where
+    // the longest note of the overlapping bunch used to end
+    static Result cleanupOverlaps(const Array<Note> &notes);
+
+    // extends each note to the next onset; if the next onset has
+    // a note of the same key, leaves a tiny gap instead of overlap
+    static Result legato(const Array<Note> &notes, float overlap);
+
+    // snaps notes to the grid of a given bar fraction (1 for whole notes,
+    // 4 for quarter notes etc.), the notes which become exact duplicates
+    // of other notes are removed
+    static Result quantize(const Array<Note> &notes, float bar);
+
+    static Array<Note> collectNotes(const PianoSequence &sequence);
+    static Array<Note> collectNotes(const PianoSequence &sequence,
+        float startBeat, float endBeat);
+
+    // smaller inputs are fast enough to be transformed synchronously
+    static constexpr auto asyncThreshold = 4096;
+
+    // runs one transform at a time on a background thread,
+    // and applies the result on the message thread, unless
+    // the sequence has been changed while the transform was running;
+    // a new request doesn't wait for the previous one: it starts
+    // as soon as the previous one is done, and its result is dropped
+    class Worker final : private Thread, private AsyncUpdater
+    {
+    public:
+
+        Worker();
+        ~Worker() override;
+
+        void transformAsync(PianoSequence &sequence,
+            Array<Note> &&notes, Transform transform);
+
+    private:
+
+        void run() override;
+        void handleAsyncUpdate() override;
+
+        void startNextIfIdle();
+
+        WeakReference<PianoSequence> sequence;
+        Array<Note> input;
+        Transform transform;
+        Result result;
+
+        WeakReference<PianoSequence> nextSequence;
+        Array<Note> nextInput;
+        Transform nextTransform;
+
+        static constexpr auto threadExitTimeoutMs = 1000;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Worker)
+    };
+};
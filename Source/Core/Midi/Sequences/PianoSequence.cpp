@@ -64,9 +64,7 @@ void PianoSequence::importMidi(const MidiMessageSequence &sequence, short timeFo
 
 void PianoSequence::exportMidi(MidiMessageSequence &outSequence,
     const Clip &clip, const KeyboardMapping &keyMap,
-    bool soloPlaybackMode, bool exportMetronome,
-    float projectFirstBeat, float projectLastBeat,
-    double timeFactor /*= 1.0*/) const
+    bool soloPlaybackMode, double timeFactor /*= 1.0*/) const
 {
     // This method pretty much duplicates base method, except for this check:
     if (this->midiEvents.isEmpty() || clip.isMuted() ||
@@ -174,6 +172,32 @@ bool PianoSequence::insertGroup(Array<Note> &group, bool undoable)
             perform(new NotesGroupInsertAction(*this->getProject(),
                 this->getTrackId(), group));
     }
+    else if (group.size() >= PianoSequence::batchChangeThreshold)
+    {
+        // same as in changeGroup, appending all the notes
+        // and sorting once is way cheaper than inserting them one by one
+        const auto firstNewIndex = this->midiEvents.size();
+        this->midiEvents.ensureStorageAllocated(firstNewIndex + group.size());
+
+        Array<Note *> insertedNotes;
+        insertedNotes.ensureStorageAllocated(group.size());
+
+        for (const auto &eventParams : group)
+        {
+            auto *ownedNote = new Note(this, eventParams);
+            this->midiEvents.add(ownedNote);
+            insertedNotes.add(ownedNote);
+        }
+
+        this->sort();
+
+        for (auto *insertedNote : insertedNotes)
+        {
+            this->eventDispatcher.dispatchAddEvent(*insertedNote);
+        }
+
+        this->updateBeatRange(true);
+    }
     else
     {
         for (int i = 0; i < group.size(); ++i)
@@ -235,6 +259,42 @@ bool PianoSequence::changeGroup(Array<Note> &groupBefore,
             perform(new NotesGroupChangeAction(*this->getProject(),
                 this->getTrackId(), groupBefore, groupAfter));
     }
+    else if (groupBefore.size() >= PianoSequence::batchChangeThreshold)
+    {
+        // for large groups, it's way cheaper to find all the notes first,
+        // change them in place and re-sort the sequence once, than to move
+        // each of the changed notes within the sorted array one by one
+        Array<Note *> changedNotes;
+        changedNotes.ensureStorageAllocated(groupBefore.size());
+
+        for (const auto &oldParams : groupBefore)
+        {
+            const int index = this->midiEvents.indexOfSorted(oldParams, &oldParams);
+            jassert(index >= 0); // see the comment below
+            changedNotes.add(index >= 0 ?
+                static_cast<Note *>(this->midiEvents.getUnchecked(index)) : nullptr);
+        }
+
+        for (int i = 0; i < changedNotes.size(); ++i)
+        {
+            if (auto *changedNote = changedNotes.getUnchecked(i))
+            {
+                changedNote->applyChanges(groupAfter.getReference(i));
+            }
+        }
+
+        this->sort();
+
+        for (int i = 0; i < changedNotes.size(); ++i)
+        {
+            if (auto *changedNote = changedNotes.getUnchecked(i))
+            {
+                this->eventDispatcher.dispatchChangeEvent(groupBefore.getReference(i), *changedNote);
+            }
+        }
+
+        this->updateBeatRange(true);
+    }
     else
     {
         for (int i = 0; i < groupBefore.size(); ++i)
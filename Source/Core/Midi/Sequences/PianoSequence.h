@@ -35,9 +35,7 @@ public:
     void importMidi(const MidiMessageSequence &sequence, short timeFormat) override;
     void exportMidi(MidiMessageSequence &outSequence,
         const Clip &clip, const KeyboardMapping &keyMap,
-        bool soloPlaybackMode, bool exportMetronome,
-        float projectFirstBeat, float projectLastBeat,
-        double timeFactor = 1.0) const override;
+        bool soloPlaybackMode, double timeFactor = 1.0) const override;
 
     //===------------------------------------------------------------------===//
     // Undoable track editing
@@ -66,6 +64,8 @@ private:
 
     float findLastBeat() const noexcept override;
 
+    static constexpr auto batchChangeThreshold = 256;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PianoSequence);
     JUCE_DECLARE_WEAK_REFERENCEABLE(PianoSequence);
 };
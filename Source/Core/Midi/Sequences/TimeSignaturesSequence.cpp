@@ -55,91 +55,65 @@ void TimeSignaturesSequence::importMidi(const MidiMessageSequence &sequence, sho
     this->updateBeatRange(false);
 }
 
-void TimeSignaturesSequence::exportMidi(MidiMessageSequence &outSequence,
-    const Clip &clip, const KeyboardMapping &keyMap,
-    bool soloPlaybackMode, bool exportMetronome,
-    float projectFirstBeat, float projectLastBeat,
-    double timeFactor /*= 1.0*/) const
+//===----------------------------------------------------------------------===//
+// Metronome
+//===----------------------------------------------------------------------===//
+
+Array<TimeSignaturesSequence::MetronomeRange>
+    TimeSignaturesSequence::getMetronomeRanges(float projectFirstBeat, float projectLastBeat) const
 {
-    // This method pretty much duplicates the base method, except for
-    // emitting the "virtual" metronome track, if it's needed
-    if (exportMetronome)
+    Array<MetronomeRange> result;
+
+    const auto addRange = [&result](float startBeat, float endBeat,
+        float stepBeats, const MetronomeScheme &scheme)
     {
-        // I'm too lazy to take timeFactor into account here,
-        // but it is only used when exporting to midi file (i.e. sets midi clock),
-        // and we don't export the virtual metronome track to midi files:
-        jassert(timeFactor == 1.0);
+        jassert(scheme.isValid());
+        jassert(stepBeats > 0.f);
 
-        const auto emitNextMetronomeEvent = [](MidiMessageSequence &outSequence,
-            float beat, const MetronomeScheme &scheme, int &syllableIndex)
+        if (startBeat >= endBeat || !scheme.isValid())
         {
-            const auto currentSyllable = scheme.getSyllableAt(syllableIndex);
-            const auto key = MetronomeSynth::getKeyForSyllable(currentSyllable);
-
-            syllableIndex = ++syllableIndex % scheme.getSize();
-
-            constexpr auto metronomeChannel = 1;    // doesn't matter which one
-            constexpr auto metronomeVelocity = 1.f; // also will be ignored
-
-            MidiMessage mentonomeNoteOn(MidiMessage::noteOn(metronomeChannel, key, metronomeVelocity));
-            mentonomeNoteOn.setTimeStamp(beat);
-            outSequence.addEvent(mentonomeNoteOn);
+            return;
+        }
 
-            // for simplicity, not emitting note-offs for the built-in metronome,
-            // Synthesiser class automatically stops/starts the voices when the same note repeats
-        };
+        MetronomeRange range;
+        range.startBeat = startBeat;
+        range.endBeat = endBeat;
+        range.stepBeats = stepBeats;
 
-        if (this->midiEvents.isEmpty())
-        {
-            int syllableIndex = 0;
-            const MetronomeScheme defaultScheme;
-            for (float beat = projectFirstBeat; beat <= projectLastBeat; beat += 1.f)
-            {
-                emitNextMetronomeEvent(outSequence, beat, defaultScheme, syllableIndex);
-            }
-        }
-        else
+        for (const auto syllable : scheme.getSyllables())
         {
-            const auto *firstEvent = static_cast<const TimeSignatureEvent *>(this->midiEvents.getFirst());
-            jassert(firstEvent->getBeat() >= projectFirstBeat);
-
-            {
-                int syllableIndex = 0;
-                const auto metronomeScheme = firstEvent->getMeter().getMetronome();
-                jassert(metronomeScheme.isValid());
-
-                for (float beat = projectFirstBeat; beat < firstEvent->getBeat();
-                     beat += firstEvent->getDenominatorInBeats())
-                {
-                    emitNextMetronomeEvent(outSequence, beat, metronomeScheme, syllableIndex);
-                }
-            }
-
-            for (int i = 0; i < this->midiEvents.size(); ++i)
-            {
-                const auto *event = static_cast<const TimeSignatureEvent *>(this->midiEvents.getUnchecked(i));
-                const auto nextBeat = (i < this->midiEvents.size() - 1) ?
-                    this->midiEvents.getUnchecked(i + 1)->getBeat() : projectLastBeat;
-
-                int syllableIndex = 0;
-                const auto metronomeScheme = event->getMeter().getMetronome();
-                jassert(metronomeScheme.isValid());
-
-                for (float beat = event->getBeat(); beat < nextBeat;
-                     beat += event->getDenominatorInBeats())
-                {
-                    emitNextMetronomeEvent(outSequence, beat, metronomeScheme, syllableIndex);
-                }
-            }
+            range.keys.add(MetronomeSynth::getKeyForSyllable(syllable));
         }
+
+        result.add(range);
+    };
+
+    if (this->midiEvents.isEmpty())
+    {
+        // the last beat is inclusive here, as it always was
+        addRange(projectFirstBeat, projectLastBeat + 1.f, 1.f, MetronomeScheme());
+        return result;
     }
 
-    for (const auto *event : this->midiEvents)
+    const auto *firstEvent = static_cast<const TimeSignatureEvent *>(this->midiEvents.getFirst());
+    jassert(firstEvent->getBeat() >= projectFirstBeat);
+
+    addRange(projectFirstBeat, firstEvent->getBeat(),
+        firstEvent->getDenominatorInBeats(),
+        firstEvent->getMeter().getMetronome());
+
+    for (int i = 0; i < this->midiEvents.size(); ++i)
     {
-        event->exportMessages(outSequence, clip, keyMap, timeFactor);
+        const auto *event = static_cast<const TimeSignatureEvent *>(this->midiEvents.getUnchecked(i));
+        const auto nextBeat = (i < this->midiEvents.size() - 1) ?
+            this->midiEvents.getUnchecked(i + 1)->getBeat() : projectLastBeat;
+
+        addRange(event->getBeat(), nextBeat,
+            event->getDenominatorInBeats(),
+            event->getMeter().getMetronome());
     }
 
-    outSequence.updateMatchedPairs();
+    return result;
 }
 
 //===----------------------------------------------------------------------===//
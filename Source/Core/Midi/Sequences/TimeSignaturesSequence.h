@@ -32,11 +32,24 @@ public:
     //===------------------------------------------------------------------===//
 
     void importMidi(const MidiMessageSequence &sequence, short timeFormat) override;
-    void exportMidi(MidiMessageSequence &outSequence,
-        const Clip &clip, const KeyboardMapping &keyMap,
-        bool soloPlaybackMode, bool exportMetronome,
-        float projectFirstBeat, float projectLastBeat,
-        double timeFactor = 1.0) const override;
+
+    //===------------------------------------------------------------------===//
+    // Metronome
+    //===------------------------------------------------------------------===//
+
+    // The metronome is not exported as a note per beat; instead, it is
+    // described by a short list of ranges with the same step and scheme,
+    // and the player generates the clicks on the fly (see CachedMetronome)
+    struct MetronomeRange final
+    {
+        float startBeat = 0.f;
+        float endBeat = 0.f;
+        float stepBeats = 1.f;
+        Array<int> keys; // the metronome synth key for each syllable
+    };
+
+    Array<MetronomeRange> getMetronomeRanges(float projectFirstBeat,
+        float projectLastBeat) const;
 
     //===------------------------------------------------------------------===//
     // Undoable track editing
@@ -0,0 +1,542 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Common.h"
+#include "ProjectBenchmarks.h"
+
+#if JUCE_UNIT_TESTS
+
+#include "ProjectNode.h"
+#include "PianoTrackNode.h"
+#include "AutomationTrackNode.h"
+#include "PianoSequence.h"
+#include "AutomationSequence.h"
+#include "NoteTransforms.h"
+#include "Pattern.h"
+#include "Transport.h"
+#include "VersionControl.h"
+#include "RevisionItem.h"
+#include "PianoRoll.h"
+#include "DefaultSynthAudioPlugin.h"
+#include "DocumentHelpers.h"
+#include "BinarySerializer.h"
+#include "JsonSerializer.h"
+
+ProjectBenchmarks::ProjectBenchmarks() :
+    UnitTest("Project benchmarks", UnitTestCategories::helioBenchmarks) {}
+
+void ProjectBenchmarks::runTest()
+{
+    using namespace Serialization;
+
+    SerializedData report(Benchmarks::benchmarks);
+    report.setProperty(Benchmarks::appVersion, App::getAppReadableVersion());
+    report.setProperty(Benchmarks::timestamp, Time::getCurrentTime().toISO8601(true));
+
+    for (const auto &size : ProjectBenchmarks::getProjectSizes())
+    {
+        beginTest("Benchmarking a " + size.name + " project");
+        report.appendChild(this->runBenchmarks(size));
+    }
+
+    const auto resultsFile = ProjectBenchmarks::getResultsFile();
+    const auto saved = JsonSerializer().saveToFile(resultsFile, report);
+    expect(saved.wasOk(), saved.getErrorMessage());
+
+    this->logMessage("Benchmark results saved to " + resultsFile.getFullPathName());
+}
+
+//===----------------------------------------------------------------------===//
+// Synthetic projects
+//===----------------------------------------------------------------------===//
+
+Array<ProjectBenchmarks::ProjectSize> ProjectBenchmarks::getProjectSizes()
+{
+    // name, piano tracks, notes per track, clips per track,
+    // automation tracks, events per automation track, revisions
+    const Array<ProjectSize> presets = {
+        { "small", 8, 500, 2, 2, 100, 5 },
+        { "medium", 32, 2000, 4, 4, 500, 10 },
+        { "large", 64, 10000, 8, 8, 2000, 20 }
+    };
+
+    auto names = StringArray::fromTokens(SystemStats::getEnvironmentVariable(
+        "HELIO_BENCHMARK_PROJECTS", "small,medium"), ",", "");
+
+    names.trim();
+
+    Array<ProjectSize> result;
+    for (const auto &preset : presets)
+    {
+        if (names.contains(preset.name))
+        {
+            result.add(preset);
+        }
+    }
+
+    return result;
+}
+
+File ProjectBenchmarks::getResultsFile()
+{
+    const auto path = SystemStats::getEnvironmentVariable("HELIO_BENCHMARK_RESULTS", {});
+    if (path.isNotEmpty())
+    {
+        return File::getCurrentWorkingDirectory().getChildFile(path);
+    }
+
+    return File::getCurrentWorkingDirectory().getChildFile("benchmarks.json");
+}
+
+static void insertClips(Pattern *pattern, int numClips)
+{
+    Array<Clip> clips;
+    for (int i = 0; i < numClips; ++i)
+    {
+        // the instances overlap, as the looped parts often do
+        clips.add(Clip(pattern, float(i) * 16.f));
+    }
+
+    pattern->insertGroup(clips, false);
+}
+
+UniquePointer<ProjectNode> ProjectBenchmarks::createProject(const ProjectSize &size,
+    const File &projectFile)
+{
+    auto project = make<ProjectNode>(projectFile);
+
+    // a fixed seed, so that each build benchmarks the same content
+    Random random(size.name.hashCode64());
+
+    for (int i = 0; i < size.numPianoTracks; ++i)
+    {
+        auto *track = new PianoTrackNode("Track " + String(i + 1));
+        insertClips(track->getPattern(), size.numClipsPerTrack);
+        project->addChildNode(track, -1, false);
+
+        auto *sequence = static_cast<PianoSequence *>(track->getSequence());
+
+        Array<Note> notes;
+        notes.ensureStorageAllocated(size.numNotesPerTrack);
+
+        float beat = 0.f;
+        for (int j = 0; j < size.numNotesPerTrack; ++j)
+        {
+            // a mix of chords and runs
+            beat += float(random.nextInt(3)) * 0.25f;
+            const auto key = 36 + random.nextInt(48);
+            const auto length = float(1 + random.nextInt(8)) * 0.25f;
+            const auto velocity = 0.25f + random.nextFloat() * 0.75f;
+            notes.add(Note(sequence, key, beat, length, velocity));
+        }
+
+        sequence->insertGroup(notes, false);
+    }
+
+    for (int i = 0; i < size.numAutomationTracks; ++i)
+    {
+        // the first one is the tempo track, the rest are some controllers
+        const auto controllerNumber = (i == 0) ? int(MidiTrack::tempoController) : i;
+
+        auto *track = new AutomationTrackNode("Automation " + String(i + 1));
+        insertClips(track->getPattern(), size.numClipsPerTrack);
+        project->addChildNode(track, -1, false);
+        track->setTrackControllerNumber(controllerNumber, dontSendNotification);
+
+        auto *sequence = static_cast<AutomationSequence *>(track->getSequence());
+
+        Array<AutomationEvent> events;
+        events.ensureStorageAllocated(size.numEventsPerAutomationTrack);
+
+        for (int j = 0; j < size.numEventsPerAutomationTrack; ++j)
+        {
+            events.add(AutomationEvent(sequence, float(j), random.nextFloat()));
+        }
+
+        sequence->insertGroup(events, false);
+    }
+
+    project->broadcastReloadProjectContent();
+    const auto range = project->broadcastChangeProjectBeatRange();
+    project->broadcastChangeViewBeatRange(range.getStart(), range.getEnd());
+
+    return project;
+}
+
+// transposes every n-th note of each track, so that vcs has something to diff
+static void transposeEveryNthNote(ProjectNode &project, int n, int delta)
+{
+    for (auto *track : project.findChildrenOfType<PianoTrackNode>())
+    {
+        auto *sequence = static_cast<PianoSequence *>(track->getSequence());
+
+        Array<Note> groupBefore, groupAfter;
+        for (int i = 0; i < sequence->size(); i += n)
+        {
+            const auto &note = static_cast<const Note &>(*sequence->getUnchecked(i));
+            groupBefore.add(note);
+            groupAfter.add(note.withDeltaKey(delta));
+        }
+
+        sequence->changeGroup(groupBefore, groupAfter, false);
+    }
+}
+
+static void commitAllChanges(VersionControl &vcs, const String &message)
+{
+    auto &head = vcs.getHead();
+    head.rebuildDiffSynchronously();
+
+    SparseSet<int> allItems;
+    allItems.addRange({ 0, head.getDiff()->getItems().size() });
+    vcs.commit(allItems, message);
+}
+
+// Renders the beginning of the project with the built-in synth directly,
+// bypassing the instruments' processor graphs, which would need
+// the message thread to be free to rebuild them while rendering
+static int64 renderWithDefaultSynth(Transport &transport, double seconds)
+{
+    constexpr auto sampleRate = 44100.0;
+    constexpr auto numChannels = 2;
+    constexpr auto bufferSize = 512;
+
+    const auto context = transport.fillPlaybackContextAt(transport.getProjectFirstBeat());
+    auto sequences = transport.getPlaybackCache();
+
+    DefaultSynthAudioPlugin synth;
+    synth.prepareToPlay(sampleRate, bufferSize);
+    synth.setNonRealtime(true);
+
+    MemoryBlock renderedData;
+    UniquePointer<AudioFormatWriter> writer;
+    {
+        WavAudioFormat wavFormat;
+        writer.reset(wavFormat.createWriterFor(new MemoryOutputStream(renderedData, false),
+            sampleRate, numChannels, 16, {}, 0));
+    }
+
+    AudioBuffer<float> sampleBuffer(numChannels, bufferSize);
+    MidiBuffer midiBuffer;
+
+    sequences.seekToStart();
+
+    CachedMidiMessage nextMessage;
+    bool hasNextMessage = sequences.getNextMessage(nextMessage, false);
+
+    double secondsPerBeat = context->startBeatTempo / 1000.0;
+    double lastEventBeat = hasNextMessage ? nextMessage.message.getTimeStamp() : 0.0;
+    double lastEventTime = 0.0;
+
+    const auto numSamples = int64(seconds * sampleRate);
+    for (int64 bufferStart = 0; bufferStart < numSamples; bufferStart += bufferSize)
+    {
+        while (hasNextMessage)
+        {
+            const auto eventBeat = nextMessage.message.getTimeStamp();
+            const auto eventTime = lastEventTime + (eventBeat - lastEventBeat) * secondsPerBeat;
+            const auto eventSample = int64(eventTime * sampleRate);
+            if (eventSample >= bufferStart + bufferSize)
+            {
+                break;
+            }
+
+            lastEventBeat = eventBeat;
+            lastEventTime = eventTime;
+
+            if (nextMessage.message.isTempoMetaEvent())
+            {
+                secondsPerBeat = nextMessage.message.getTempoSecondsPerQuarterNote();
+            }
+            else
+            {
+                midiBuffer.addEvent(nextMessage.message,
+                    int(jmax(int64(0), eventSample - bufferStart)));
+            }
+
+            hasNextMessage = sequences.getNextMessage(nextMessage, false);
+        }
+
+        synth.processBlock(sampleBuffer, midiBuffer);
+        midiBuffer.clear();
+
+        writer->writeFromAudioSampleBuffer(sampleBuffer, 0, bufferSize);
+    }
+
+    writer = nullptr; // flushes the stream
+    return int64(renderedData.getSize());
+}
+
+//===----------------------------------------------------------------------===//
+// Benchmarks
+//===----------------------------------------------------------------------===//
+
+SerializedData ProjectBenchmarks::runBenchmarks(const ProjectSize &size)
+{
+    using namespace Serialization;
+
+    SerializedData results(Benchmarks::project);
+    results.setProperty(Benchmarks::projectName, size.name);
+    results.setProperty(Benchmarks::numPianoTracks, size.numPianoTracks);
+    results.setProperty(Benchmarks::numNotesPerTrack, size.numNotesPerTrack);
+    results.setProperty(Benchmarks::numClipsPerTrack, size.numClipsPerTrack);
+    results.setProperty(Benchmarks::numAutomationTracks, size.numAutomationTracks);
+    results.setProperty(Benchmarks::numEventsPerAutomationTrack, size.numEventsPerAutomationTrack);
+    results.setProperty(Benchmarks::numRevisions, size.numRevisions);
+
+    const auto fileName = "benchmark-" + size.name;
+    const auto projectFile = DocumentHelpers::getTempSlot(fileName + ".helio");
+    auto project = ProjectBenchmarks::createProject(size, projectFile);
+    auto &transport = project->getTransport();
+
+    // playback
+
+    this->measure(results, "buildPlaybackCache", 10,
+        [&transport]() { transport.buildPlaybackCache(); });
+
+    const auto beatRange = project->getProjectBeatRange();
+    const auto middleBeat = beatRange.getStart() + beatRange.getLength() / 2.f;
+    transport.fillPlaybackContextAt(middleBeat); // rebuilds the cache
+
+    this->measure(results, "fillPlaybackContextAt", 10,
+        [&transport, middleBeat]() { transport.fillPlaybackContextAt(middleBeat); });
+
+    static constexpr auto renderSeconds = 30.0;
+    this->measure(results, "renderOffline", 1, [this, &transport]()
+    {
+        expect(renderWithDefaultSynth(transport, renderSeconds) > 0);
+    });
+
+    // painting
+
+    this->measureRollPainting(results, *project);
+
+    // serialization
+
+    BinarySerializer binarySerializer;
+    this->measureSaveAndLoad(results, "Binary", binarySerializer,
+        *project, DocumentHelpers::getTempSlot(fileName + "-saved.helio"));
+
+    JsonSerializer jsonSerializer;
+    this->measureSaveAndLoad(results, "Json", jsonSerializer,
+        *project, DocumentHelpers::getTempSlot(fileName + "-saved.json"));
+
+    // edits, undos and redos
+
+    auto *track = project->findChildOfType<PianoTrackNode>();
+    auto *sequence = static_cast<PianoSequence *>(track->getSequence());
+
+    auto groupBefore = NoteTransforms::collectNotes(*sequence);
+    Array<Note> groupAfter;
+    int transposition = 1;
+
+    this->measure(results, "changeGroup", 10,
+        [&]()
+        {
+            sequence->changeGroup(groupBefore, groupAfter, true);
+            groupBefore.swapWith(groupAfter);
+        },
+        [&]()
+        {
+            project->checkpoint();
+            groupAfter.clearQuick();
+            for (const auto &note : groupBefore)
+            {
+                groupAfter.add(note.withDeltaKey(transposition));
+            }
+            transposition = -transposition;
+        });
+
+    this->measure(results, "undo", 10, [&project]() { project->undo(); });
+    this->measure(results, "redo", 10, [&project]() { project->redo(); });
+    expectEquals(sequence->size(), size.numNotesPerTrack);
+
+    // version control
+
+    {
+        VersionControl vcs(*project);
+        commitAllChanges(vcs, "Initial revision");
+        for (int i = 1; i < size.numRevisions; ++i)
+        {
+            transposeEveryNthNote(*project, 10 + i, 1);
+            commitAllChanges(vcs, "Revision " + String(i));
+        }
+
+        const auto lastRevision = vcs.getHead().getHeadingRevision();
+
+        this->measure(results, "headMoveTo", 5,
+            [&vcs, &lastRevision]() { vcs.getHead().moveTo(lastRevision); },
+            [&vcs]() { vcs.getHead().resetKeyframes(); });
+
+        this->measure(results, "headMoveToKeyframe", 5,
+            [&vcs, &lastRevision]() { vcs.getHead().moveTo(lastRevision); });
+
+        const VCS::RevisionItem::Ptr trackState(new VCS::RevisionItem(VCS::RevisionItem::Type::Added, track));
+        transposeEveryNthNote(*project, 2, 1);
+
+        this->measure(results, "createEventsDiffs", 10, [track, &trackState]()
+        {
+            UniquePointer<VCS::Diff> diff(track->getDiffLogic()->createDiff(*trackState));
+        });
+
+        this->measure(results, "headRebuildDiff", 5,
+            [&vcs]() { vcs.getHead().rebuildDiffSynchronously(); });
+
+        expect(vcs.getHead().hasAnythingOnTheStage());
+
+        // loading assembles all the blobs, each with its own copies of the
+        // stored chunks' events, so both numbers go to the report to see
+        // how much the deltas data takes in memory compared to the file
+        const auto history = vcs.serialize();
+        VersionControl loadedVcs(*project);
+
+        this->measure(results, "loadHistory", 5,
+            [&loadedVcs, &history]() { loadedVcs.deserialize(history); });
+
+        const auto blobNodes = loadedVcs.blobs.countNodes();
+        results.setProperty(Benchmarks::blobChunkEvents, blobNodes.numChunkEvents);
+        results.setProperty(Benchmarks::blobAssembledEvents, blobNodes.numAssembledEvents);
+    }
+
+    project = nullptr; // saves the document on destruction
+    projectFile.deleteFile();
+
+    return results;
+}
+
+void ProjectBenchmarks::measureSaveAndLoad(SerializedData &results, const String &formatName,
+    const Serializer &serializer, const ProjectNode &project, const File &file)
+{
+    this->measure(results, "save" + formatName, 5,
+        [&serializer, &project, &file]() { serializer.saveToFile(file, project.save()); });
+
+    expect(file.existsAsFile());
+    results.setProperty(Serialization::Benchmarks::fileSizePrefix.toString() + formatName, file.getSize());
+
+    // the serializers alone, without building or loading the project tree
+    const auto tree = project.save();
+    this->measure(results, "write" + formatName, 5,
+        [&serializer, &tree, &file]() { serializer.saveToFile(file, tree); });
+
+    this->measure(results, "read" + formatName, 5,
+        [this, &serializer, &file]() { expect(serializer.loadFromFile(file).isValid()); });
+
+    // loads into a new project each time, not counting its construction
+    const auto loadedProjectFile = file.getSiblingFile(file.getFileNameWithoutExtension() + "-loaded.helio");
+    UniquePointer<ProjectNode> loadedProject;
+
+    this->measure(results, "load" + formatName, 5,
+        [&serializer, &loadedProject, &file]() { loadedProject->load(serializer.loadFromFile(file)); },
+        [&loadedProject, &loadedProjectFile]() { loadedProject = make<ProjectNode>(loadedProjectFile); });
+
+    expectEquals(loadedProject->getTracks().size(), project.getTracks().size());
+
+    loadedProject = nullptr;
+    loadedProjectFile.deleteFile();
+    file.deleteFile();
+}
+
+void ProjectBenchmarks::measureRollPainting(SerializedData &results, ProjectNode &project)
+{
+    static constexpr auto paintWidth = 1920;
+    static constexpr auto paintHeight = 1080;
+
+    // the range of keys used by createProject
+    static constexpr auto minKey = 36;
+    static constexpr auto maxKey = 84;
+
+    Viewport viewport;
+    viewport.setSize(paintWidth, paintHeight);
+
+    PianoRoll roll(project, viewport, nullptr);
+    viewport.setViewedComponent(&roll, false);
+
+    // the roll has subscribed to the project just now, so it needs a reload
+    project.broadcastReloadProjectContent();
+    const auto range = project.broadcastChangeProjectBeatRange();
+    project.broadcastChangeViewBeatRange(range.getStart(), range.getEnd());
+
+    // not using project.setEditableScope, which would also try to show the editor page
+    auto *track = project.findChildOfType<PianoTrackNode>();
+    roll.onChangeViewEditableScope(track, *track->getPattern()->getClips().getFirst(), false);
+
+    Image image(Image::RGB, paintWidth, paintHeight, false);
+    const auto paintRoll = [&roll, &viewport, &image]()
+    {
+        Graphics g(image);
+        g.setOrigin(-viewport.getViewPosition());
+        roll.paintEntireComponent(g, false);
+    };
+
+    // 32 beats in the middle of the project, all notes are painted as notes
+    const auto middleBeat = range.getStart() + range.getLength() / 2.f;
+    roll.zoomToArea(minKey, maxKey, middleBeat - 16.f, middleBeat + 16.f);
+    this->measure(results, "paintRoll", 10, paintRoll);
+
+    // zoomed out, so that the notes are painted as density bars
+    roll.setBeatWidth(PianoRoll::densityBarsMaxBeatWidth / 2.f);
+    viewport.setViewPosition(0, viewport.getViewPositionY());
+    this->measure(results, "paintRollDensity", 10, paintRoll);
+}
+
+void ProjectBenchmarks::measure(SerializedData &results, const String &name, int numRuns,
+    Function<void()> operation, Function<void()> setup)
+{
+    using namespace Serialization;
+    jassert(numRuns > 0);
+
+    Array<double> timings;
+    timings.ensureStorageAllocated(numRuns);
+
+    for (int i = 0; i < numRuns; ++i)
+    {
+        if (setup != nullptr)
+        {
+            setup();
+        }
+
+        const auto startTicks = Time::getHighResolutionTicks();
+        operation();
+        const auto endTicks = Time::getHighResolutionTicks();
+
+        timings.add(Time::highResolutionTicksToSeconds(endTicks - startTicks) * 1000.0);
+    }
+
+    timings.sort();
+
+    double totalMs = 0.0;
+    for (const auto ms : timings)
+    {
+        totalMs += ms;
+    }
+
+    const auto medianMs = timings[timings.size() / 2];
+
+    SerializedData benchmark(Benchmarks::benchmark);
+    benchmark.setProperty(Benchmarks::benchmarkName, name);
+    benchmark.setProperty(Benchmarks::numRuns, numRuns);
+    benchmark.setProperty(Benchmarks::minMs, timings.getFirst());
+    benchmark.setProperty(Benchmarks::medianMs, medianMs);
+    benchmark.setProperty(Benchmarks::meanMs, totalMs / double(numRuns));
+    results.appendChild(benchmark);
+
+    this->logMessage(name + ": " + String(medianMs, 3) + " ms");
+}
+
+static ProjectBenchmarks projectBenchmarks;
+
+#endif
@@ -0,0 +1,79 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#if JUCE_UNIT_TESTS
+
+class ProjectNode;
+class Serializer;
+
+// Times the hot paths (playback caches, roll painting, saving and loading,
+// vcs diffs, edits and undos, offline rendering) on synthetic projects of several sizes,
+// and writes the results as json, so that they can be compared between builds.
+// Only runs in the benchmarks build configuration with a headless workspace.
+
+class ProjectBenchmarks final : public UnitTest
+{
+public:
+
+    ProjectBenchmarks();
+
+    void runTest() override;
+
+    struct ProjectSize final
+    {
+        String name;
+        int numPianoTracks;
+        int numNotesPerTrack;
+        int numClipsPerTrack;
+        int numAutomationTracks;
+        int numEventsPerAutomationTrack;
+        int numRevisions;
+    };
+
+private:
+
+    // the presets to run are picked by HELIO_BENCHMARK_PROJECTS
+    // environment variable, e.g. "small,large", defaults to "small,medium"
+    static Array<ProjectSize> getProjectSizes();
+
+    // HELIO_BENCHMARK_RESULTS environment variable, if set,
+    // or benchmarks.json in the current working directory
+    static File getResultsFile();
+
+    static UniquePointer<ProjectNode> createProject(const ProjectSize &size,
+        const File &projectFile);
+
+    SerializedData runBenchmarks(const ProjectSize &size);
+
+    void measureSaveAndLoad(SerializedData &results, const String &formatName,
+        const Serializer &serializer, const ProjectNode &project, const File &file);
+
+    // paints a piano roll showing the project into an image,
+    // zoomed in to the notes, and zoomed out to the density bars
+    void measureRollPainting(SerializedData &results, ProjectNode &project);
+
+    // runs the operation a given number of times, and adds min, median
+    // and mean timings to the results; the optional setup function
+    // is called before each run and isn't included in timings
+    void measure(SerializedData &results, const String &name, int numRuns,
+        Function<void()> operation, Function<void()> setup = nullptr);
+
+};
+
+#endif
@@ -21,6 +21,45 @@
 static const char *kHelioHeaderV2String = "Helio2::";
 static const uint64 kHelioHeaderV2 = ByteOrder::littleEndianInt64(kHelioHeaderV2String);
 
+// v3 may contain the tables of homogeneous nodes, see SerializedData
+static const char *kHelioHeaderV3String = "Helio3::";
+static const uint64 kHelioHeaderV3 = ByteOrder::littleEndianInt64(kHelioHeaderV3String);
+
+// When loading on a background thread, this one stops providing data as soon
+// as the thread is asked to exit, so the deserialization unwinds quickly,
+// and loading a large file can be cancelled halfway
+class BinarySerializerInputStream final : public MemoryInputStream
+{
+public:
+
+    explicit BinarySerializerInputStream(const MemoryBlock &data) :
+        MemoryInputStream(data, false),
+        thread(Thread::getCurrentThread()) {}
+
+    bool isCancelled() const noexcept
+    {
+        return this->thread != nullptr && this->thread->threadShouldExit();
+    }
+
+    int read(void *destBuffer, int maxBytesToRead) override
+    {
+        return this->isCancelled() ? 0 :
+            MemoryInputStream::read(destBuffer, maxBytesToRead);
+    }
+
+    bool isExhausted() override
+    {
+        return this->isCancelled() || MemoryInputStream::isExhausted();
+    }
+
+private:
+
+    // nullptr on the message thread, which is never asked to exit
+    const Thread *const thread;
+
+    JUCE_DECLARE_NON_COPYABLE(BinarySerializerInputStream)
+};
+
 Result BinarySerializer::saveToFile(File file, const SerializedData &tree) const
 {
     FileOutputStream fileStream(file);
@@ -28,7 +67,7 @@ Result BinarySerializer::saveToFile(File file, const SerializedData &tree) const
     {
         fileStream.setPosition(0);
         fileStream.truncate();
-        fileStream.writeInt64(kHelioHeaderV2);
+        fileStream.writeInt64(kHelioHeaderV3);
         tree.writeToStream(fileStream);
         return Result::ok();
     }
@@ -48,11 +87,15 @@ SerializedData BinarySerializer::loadFromFile(const File &file) const
     MemoryBlock mb;
     if (file.loadFileAsData(mb))
     {
-        MemoryInputStream inputStream(mb, false);
+        BinarySerializerInputStream inputStream(mb);
         const auto magicNumber = static_cast<uint64>(inputStream.readInt64());
-        if (magicNumber == kHelioHeaderV2)
+        if (magicNumber == kHelioHeaderV3 || magicNumber == kHelioHeaderV2)
         {
-            return SerializedData::readFromStream(inputStream);
+            auto result = SerializedData::readFromStream(inputStream);
+            if (!inputStream.isCancelled())
+            {
+                return result;
+            }
         }
     }
 
@@ -62,7 +105,7 @@ SerializedData BinarySerializer::loadFromFile(const File &file) const
 Result BinarySerializer::saveToString(String &string, const SerializedData &tree) const
 {
     MemoryOutputStream memStream;
-    memStream.writeInt64(kHelioHeaderV2);
+    memStream.writeInt64(kHelioHeaderV3);
     tree.writeToStream(memStream);
     string = memStream.toUTF8();
     return Result::ok();
@@ -86,5 +129,6 @@ bool BinarySerializer::supportsFileWithExtension(const String &extension) const
 
 bool BinarySerializer::supportsFileWithHeader(const String &header) const
 {
-    return header.startsWith(kHelioHeaderV2String);
+    return header.startsWith(kHelioHeaderV3String) ||
+        header.startsWith(kHelioHeaderV2String);
 }
@@ -197,16 +197,20 @@ File DocumentHelpers::getTempSlot(const String &fileName)
     return getFirstSlot(tempPath, tempPath, fileName);
 }
 
-static const OwnedArray<Serializer> &getSerializers()
+struct Serializers final : OwnedArray<Serializer>
 {
-    static OwnedArray<Serializer> serializers;
-    if (serializers.isEmpty())
+    Serializers()
     {
-        serializers.add(new XmlSerializer());
-        serializers.add(new JsonSerializer());
-        serializers.add(new BinarySerializer());
+        this->add(new XmlSerializer());
+        this->add(new JsonSerializer());
+        this->add(new BinarySerializer());
     }
+};
 
+static const OwnedArray<Serializer> &getSerializers()
+{
+    // initialized once in a thread-safe manner
+    static Serializers serializers;
     return serializers;
 }
 
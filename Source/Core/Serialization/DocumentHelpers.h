@@ -40,7 +40,9 @@ public:
     }
 
     // This tries to auto-detect serializer type
-    // for the given file by extension and return a valid tree
+    // for the given file by extension and return a valid tree;
+    // when called on a background thread, the binary and json serializers
+    // give up and return an invalid tree as soon as the thread is asked to exit
     static SerializedData load(const File &file);
     static SerializedData load(const String &string);
 
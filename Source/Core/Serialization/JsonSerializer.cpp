@@ -22,197 +22,188 @@
 // Json parser
 //===----------------------------------------------------------------------===//
 
-// Slightly modified JSONParser from JUCE classes,
+// A single-pass parser, originally based on JSONParser from JUCE classes,
 // but returns SerializedData instead of var, and supports comments like `//` and `/* */`.
 // Parses arrays and objects as nodes/children, and all others as properties.
+// Works over a raw utf-8 buffer, e.g. a memory-mapped file: all the structural
+// characters are ascii, so only the escape sequences in strings need decoding.
+// When running on a background thread, it stops as soon as the thread is asked
+// to exit, so that loading a large file can be cancelled halfway.
 
-struct JsonParser final
+class JsonParser final
 {
-    static Result parseObjectOrArray(String::CharPointerType t, SerializedData &result)
+public:
+
+    JsonParser(const void *data, size_t numBytes) noexcept :
+        t(static_cast<const char *>(data)),
+        end(static_cast<const char *>(data) + numBytes),
+        thread(Thread::getCurrentThread())
     {
-        skipCommentsAndWhitespaces(t);
+        // skip the utf-8 byte order mark, if any
+        if (numBytes >= 3 && uint8(this->t[0]) == 0xef &&
+            uint8(this->t[1]) == 0xbb && uint8(this->t[2]) == 0xbf)
+        {
+            this->t += 3;
+        }
+    }
 
-        switch (t.getAndAdvance())
+    Result parseObjectOrArray(SerializedData &result)
+    {
+        this->skipCommentsAndWhitespaces();
+
+        switch (this->next())
         {
         case 0:      result = SerializedData(); return Result::ok();
-        case '{':    return parseObject(t, result);
-        case '[':    return parseArray(t, result, result.getType());
+        case '{':    return this->parseObject(result);
+        case '[':    return this->parseArray(result, result.getType());
         }
 
-        return createFail("Expected '{' or '['", &t);
+        return this->createFail("Expected '{' or '['", this->t - 1);
     }
 
-    static Result parseStringProperty(const juce_wchar quoteChar, String::CharPointerType &t, const Identifier &propertyName, SerializedData &tree)
+private:
+
+    const char *t;
+    const char *const end;
+
+    // nullptr on the message thread, which is never asked to exit
+    const Thread *const thread;
+
+    inline bool isCancelled() const noexcept
     {
-        String property;
-        const auto r = parseString(quoteChar, t, property);
-        if (r.wasOk())
-        {
-            tree.setProperty(propertyName, property);
-        }
+        return this->thread != nullptr && this->thread->threadShouldExit();
+    }
 
-        return r;
+    inline char peek() const noexcept
+    {
+        return this->t < this->end ? *this->t : 0;
     }
 
-    static Result parseString(const juce_wchar quoteChar, String::CharPointerType &t, String &result)
+    inline char next() noexcept
     {
-        static MemoryOutputStream buffer(256);
-        buffer.reset();
+        return this->t < this->end ? *this->t++ : 0;
+    }
 
+    static inline bool isWhitespace(char c) noexcept
+    {
+        return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\f' || c == '\v';
+    }
+
+    static inline bool isDigit(char c) noexcept
+    {
+        return c >= '0' && c <= '9';
+    }
+
+    void skipCommentsAndWhitespaces() noexcept
+    {
         for (;;)
         {
-            auto c = t.getAndAdvance();
-
-            if (c == quoteChar)
+            while (this->t < this->end && isWhitespace(*this->t))
             {
-                break;
+                ++this->t;
             }
 
-            if (c == '\\')
+            if (this->peek() != '/' || this->t + 1 >= this->end)
             {
-                c = t.getAndAdvance();
+                return;
+            }
 
-                switch (c)
-                {
-                case '"':
-                case '\'':
-                case '\\':
-                case '/':  break;
-
-                case 'a':  c = '\a'; break;
-                case 'b':  c = '\b'; break;
-                case 'f':  c = '\f'; break;
-                case 'n':  c = '\n'; break;
-                case 'r':  c = '\r'; break;
-                case 't':  c = '\t'; break;
-
-                case 'u':
+            if (this->t[1] == '/')
+            {
+                this->t += 2;
+                while (this->t < this->end && *this->t != '\n' && *this->t != '\r')
                 {
-                    c = 0;
-
-                    for (int i = 4; --i >= 0;)
-                    {
-                        auto digitValue = CharacterFunctions::getHexDigitValue(t.getAndAdvance());
-                        if (digitValue < 0) { return createFail("Syntax error in Unicode escape sequence"); }
-                        c = (juce_wchar)((c << 4) + static_cast<juce_wchar> (digitValue));
-                    }
-
-                    break;
-                }
+                    ++this->t;
                 }
             }
+            else if (this->t[1] == '*')
+            {
+                this->t += 2;
+                while (this->t < this->end &&
+                    !(*this->t == '*' && this->t + 1 < this->end && this->t[1] == '/'))
+                {
+                    ++this->t;
+                }
 
-            if (c == 0) { return createFail("Unexpected end-of-input in string constant"); }
-            buffer.appendUTF8Char(c);
+                this->t = jmin(this->t + 2, this->end);
+            }
+            else
+            {
+                return;
+            }
         }
-
-        result = buffer.toUTF8();
-        return Result::ok();
-    }
-
-    static void findNextNewline(String::CharPointerType &t)
-    {
-        juce_wchar c = 0;
-        do { c = t.getAndAdvance(); } while (c != '\n' && c != '\r');
     }
 
-    static void findEndOfMultilineComment(String::CharPointerType &t)
+    bool skipLiteral(const char *literal) noexcept
     {
-        juce_wchar c1 = 0;
-        juce_wchar c2 = 0;
-        do
-        { 
-            c1 = c2;
-            c2 = t.getAndAdvance();
-            if (c2 == 0) { return; }
-        } while (c1 != '*' || c2 != '/');
-    }
-
-    static void skipCommentsAndWhitespaces(String::CharPointerType &t)
-    {
-        t = t.findEndOfWhitespace();
-        auto t2 = t;
-        switch (t2.getAndAdvance())
+        auto *t2 = this->t;
+        for (; *literal != 0; ++literal, ++t2)
         {
-        case '/':
-            const auto c = t2.getAndAdvance();
-            if (c == '/')
-            {
-                t = t2;
-                findNextNewline(t);
-                skipCommentsAndWhitespaces(t);
-            }
-            else if (c == '*')
+            if (t2 >= this->end || *t2 != *literal)
             {
-                t = t2;
-                findEndOfMultilineComment(t);
-                skipCommentsAndWhitespaces(t);
+                return false;
             }
         }
+
+        this->t = t2;
+        return true;
     }
 
-    static Result parseAny(String::CharPointerType &t, SerializedData &result, const Identifier &nodeOrProperty)
+    Result parseAny(SerializedData &result, const Identifier &nodeOrProperty)
     {
-        skipCommentsAndWhitespaces(t);
-        auto t2 = t;
+        this->skipCommentsAndWhitespaces();
+        const auto *location = this->t;
 
-        switch (t2.getAndAdvance())
+        switch (this->next())
         {
         case '{':
             {
-                t = t2;
                 SerializedData child(nodeOrProperty);
                 result.appendChild(child);
-                return parseObject(t, child);
+                return this->parseObject(child);
             }
 
         case '[':
-            t = t2;
-            return parseArray(t, result, nodeOrProperty);
+            return this->parseArray(result, nodeOrProperty);
 
         case '"':
-            t = t2;
-            return parseStringProperty('"', t, nodeOrProperty, result);
-
         case '\'':
-            t = t2;
-            return parseStringProperty('\'', t, nodeOrProperty, result);
-
-        case '-':
-            skipCommentsAndWhitespaces(t2);
-            if (!CharacterFunctions::isDigit(*t2))
-                break;
+            {
+                String property;
+                const auto r = this->parseString(*location, property);
+                if (r.wasOk())
+                {
+                    result.setProperty(nodeOrProperty, property);
+                }
 
-            t = t2;
-            return parseNumberProperty(t, nodeOrProperty, result, true);
+                return r;
+            }
 
+        case '-':
         case '0': case '1': case '2': case '3': case '4':
         case '5': case '6': case '7': case '8': case '9':
-            return parseNumberProperty(t, nodeOrProperty, result, false);
+            this->t = location;
+            return this->parseNumberProperty(result, nodeOrProperty);
 
-        case 't':   // "true"
-            if (t2.getAndAdvance() == 'r' && t2.getAndAdvance() == 'u' && t2.getAndAdvance() == 'e')
+        case 't':
+            if (this->skipLiteral("rue"))
             {
-                t = t2;
                 result.setProperty(nodeOrProperty, true);
                 return Result::ok();
             }
             break;
 
-        case 'f':   // "false"
-            if (t2.getAndAdvance() == 'a' && t2.getAndAdvance() == 'l'
-                && t2.getAndAdvance() == 's' && t2.getAndAdvance() == 'e')
+        case 'f':
+            if (this->skipLiteral("alse"))
             {
-                t = t2;
                 result.setProperty(nodeOrProperty, false);
                 return Result::ok();
             }
             break;
 
-        case 'n':   // "null"
-            if (t2.getAndAdvance() == 'u' && t2.getAndAdvance() == 'l' && t2.getAndAdvance() == 'l')
+        case 'n':
+            if (this->skipLiteral("ull"))
             {
-                t = t2;
                 // no need to set any property in this case?
                 return Result::ok();
             }
@@ -222,139 +213,444 @@ struct JsonParser final
             break;
         }
 
-        return createFail("Syntax error", &t);
+        return this->createFail("Syntax error", location);
     }
 
-private:
-    static Result createFail(const char *const message, const String::CharPointerType *location = nullptr)
+    Result createFail(const char *const message, const char *location = nullptr) const
     {
         String m(message);
-        if (location != nullptr)
-            m << ": \"" << String(*location, 20) << '"';
+        if (location != nullptr && location < this->end)
+        {
+            m << ": \"" << String::fromUTF8(location, int(jmin<size_t>(20, size_t(this->end - location)))) << '"';
+        }
 
         return Result::fail(m);
     }
 
-    static Result parseNumberProperty(String::CharPointerType &t, const Identifier &propertyName, SerializedData &result, const bool isNegative)
+    //===------------------------------------------------------------------===//
+    // Strings and keys
+    //===------------------------------------------------------------------===//
+
+    // the strings without escape sequences are copied at once,
+    // and the rest are decoded into this buffer
+    MemoryOutputStream stringBuffer { 256 };
+
+    Result parseString(char quoteChar, String &result)
     {
-        auto oldT = t;
+        const auto *start = this->t;
+        while (this->t < this->end)
+        {
+            const auto c = *this->t;
+            if (c == quoteChar)
+            {
+                result = String::fromUTF8(start, int(this->t - start));
+                ++this->t;
+                return Result::ok();
+            }
 
-        int64 intValue = t.getAndAdvance() - '0';
-        jassert(intValue >= 0 && intValue < 10);
+            if (c == '\\')
+            {
+                return this->parseEscapedString(quoteChar, start, result);
+            }
+
+            ++this->t;
+        }
+
+        return this->createFail("Unexpected end-of-input in string constant");
+    }
+
+    bool parseUnicodeEscape(juce_wchar &result) noexcept
+    {
+        result = 0;
+        for (int i = 4; --i >= 0;)
+        {
+            const auto digitValue = CharacterFunctions::getHexDigitValue(juce_wchar(uint8(this->next())));
+            if (digitValue < 0)
+            {
+                return false;
+            }
+
+            result = juce_wchar((result << 4) + static_cast<juce_wchar>(digitValue));
+        }
+
+        return true;
+    }
+
+    Result parseEscapedString(char quoteChar, const char *start, String &result)
+    {
+        this->stringBuffer.reset();
+        this->stringBuffer.write(start, size_t(this->t - start));
 
         for (;;)
         {
-            auto previousChar = t;
-            auto c = t.getAndAdvance();
-            auto digit = ((int)c) - '0';
+            if (this->t >= this->end)
+            {
+                return this->createFail("Unexpected end-of-input in string constant");
+            }
 
-            if (isPositiveAndBelow(digit, 10))
+            const auto c = *this->t++;
+
+            if (c == quoteChar)
             {
-                intValue = intValue * 10 + digit;
-                continue;
+                break;
             }
 
-            if (c == 'e' || c == 'E' || c == '.')
+            if (c != '\\')
             {
-                t = oldT;
-                auto asDouble = CharacterFunctions::readDoubleValue(t);
-                result.setProperty(propertyName, isNegative ? -asDouble : asDouble);
-                return Result::ok();
+                this->stringBuffer.writeByte(c);
+                continue;
             }
 
-            if (CharacterFunctions::isWhitespace(c)
-                || c == ',' || c == '}' || c == ']' || c == 0)
+            const auto e = this->next();
+            switch (e)
+            {
+            case 0:    return this->createFail("Unexpected end-of-input in string constant");
+            case 'a':  this->stringBuffer.writeByte('\a'); break;
+            case 'b':  this->stringBuffer.writeByte('\b'); break;
+            case 'f':  this->stringBuffer.writeByte('\f'); break;
+            case 'n':  this->stringBuffer.writeByte('\n'); break;
+            case 'r':  this->stringBuffer.writeByte('\r'); break;
+            case 't':  this->stringBuffer.writeByte('\t'); break;
+
+            case 'u':
             {
-                t = previousChar;
+                juce_wchar unicodeChar = 0;
+                if (!this->parseUnicodeEscape(unicodeChar))
+                {
+                    return this->createFail("Syntax error in Unicode escape sequence");
+                }
+
+                // the formatter writes the characters outside of the basic
+                // multilingual plane as utf-16 surrogate pairs:
+                if (unicodeChar >= 0xd800 && unicodeChar <= 0xdbff &&
+                    this->t + 1 < this->end && this->t[0] == '\\' && this->t[1] == 'u')
+                {
+                    const auto *surrogateStart = this->t;
+                    this->t += 2;
+
+                    juce_wchar lowSurrogate = 0;
+                    if (this->parseUnicodeEscape(lowSurrogate) &&
+                        lowSurrogate >= 0xdc00 && lowSurrogate <= 0xdfff)
+                    {
+                        unicodeChar = 0x10000 + ((unicodeChar - 0xd800) << 10) + (lowSurrogate - 0xdc00);
+                    }
+                    else
+                    {
+                        this->t = surrogateStart;
+                    }
+                }
+
+                this->stringBuffer.appendUTF8Char(unicodeChar);
                 break;
             }
 
-            return createFail("Syntax error in number", &oldT);
+            default:
+                // quotes, slashes, and anything else escaped for no reason
+                this->stringBuffer.writeByte(e);
+                break;
+            }
         }
 
-        auto correctedValue = isNegative ? -intValue : intValue;
+        result = String::fromUTF8(static_cast<const char *>(this->stringBuffer.getData()),
+            int(this->stringBuffer.getDataSize()));
+
+        return Result::ok();
+    }
+
+    // all the objects of the same kind have the same keys, so each key
+    // is only looked up in the global identifiers pool once per file
+    struct KeyTable final
+    {
+        struct Entry final
+        {
+            const char *data = nullptr;
+            int size = 0;
+            uint32 hash = 0;
+            Identifier key;
+        };
+
+        Array<Entry> entries;
+        int numEntries = 0;
 
-        if ((intValue >> 31) != 0)
-            result.setProperty(propertyName, correctedValue);
+        Identifier get(const char *data, int size)
+        {
+            uint32 hash = 2166136261u; // fnv-1a
+            for (int i = 0; i < size; ++i)
+            {
+                hash = (hash ^ uint8(data[i])) * 16777619u;
+            }
+
+            if ((this->numEntries + 1) * 2 > this->entries.size())
+            {
+                this->rehash(jmax(64, this->entries.size() * 2));
+            }
+
+            const auto mask = uint32(this->entries.size() - 1);
+            for (auto i = hash & mask;; i = (i + 1) & mask)
+            {
+                auto &entry = this->entries.getReference(int(i));
+                if (entry.data == nullptr)
+                {
+                    entry.data = data;
+                    entry.size = size;
+                    entry.hash = hash;
+                    entry.key = Identifier(String::fromUTF8(data, size));
+                    this->numEntries++;
+                    return entry.key;
+                }
+
+                if (entry.hash == hash && entry.size == size &&
+                    memcmp(entry.data, data, size_t(size)) == 0)
+                {
+                    return entry.key;
+                }
+            }
+        }
+
+        void rehash(int newSize)
+        {
+            Array<Entry> oldEntries;
+            oldEntries.swapWith(this->entries);
+            this->entries.resize(newSize);
+
+            const auto mask = uint32(newSize - 1);
+            for (const auto &entry : oldEntries)
+            {
+                if (entry.data != nullptr)
+                {
+                    auto i = entry.hash & mask;
+                    while (this->entries.getReference(int(i)).data != nullptr)
+                    {
+                        i = (i + 1) & mask;
+                    }
+
+                    this->entries.setUnchecked(int(i), entry);
+                }
+            }
+        }
+    };
+
+    KeyTable keys;
+
+    Result parseKey(Identifier &result)
+    {
+        const auto *start = this->t;
+        while (this->t < this->end && *this->t != '"' && *this->t != '\\')
+        {
+            ++this->t;
+        }
+
+        if (this->peek() == '"')
+        {
+            const auto size = int(this->t - start);
+            ++this->t;
+            result = size > 0 ? this->keys.get(start, size) : Identifier();
+            return Result::ok();
+        }
+
+        // escaped characters in the key, which is hardly ever the case
+        String key;
+        this->t = start;
+        const auto r = this->parseString('"', key);
+        if (r.wasOk() && key.isNotEmpty())
+        {
+            result = Identifier(key);
+        }
+
+        return r;
+    }
+
+    //===------------------------------------------------------------------===//
+    // Numbers
+    //===------------------------------------------------------------------===//
+
+    Result parseNumberProperty(SerializedData &result, const Identifier &propertyName)
+    {
+        static const double powersOf10[] = {
+            1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+        const auto *start = this->t;
+        const bool isNegative = this->peek() == '-';
+        if (isNegative)
+        {
+            ++this->t;
+        }
+
+        uint64 mantissa = 0;
+        int numDigits = 0;
+        int exponent = 0;
+        bool isInteger = true;
+
+        while (isDigit(this->peek()))
+        {
+            mantissa = mantissa * 10 + uint64(*this->t++ - '0');
+            numDigits++;
+        }
+
+        if (numDigits == 0)
+        {
+            return this->createFail("Syntax error in number", start);
+        }
+
+        if (this->peek() == '.')
+        {
+            isInteger = false;
+            ++this->t;
+
+            while (isDigit(this->peek()))
+            {
+                mantissa = mantissa * 10 + uint64(*this->t++ - '0');
+                numDigits++;
+                exponent--;
+            }
+        }
+
+        if (this->peek() == 'e' || this->peek() == 'E')
+        {
+            isInteger = false;
+            ++this->t;
+
+            const bool isNegativeExponent = this->peek() == '-';
+            if (isNegativeExponent || this->peek() == '+')
+            {
+                ++this->t;
+            }
+
+            int explicitExponent = 0;
+            while (isDigit(this->peek()))
+            {
+                explicitExponent = jmin(explicitExponent * 10 + (*this->t++ - '0'), 100000);
+            }
+
+            exponent += isNegativeExponent ? -explicitExponent : explicitExponent;
+        }
+
+        // a comment can follow a number with no whitespace in between
+        const auto c = this->peek();
+        if (!isWhitespace(c) && c != ',' && c != '}' && c != ']' && c != '/' && c != 0)
+        {
+            return this->createFail("Syntax error in number", start);
+        }
+
+        if (isInteger && numDigits <= 18)
+        {
+            const auto value = isNegative ? -int64(mantissa) : int64(mantissa);
+            if ((mantissa >> 31) != 0)
+            {
+                result.setProperty(propertyName, value);
+            }
+            else
+            {
+                result.setProperty(propertyName, int(value));
+            }
+
+            return Result::ok();
+        }
+
+        // the mantissa and the power of 10 are both exact here,
+        // so a single multiplication or division is correctly rounded
+        if (!isInteger && numDigits <= 15 && exponent >= -22 && exponent <= 22)
+        {
+            const auto value = exponent < 0 ?
+                double(mantissa) / powersOf10[-exponent] :
+                double(mantissa) * powersOf10[exponent];
+
+            result.setProperty(propertyName, isNegative ? -value : value);
+            return Result::ok();
+        }
+
+        const auto number = String::fromUTF8(start, int(this->t - start));
+        if (isInteger)
+        {
+            result.setProperty(propertyName, number.getLargeIntValue());
+        }
         else
-            result.setProperty(propertyName, (int)correctedValue);
+        {
+            result.setProperty(propertyName, number.getDoubleValue());
+        }
 
         return Result::ok();
     }
 
-    static Result parseObject(String::CharPointerType &t, SerializedData &result)
+    //===------------------------------------------------------------------===//
+    // Objects and arrays
+    //===------------------------------------------------------------------===//
+
+    Result parseObject(SerializedData &result)
     {
         for (;;)
         {
-            skipCommentsAndWhitespaces(t);
+            if (this->isCancelled()) { return Result::fail("Cancelled"); }
 
-            auto oldT = t;
-            auto c = t.getAndAdvance();
+            this->skipCommentsAndWhitespaces();
+
+            const auto *location = this->t;
+            const auto c = this->next();
 
             if (c == '}') { break; }
-            if (c == 0) { return createFail("Unexpected end-of-input in object declaration"); }
+            if (c == 0) { return this->createFail("Unexpected end-of-input in object declaration"); }
             if (c == '"')
             {
-                String nodeNameVar;
-                const auto r = parseString('"', t, nodeNameVar);
+                Identifier nodeName;
+                const auto r = this->parseKey(nodeName);
                 if (r.failed()) { return r; }
 
-                const Identifier nodeName(nodeNameVar);
                 if (nodeName.isValid())
                 {
-                    skipCommentsAndWhitespaces(t);
-                    oldT = t;
+                    this->skipCommentsAndWhitespaces();
+                    location = this->t;
 
-                    auto c2 = t.getAndAdvance();
+                    if (this->next() != ':') { return this->createFail("Expected ':', but found", location); }
 
-                    if (c2 != ':') { return createFail("Expected ':', but found", &oldT); }
-
-                    const auto r2 = parseAny(t, result, nodeName);
+                    const auto r2 = this->parseAny(result, nodeName);
                     if (r2.failed()) { return r2; }
 
-                    skipCommentsAndWhitespaces(t);
-                    oldT = t;
+                    this->skipCommentsAndWhitespaces();
+                    location = this->t;
 
-                    auto nextChar = t.getAndAdvance();
+                    const auto nextChar = this->next();
                     if (nextChar == ',') { continue; }
                     if (nextChar == '}') { break; }
                 }
             }
 
-            return createFail("Expected object member declaration, but found", &oldT);
+            return this->createFail("Expected object member declaration, but found", location);
         }
 
         return Result::ok();
     }
 
-    static Result parseArray(String::CharPointerType &t, SerializedData &result, const Identifier &nodeName)
+    Result parseArray(SerializedData &result, const Identifier &nodeName)
     {
         for (;;)
         {
-            skipCommentsAndWhitespaces(t);
+            if (this->isCancelled()) { return Result::fail("Cancelled"); }
 
-            auto oldT = t;
-            auto c = t.getAndAdvance();
+            this->skipCommentsAndWhitespaces();
 
-            if (c == ']') { break; }
-            if (c == 0) { return createFail("Unexpected end-of-input in array declaration"); }
+            const auto *location = this->t;
+            const auto c = this->peek();
 
-            t = oldT;
-            auto r = parseAny(t, result, nodeName);
+            if (c == ']') { ++this->t; break; }
+            if (c == 0) { return this->createFail("Unexpected end-of-input in array declaration"); }
 
+            const auto r = this->parseAny(result, nodeName);
             if (r.failed()) { return r; }
 
-            skipCommentsAndWhitespaces(t);
-            oldT = t;
+            this->skipCommentsAndWhitespaces();
+            location = this->t;
 
-            auto nextChar = t.getAndAdvance();
+            const auto nextChar = this->next();
             if (nextChar == ',') { continue; }
             if (nextChar == ']') { break; }
-            return createFail("Expected object array item, but found", &oldT);
+            return this->createFail("Expected object array item, but found", location);
         }
 
         return Result::ok();
     }
+
+    JUCE_DECLARE_NON_COPYABLE(JsonParser)
 };
 
 //===----------------------------------------------------------------------===//
@@ -394,7 +690,7 @@ struct JsonFormatter final
 
         if (!oneLine) { writeSpaces(out, indentLevel + indentSize); }
         out << '"';
-        writeString(out, tree.getType());
+        writeString(out, tree.getType().getCharPointer());
         out << "\": ";
         writeObject(out, tree, indentLevel + indentSize, oneLine, maximumDecimalPlaces);
 
@@ -412,13 +708,13 @@ struct JsonFormatter final
         const int numChildren = tree.getNumChildren();
         for (int i = 0; i < numProperties; ++i)
         {
-            const auto propertyName(tree.getPropertyName(i));
+            const auto propertyName = tree.getPropertyName(i);
 
             if (!allOnOneLine) { writeSpaces(out, indentLevel + indentSize); }
             out << '"';
-            writeString(out, propertyName);
+            writeString(out, propertyName.getCharPointer());
             out << "\": ";
-            writeProperty(out, tree.getProperty(propertyName), maximumDecimalPlaces);
+            writeProperty(out, tree.getPropertyValue(i), maximumDecimalPlaces);
 
             const bool shouldHaveComma = i < numProperties - 1 || numChildren > 0;
             if (shouldHaveComma)
@@ -431,6 +727,13 @@ struct JsonFormatter final
             }
         }
 
+        if (numChildren == 0)
+        {
+            if (!allOnOneLine) { writeSpaces(out, indentLevel); }
+            out << '}';
+            return;
+        }
+
         using GroupedChildren = FlatHashMap<Identifier, Array<SerializedData>, IdentifierHash>;
         GroupedChildren children;
         for (const auto &child : tree)
@@ -455,7 +758,7 @@ struct JsonFormatter final
             }
 
             out << '"';
-            writeString(out, childrenType);
+            writeString(out, childrenType.getCharPointer());
             out << "\": ";
 
             if (childGroupOfSameType.size() == 1)
@@ -509,7 +812,7 @@ struct JsonFormatter final
         }
         else if (v.isInt() || v.isInt64())
         {
-            out << v.toString();
+            writeInteger(out, static_cast<int64>(v));
         }
         else if (v.isDouble())
         {
@@ -528,10 +831,50 @@ struct JsonFormatter final
         out << "\\u" << String::toHexString((int)value).paddedLeft('0', 4);
     }
 
+    static void writeInteger(OutputStream &out, int64 value)
+    {
+        char buffer[24];
+        auto *end = buffer + numElementsInArray(buffer);
+        auto *start = end;
+
+        auto absValue = value < 0 ? uint64(-(value + 1)) + 1 : uint64(value);
+        do
+        {
+            *--start = char('0' + absValue % 10);
+            absValue /= 10;
+        } while (absValue > 0);
+
+        if (value < 0)
+        {
+            *--start = '-';
+        }
+
+        out.write(start, size_t(end - start));
+    }
+
+    static inline bool needsEscaping(char c) noexcept
+    {
+        return c < 32 || c >= 127 || c == '\"' || c == '\\';
+    }
+
     static void writeString(OutputStream &out, String::CharPointerType t)
     {
         for (;;)
         {
+            // write the runs of plain ascii characters at once
+            const auto *run = t.getAddress();
+            auto *runEnd = run;
+            while (*runEnd != 0 && !needsEscaping(*runEnd))
+            {
+                ++runEnd;
+            }
+
+            if (runEnd != run)
+            {
+                out.write(run, size_t(runEnd - run));
+                t = String::CharPointerType(runEnd);
+            }
+
             auto c = t.getAndAdvance();
 
             switch (c)
@@ -632,7 +975,8 @@ void JsonSerializer::setHeaderComments(StringArray comments) noexcept
 
 Result JsonSerializer::saveToFile(File file, const SerializedData &tree) const
 {
-    FileOutputStream fileStream(file);
+    static constexpr auto bufferSize = 1 << 16;
+    FileOutputStream fileStream(file, bufferSize);
     if (fileStream.openedOk())
     {
         fileStream.setPosition(0);
@@ -647,9 +991,24 @@ Result JsonSerializer::saveToFile(File file, const SerializedData &tree) const
 
 SerializedData JsonSerializer::loadFromFile(const File &file) const
 {
-    const String text(file.loadFileAsString());
     SerializedData root(fakeRoot);
-    const auto result = JsonParser::parseObjectOrArray(text.getCharPointer(), root);
+    auto result = Result::fail("Failed to load");
+
+    const MemoryMappedFile mappedFile(file, MemoryMappedFile::readOnly);
+    if (mappedFile.getData() != nullptr)
+    {
+        JsonParser parser(mappedFile.getData(), mappedFile.getSize());
+        result = parser.parseObjectOrArray(root);
+    }
+    else
+    {
+        // e.g. empty files cannot be mapped
+        MemoryBlock data;
+        file.loadFileAsData(data);
+        JsonParser parser(data.getData(), data.getSize());
+        result = parser.parseObjectOrArray(root);
+    }
+
     if (result.wasOk())
     {
         return root.getChild(0);
@@ -669,7 +1028,8 @@ Result JsonSerializer::saveToString(String &string, const SerializedData &tree)
 SerializedData JsonSerializer::loadFromString(const String &string) const
 {
     SerializedData root(fakeRoot);
-    const auto result = JsonParser::parseObjectOrArray(string.getCharPointer(), root);
+    JsonParser parser(string.toRawUTF8(), string.getNumBytesAsUTF8());
+    const auto result = parser.parseObjectOrArray(root);
     if (result.wasOk())
     {
         if (root.getNumChildren() == 1 && root.getNumProperties() == 0)
@@ -697,3 +1057,81 @@ bool JsonSerializer::supportsFileWithHeader(const String &header) const
     // Enough for all our cases:
     return header.startsWithChar('[') || header.startsWithChar('{');
 }
+
+//===----------------------------------------------------------------------===//
+// Tests
+//===----------------------------------------------------------------------===//
+
+#if JUCE_UNIT_TESTS
+
+class JsonSerializerTests final : public UnitTest
+{
+public:
+
+    JsonSerializerTests() : UnitTest("Json serializer tests", UnitTestCategories::helio) {}
+
+    void runTest() override
+    {
+        static const Identifier trackType = "track";
+        static const Identifier noteType = "note";
+        static const Identifier nameProperty = "name";
+        static const Identifier keyProperty = "key";
+        static const Identifier valueProperty = "value";
+        static const Identifier flagProperty = "flag";
+
+        beginTest("Parse comments, numbers and escaped strings");
+
+        const JsonSerializer serializer;
+        const auto parsed = serializer.loadFromString(
+            "{ /* header\n comment */ \"track\": {\n"
+            "  // a line comment\n"
+            "  \"name\": \"Tab\\tquote\\\" \\u00e9 \\ud83c\\udfb5\",\n"
+            "  \"flag\": true,\n"
+            "  \"note\": [\n"
+            "    { \"key\": -12, \"value\": 0.25 },\n"
+            "    { \"key\": 3000000000, \"value\": -1.5e-3 }\n"
+            "  ]\n"
+            "} }");
+
+        expect(parsed.hasType(trackType));
+        expectEquals(parsed.getProperty(nameProperty).toString(),
+            String(CharPointer_UTF8("Tab\tquote\" \xc3\xa9 \xf0\x9f\x8e\xb5")));
+        expect(bool(parsed.getProperty(flagProperty)));
+        expectEquals(parsed.getNumChildren(), 2);
+
+        const auto note1 = parsed.getChild(0);
+        expect(note1.hasType(noteType));
+        expect(note1.getProperty(keyProperty).isInt());
+        expectEquals(int(note1.getProperty(keyProperty)), -12);
+        expectEquals(double(note1.getProperty(valueProperty)), 0.25);
+
+        const auto note2 = parsed.getChild(1);
+        expect(note2.getProperty(keyProperty).isInt64());
+        expectEquals(int64(note2.getProperty(keyProperty)), int64(3000000000));
+        expectEquals(double(note2.getProperty(valueProperty)), -1.5e-3);
+
+        beginTest("Parse comments right after numbers");
+
+        const auto commented = serializer.loadFromString(
+            "{ \"note\": { \"key\": 1// the key\n, \"value\": 2/* the value */ } }");
+
+        expect(commented.hasType(noteType));
+        expectEquals(int(commented.getProperty(keyProperty)), 1);
+        expectEquals(int(commented.getProperty(valueProperty)), 2);
+
+        beginTest("Save and load round trip");
+
+        String saved;
+        expect(serializer.saveToString(saved, parsed).wasOk());
+        expect(serializer.loadFromString(saved).isEquivalentTo(parsed));
+
+        beginTest("Malformed input");
+
+        expect(!serializer.loadFromString("{ \"track\": { \"key\": 1- } }").isValid());
+        expect(!serializer.loadFromString("{ \"track\": { \"name\": \"unterminated").isValid());
+    }
+};
+
+static JsonSerializerTests jsonSerializerTests;
+
+#endif
@@ -176,6 +176,16 @@ namespace Serialization
         static const Identifier pluginNumInputs = "numInputs";
         static const Identifier pluginNumOutputs = "numOutputs";
 
+        static const Identifier pluginsScanCache = "scanCache";
+        static const Identifier scannedFile = "scannedFile";
+        static const Identifier scannedFilePath = "path";
+        static const Identifier scannedFileModTime = "fileTime";
+        static const Identifier scannedFileSize = "fileSize";
+        static const Identifier scannedFileNumTypes = "numTypes";
+        static const Identifier lastScanNumChecked = "lastScanChecked";
+        static const Identifier lastScanNumCached = "lastScanCached";
+        static const Identifier lastScanDurationMs = "lastScanTimeMs";
+
         static const Identifier midiInputName = "midiInputName";
         static const Identifier midiInputId = "midiInputId";
         static const Identifier midiInputReadjusting = "midiInputReadjusting";
@@ -209,6 +219,27 @@ namespace Serialization
             static const Identifier filePath = "filePath";
             static const Identifier programIndex = "programIndex";
         } // namespace SoundFont
+
+        namespace Load
+        {
+            static const Identifier audioLoad = "audioLoad";
+            static const Identifier appVersion = "version";
+            static const Identifier timestamp = "timestamp";
+            static const Identifier deviceCpuUsage = "deviceCpuUsage";
+            static const Identifier deviceXruns = "deviceXruns";
+            static const Identifier numBlocks = "numBlocks";
+            static const Identifier numOverruns = "numOverruns";
+            static const Identifier averageLoad = "averageLoad";
+            static const Identifier peakLoad = "peakLoad";
+            static const Identifier numDroppedMidiMessages = "droppedMidiMessages";
+            static const Identifier histogramBin = "histogramBin";
+            static const Identifier histogramBinMaxLoad = "maxLoad";
+            static const Identifier histogramBinCount = "count";
+            static const Identifier block = "block";
+            static const Identifier blockStartTime = "startTimeMs";
+            static const Identifier blockElapsedTime = "elapsedMs";
+            static const Identifier blockLoad = "load";
+        } // namespace Load
     } // namespace Audio
 
     namespace Config
@@ -219,6 +250,7 @@ namespace Serialization
         static const Identifier activeUiFlags = "activeUiFlags";
         static const Identifier currentLocale = "currentLocale";
         static const Identifier checkForUpdates = "checkForUpdates";
+        static const Identifier pluginScanProcesses = "pluginScanProcesses";
 
         static const Identifier lastShownPageId = "lastShownPageId";
         static const Identifier lastUsedScale = "lastUsedScale";
@@ -239,6 +271,10 @@ namespace Serialization
         static const Identifier colourSchemes = "colourSchemes";
         static const Identifier hotkeySchemes = "hotkeySchemes";
         static const Identifier keyboardMappings = "keyboardMappings";
+
+        // parsed resources cache
+        static const Identifier cache = "cache";
+        static const Identifier cacheKey = "key";
     }
 
     namespace UI
@@ -470,6 +506,13 @@ namespace Serialization
         static const Identifier deltaTypeId = "type";
 
         static const Identifier headStateDelta = "headState";
+        static const Identifier deltaDataKey = "dataKey";
+
+        static const Identifier blobStorage = "blobs";
+        static const Identifier blob = "blob";
+        static const Identifier blobChunk = "chunk";
+        static const Identifier blobChunks = "chunks";
+        static const Identifier blobKey = "key";
 
         namespace ProjectInfoDeltas
         {
@@ -665,6 +708,9 @@ namespace Serialization
         static const Identifier noteAfter = "noteAfter";
         static const Identifier groupBefore = "groupBefore";
         static const Identifier groupAfter = "groupAfter";
+        static const Identifier packedGroup = "packedGroup";
+        static const Identifier packedGroupBefore = "packedGroupBefore";
+        static const Identifier packedGroupDelta = "packedGroupDelta";
         static const Identifier instanceBefore = "instanceBefore";
         static const Identifier instanceAfter = "instanceAfter";
 
@@ -715,4 +761,30 @@ namespace Serialization
 
         static const Identifier projectTemperamentChangeAction = "temperamentChange";
     } // namespace Undo
+
+    namespace Benchmarks
+    {
+        static const Identifier benchmarks = "benchmarks";
+        static const Identifier appVersion = "version";
+        static const Identifier timestamp = "timestamp";
+
+        static const Identifier project = "project";
+        static const Identifier projectName = "name";
+        static const Identifier numPianoTracks = "pianoTracks";
+        static const Identifier numNotesPerTrack = "notesPerTrack";
+        static const Identifier numClipsPerTrack = "clipsPerTrack";
+        static const Identifier numAutomationTracks = "automationTracks";
+        static const Identifier numEventsPerAutomationTrack = "eventsPerAutomationTrack";
+        static const Identifier numRevisions = "revisions";
+        static const Identifier fileSizePrefix = "fileSize"; // followed by the format name
+        static const Identifier blobChunkEvents = "blobChunkEvents";
+        static const Identifier blobAssembledEvents = "blobAssembledEvents";
+
+        static const Identifier benchmark = "benchmark";
+        static const Identifier benchmarkName = "name";
+        static const Identifier numRuns = "runs";
+        static const Identifier minMs = "minMs";
+        static const Identifier medianMs = "medianMs";
+        static const Identifier meanMs = "meanMs";
+    } // namespace Benchmarks
 }  // namespace Serialization
@@ -18,6 +18,128 @@
 #include "Common.h"
 #include "SerializedData.h"
 
+// Most of the nodes are events with a handful of properties each,
+// so the first few properties are kept in place, which saves an allocation
+// per node; the names are pooled identifiers, compared by pointers
+
+class SerializedProperties final
+{
+public:
+
+    SerializedProperties() = default;
+
+    inline int size() const noexcept
+    {
+        return this->numProperties;
+    }
+
+    inline const Identifier &getName(int index) const noexcept
+    {
+        return this->get(index).name;
+    }
+
+    inline const var &getValueAt(int index) const noexcept
+    {
+        return this->get(index).value;
+    }
+
+    const var *find(const Identifier &name) const noexcept
+    {
+        for (int i = 0; i < this->numProperties; ++i)
+        {
+            const auto &property = this->get(i);
+            if (property.name == name)
+            {
+                return &property.value;
+            }
+        }
+
+        return nullptr;
+    }
+
+    void set(const Identifier &name, const var &value)
+    {
+        for (int i = 0; i < this->numProperties; ++i)
+        {
+            auto &property = this->get(i);
+            if (property.name == name)
+            {
+                property.value = value;
+                return;
+            }
+        }
+
+        if (this->numProperties < SerializedProperties::numSlots)
+        {
+            auto &slot = this->slots[this->numProperties];
+            slot.name = name;
+            slot.value = value;
+        }
+        else
+        {
+            this->overflow.add({ name, value });
+        }
+
+        this->numProperties++;
+    }
+
+    // the order of properties doesn't matter here
+    bool operator== (const SerializedProperties &other) const noexcept
+    {
+        if (this->numProperties != other.numProperties)
+        {
+            return false;
+        }
+
+        for (int i = 0; i < this->numProperties; ++i)
+        {
+            const auto &property = this->get(i);
+            const auto *otherValue = (other.getName(i) == property.name) ?
+                &other.getValueAt(i) : other.find(property.name);
+
+            if (otherValue == nullptr || *otherValue != property.value)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool operator!= (const SerializedProperties &other) const noexcept
+    {
+        return !(*this == other);
+    }
+
+private:
+
+    struct Property final
+    {
+        Identifier name;
+        var value;
+    };
+
+    inline Property &get(int index) noexcept
+    {
+        jassert(index < this->numProperties);
+        return index < SerializedProperties::numSlots ?
+            this->slots[index] : this->overflow.getReference(index - SerializedProperties::numSlots);
+    }
+
+    inline const Property &get(int index) const noexcept
+    {
+        jassert(index < this->numProperties);
+        return index < SerializedProperties::numSlots ?
+            this->slots[index] : this->overflow.getReference(index - SerializedProperties::numSlots);
+    }
+
+    // enough for any of the events
+    static constexpr auto numSlots = 6;
+    Property slots[numSlots];
+    Array<Property> overflow;
+    int numProperties = 0;
+};
+
 class SerializedData::SharedData final : public ReferenceCountedObject
 {
 public:
@@ -124,7 +246,11 @@ public:
     XmlElement *createXml() const
     {
         auto *xml = new XmlElement(this->type);
-        this->properties.copyToXmlAttributes(*xml);
+        for (int i = 0; i < this->properties.size(); ++i)
+        {
+            xml->setAttribute(this->properties.getName(i),
+                this->properties.getValueAt(i).toString());
+        }
 
         for (auto i = this->children.size(); --i >= 0;)
         {
@@ -145,6 +271,12 @@ public:
             this->properties.getValueAt(j).writeToStream(output);
         }
 
+        if (this->canWriteChildrenAsTable())
+        {
+            this->writeChildrenAsTable(output);
+            return;
+        }
+
         output.writeCompressedInt(this->children.size());
 
         for (auto *c : this->children)
@@ -153,6 +285,90 @@ public:
         }
     }
 
+    // a long list of the same type nodes, which have no children,
+    // like notes or automation events, is written as a table:
+    // the type and the property names are only written once,
+    // and each row is a mask of present columns plus the values;
+    // the negative number of children marks the table
+
+    static constexpr auto minTableRows = 8;
+    static constexpr auto maxTableColumns = 31;
+
+    bool canWriteChildrenAsTable() const noexcept
+    {
+        if (this->children.size() < SharedData::minTableRows)
+        {
+            return false;
+        }
+
+        const auto &rowType = this->children.getObjectPointerUnchecked(0)->type;
+        for (const auto *c : this->children)
+        {
+            if (c->type != rowType || !c->children.isEmpty() ||
+                c->properties.size() > SharedData::maxTableColumns)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    void writeChildrenAsTable(OutputStream &output) const
+    {
+        Array<Identifier> columns;
+        for (const auto *c : this->children)
+        {
+            for (int i = 0; i < c->properties.size(); ++i)
+            {
+                columns.addIfNotAlreadyThere(c->properties.getName(i));
+            }
+        }
+
+        if (columns.size() > SharedData::maxTableColumns)
+        {
+            // too sparse to be a table, fallback to the regular format
+            output.writeCompressedInt(this->children.size());
+            for (auto *c : this->children)
+            {
+                writeObjectToStream(output, c);
+            }
+
+            return;
+        }
+
+        output.writeCompressedInt(-this->children.size());
+        output.writeString(this->children.getObjectPointerUnchecked(0)->type.toString());
+        output.writeCompressedInt(columns.size());
+
+        for (const auto &column : columns)
+        {
+            output.writeString(column.toString());
+        }
+
+        for (const auto *c : this->children)
+        {
+            int mask = 0;
+            for (int i = 0; i < columns.size(); ++i)
+            {
+                if (c->properties.find(columns.getReference(i)) != nullptr)
+                {
+                    mask |= (1 << i);
+                }
+            }
+
+            output.writeCompressedInt(mask);
+
+            for (int i = 0; i < columns.size(); ++i)
+            {
+                if (const auto *value = c->properties.find(columns.getReference(i)))
+                {
+                    value->writeToStream(output);
+                }
+            }
+        }
+    }
+
     static void writeObjectToStream(OutputStream &output, const SharedData *data)
     {
         if (data != nullptr)
@@ -168,7 +384,7 @@ public:
     }
 
     const Identifier type;
-    NamedValueSet properties;
+    SerializedProperties properties;
     ReferenceCountedArray<SharedData> children;
     SharedData *parent = nullptr;
 
@@ -211,6 +427,11 @@ bool SerializedData::operator!= (const SerializedData &other) const noexcept
     return this->data != other.data;
 }
 
+HashCode SerializedData::IdentityHash::operator()(const SerializedData &key) const noexcept
+{
+    return std::hash<const void *>()(key.data.get());
+}
+
 bool SerializedData::isEquivalentTo(const SerializedData &other) const
 {
     return this->data == other.data
@@ -260,13 +481,24 @@ SerializedData SerializedData::getParent() const noexcept
 const var &SerializedData::getProperty(const Identifier &name) const noexcept
 {
     jassert(this->data != nullptr);
-    return this->data->properties[name];
+    if (const auto *value = this->data->properties.find(name))
+    {
+        return *value;
+    }
+
+    static const var nullValue;
+    return nullValue;
 }
 
 var SerializedData::getProperty(const Identifier &name, const var &defaultValue) const
 {
     jassert(this->data != nullptr);
-    return this->data->properties.getWithDefault(name, defaultValue);
+    if (const auto *value = this->data->properties.find(name))
+    {
+        return *value;
+    }
+
+    return defaultValue;
 }
 
 SerializedData &SerializedData::setProperty(const Identifier &name, const var &newValue)
@@ -279,7 +511,7 @@ SerializedData &SerializedData::setProperty(const Identifier &name, const var &n
 
 bool SerializedData::hasProperty(const Identifier &name) const noexcept
 {
-    return this->data != nullptr && this->data->properties.contains(name);
+    return this->data != nullptr && this->data->properties.find(name) != nullptr;
 }
 
 int SerializedData::getNumProperties() const noexcept
@@ -293,6 +525,12 @@ Identifier SerializedData::getPropertyName(int index) const noexcept
     return this->data->properties.getName(index);
 }
 
+const var &SerializedData::getPropertyValue(int index) const noexcept
+{
+    jassert(this->data != nullptr);
+    return this->data->properties.getValueAt(index);
+}
+
 int SerializedData::getNumChildren() const noexcept
 {
     return this->data == nullptr ? 0 : this->data->children.size();
@@ -371,7 +609,11 @@ SerializedData SerializedData::readFromXml(const XmlElement &xml)
     if (!xml.isTextElement())
     {
         SerializedData v(xml.getTagName());
-        v.data->properties.setFromXmlAttributes(xml);
+        for (int i = 0; i < xml.getNumAttributes(); ++i)
+        {
+            v.data->properties.set(xml.getAttributeName(i),
+                var(xml.getAttributeValue(i)));
+        }
 
         for (auto *child : xml.getChildIterator())
         {
@@ -395,8 +637,9 @@ inline static Identifier readIdentifier(InputStream &input)
     // avoid re-allocating a buffer *every* time we read an object or property type
     // (using JUCE's readString() on deserialization sucks really hard);
     // also preallocated size of 32 should be enough for all identifiers I ever use,
-    // and for all string values var::readFromStream() will be called, but far less frequently 
-    static MemoryOutputStream buffer(32);
+    // and for all string values var::readFromStream() will be called, but far less frequently;
+    // the buffer is per-thread, since resources may be loaded in parallel
+    thread_local MemoryOutputStream buffer(32);
     buffer.reset();
 
     for (;;)
@@ -411,6 +654,46 @@ inline static Identifier readIdentifier(InputStream &input)
     }
 }
 
+// see the comment in SharedData::writeChildrenAsTable
+void SerializedData::readTableFromStream(InputStream &input,
+    SerializedData &parent, int numRows)
+{
+    const auto rowType = readIdentifier(input);
+    const auto numColumns = input.readCompressedInt();
+
+    if (!rowType.isValid() || numColumns < 0 ||
+        numColumns > SharedData::maxTableColumns)
+    {
+        jassertfalse;
+        return;
+    }
+
+    Array<Identifier> columns;
+    for (int i = 0; i < numColumns; ++i)
+    {
+        columns.add(readIdentifier(input));
+    }
+
+    parent.data->children.ensureStorageAllocated(numRows);
+
+    for (int row = 0; row < numRows && !input.isExhausted(); ++row)
+    {
+        SharedData::Ptr child(new SharedData(rowType));
+
+        const auto mask = input.readCompressedInt();
+        for (int i = 0; i < numColumns; ++i)
+        {
+            if ((mask & (1 << i)) != 0)
+            {
+                child->properties.set(columns.getReference(i), var::readFromStream(input));
+            }
+        }
+
+        parent.data->children.add(child);
+        child->parent = parent.data.get();
+    }
+}
+
 SerializedData SerializedData::readFromStream(InputStream &input)
 {
     const auto type = readIdentifier(input);
@@ -439,6 +722,12 @@ SerializedData SerializedData::readFromStream(InputStream &input)
     }
 
     const auto numChildren = input.readCompressedInt();
+    if (numChildren < 0)
+    {
+        readTableFromStream(input, v, -numChildren);
+        return v;
+    }
+
     v.data->children.ensureStorageAllocated(numChildren);
 
     for (int i = 0; i < numChildren; ++i)
@@ -462,3 +751,87 @@ SerializedData SerializedData::readFromData(const void *data, size_t numBytes)
     MemoryInputStream in(data, numBytes, false);
     return readFromStream(in);
 }
+
+//===----------------------------------------------------------------------===//
+// Tests
+//===----------------------------------------------------------------------===//
+
+#if JUCE_UNIT_TESTS
+
+class SerializedDataTests final : public UnitTest
+{
+public:
+
+    SerializedDataTests() : UnitTest("Serialized data tests", UnitTestCategories::helio) {}
+
+    void runTest() override
+    {
+        static const Identifier trackType = "track";
+        static const Identifier noteType = "note";
+        static const Identifier nameProperty = "name";
+        static const Identifier keyProperty = "key";
+        static const Identifier beatProperty = "beat";
+        static const Identifier tupletProperty = "tuplet";
+
+        SerializedData track(trackType);
+        track.setProperty(nameProperty, "Track");
+
+        for (int i = 0; i < 100; ++i)
+        {
+            SerializedData note(noteType);
+            note.setProperty(keyProperty, i % 128);
+            note.setProperty(beatProperty, float(i) / 4.f);
+            if (i % 10 == 0)
+            {
+                note.setProperty(tupletProperty, 3);
+            }
+
+            track.appendChild(note);
+        }
+
+        const auto writeToBlock = [](const SerializedData &data)
+        {
+            MemoryOutputStream out;
+            data.writeToStream(out);
+            return out.getMemoryBlock();
+        };
+
+        beginTest("Properties storage");
+
+        SerializedData node(noteType);
+        for (int i = 0; i < 10; ++i)
+        {
+            node.setProperty(Identifier("p" + String(i)), i);
+        }
+
+        node.setProperty(Identifier("p8"), -8);
+        expectEquals(node.getNumProperties(), 10);
+        expectEquals(int(node.getProperty(Identifier("p2"))), 2);
+        expectEquals(int(node.getProperty(Identifier("p8"))), -8);
+        expect(node.getProperty(nameProperty).isVoid());
+        expectEquals(int(node.getProperty(nameProperty, 42)), 42);
+
+        beginTest("Homogeneous children round trip as a table");
+
+        const auto block = writeToBlock(track);
+        const auto loaded = SerializedData::readFromData(block.getData(), block.getSize());
+        expect(loaded.isEquivalentTo(track));
+        expectEquals(loaded.getNumChildren(), 100);
+        expect(!loaded.getChild(1).hasProperty(tupletProperty));
+        expectEquals(int(loaded.getChild(10).getProperty(tupletProperty)), 3);
+        expect(loaded.getChild(5).getParent() == loaded);
+
+        // same data, but with the type and property names for each node
+        SerializedData mixedTrack(track.createCopy());
+        mixedTrack.appendChild(SerializedData(trackType));
+        expect(block.getSize() * 4 < writeToBlock(mixedTrack).getSize() * 3);
+
+        const auto mixedBlock = writeToBlock(mixedTrack);
+        expect(SerializedData::readFromData(mixedBlock.getData(),
+            mixedBlock.getSize()).isEquivalentTo(mixedTrack));
+    }
+};
+
+static SerializedDataTests serializedDataTests;
+
+#endif
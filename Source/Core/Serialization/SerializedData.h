@@ -33,6 +33,12 @@ public:
     bool operator== (const SerializedData &) const noexcept;
     bool operator!= (const SerializedData &) const noexcept;
 
+    // hashes the shared data pointer, i.e. consistent with operator==
+    struct IdentityHash final
+    {
+        HashCode operator()(const SerializedData &key) const noexcept;
+    };
+
     bool isEquivalentTo(const SerializedData &) const;
     bool isValid() const noexcept;
     bool isEmpty() const noexcept;
@@ -49,6 +55,7 @@ public:
     bool hasProperty(const Identifier &name) const noexcept;
     int getNumProperties() const noexcept;
     Identifier getPropertyName(int index) const noexcept;
+    const var &getPropertyValue(int index) const noexcept;
 
     int getNumChildren() const noexcept;
     SerializedData getChild(int index) const;
@@ -95,4 +102,7 @@ private:
     friend class SharedData;
     explicit SerializedData(ReferenceCountedObjectPtr<SharedData>) noexcept;
     explicit SerializedData(SharedData &) noexcept;
+
+    static void readTableFromStream(InputStream &input,
+        SerializedData &parent, int numRows);
 };
@@ -449,7 +449,7 @@ void MidiTrackNode::dispatchChangeProjectBeatRange()
 {
     if (this->lastFoundParent != nullptr)
     {
-        this->lastFoundParent->broadcastChangeProjectBeatRange();
+        this->lastFoundParent->scheduleProjectBeatRangeUpdate(this);
     }
 }
 
@@ -20,6 +20,7 @@
 class MidiTrack;
 class MidiEvent;
 class MidiSequence;
+class Note;
 class Pattern;
 class Clip;
 class ProjectMetadata;
@@ -63,6 +64,11 @@ public:
 
     virtual void onChangeViewBeatRange(float firstBeat, float lastBeat) = 0;
 
+    // The notes being recorded, which are still held and not yet
+    // in the sequence; sent a few times a second while recording,
+    // and with an empty array once they are all released
+    virtual void onChangeRecordingNotes(const Clip &clip, const Array<Note> &notes) {}
+
     // Sent on midi import, reload or reset by VCS
     virtual void onBeforeReloadProjectContent() {};
     virtual void onReloadProjectContent(const Array<MidiTrack *> &tracks,
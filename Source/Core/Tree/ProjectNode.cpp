@@ -423,34 +423,19 @@ void ProjectNode::collectTracks(Array<MidiTrack *> &resultArray, bool onlySelect
     }
 }
 
+// the range is cheap to calculate now, so it's always up to date,
+// even if the listeners haven't been notified about the change yet
 Range<float> ProjectNode::getProjectBeatRange() const
 {
-    return this->beatRange;
+    return this->calculateProjectBeatRange();
 }
 
 Range<float> ProjectNode::calculateProjectBeatRange() const
 {
-    float lastBeat = -FLT_MAX;
-    float firstBeat = FLT_MAX;
-
     this->rebuildTracksRefsCacheIfNeeded();
 
-    for (const auto &i : this->tracksRefsCache)
-    {
-        const auto *track = i.second.get();
-        if (track->getSequence()->isEmpty())
-        {
-            // ignore empty tracks as they affect the project range in a misleading way
-            continue;
-        }
-
-        const float sequenceFirstBeat = track->getSequence()->getFirstBeat();
-        const float sequenceLastBeat = track->getSequence()->getLastBeat();
-        const float patternFirstBeat = track->getPattern() ? track->getPattern()->getFirstBeat() : 0.f;
-        const float patternLastBeat = track->getPattern() ? track->getPattern()->getLastBeat() : 0.f;
-        firstBeat = jmin(firstBeat, sequenceFirstBeat + patternFirstBeat);
-        lastBeat = jmax(lastBeat, sequenceLastBeat + patternLastBeat);
-    }
+    float firstBeat = this->tracksBeatRanges.getFirstBeat();
+    float lastBeat = this->tracksBeatRanges.getLastBeat();
     
     if (firstBeat == FLT_MAX)
     {
@@ -469,6 +454,25 @@ Range<float> ProjectNode::calculateProjectBeatRange() const
     return { firstBeat, lastBeat };
 }
 
+void ProjectNode::updateTrackInBeatRangeTree(const MidiTrack *track) const
+{
+    const auto *sequence = track->getSequence();
+    if (sequence->isEmpty())
+    {
+        // ignore empty tracks as they affect the project range in a misleading way
+        this->tracksBeatRanges.set(track, FLT_MAX, -FLT_MAX);
+        return;
+    }
+
+    const float sequenceFirstBeat = sequence->getFirstBeat();
+    const float sequenceLastBeat = sequence->getLastBeat();
+    const float patternFirstBeat = track->getPattern() ? track->getPattern()->getFirstBeat() : 0.f;
+    const float patternLastBeat = track->getPattern() ? track->getPattern()->getLastBeat() : 0.f;
+    this->tracksBeatRanges.set(track,
+        sequenceFirstBeat + patternFirstBeat,
+        sequenceLastBeat + patternLastBeat);
+}
+
 StringArray ProjectNode::getAllTrackNames() const
 {
     StringArray names;
@@ -561,6 +565,19 @@ SerializedData ProjectNode::save() const
 }
 
 void ProjectNode::load(const SerializedData &tree)
+{
+    if (this->startLoading(tree))
+    {
+        while (this->loadNextChildren(std::numeric_limits<double>::max())) {}
+        this->finishLoading();
+    }
+}
+
+//===----------------------------------------------------------------------===//
+// Loading in steps
+//===----------------------------------------------------------------------===//
+
+bool ProjectNode::startLoading(const SerializedData &tree)
 {
     this->broadcastBeforeReloadProjectContent();
     this->reset();
@@ -568,7 +585,7 @@ void ProjectNode::load(const SerializedData &tree)
     const auto root = tree.hasType(Serialization::Core::project) ?
         tree : tree.getChildWithName(Serialization::Core::project);
 
-    if (!root.isValid()) { return; }
+    if (!root.isValid()) { return false; }
 
     this->id = root.getProperty(Serialization::Core::projectId, Uuid().toString());
     
@@ -578,8 +595,42 @@ void ProjectNode::load(const SerializedData &tree)
     this->metadata->deserialize(root);
     this->timeline->deserialize(root);
 
-    // Proceed with basic properties and children
-    TreeNode::deserialize(root);
+    // Proceed with basic properties, children are loaded in the next steps
+    this->name = root.getProperty(Serialization::Core::treeNodeName);
+
+    this->contentToLoad = root;
+    this->numLoadedChildren = 0;
+    return true;
+}
+
+bool ProjectNode::loadNextChildren(double timeBudgetMs)
+{
+    jassert(this->isLoading());
+    const auto deadline = Time::getMillisecondCounterHiRes() + timeBudgetMs;
+
+    while (this->numLoadedChildren < this->contentToLoad.getNumChildren())
+    {
+        const auto child = this->contentToLoad.getChild(this->numLoadedChildren++);
+        if (child.hasType(Serialization::Core::treeNode))
+        {
+            TreeNodeSerializer::deserializeChild(*this, child);
+
+            if (Time::getMillisecondCounterHiRes() >= deadline)
+            {
+                break;
+            }
+        }
+    }
+
+    return this->numLoadedChildren < this->contentToLoad.getNumChildren();
+}
+
+void ProjectNode::finishLoading()
+{
+    jassert(this->isLoading());
+    const auto root = this->contentToLoad;
+    this->contentToLoad = {};
+    this->numLoadedChildren = 0;
 
     // Legacy support: if no pattern set manager found, create one
     if (nullptr == this->findChildOfType<PatternEditorNode>())
@@ -608,6 +659,11 @@ void ProjectNode::load(const SerializedData &tree)
     this->sequencerLayout->deserialize(root);
 }
 
+bool ProjectNode::isLoading() const noexcept
+{
+    return this->contentToLoad.isValid();
+}
+
 void ProjectNode::importMidi(InputStream &stream)
 {
     MidiFile tempFile;
@@ -796,8 +852,9 @@ void ProjectNode::broadcastChangeTrackProperties(MidiTrack *const track)
 
 void ProjectNode::broadcastChangeTrackBeatRange(MidiTrack *const track)
 {
-    this->changeListeners.call(&ProjectListener::onChangeTrackBeatRange, track);
-    this->sendChangeMessage();
+    // sent along with the project range notification, see handleAsyncUpdate
+    this->tracksWithPendingBeatRangeUpdate.addIfNotAlreadyThere(track);
+    this->scheduleProjectBeatRangeUpdate(track);
 }
 
 void ProjectNode::broadcastAddClip(const Clip &clip)
@@ -832,6 +889,22 @@ void ProjectNode::broadcastChangeProjectInfo(const ProjectMetadata *info)
 
 Range<float> ProjectNode::broadcastChangeProjectBeatRange()
 {
+    // explicit calls are rare (loading, resetting, importing, etc.),
+    // and some of the changes before them might have been done silently,
+    // so this re-reads the ranges of all tracks, just to be safe
+    this->rebuildTracksRefsCacheIfNeeded();
+    for (const auto &i : this->tracksRefsCache)
+    {
+        this->updateTrackInBeatRangeTree(i.second.get());
+    }
+
+    return this->notifyProjectBeatRangeIfChanged();
+}
+
+Range<float> ProjectNode::notifyProjectBeatRangeIfChanged()
+{
+    this->isProjectBeatRangeUpdatePending = false;
+
     const auto newBeatRange = this->calculateProjectBeatRange();
     
     if (this->beatRange != newBeatRange)
@@ -852,6 +925,18 @@ Range<float> ProjectNode::broadcastChangeProjectBeatRange()
     return this->beatRange;
 }
 
+void ProjectNode::scheduleProjectBeatRangeUpdate(MidiTrack *const track)
+{
+    if (!this->isTracksCacheOutdated)
+    {
+        // otherwise, the whole tree will be rebuilt anyway
+        this->updateTrackInBeatRangeTree(track);
+    }
+
+    this->isProjectBeatRangeUpdatePending = true;
+    this->triggerAsyncUpdate();
+}
+
 void ProjectNode::broadcastBeforeReloadProjectContent()
 {
     this->changeListeners.call(&ProjectListener::onBeforeReloadProjectContent);
@@ -883,6 +968,12 @@ void ProjectNode::broadcastChangeViewBeatRange(float firstBeat, float lastBeat)
     // this->sendChangeMessage(); the project itself didn't change, so dont call this
 }
 
+void ProjectNode::broadcastChangeRecordingNotes(const Clip &clip, const Array<Note> &notes)
+{
+    this->changeListeners.call(&ProjectListener::onChangeRecordingNotes, clip, notes);
+    // same here, the notes are not in the project yet
+}
+
 //===----------------------------------------------------------------------===//
 // DocumentOwner
 //===----------------------------------------------------------------------===//
@@ -907,6 +998,11 @@ bool ProjectNode::onDocumentLoad(const File &file)
 
 bool ProjectNode::onDocumentSave(const File &file)
 {
+    if (this->isLoading())
+    {
+        return false; // the content is incomplete, don't overwrite the file
+    }
+
     const auto projectNode = this->save();
 #if DEBUG
     DocumentHelpers::save<XmlSerializer>(file.withFileExtension("xml"), projectNode);
@@ -940,9 +1036,6 @@ void ProjectNode::exportMidi(OutputStream &stream) const
     // in MIDI export, as I believe they shouldn't:
     const bool soloFlag = false;
 
-    // Metronome track flag is only needed for playback:
-    const bool metronomeFlag = false;
-
     const auto grouping = this->getTrackGroupingMode();
     FlatHashMap<String, MidiMessageSequence, StringHash> sequences;
 
@@ -959,20 +1052,47 @@ void ProjectNode::exportMidi(OutputStream &stream) const
         // todo add more meta events like track name
         if (track->getPattern() != nullptr)
         {
+            // same as in the playback cache, the sequence is exported once
+            // for all clips which only differ in position, and then copied
+            Array<Clip> exportedClips;
+            OwnedArray<MidiMessageSequence> exportedSequences;
+
             for (const auto *clip : track->getPattern()->getClips())
             {
-                track->getSequence()->exportMidi(sequence, *clip,
-                    simpleMapping, soloFlag, metronomeFlag,
-                    this->beatRange.getStart(), this->beatRange.getEnd(),
-                    midiClock);
+                const MidiMessageSequence *exported = nullptr;
+                for (int i = 0; i < exportedClips.size(); ++i)
+                {
+                    if (exportedClips.getReference(i).hasSameContentAs(*clip))
+                    {
+                        exported = exportedSequences.getUnchecked(i);
+                        break;
+                    }
+                }
+
+                if (exported == nullptr)
+                {
+                    auto *newSequence = exportedSequences.add(new MidiMessageSequence());
+                    track->getSequence()->exportMidi(*newSequence, clip->withBeat(0.f),
+                        simpleMapping, soloFlag, midiClock);
+
+                    exportedClips.add(*clip);
+                    exported = newSequence;
+                }
+
+                // the clips are sorted, so this will mostly append to the end
+                const auto clipOffset = double(clip->getBeat()) * midiClock;
+                for (const auto *event : *exported)
+                {
+                    sequence.addEvent(event->message, clipOffset);
+                }
             }
+
+            sequence.updateMatchedPairs();
         }
         else
         {
             track->getSequence()->exportMidi(sequence, noTransform,
-                simpleMapping, soloFlag, metronomeFlag,
-                this->beatRange.getStart(), this->beatRange.getEnd(),
-                midiClock);
+                simpleMapping, soloFlag, midiClock);
         }
 
         // the project will not necessarily start from 0 timestamp;
@@ -1143,6 +1263,34 @@ void ProjectNode::changeListenerCallback(ChangeBroadcaster *source)
     }
 }
 
+//===----------------------------------------------------------------------===//
+// AsyncUpdater
+//===----------------------------------------------------------------------===//
+
+void ProjectNode::handleAsyncUpdate()
+{
+    if (!this->tracksWithPendingBeatRangeUpdate.isEmpty())
+    {
+        Array<WeakReference<MidiTrack>> tracks;
+        tracks.swapWith(this->tracksWithPendingBeatRangeUpdate);
+
+        for (const auto &track : tracks)
+        {
+            if (track != nullptr)
+            {
+                this->changeListeners.call(&ProjectListener::onChangeTrackBeatRange, track.get());
+            }
+        }
+
+        this->sendChangeMessage();
+    }
+
+    if (this->isProjectBeatRangeUpdatePending)
+    {
+        this->notifyProjectBeatRangeIfChanged();
+    }
+}
+
 void ProjectNode::rebuildTracksRefsCacheIfNeeded() const
 {
     if (this->isTracksCacheOutdated)
@@ -1165,7 +1313,13 @@ void ProjectNode::rebuildTracksRefsCacheIfNeeded() const
             MidiTrack *const track = children.getUnchecked(i);
             this->tracksRefsCache[track->getTrackId()] = track;
         }
-        
+
+        this->tracksBeatRanges.clear();
+        for (const auto &i : this->tracksRefsCache)
+        {
+            this->updateTrackInBeatRangeTree(i.second.get());
+        }
+
         this->isTracksCacheOutdated = false;
     }
 }
@@ -42,6 +42,7 @@ class Clip;
 #include "CommandPaletteModel.h"
 #include "MidiTrack.h"
 #include "MidiTrackSource.h"
+#include "BeatRangeTree.h"
 
 class ProjectNode final :
     public TreeNode,
@@ -49,7 +50,8 @@ class ProjectNode final :
     public MidiTrackSource,
     public CommandPaletteModel,
     public VCS::TrackedItemsSource,  // vcs stuff
-    public ChangeListener // subscribed to VersionControl
+    public ChangeListener, // subscribed to VersionControl
+    private AsyncUpdater // coalesces beat range notifications
 {
 public:
 
@@ -125,6 +127,19 @@ public:
     void deserialize(const SerializedData &data) override;
     void reset() override;
 
+    //===------------------------------------------------------------------===//
+    // Loading in steps
+    //===------------------------------------------------------------------===//
+
+    // restores the already parsed project content in several steps (see ProjectLoader),
+    // so that opening a large project doesn't freeze the message thread for long;
+    // each step restores the next children until the time budget is spent, and returns
+    // true if there's more to load; the project is never saved while still loading
+    bool startLoading(const SerializedData &tree);
+    bool loadNextChildren(double timeBudgetMs);
+    void finishLoading();
+    bool isLoading() const noexcept;
+
     //===------------------------------------------------------------------===//
     // Project listeners
     //===------------------------------------------------------------------===//
@@ -154,8 +169,15 @@ public:
 
     void broadcastChangeProjectInfo(const ProjectMetadata *info);
     void broadcastChangeViewBeatRange(float firstBeat, float lastBeat);
+    void broadcastChangeRecordingNotes(const Clip &clip, const Array<Note> &notes);
     Range<float> broadcastChangeProjectBeatRange();
 
+    // called by the tracks as they change, updates the track's range
+    // in the range tree, and schedules the project range notification,
+    // which is sent at most once per message loop, however many edits
+    // have happened, unlike broadcastChangeProjectBeatRange above
+    void scheduleProjectBeatRangeUpdate(MidiTrack *const track);
+
     void broadcastBeforeReloadProjectContent();
     void broadcastReloadProjectContent();
 
@@ -188,6 +210,12 @@ public:
 
     void changeListenerCallback(ChangeBroadcaster *source) override;
 
+    //===------------------------------------------------------------------===//
+    // AsyncUpdater
+    //===------------------------------------------------------------------===//
+
+    void handleAsyncUpdate() override;
+
 protected:
 
     //===------------------------------------------------------------------===//
@@ -235,10 +263,16 @@ private:
     SerializedData save() const;
     void load(const SerializedData &tree);
 
+    friend class ProjectBenchmarks;
+
 private:
 
     String id;
 
+    // the parsed content which is being loaded in steps, if any
+    SerializedData contentToLoad;
+    int numLoadedChildren = 0;
+
     ReadWriteLock vcsInfoLock;
     Array<const VCS::TrackedItem *> vcsItems;
 
@@ -246,9 +280,17 @@ private:
 
     MidiTrack::Grouping trackGroupingMode = MidiTrack::Grouping::GroupByName;
 
+    // the last range the listeners were notified about
     mutable Range<float> beatRange = { 0.f, Globals::Defaults::projectLength };
     Range<float> calculateProjectBeatRange() const;
 
+    mutable BeatRangeTree tracksBeatRanges;
+    void updateTrackInBeatRangeTree(const MidiTrack *track) const;
+
+    bool isProjectBeatRangeUpdatePending = false;
+    Range<float> notifyProjectBeatRangeIfChanged();
+    Array<WeakReference<MidiTrack>> tracksWithPendingBeatRangeUpdate;
+
     mutable bool isTracksCacheOutdated = true;
     mutable FlatHashMap<String, WeakReference<MidiTrack>, StringHash> tracksRefsCache;
     void rebuildTracksRefsCacheIfNeeded() const;
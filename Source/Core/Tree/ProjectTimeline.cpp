@@ -307,12 +307,16 @@ void ProjectTimeline::dispatchChangeTrackProperties()
 
 void ProjectTimeline::dispatchChangeTrackBeatRange()
 {
-    this->project.broadcastChangeProjectBeatRange();
+    this->dispatchChangeProjectBeatRange();
 }
 
 void ProjectTimeline::dispatchChangeProjectBeatRange()
 {
-    this->project.broadcastChangeProjectBeatRange();
+    // all timeline tracks share this dispatcher, so it doesn't know
+    // which one has changed, but updating all three of them is cheap
+    this->project.scheduleProjectBeatRangeUpdate(this->getAnnotations());
+    this->project.scheduleProjectBeatRangeUpdate(this->getKeySignatures());
+    this->project.scheduleProjectBeatRangeUpdate(this->getTimeSignatures());
 }
 
 // Timeline sequences are the case where there are no patterns and clips
@@ -66,7 +66,7 @@ void RootNode::recreatePage()
 // Children
 //===----------------------------------------------------------------------===//
 
-ProjectNode *RootNode::openProject(const File &file)
+ProjectNode *RootNode::openProject(const File &file, const SerializedData &data)
 {
     const auto myProjects(this->findChildrenOfType<ProjectNode>());
 
@@ -80,28 +80,26 @@ ProjectNode *RootNode::openProject(const File &file)
         }
     }
 
-    DBG("Opening project: " + file.getFullPathName());
-    if (file.existsAsFile())
-    {
-        auto project = make<ProjectNode>(file);
-        this->addChildNode(project.get(), 1);
+    // second check for duplicates (project id), before creating anything
+    const auto root = data.hasType(Serialization::Core::project) ?
+        data : data.getChildWithName(Serialization::Core::project);
 
-        if (!project->getDocument()->load(file))
+    const String projectId = root.getProperty(Serialization::Core::projectId);
+    for (auto *myProject : myProjects)
+    {
+        if (projectId.isNotEmpty() && myProject->getId() == projectId)
         {
+            myProject->selectFirstChildOfType<PianoTrackNode, PatternEditorNode>();
             return nullptr;
         }
+    }
 
-        // second check for duplicates (project id)
-        for (auto *myProject : myProjects)
-        {
-            if (myProject->getId() == project->getId())
-            {
-                myProject->selectFirstChildOfType<PianoTrackNode, PatternEditorNode>();
-                return nullptr;
-            }
-        }
-
-        project->selectFirstChildOfType<PianoTrackNode, PatternEditorNode>();
+    DBG("Opening project: " + file.getFullPathName());
+    if (file.existsAsFile() && root.isValid())
+    {
+        auto project = make<ProjectNode>(file);
+        this->addChildNode(project.get(), 1);
+        project->startLoading(data);
         return project.release();
     }
 
@@ -42,7 +42,10 @@ public:
     //===------------------------------------------------------------------===//
 
     ProjectNode *importMidi(const File &file);
-    ProjectNode *openProject(const File &file);
+    // the data is expected to be already parsed (see ProjectLoader);
+    // returns the attached project, which content is still to be loaded in steps,
+    // see ProjectNode::loadNextChildren, or nullptr if it's already open
+    ProjectNode *openProject(const File &file, const SerializedData &data);
 
 #if !NO_NETWORK
     ProjectNode *checkoutProject(const String &id, const String &name);
@@ -21,6 +21,7 @@
 
 #include "SyncSettings.h"
 #include "AudioSettings.h"
+#include "AudioLoadSettings.h"
 #include "ThemeSettings.h"
 #include "UserInterfaceSettings.h"
 #include "TranslationSettings.h"
@@ -70,6 +71,8 @@ void SettingsNode::recreatePage()
     this->themeSettings = nullptr;
     this->audioSettingsWrapper = nullptr;
     this->audioSettings = nullptr;
+    this->audioLoadSettingsWrapper = nullptr;
+    this->audioLoadSettings = nullptr;
     this->settingsList = nullptr;
     
     this->settingsList = make<ComponentsList>(0, 6);
@@ -93,6 +96,10 @@ void SettingsNode::recreatePage()
     this->audioSettingsWrapper = make<SettingsFrameWrapper>(this->audioSettings.get(), TRANS(I18n::Settings::audio));
     this->settingsList->addAndMakeVisible(this->audioSettingsWrapper.get());
 
+    this->audioLoadSettings = make<AudioLoadSettings>(App::Workspace().getAudioCore());
+    this->audioLoadSettingsWrapper = make<SettingsFrameWrapper>(this->audioLoadSettings.get(), TRANS(I18n::Settings::audioLoad));
+    this->settingsList->addAndMakeVisible(this->audioLoadSettingsWrapper.get());
+
 #if !NO_NETWORK
     this->networkSettings = make<NetworkSettings>();
     this->networkSettingsWrapper = make<SettingsFrameWrapper>(this->networkSettings.get());
@@ -40,6 +40,8 @@ private:
     UniquePointer<ComponentsList> settingsList;
     UniquePointer<Component> audioSettings;
     UniquePointer<Component> audioSettingsWrapper;
+    UniquePointer<Component> audioLoadSettings;
+    UniquePointer<Component> audioLoadSettingsWrapper;
     UniquePointer<Component> uiSettings;
     UniquePointer<Component> uiSettingsWrapper;
     UniquePointer<Component> themeSettings;
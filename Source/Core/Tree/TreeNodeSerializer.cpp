@@ -40,29 +40,35 @@ void TreeNodeSerializer::serializeChildren(const TreeNode &parentItem, Serialize
 }
 
 void TreeNodeSerializer::deserializeChildren(TreeNode &parentItem, const SerializedData &parent)
+{
+    forEachChildWithType(parent, e, Serialization::Core::treeNode)
+    {
+        TreeNodeSerializer::deserializeChild(parentItem, e);
+    }
+}
+
+void TreeNodeSerializer::deserializeChild(TreeNode &parentItem, const SerializedData &data)
 {
     using namespace Serialization;
 
-    forEachChildWithType(parent, e, Core::treeNode)
-    {
-        const auto type = Identifier(e.getProperty(Core::treeNodeType));
+    jassert(data.hasType(Core::treeNode));
+    const auto type = Identifier(data.getProperty(Core::treeNodeType));
 
-        TreeNode *child = nullptr;
+    TreeNode *child = nullptr;
 
-        if (type == Core::project)              { child = new ProjectNode(); }
-        else if (type == Core::settings)        { child = new SettingsNode(); }
-        else if (type == Core::trackGroup)      { child = new TrackGroupNode(""); }
-        else if (type == Core::pianoTrack)      { child = new PianoTrackNode(""); }
-        else if (type == Core::automationTrack) { child = new AutomationTrackNode(""); }
-        else if (type == Core::instrumentsList) { child = new OrchestraPitNode(); }
-        else if (type == Core::instrumentRoot)  { child = new InstrumentNode(); }
-        else if (type == Core::versionControl)  { child = new VersionControlNode(); }
-        else if (type == Core::patternSet)      { child = new PatternEditorNode(); }
+    if (type == Core::project)              { child = new ProjectNode(); }
+    else if (type == Core::settings)        { child = new SettingsNode(); }
+    else if (type == Core::trackGroup)      { child = new TrackGroupNode(""); }
+    else if (type == Core::pianoTrack)      { child = new PianoTrackNode(""); }
+    else if (type == Core::automationTrack) { child = new AutomationTrackNode(""); }
+    else if (type == Core::instrumentsList) { child = new OrchestraPitNode(); }
+    else if (type == Core::instrumentRoot)  { child = new InstrumentNode(); }
+    else if (type == Core::versionControl)  { child = new VersionControlNode(); }
+    else if (type == Core::patternSet)      { child = new PatternEditorNode(); }
 
-        if (child != nullptr)
-        {
-            parentItem.addChildNode(child);
-            child->deserialize(e);
-        }
+    if (child != nullptr)
+    {
+        parentItem.addChildNode(child);
+        child->deserialize(data);
     }
 }
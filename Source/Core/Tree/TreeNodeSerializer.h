@@ -25,4 +25,5 @@ public:
 
     static void serializeChildren(const TreeNode &parentItem, SerializedData &parent);
     static void deserializeChildren(TreeNode &parentItem, const SerializedData &parent);
+    static void deserializeChild(TreeNode &parentItem, const SerializedData &data);
 };
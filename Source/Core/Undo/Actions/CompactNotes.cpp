@@ -0,0 +1,442 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Common.h"
+#include "CompactNotes.h"
+#include "MidiSequence.h"
+
+static inline void writeCompactValue(OutputStream &out, float value) { out.writeFloat(value); }
+static inline void writeCompactValue(OutputStream &out, int32 value) { out.writeInt(value); }
+static inline void writeCompactValue(OutputStream &out, int8 value) { out.writeByte(char(value)); }
+
+static inline void readCompactValue(InputStream &in, float &value) { value = in.readFloat(); }
+static inline void readCompactValue(InputStream &in, int32 &value) { value = in.readInt(); }
+static inline void readCompactValue(InputStream &in, int8 &value) { value = int8(in.readByte()); }
+
+template <typename T>
+static void writeCompactColumn(OutputStream &out, const Array<T> &column)
+{
+    for (const auto &value : column)
+    {
+        writeCompactValue(out, value);
+    }
+}
+
+template <typename T>
+static void readCompactColumn(InputStream &in, Array<T> &column, int numValues)
+{
+    column.clearQuick();
+    column.ensureStorageAllocated(numValues);
+
+    for (int i = 0; i < numValues; ++i)
+    {
+        T value;
+        readCompactValue(in, value);
+        column.add(value);
+    }
+}
+
+//===----------------------------------------------------------------------===//
+// CompactNotes
+//===----------------------------------------------------------------------===//
+
+CompactNotes::CompactNotes(const Array<Note> &notes)
+{
+    this->ids.ensureStorageAllocated(notes.size());
+    this->beats.ensureStorageAllocated(notes.size());
+    this->keys.ensureStorageAllocated(notes.size());
+    this->lengths.ensureStorageAllocated(notes.size());
+    this->velocities.ensureStorageAllocated(notes.size());
+    this->tuplets.ensureStorageAllocated(notes.size());
+
+    for (const auto &note : notes)
+    {
+        this->add(note);
+    }
+}
+
+void CompactNotes::add(const Note &note)
+{
+    this->ids.add(note.getId());
+    this->beats.add(note.getBeat());
+    this->keys.add(note.getKey());
+    this->lengths.add(note.getLength());
+    this->velocities.add(note.getVelocity());
+    this->tuplets.add(note.getTuplet());
+}
+
+void CompactNotes::addArray(const CompactNotes &other)
+{
+    this->ids.addArray(other.ids);
+    this->beats.addArray(other.beats);
+    this->keys.addArray(other.keys);
+    this->lengths.addArray(other.lengths);
+    this->velocities.addArray(other.velocities);
+    this->tuplets.addArray(other.tuplets);
+}
+
+void CompactNotes::clear()
+{
+    this->ids.clear();
+    this->beats.clear();
+    this->keys.clear();
+    this->lengths.clear();
+    this->velocities.clear();
+    this->tuplets.clear();
+}
+
+Array<Note> CompactNotes::getNotes(WeakReference<MidiSequence> owner) const
+{
+    Array<Note> result;
+    result.ensureStorageAllocated(this->size());
+
+    for (int i = 0; i < this->size(); ++i)
+    {
+        result.add(Note(owner, this->ids.getUnchecked(i),
+            this->keys.getUnchecked(i), this->beats.getUnchecked(i),
+            this->lengths.getUnchecked(i), this->velocities.getUnchecked(i),
+            this->tuplets.getUnchecked(i)));
+    }
+
+    return result;
+}
+
+Array<Note> CompactNotes::getNotesWithNewIds(MidiSequence &owner, float deltaBeat) const
+{
+    const auto newIds = owner.createUniqueEventIds(this->size());
+
+    Array<Note> result;
+    result.ensureStorageAllocated(this->size());
+
+    for (int i = 0; i < this->size(); ++i)
+    {
+        result.add(Note(&owner, newIds.getUnchecked(i),
+            this->keys.getUnchecked(i), this->beats.getUnchecked(i) + deltaBeat,
+            this->lengths.getUnchecked(i), this->velocities.getUnchecked(i),
+            this->tuplets.getUnchecked(i)));
+    }
+
+    return result;
+}
+
+int CompactNotes::getSizeInBytes() const noexcept
+{
+    return int(sizeof(CompactNotes)) + this->size() *
+        int(sizeof(MidiEvent::Id) + sizeof(float) + sizeof(Note::Key) +
+            sizeof(float) + sizeof(float) + sizeof(Note::Tuplet));
+}
+
+String CompactNotes::pack() const
+{
+    MemoryOutputStream out;
+    out.writeCompressedInt(this->size());
+    writeCompactColumn(out, this->ids);
+    writeCompactColumn(out, this->beats);
+    writeCompactColumn(out, this->keys);
+    writeCompactColumn(out, this->lengths);
+    writeCompactColumn(out, this->velocities);
+    writeCompactColumn(out, this->tuplets);
+    return out.getMemoryBlock().toBase64Encoding();
+}
+
+void CompactNotes::unpack(const String &data)
+{
+    this->clear();
+
+    MemoryBlock block;
+    if (!block.fromBase64Encoding(data))
+    {
+        jassertfalse;
+        return;
+    }
+
+    MemoryInputStream in(block, false);
+    const auto numNotes = in.readCompressedInt();
+    readCompactColumn(in, this->ids, numNotes);
+    readCompactColumn(in, this->beats, numNotes);
+    readCompactColumn(in, this->keys, numNotes);
+    readCompactColumn(in, this->lengths, numNotes);
+    readCompactColumn(in, this->velocities, numNotes);
+    readCompactColumn(in, this->tuplets, numNotes);
+}
+
+//===----------------------------------------------------------------------===//
+// CompactNotesDelta
+//===----------------------------------------------------------------------===//
+
+template <typename T>
+template <typename Getter>
+void CompactNotesDelta::Column<T>::init(const Array<Note> &before,
+    const Array<Note> &after, Getter get)
+{
+    this->mode = Mode::Unchanged;
+    this->shift = {};
+    this->values.clear();
+
+    if (before.isEmpty())
+    {
+        return;
+    }
+
+    bool isUnchanged = true;
+    bool isShifted = true;
+    const auto commonShift = T(get(after.getReference(0)) - get(before.getReference(0)));
+
+    for (int i = 0; i < before.size(); ++i)
+    {
+        const T valueBefore = get(before.getReference(i));
+        const T valueAfter = get(after.getReference(i));
+        isUnchanged = isUnchanged && valueBefore == valueAfter;
+        isShifted = isShifted && T(valueBefore + commonShift) == valueAfter;
+    }
+
+    if (isUnchanged)
+    {
+        return;
+    }
+
+    if (isShifted)
+    {
+        this->mode = Mode::Shift;
+        this->shift = commonShift;
+        return;
+    }
+
+    this->mode = Mode::Values;
+    this->values.ensureStorageAllocated(after.size());
+    for (const auto &note : after)
+    {
+        this->values.add(get(note));
+    }
+}
+
+template <typename T>
+T CompactNotesDelta::Column<T>::apply(int index, T valueBefore) const noexcept
+{
+    switch (this->mode)
+    {
+    case Mode::Shift:
+        return T(valueBefore + this->shift);
+    case Mode::Values:
+        return this->values.getUnchecked(index);
+    default:
+        return valueBefore;
+    }
+}
+
+template <typename T>
+void CompactNotesDelta::Column<T>::write(OutputStream &out) const
+{
+    out.writeByte(char(this->mode));
+
+    if (this->mode == Mode::Shift)
+    {
+        writeCompactValue(out, this->shift);
+    }
+    else if (this->mode == Mode::Values)
+    {
+        writeCompactColumn(out, this->values);
+    }
+}
+
+template <typename T>
+void CompactNotesDelta::Column<T>::read(InputStream &in, int numValues)
+{
+    this->mode = Mode(in.readByte());
+    this->shift = {};
+    this->values.clear();
+
+    if (this->mode == Mode::Shift)
+    {
+        readCompactValue(in, this->shift);
+    }
+    else if (this->mode == Mode::Values)
+    {
+        readCompactColumn(in, this->values, numValues);
+    }
+    else
+    {
+        this->mode = Mode::Unchanged;
+    }
+}
+
+CompactNotesDelta::CompactNotesDelta(const Array<Note> &before, const Array<Note> &after) :
+    numNotes(before.size())
+{
+    jassert(before.size() == after.size());
+
+    this->beats.init(before, after, [](const Note &n) { return n.getBeat(); });
+    this->keys.init(before, after, [](const Note &n) { return n.getKey(); });
+    this->lengths.init(before, after, [](const Note &n) { return n.getLength(); });
+    this->velocities.init(before, after, [](const Note &n) { return n.getVelocity(); });
+    this->tuplets.init(before, after, [](const Note &n) { return n.getTuplet(); });
+}
+
+Array<Note> CompactNotesDelta::apply(const Array<Note> &before) const
+{
+    jassert(before.size() == this->numNotes);
+
+    Array<Note> result;
+    result.ensureStorageAllocated(before.size());
+
+    for (int i = 0; i < before.size(); ++i)
+    {
+        const auto &note = before.getReference(i);
+        result.add(Note(note.getSequence(), note.getId(),
+            this->keys.apply(i, note.getKey()),
+            this->beats.apply(i, note.getBeat()),
+            this->lengths.apply(i, note.getLength()),
+            this->velocities.apply(i, note.getVelocity()),
+            this->tuplets.apply(i, note.getTuplet())));
+    }
+
+    return result;
+}
+
+void CompactNotesDelta::clear()
+{
+    this->numNotes = 0;
+    this->beats = {};
+    this->keys = {};
+    this->lengths = {};
+    this->velocities = {};
+    this->tuplets = {};
+}
+
+int CompactNotesDelta::getSizeInBytes() const noexcept
+{
+    return int(sizeof(CompactNotesDelta)) +
+        this->beats.values.size() * int(sizeof(float)) +
+        this->keys.values.size() * int(sizeof(Note::Key)) +
+        this->lengths.values.size() * int(sizeof(float)) +
+        this->velocities.values.size() * int(sizeof(float)) +
+        this->tuplets.values.size() * int(sizeof(Note::Tuplet));
+}
+
+String CompactNotesDelta::pack() const
+{
+    MemoryOutputStream out;
+    out.writeCompressedInt(this->numNotes);
+    this->beats.write(out);
+    this->keys.write(out);
+    this->lengths.write(out);
+    this->velocities.write(out);
+    this->tuplets.write(out);
+    return out.getMemoryBlock().toBase64Encoding();
+}
+
+void CompactNotesDelta::unpack(const String &data)
+{
+    this->clear();
+
+    MemoryBlock block;
+    if (!block.fromBase64Encoding(data))
+    {
+        jassertfalse;
+        return;
+    }
+
+    MemoryInputStream in(block, false);
+    this->numNotes = in.readCompressedInt();
+    this->beats.read(in, this->numNotes);
+    this->keys.read(in, this->numNotes);
+    this->lengths.read(in, this->numNotes);
+    this->velocities.read(in, this->numNotes);
+    this->tuplets.read(in, this->numNotes);
+}
+
+//===----------------------------------------------------------------------===//
+// Tests
+//===----------------------------------------------------------------------===//
+
+#if JUCE_UNIT_TESTS
+
+class CompactNotesTests final : public UnitTest
+{
+public:
+
+    CompactNotesTests() : UnitTest("Compact notes tests", UnitTestCategories::helio) {}
+
+    void runTest() override
+    {
+        Array<Note> notes;
+        for (int i = 0; i < 1000; ++i)
+        {
+            notes.add(Note(nullptr, i + 1, i % 128, float(i) * 0.25f,
+                0.5f + float(i % 4) * 0.25f, float(i % 100) / 100.f, Note::Tuplet(1 + i % 3)));
+        }
+
+        const auto expectSameNotes = [this](const Array<Note> &a, const Array<Note> &b)
+        {
+            expectEquals(a.size(), b.size());
+            for (int i = 0; i < a.size(); ++i)
+            {
+                const auto &n1 = a.getReference(i);
+                const auto &n2 = b.getReference(i);
+                expectEquals(n1.getId(), n2.getId());
+                expectEquals(n1.getKey(), n2.getKey());
+                expectEquals(n1.getBeat(), n2.getBeat());
+                expectEquals(n1.getLength(), n2.getLength());
+                expectEquals(n1.getVelocity(), n2.getVelocity());
+                expectEquals(int(n1.getTuplet()), int(n2.getTuplet()));
+            }
+        };
+
+        beginTest("Notes round trip");
+
+        const CompactNotes compact(notes);
+        expectSameNotes(compact.getNotes(nullptr), notes);
+        expect(compact.getSizeInBytes() < int(sizeof(Note)) * notes.size());
+
+        CompactNotes unpacked;
+        unpacked.unpack(compact.pack());
+        expectSameNotes(unpacked.getNotes(nullptr), notes);
+
+        beginTest("Common shifts take no space per note");
+
+        Array<Note> shifted;
+        for (const auto &note : notes)
+        {
+            shifted.add(note.withDeltaBeat(2.f).withDeltaKey(1));
+        }
+
+        const CompactNotesDelta shift(notes, shifted);
+        expectSameNotes(shift.apply(notes), shifted);
+        expectEquals(shift.getSizeInBytes(), int(sizeof(CompactNotesDelta)));
+
+        beginTest("Arbitrary changes keep the changed fields only");
+
+        Array<Note> changed;
+        for (const auto &note : notes)
+        {
+            changed.add(note.withVelocity(float(note.getKey() % 7) / 7.f));
+        }
+
+        const CompactNotesDelta change(notes, changed);
+        expectSameNotes(change.apply(notes), changed);
+        expectEquals(change.getSizeInBytes(),
+            int(sizeof(CompactNotesDelta) + sizeof(float) * notes.size()));
+
+        CompactNotesDelta unpackedChange;
+        unpackedChange.unpack(change.pack());
+        expectSameNotes(unpackedChange.apply(notes), changed);
+    }
+};
+
+static CompactNotesTests compactNotesTests;
+
+#endif
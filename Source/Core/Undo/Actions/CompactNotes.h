@@ -0,0 +1,121 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "Note.h"
+
+// The undo actions may keep thousands of notes per transaction,
+// so instead of the full Note objects (with their vtables and owner
+// references), they store the note parameters column-wise:
+
+class CompactNotes final
+{
+public:
+
+    CompactNotes() = default;
+    explicit CompactNotes(const Array<Note> &notes);
+
+    void add(const Note &note);
+    void addArray(const CompactNotes &other);
+    void clear();
+
+    inline int size() const noexcept { return this->ids.size(); }
+    inline bool isEmpty() const noexcept { return this->ids.isEmpty(); }
+    inline MidiEvent::Id getId(int index) const noexcept { return this->ids.getUnchecked(index); }
+
+    Array<Note> getNotes(WeakReference<MidiSequence> owner) const;
+
+    // the copies of the notes with the new ids, which are allocated
+    // by the new owner sequence all at once, e.g. for pasting
+    Array<Note> getNotesWithNewIds(MidiSequence &owner, float deltaBeat = 0.f) const;
+
+    int getSizeInBytes() const noexcept;
+
+    // binary-packed, base64-encoded, so that it can be stored
+    // as a property by any of the serializers
+    String pack() const;
+    void unpack(const String &data);
+
+private:
+
+    Array<MidiEvent::Id> ids;
+    Array<float> beats;
+    Array<Note::Key> keys;
+    Array<float> lengths;
+    Array<float> velocities;
+    Array<Note::Tuplet> tuplets;
+
+    JUCE_LEAK_DETECTOR(CompactNotes)
+};
+
+// The changes of a group of notes, relative to its previous state:
+// for each of the note fields, it keeps nothing if that field didn't change,
+// a single shift if all the notes were shifted by the same amount,
+// (which is what most of the tools do, e.g. dragging or transposing),
+// or the new values of the field only
+
+class CompactNotesDelta final
+{
+public:
+
+    CompactNotesDelta() = default;
+    CompactNotesDelta(const Array<Note> &before, const Array<Note> &after);
+
+    // the notes are expected to be in the same order as they were passed
+    Array<Note> apply(const Array<Note> &before) const;
+
+    void clear();
+
+    int getSizeInBytes() const noexcept;
+
+    String pack() const;
+    void unpack(const String &data);
+
+private:
+
+    template <typename T>
+    struct Column final
+    {
+        enum class Mode : uint8
+        {
+            Unchanged = 0,
+            Shift = 1,
+            Values = 2
+        };
+
+        Mode mode = Mode::Unchanged;
+        T shift = {};
+        Array<T> values;
+
+        template <typename Getter>
+        void init(const Array<Note> &before, const Array<Note> &after, Getter get);
+        T apply(int index, T valueBefore) const noexcept;
+
+        void write(OutputStream &out) const;
+        void read(InputStream &in, int numValues);
+    };
+
+    int numNotes = 0;
+    Column<float> beats;
+    Column<Note::Key> keys;
+    Column<float> lengths;
+    Column<float> velocities;
+    Column<Note::Tuplet> tuplets;
+
+    JUCE_LEAK_DETECTOR(CompactNotesDelta)
+};
@@ -261,17 +261,22 @@ void NoteChangeAction::reset()
 NotesGroupInsertAction::NotesGroupInsertAction(MidiTrackSource &source,
     const String &trackId, Array<Note> &target) noexcept :
     UndoAction(source),
-    trackId(trackId)
-{
-    this->notes.swapWith(target);
-}
+    trackId(trackId),
+    notes(target) {}
+
+NotesGroupInsertAction::NotesGroupInsertAction(MidiTrackSource &source,
+    const String &trackId, CompactNotes &&target) noexcept :
+    UndoAction(source),
+    trackId(trackId),
+    notes(move(target)) {}
 
 NotesGroupInsertAction::NotesGroupInsertAction(MidiTrackSource &source,
     const String &trackId, Note &action1Note, Note &action2Note) noexcept :
     UndoAction(source),
     trackId(trackId)
 {
-    this->notes.add(action1Note, action2Note);
+    this->notes.add(action1Note);
+    this->notes.add(action2Note);
 }
 
 bool NotesGroupInsertAction::perform()
@@ -279,7 +284,8 @@ bool NotesGroupInsertAction::perform()
     if (PianoSequence *sequence =
         this->source.findSequenceByTrackId<PianoSequence>(this->trackId))
     {
-        return sequence->insertGroup(this->notes, false);
+        auto notes = this->notes.getNotes(sequence);
+        return sequence->insertGroup(notes, false);
     }
     
     return false;
@@ -290,7 +296,8 @@ bool NotesGroupInsertAction::undo()
     if (PianoSequence *sequence =
         this->source.findSequenceByTrackId<PianoSequence>(this->trackId))
     {
-        return sequence->removeGroup(this->notes, false);
+        auto notes = this->notes.getNotes(sequence);
+        return sequence->removeGroup(notes, false);
     }
     
     return false;
@@ -298,19 +305,14 @@ bool NotesGroupInsertAction::undo()
 
 int NotesGroupInsertAction::getSizeInUnits()
 {
-    return (sizeof(Note) * this->notes.size());
+    return this->notes.getSizeInBytes();
 }
 
 SerializedData NotesGroupInsertAction::serialize() const
 {
     SerializedData tree(Serialization::Undo::notesGroupInsertAction);
     tree.setProperty(Serialization::Undo::trackId, this->trackId);
-    
-    for (int i = 0; i < this->notes.size(); ++i)
-    {
-        tree.appendChild(this->notes.getUnchecked(i).serialize());
-    }
-    
+    tree.setProperty(Serialization::Undo::packedGroup, this->notes.pack());
     return tree;
 }
 
@@ -318,7 +320,14 @@ void NotesGroupInsertAction::deserialize(const SerializedData &data)
 {
     this->reset();
     this->trackId = data.getProperty(Serialization::Undo::trackId);
-    
+
+    if (data.hasProperty(Serialization::Undo::packedGroup))
+    {
+        this->notes.unpack(data.getProperty(Serialization::Undo::packedGroup));
+        return;
+    }
+
+    // the legacy format, one child per note
     for (const auto &props : data)
     {
         Note n;
@@ -345,7 +354,7 @@ UndoAction *NotesGroupInsertAction::createCoalescedAction(UndoAction *nextAction
         //DBG("NotesGroupInsertAction ++");
         this->notes.addArray(nextGroup->notes);
         return new NotesGroupInsertAction(this->source,
-            this->trackId, this->notes);
+            this->trackId, move(this->notes));
     }
     else if (auto *nextChanger = dynamic_cast<NoteInsertAction *>(nextAction))
     {
@@ -357,7 +366,7 @@ UndoAction *NotesGroupInsertAction::createCoalescedAction(UndoAction *nextAction
         //DBG("NotesGroupInsertAction + NoteInsertAction");
         this->notes.add(nextChanger->note);
         return new NotesGroupInsertAction(this->source,
-            this->trackId, this->notes);
+            this->trackId, move(this->notes));
     }
 
     (void)nextAction;
@@ -371,17 +380,16 @@ UndoAction *NotesGroupInsertAction::createCoalescedAction(UndoAction *nextAction
 NotesGroupRemoveAction::NotesGroupRemoveAction(MidiTrackSource &source,
     const String &trackId, Array<Note> &target) noexcept :
     UndoAction(source),
-    trackId(trackId)
-{
-    this->notes.swapWith(target);
-}
+    trackId(trackId),
+    notes(target) {}
 
 bool NotesGroupRemoveAction::perform()
 {
     if (PianoSequence *sequence =
         this->source.findSequenceByTrackId<PianoSequence>(this->trackId))
     {
-        return sequence->removeGroup(this->notes, false);
+        auto notes = this->notes.getNotes(sequence);
+        return sequence->removeGroup(notes, false);
     }
     
     return false;
@@ -392,7 +400,8 @@ bool NotesGroupRemoveAction::undo()
     if (PianoSequence *sequence =
         this->source.findSequenceByTrackId<PianoSequence>(this->trackId))
     {
-        return sequence->insertGroup(this->notes, false);
+        auto notes = this->notes.getNotes(sequence);
+        return sequence->insertGroup(notes, false);
     }
     
     return false;
@@ -400,19 +409,14 @@ bool NotesGroupRemoveAction::undo()
 
 int NotesGroupRemoveAction::getSizeInUnits()
 {
-    return (sizeof(Note) * this->notes.size());
+    return this->notes.getSizeInBytes();
 }
 
 SerializedData NotesGroupRemoveAction::serialize() const
 {
     SerializedData tree(Serialization::Undo::notesGroupRemoveAction);
     tree.setProperty(Serialization::Undo::trackId, this->trackId);
-    
-    for (int i = 0; i < this->notes.size(); ++i)
-    {
-        tree.appendChild(this->notes.getUnchecked(i).serialize());
-    }
-    
+    tree.setProperty(Serialization::Undo::packedGroup, this->notes.pack());
     return tree;
 }
 
@@ -420,7 +424,14 @@ void NotesGroupRemoveAction::deserialize(const SerializedData &data)
 {
     this->reset();
     this->trackId = data.getProperty(Serialization::Undo::trackId);
-    
+
+    if (data.hasProperty(Serialization::Undo::packedGroup))
+    {
+        this->notes.unpack(data.getProperty(Serialization::Undo::packedGroup));
+        return;
+    }
+
+    // the legacy format, one child per note
     for (const auto &props : data)
     {
         Note n;
@@ -442,18 +453,25 @@ void NotesGroupRemoveAction::reset()
 NotesGroupChangeAction::NotesGroupChangeAction(MidiTrackSource &source,
     const String &trackId, Array<Note> &state1, Array<Note> &state2) noexcept :
     UndoAction(source),
-    trackId(trackId)
-{
-    this->notesBefore.swapWith(state1);
-    this->notesAfter.swapWith(state2);
-}
+    trackId(trackId),
+    notesBefore(state1),
+    notesDelta(state1, state2) {}
+
+NotesGroupChangeAction::NotesGroupChangeAction(MidiTrackSource &source,
+    const String &trackId, CompactNotes &&state1, CompactNotesDelta &&delta) noexcept :
+    UndoAction(source),
+    trackId(trackId),
+    notesBefore(move(state1)),
+    notesDelta(move(delta)) {}
 
 bool NotesGroupChangeAction::perform()
 {
     if (PianoSequence *sequence =
         this->source.findSequenceByTrackId<PianoSequence>(this->trackId))
     {
-        return sequence->changeGroup(this->notesBefore, this->notesAfter, false);
+        auto notesBefore = this->notesBefore.getNotes(sequence);
+        auto notesAfter = this->notesDelta.apply(notesBefore);
+        return sequence->changeGroup(notesBefore, notesAfter, false);
     }
     
     return false;
@@ -464,7 +482,9 @@ bool NotesGroupChangeAction::undo()
     if (PianoSequence *sequence =
         this->source.findSequenceByTrackId<PianoSequence>(this->trackId))
     {
-        return sequence->changeGroup(this->notesAfter, this->notesBefore, false);
+        auto notesBefore = this->notesBefore.getNotes(sequence);
+        auto notesAfter = this->notesDelta.apply(notesBefore);
+        return sequence->changeGroup(notesAfter, notesBefore, false);
     }
     
     return false;
@@ -472,8 +492,8 @@ bool NotesGroupChangeAction::undo()
 
 int NotesGroupChangeAction::getSizeInUnits()
 {
-    return (sizeof(Note) * this->notesBefore.size()) +
-        (sizeof(Note) * this->notesAfter.size());
+    return this->notesBefore.getSizeInBytes() +
+        this->notesDelta.getSizeInBytes();
 }
 
 UndoAction *NotesGroupChangeAction::createCoalescedAction(UndoAction *nextAction)
@@ -485,23 +505,25 @@ UndoAction *NotesGroupChangeAction::createCoalescedAction(UndoAction *nextAction
             return nullptr;
         }
             
-        if (this->notesBefore.size() != nextChanger->notesAfter.size())
+        if (this->notesBefore.size() != nextChanger->notesBefore.size())
         {
             return nullptr;
         }
             
         for (int i = 0; i < this->notesBefore.size(); ++i)
         {
-            if (this->notesBefore.getUnchecked(i).getId() !=
-                nextChanger->notesAfter.getUnchecked(i).getId())
+            if (this->notesBefore.getId(i) != nextChanger->notesBefore.getId(i))
             {
                 return nullptr;
             }
         }
             
         //DBG("NotesGroupChangeAction ++");
-        return new NotesGroupChangeAction(this->source,
-            this->trackId, this->notesBefore, nextChanger->notesAfter);
+        const auto notesBefore = this->notesBefore.getNotes(nullptr);
+        const auto nextNotesBefore = nextChanger->notesBefore.getNotes(nullptr);
+        const auto nextNotesAfter = nextChanger->notesDelta.apply(nextNotesBefore);
+        return new NotesGroupChangeAction(this->source, this->trackId,
+            move(this->notesBefore), CompactNotesDelta(notesBefore, nextNotesAfter));
     }
 
     (void) nextAction;
@@ -516,23 +538,8 @@ SerializedData NotesGroupChangeAction::serialize() const
 {
     SerializedData tree(Serialization::Undo::notesGroupChangeAction);
     tree.setProperty(Serialization::Undo::trackId, this->trackId);
-    
-    SerializedData groupBeforeChild(Serialization::Undo::groupBefore);
-    SerializedData groupAfterChild(Serialization::Undo::groupAfter);
-    
-    for (int i = 0; i < this->notesBefore.size(); ++i)
-    {
-        groupBeforeChild.appendChild(this->notesBefore.getUnchecked(i).serialize());
-    }
-    
-    for (int i = 0; i < this->notesAfter.size(); ++i)
-    {
-        groupAfterChild.appendChild(this->notesAfter.getUnchecked(i).serialize());
-    }
-    
-    tree.appendChild(groupBeforeChild);
-    tree.appendChild(groupAfterChild);
-    
+    tree.setProperty(Serialization::Undo::packedGroupBefore, this->notesBefore.pack());
+    tree.setProperty(Serialization::Undo::packedGroupDelta, this->notesDelta.pack());
     return tree;
 }
 
@@ -541,28 +548,44 @@ void NotesGroupChangeAction::deserialize(const SerializedData &data)
     this->reset();
     
     this->trackId = data.getProperty(Serialization::Undo::trackId);
-    
+
+    if (data.hasProperty(Serialization::Undo::packedGroupBefore))
+    {
+        this->notesBefore.unpack(data.getProperty(Serialization::Undo::packedGroupBefore));
+        this->notesDelta.unpack(data.getProperty(Serialization::Undo::packedGroupDelta));
+        return;
+    }
+
+    // the legacy format, two groups of full notes
     const auto groupBeforeChild = data.getChildWithName(Serialization::Undo::groupBefore);
     const auto groupAfterChild = data.getChildWithName(Serialization::Undo::groupAfter);
 
+    Array<Note> notesBefore;
     for (const auto &props : groupBeforeChild)
     {
         Note n;
         n.deserialize(props);
-        this->notesBefore.add(n);
+        notesBefore.add(n);
     }
 
+    Array<Note> notesAfter;
     for (const auto &props : groupAfterChild)
     {
         Note n;
         n.deserialize(props);
-        this->notesAfter.add(n);
+        notesAfter.add(n);
+    }
+
+    if (notesBefore.size() == notesAfter.size())
+    {
+        this->notesBefore = CompactNotes(notesBefore);
+        this->notesDelta = CompactNotesDelta(notesBefore, notesAfter);
     }
 }
 
 void NotesGroupChangeAction::reset()
 {
     this->notesBefore.clear();
-    this->notesAfter.clear();
+    this->notesDelta.clear();
     this->trackId.clear();
 }
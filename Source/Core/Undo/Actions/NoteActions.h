@@ -21,6 +21,7 @@ class PianoSequence;
 class MidiTrackSource;
 
 #include "Note.h"
+#include "CompactNotes.h"
 #include "UndoAction.h"
 
 //===----------------------------------------------------------------------===//
@@ -135,6 +136,9 @@ public:
 
     NotesGroupInsertAction(MidiTrackSource &source,
         const String &trackId, Array<Note> &target) noexcept;
+
+    NotesGroupInsertAction(MidiTrackSource &source,
+        const String &trackId, CompactNotes &&target) noexcept;
     
     bool perform() override;
     bool undo() override;
@@ -149,7 +153,7 @@ public:
 private:
     
     String trackId;
-    Array<Note> notes;
+    CompactNotes notes;
     
     JUCE_DECLARE_NON_COPYABLE(NotesGroupInsertAction)
 };
@@ -179,7 +183,7 @@ public:
 private:
     
     String trackId;
-    Array<Note> notes;
+    CompactNotes notes;
     
     JUCE_DECLARE_NON_COPYABLE(NotesGroupRemoveAction)
 };
@@ -198,6 +202,9 @@ public:
     NotesGroupChangeAction(MidiTrackSource &source, const String &trackId,
         Array<Note> &state1, Array<Note> &state2) noexcept;
 
+    NotesGroupChangeAction(MidiTrackSource &source, const String &trackId,
+        CompactNotes &&state1, CompactNotesDelta &&delta) noexcept;
+
     bool perform() override;
     bool undo() override;
     int getSizeInUnits() override;
@@ -211,8 +218,10 @@ private:
 
     String trackId;
 
-    Array<Note> notesBefore;
-    Array<Note> notesAfter;
+    // only the ids and parameters of the notes before the change,
+    // and the difference between them and the notes after the change
+    CompactNotes notesBefore;
+    CompactNotesDelta notesDelta;
 
     JUCE_DECLARE_NON_COPYABLE(NotesGroupChangeAction)
 };
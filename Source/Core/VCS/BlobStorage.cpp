@@ -0,0 +1,442 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Common.h"
+#include "BlobStorage.h"
+
+namespace VCS
+{
+
+// FNV-1a, good enough to address the chunks within one history tree,
+// the keys are only used to look up the chunks in the same file
+static constexpr uint64 initialContentHash = 14695981039346656037ull;
+
+static uint64 updateContentHash(uint64 hash, const void *data, size_t numBytes) noexcept
+{
+    const auto *bytes = static_cast<const uint8 *>(data);
+    for (size_t i = 0; i < numBytes; ++i)
+    {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+
+    return hash;
+}
+
+static String contentHashToKey(uint64 hash)
+{
+    return String::toHexString(static_cast<int64>(hash));
+}
+
+String BlobStorage::put(const SerializedData &data)
+{
+    jassert(data.isValid());
+
+    // the deltas data is never changed in place, so the data instances
+    // which were put or got before don't need to be hashed again
+    const auto knownInstance = this->keysByInstance.find(data);
+    if (knownInstance != this->keysByInstance.end())
+    {
+        const auto knownBlob = this->blobs.find(knownInstance->second);
+        if (knownBlob != this->blobs.end())
+        {
+            knownBlob.value().isUsed = true;
+            return knownInstance->second;
+        }
+    }
+
+    Blob blob;
+    blob.header = SerializedData(data.getType());
+    for (int i = 0; i < data.getNumProperties(); ++i)
+    {
+        const auto name = data.getPropertyName(i);
+        blob.header.setProperty(name, data.getProperty(name));
+    }
+
+    this->buffer.reset();
+    blob.header.writeToStream(this->buffer);
+    auto blobHash = updateContentHash(initialContentHash,
+        this->buffer.getData(), this->buffer.getDataSize());
+
+    Array<SerializedData> chunk;
+    auto chunkHash = initialContentHash;
+
+    const auto finishChunk = [&]()
+    {
+        const auto chunkKey = this->addChunk(contentHashToKey(chunkHash), chunk);
+        blob.chunkKeys.add(chunkKey);
+        blobHash = updateContentHash(blobHash, chunkKey.toRawUTF8(), chunkKey.getNumBytesAsUTF8());
+
+        chunk.clearQuick();
+        chunkHash = initialContentHash;
+    };
+
+    for (const auto &child : data)
+    {
+        this->buffer.reset();
+        child.writeToStream(this->buffer);
+        const auto childHash = updateContentHash(initialContentHash,
+            this->buffer.getData(), this->buffer.getDataSize());
+
+        chunk.add(child);
+        chunkHash = updateContentHash(chunkHash, &childHash, sizeof(childHash));
+
+        if (childHash % BlobStorage::averageChunkSize == 0 ||
+            chunk.size() == BlobStorage::maxChunkSize)
+        {
+            finishChunk();
+        }
+    }
+
+    if (!chunk.isEmpty())
+    {
+        finishChunk();
+    }
+
+    const auto blobKey = this->addBlob(contentHashToKey(blobHash), move(blob));
+    this->keysByInstance[data] = blobKey;
+    return blobKey;
+}
+
+// the keys are 64-bit hashes, so a collision is unlikely, but not impossible:
+// the content behind an existing key is compared, and if it differs,
+// the new content gets the next free key with a suffix
+
+String BlobStorage::addChunk(const String &hashKey, const Array<SerializedData> &chunk)
+{
+    for (int attempt = 0; ; ++attempt)
+    {
+        const auto chunkKey = attempt == 0 ? hashKey : hashKey + "-" + String(attempt);
+        const auto existing = this->chunks.find(chunkKey);
+        if (existing == this->chunks.end())
+        {
+            SerializedData chunkNode(Serialization::VCS::blobChunk);
+            chunkNode.setProperty(Serialization::VCS::blobKey, chunkKey);
+            for (const auto &child : chunk)
+            {
+                chunkNode.appendChild(child.getParent().isValid() ? child.createCopy() : child);
+            }
+
+            this->chunks[chunkKey] = chunkNode;
+            return chunkKey;
+        }
+
+        bool isSameContent = existing->second.getNumChildren() == chunk.size();
+        for (int i = 0; isSameContent && i < chunk.size(); ++i)
+        {
+            isSameContent = existing->second.getChild(i).isEquivalentTo(chunk.getReference(i));
+        }
+
+        if (isSameContent)
+        {
+            return chunkKey;
+        }
+    }
+}
+
+String BlobStorage::addBlob(const String &hashKey, Blob &&blob)
+{
+    for (int attempt = 0; ; ++attempt)
+    {
+        const auto blobKey = attempt == 0 ? hashKey : hashKey + "-" + String(attempt);
+        const auto existing = this->blobs.find(blobKey);
+        if (existing == this->blobs.end())
+        {
+            blob.node = SerializedData(Serialization::VCS::blob);
+            blob.node.setProperty(Serialization::VCS::blobKey, blobKey);
+            blob.node.setProperty(Serialization::VCS::blobChunks, blob.chunkKeys.joinIntoString(" "));
+            blob.node.appendChild(blob.header);
+            blob.isUsed = true;
+            this->blobs[blobKey] = move(blob);
+            return blobKey;
+        }
+
+        if (existing->second.chunkKeys == blob.chunkKeys &&
+            existing->second.header.isEquivalentTo(blob.header))
+        {
+            existing.value().isUsed = true;
+            return blobKey;
+        }
+    }
+}
+
+SerializedData BlobStorage::get(const String &key) const
+{
+    const auto assembled = this->assembledBlobs.find(key);
+    if (assembled != this->assembledBlobs.end())
+    {
+        return assembled->second;
+    }
+
+    const auto blob = this->blobs.find(key);
+    if (blob == this->blobs.end())
+    {
+        jassertfalse;
+        return {};
+    }
+
+    auto data = blob->second.header.createCopy();
+    for (const auto &chunkKey : blob->second.chunkKeys)
+    {
+        const auto chunk = this->chunks.find(chunkKey);
+        if (chunk == this->chunks.end())
+        {
+            jassertfalse;
+            return {};
+        }
+
+        for (const auto &child : chunk->second)
+        {
+            data.appendChild(child.createCopy());
+        }
+    }
+
+    this->assembledBlobs[key] = data;
+    this->keysByInstance[data] = key;
+    return data;
+}
+
+BlobStorage::NodeCounts BlobStorage::countNodes() const
+{
+    NodeCounts counts;
+
+    for (const auto &chunk : this->chunks)
+    {
+        counts.numChunkEvents += chunk.second.getNumChildren();
+    }
+
+    for (const auto &blob : this->assembledBlobs)
+    {
+        counts.numAssembledEvents += blob.second.getNumChildren();
+    }
+
+    return counts;
+}
+
+//===----------------------------------------------------------------------===//
+// Saving
+//===----------------------------------------------------------------------===//
+
+void BlobStorage::beginSaving()
+{
+    for (auto it = this->blobs.begin(); it != this->blobs.end(); ++it)
+    {
+        it.value().isUsed = false;
+    }
+}
+
+void BlobStorage::removeUnused()
+{
+    FlatHashSet<String, StringHash> usedChunks;
+    for (auto it = this->blobs.begin(); it != this->blobs.end();)
+    {
+        if (it->second.isUsed)
+        {
+            for (const auto &chunkKey : it->second.chunkKeys)
+            {
+                usedChunks.insert(chunkKey);
+            }
+
+            ++it;
+        }
+        else
+        {
+            this->assembledBlobs.erase(it->first);
+            it = this->blobs.erase(it);
+        }
+    }
+
+    for (auto it = this->chunks.begin(); it != this->chunks.end();)
+    {
+        it = usedChunks.contains(it->first) ? std::next(it) : this->chunks.erase(it);
+    }
+
+    for (auto it = this->keysByInstance.begin(); it != this->keysByInstance.end();)
+    {
+        it = this->blobs.contains(it->second) ? std::next(it) : this->keysByInstance.erase(it);
+    }
+}
+
+//===----------------------------------------------------------------------===//
+// Serializable
+//===----------------------------------------------------------------------===//
+
+SerializedData BlobStorage::serialize() const
+{
+    SerializedData tree(Serialization::VCS::blobStorage);
+
+    // the nodes are built once, when the content is added or loaded,
+    // and are only copied if the previous saved tree is still alive
+    for (const auto &chunk : this->chunks)
+    {
+        tree.appendChild(chunk.second.getParent().isValid() ?
+            chunk.second.createCopy() : chunk.second);
+    }
+
+    for (const auto &blob : this->blobs)
+    {
+        tree.appendChild(blob.second.node.getParent().isValid() ?
+            blob.second.node.createCopy() : blob.second.node);
+    }
+
+    return tree;
+}
+
+void BlobStorage::deserialize(const SerializedData &data)
+{
+    this->reset();
+
+    const auto root = data.hasType(Serialization::VCS::blobStorage) ?
+        data : data.getChildWithName(Serialization::VCS::blobStorage);
+
+    if (!root.isValid()) { return; }
+
+    forEachChildWithType(root, chunkNode, Serialization::VCS::blobChunk)
+    {
+        const String chunkKey = chunkNode.getProperty(Serialization::VCS::blobKey);
+        this->chunks[chunkKey] = chunkNode;
+    }
+
+    forEachChildWithType(root, blobNode, Serialization::VCS::blob)
+    {
+        jassert(blobNode.getNumChildren() == 1);
+        if (blobNode.getNumChildren() != 1) { continue; }
+
+        Blob blob;
+        blob.node = blobNode;
+        blob.header = blobNode.getChild(0);
+        blob.chunkKeys.addTokens(blobNode.getProperty(Serialization::VCS::blobChunks).toString(), " ", "");
+
+        const String blobKey = blobNode.getProperty(Serialization::VCS::blobKey);
+        this->blobs[blobKey] = move(blob);
+    }
+}
+
+void BlobStorage::reset()
+{
+    this->blobs.clear();
+    this->chunks.clear();
+    this->assembledBlobs.clear();
+    this->keysByInstance.clear();
+}
+
+//===----------------------------------------------------------------------===//
+// Tests
+//===----------------------------------------------------------------------===//
+
+#if JUCE_UNIT_TESTS
+
+class BlobStorageTests final : public UnitTest
+{
+public:
+
+    BlobStorageTests() : UnitTest("VCS blob storage tests", UnitTestCategories::helio) {}
+
+    void runTest() override
+    {
+        static const Identifier payloadType = "payload";
+        static const Identifier eventType = "event";
+        static const Identifier valueProperty = "value";
+
+        const auto createPayload = [](int numEvents, int changedEvent)
+        {
+            SerializedData payload(payloadType);
+            payload.setProperty(valueProperty, numEvents);
+            for (int i = 0; i < numEvents; ++i)
+            {
+                SerializedData event(eventType);
+                event.setProperty(valueProperty, i == changedEvent ? -i : i);
+                payload.appendChild(event);
+            }
+
+            return payload;
+        };
+
+        const auto countChunks = [](const SerializedData &tree)
+        {
+            int numChunks = 0;
+            forEachChildWithType(tree, chunkNode, Serialization::VCS::blobChunk)
+            {
+                numChunks++;
+            }
+
+            return numChunks;
+        };
+
+        beginTest("Identical payloads deduplication");
+
+        BlobStorage storage;
+        const auto payload = createPayload(4096, -1);
+        const auto key = storage.put(payload);
+        const auto numChunks = countChunks(storage.serialize());
+
+        expect(numChunks > 1);
+        expectEquals(storage.put(payload.createCopy()), key);
+        expectEquals(countChunks(storage.serialize()), numChunks);
+
+        beginTest("Similar payloads share chunks");
+
+        const auto changedKey = storage.put(createPayload(4096, 2048));
+        expect(changedKey != key);
+
+        // the changed event's chunk might get split by a new boundary
+        const auto numChunksAfterChange = countChunks(storage.serialize());
+        expect(numChunksAfterChange > numChunks);
+        expect(numChunksAfterChange <= numChunks + 2);
+
+        beginTest("Payloads round trip");
+
+        BlobStorage loaded;
+        loaded.deserialize(storage.serialize());
+        expect(loaded.get(key).isEquivalentTo(payload));
+        expect(loaded.get(changedKey).isEquivalentTo(createPayload(4096, 2048)));
+        expect(loaded.get(key) == loaded.get(key));
+
+        // both blobs have their own copies of the chunks' events
+        const auto nodeCounts = loaded.countNodes();
+        expectEquals(nodeCounts.numAssembledEvents, 4096 * 2);
+        expect(nodeCounts.numChunkEvents < nodeCounts.numAssembledEvents);
+
+        beginTest("Unused blobs removal");
+
+        loaded.beginSaving();
+        expectEquals(loaded.put(loaded.get(key)), key);
+        loaded.removeUnused();
+
+        const auto prunedTree = loaded.serialize();
+        expectEquals(countChunks(prunedTree), numChunks);
+        expect(loaded.get(key).isEquivalentTo(payload));
+        expect(!loaded.blobs.contains(changedKey));
+
+        beginTest("Colliding keys keep both contents");
+
+        Array<SerializedData> firstChunk, secondChunk;
+        firstChunk.add(createPayload(1, -1).getChild(0));
+        secondChunk.add(createPayload(2, -1).getChild(1));
+
+        const auto firstKey = storage.addChunk("collision", firstChunk);
+        expectEquals(storage.addChunk("collision", firstChunk), firstKey);
+        const auto secondKey = storage.addChunk("collision", secondChunk);
+        expect(secondKey != firstKey);
+        expect(storage.chunks[secondKey].getChild(0).isEquivalentTo(secondChunk.getFirst()));
+    }
+};
+
+static BlobStorageTests blobStorageTests;
+
+#endif
+
+}
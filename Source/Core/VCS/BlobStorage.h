@@ -0,0 +1,106 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "Serializable.h"
+
+namespace VCS
+{
+    // Content-addressed storage for the deltas data of revision items,
+    // used when saving and loading the history: each payload is split
+    // into chunks of its child nodes (i.e. events), with chunk boundaries
+    // defined by the content itself, so that any chunk is stored once,
+    // no matter how many revisions, stashes and snapshot items contain it,
+    // and a payload which differs from another one in a few events only
+    // adds the chunks around those events instead of a full copy
+
+    class BlobStorage final : public Serializable
+    {
+    public:
+
+        BlobStorage() = default;
+
+        // stores the data, unless the same content is already there,
+        // and returns the key to restore it with
+        String put(const SerializedData &data);
+
+        // returns invalid data, if the key is not found; the same key
+        // always returns the same data instance, so it's shared between
+        // all revision items referencing it
+        SerializedData get(const String &key) const;
+
+        // the chunks are only shared in the stored form: a serialized data
+        // node can only have one parent, so each assembled blob has its own
+        // copies of the chunks' events; these are the numbers of both
+        struct NodeCounts final
+        {
+            int numChunkEvents = 0;
+            int numAssembledEvents = 0;
+        };
+
+        NodeCounts countNodes() const;
+
+        // the storage is kept between saves, so that only the new data
+        // is hashed; the blobs which are not put again between these calls
+        // are removed along with the chunks no other blob references
+        void beginSaving();
+        void removeUnused();
+
+        //===--------------------------------------------------------------===//
+        // Serializable
+        //===--------------------------------------------------------------===//
+
+        SerializedData serialize() const override;
+        void deserialize(const SerializedData &data) override;
+        void reset() override;
+
+        // a chunk ends after a child node which hash is divisible by this,
+        // or when it reaches the max size, so that inserting or removing
+        // some events only changes the chunks around them
+        static constexpr auto averageChunkSize = 32;
+        static constexpr auto maxChunkSize = 256;
+
+    private:
+
+        struct Blob final
+        {
+            // the payload node itself, without children
+            SerializedData header;
+            StringArray chunkKeys;
+            // the serialized form, built once
+            SerializedData node;
+            bool isUsed = true;
+        };
+
+        String addChunk(const String &hashKey, const Array<SerializedData> &chunk);
+        String addBlob(const String &hashKey, Blob &&blob);
+
+        FlatHashMap<String, Blob, StringHash> blobs;
+        // the serialized chunk nodes, with the events as children
+        FlatHashMap<String, SerializedData, StringHash> chunks;
+
+        mutable FlatHashMap<String, SerializedData, StringHash> assembledBlobs;
+        mutable FlatHashMap<SerializedData, String, SerializedData::IdentityHash> keysByInstance;
+
+        MemoryOutputStream buffer;
+
+        friend class BlobStorageTests;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BlobStorage)
+    };
+} // namespace VCS
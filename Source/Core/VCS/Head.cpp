@@ -93,33 +93,21 @@ void Head::setRebuildingDiffMode(bool isBuildingNow)
     this->rebuildingDiffMode = isBuildingNow;
 }
 
-void Head::mergeStateWith(Revision::Ptr changes)
+static void applyRevisionItems(Snapshot &state, const Revision &revision)
 {
-    DBG("Head::mergeStateWith " + changes->getUuid());
-
-    Revision::Ptr headRevision(this->getHeadingRevision());
-    for (auto *changesItem : changes->getItems())
+    for (auto *item : revision.getItems())
     {
-        if (changesItem->getType() == RevisionItem::Type::Added)
+        if (item->getType() == RevisionItem::Type::Added)
         {
-            if (this->state != nullptr)
-            {
-                this->state->addItem(changesItem);
-            }
+            state.addItem(item);
         }
-        else if (changesItem->getType() == RevisionItem::Type::Removed)
+        else if (item->getType() == RevisionItem::Type::Removed)
         {
-            if (this->state != nullptr)
-            {
-                this->state->removeItem(changesItem);
-            }
+            state.removeItem(item);
         }
-        else if (changesItem->getType() == RevisionItem::Type::Changed)
+        else if (item->getType() == RevisionItem::Type::Changed)
         {
-            if (this->state != nullptr)
-            {
-                this->state->mergeItem(changesItem);
-            }
+            state.mergeItem(item);
         }
         else
         {
@@ -128,60 +116,79 @@ void Head::mergeStateWith(Revision::Ptr changes)
     }
 }
 
-bool Head::moveTo(const Revision::Ptr revision)
+void Head::mergeStateWith(Revision::Ptr changes)
 {
-    if (this->isThreadRunning())
+    DBG("Head::mergeStateWith " + changes->getUuid());
+
+    if (this->state != nullptr)
     {
-        this->stopThread(Head::diffRebuildThreadStopTimeoutMs);
+        applyRevisionItems(*this->state, *changes);
     }
+}
 
-    // first, reset the snapshot state
+bool Head::moveTo(const Revision::Ptr revision)
+{
+    if (this->isThreadRunning())
     {
-        const ScopedWriteLock lock(this->stateLock);
-        this->state = make<Snapshot>();
+        this->stopThread(Head::diffRebuildThreadStopTimeoutMs);
     }
 
-    // a path from the root to current revision
-    ReferenceCountedArray<Revision> treePath;
+    // a path from the target revision up to the nearest
+    // revision with a keyframe, or to the root, if none found
+    const Snapshot *keyframe = nullptr;
+    ReferenceCountedArray<Revision> pathToKeyframe;
     Revision::Ptr currentRevision(revision);
     while (currentRevision != nullptr)
     {
-        treePath.insert(0, currentRevision);
+        keyframe = this->keyframes.find(currentRevision->getUuid());
+        if (keyframe != nullptr)
+        {
+            break;
+        }
+
+        pathToKeyframe.add(currentRevision);
         currentRevision = currentRevision->getParent();
     }
 
-    // then move from the root back to target revision
-    for (const auto *rev : treePath)
+    auto newState = keyframe != nullptr ? make<Snapshot>(*keyframe) : make<Snapshot>();
+
+    // then move from there back to target revision,
+    // picking all deltas and applying them to the state
+    for (int i = pathToKeyframe.size(); i --> 0 ;)
     {
+        const auto *rev = pathToKeyframe.getObjectPointerUnchecked(i);
         DBG("VCS head moved to " + rev->getUuid());
 
-        // picking all deltas and applying them to current state
-        for (auto *item : rev->getItems())
+        applyRevisionItems(*newState, *rev);
+
+        const auto numAppliedRevisions = pathToKeyframe.size() - i;
+        if (numAppliedRevisions % SnapshotKeyframes::keyframeInterval == 0)
         {
-            if (item->getType() == RevisionItem::Type::Added)
-            {
-                this->state->addItem(item);
-            }
-            else if (item->getType() == RevisionItem::Type::Removed)
-            {
-                this->state->removeItem(item);
-            }
-            else if (item->getType() == RevisionItem::Type::Changed)
-            {
-                this->state->mergeItem(item);
-            }
-            else
-            {
-                jassertfalse;
-            }
+            this->keyframes.add(rev->getUuid(), *newState);
         }
     }
 
+    // the revisions we move to are the most likely to be visited again
+    if (revision != nullptr && !pathToKeyframe.isEmpty())
+    {
+        this->keyframes.add(revision->getUuid(), *newState);
+    }
+
+    {
+        const ScopedWriteLock lock(this->stateLock);
+        this->state = move(newState);
+    }
+
     this->headingAt = revision;
     this->setDiffOutdated(true);
     return true;
 }
 
+void Head::resetKeyframes()
+{
+    this->keyframes.clear();
+}
+
 void Head::pointTo(const Revision::Ptr revision)
 {
     this->headingAt = revision;
@@ -189,43 +196,39 @@ void Head::pointTo(const Revision::Ptr revision)
 }
 
 
-bool Head::resetChangedItemToState(const RevisionItem::Ptr diffItem)
+Head::TrackedItemsIndex Head::createTargetItemsIndex() const
+{
+    TrackedItemsIndex index;
+    for (int i = 0; i < this->targetVcsItemsSource.getNumTrackedItems(); ++i)
+    {
+        auto *item = this->targetVcsItemsSource.getTrackedItem(i);
+        index[item->getUuid()] = item;
+    }
+
+    return index;
+}
+
+static TrackedItem *findTrackedItem(const FlatHashMap<Uuid, TrackedItem *, UuidHash> &index, const Uuid &uuid)
+{
+    const auto found = index.find(uuid);
+    return found != index.end() ? found->second : nullptr;
+}
+
+bool Head::resetChangedItemToState(const RevisionItem::Ptr diffItem, TrackedItemsIndex &targetItems)
 {
     if (this->state == nullptr)
     { return false; }
 
     // на входе - один из айтемов диффа
-    TrackedItem *sourceItem = nullptr;
-
     // ищем в собранном состоянии айтем с соответствующим уидом
-    for (int i = 0; i < this->state->getNumTrackedItems(); ++i)
-    {
-        auto *item = this->state->getTrackedItem(i);
+    TrackedItem *sourceItem = this->state->getItemWithUuid(diffItem->getUuid()).get();
 
-        if (item->getUuid() == diffItem->getUuid())
-        {
-            sourceItem = item;
-            break;
-        }
-    }
+    // ищем в проекте айтем с соответствующим уидом
+    TrackedItem *targetItem = findTrackedItem(targetItems, diffItem->getUuid());
 
     // обработать тип - добавлено, удалено, изменено
     if (diffItem->getType() == RevisionItem::Type::Changed)
     {
-        TrackedItem *targetItem = nullptr;
-
-        // ищем в проекте айтем с соответствующим уидом
-        for (int i = 0; i < this->targetVcsItemsSource.getNumTrackedItems(); ++i)
-        {
-            auto *item = this->targetVcsItemsSource.getTrackedItem(i);
-
-            if (item->getUuid() == diffItem->getUuid())
-            {
-                targetItem = item;
-                break;
-            }
-        }
-
         if (targetItem != nullptr && sourceItem != nullptr)
         {
             targetItem->resetStateTo(*sourceItem);
@@ -234,22 +237,10 @@ bool Head::resetChangedItemToState(const RevisionItem::Ptr diffItem)
     }
     else if (diffItem->getType() == RevisionItem::Type::Added)
     {
-        TrackedItem *targetItem = nullptr;
-
         // снова ищем исходный с тем же уидом и вызываем deleteTrackedItem
-        for (int i = 0; i < this->targetVcsItemsSource.getNumTrackedItems(); ++i)
-        {
-            auto *item = this->targetVcsItemsSource.getTrackedItem(i);
-
-            if (item->getUuid() == diffItem->getUuid())
-            {
-                targetItem = item;
-                break;
-            }
-        }
-
         if (targetItem)
         {
+            targetItems.erase(diffItem->getUuid());
             return this->targetVcsItemsSource.deleteTrackedItem(targetItem);
         }
     }
@@ -257,7 +248,11 @@ bool Head::resetChangedItemToState(const RevisionItem::Ptr diffItem)
     {
         const Identifier logicType(sourceItem->getDiffLogic()->getType());
         const Uuid id(sourceItem->getUuid());
-        this->targetVcsItemsSource.initTrackedItem(logicType, id, *sourceItem);
+        if (auto *newItem = this->targetVcsItemsSource.initTrackedItem(logicType, id, *sourceItem))
+        {
+            targetItems[id] = newItem;
+        }
+
         return true;
     }
 
@@ -293,10 +288,11 @@ void Head::checkout()
         }
     }
 
+    auto targetItems = this->createTargetItemsIndex();
     for (int i = 0; i < this->state->getNumTrackedItems(); ++i)
     {
         RevisionItem::Ptr stateItem = static_cast<RevisionItem *>(this->state->getTrackedItem(i));
-        this->checkoutItem(stateItem);
+        this->checkoutItem(stateItem, targetItems);
     }
 
     this->targetVcsItemsSource.onResetState();
@@ -311,18 +307,13 @@ void Head::cherryPick(const Array<Uuid> uuids)
 
     this->targetVcsItemsSource.onBeforeResetState();
 
-    for (int i = 0; i < this->state->getNumTrackedItems(); ++i)
+    auto targetItems = this->createTargetItemsIndex();
+    for (const auto &uuid : uuids)
     {
-        RevisionItem::Ptr stateItem = static_cast<RevisionItem *>(this->state->getTrackedItem(i));
-
         // если этот айтем состояния выбран юзером, то чекаут.
-        for (int j = 0; j < uuids.size(); ++j)
+        if (auto stateItem = this->state->getItemWithUuid(uuid))
         {
-            if (stateItem->getUuid() == uuids.getUnchecked(j))
-            {
-                this->checkoutItem(stateItem);
-                break;
-            }
+            this->checkoutItem(stateItem, targetItems);
         }
     }
 
@@ -338,10 +329,11 @@ void Head::cherryPickAll()
 
     this->targetVcsItemsSource.onBeforeResetState();
 
+    auto targetItems = this->createTargetItemsIndex();
     for (int i = 0; i < this->state->getNumTrackedItems(); ++i)
     {
         RevisionItem::Ptr stateItem = static_cast<RevisionItem *>(this->state->getTrackedItem(i));
-        this->checkoutItem(stateItem);
+        this->checkoutItem(stateItem, targetItems);
     }
 
     this->targetVcsItemsSource.onResetState();
@@ -356,31 +348,21 @@ bool Head::resetChanges(const Array<RevisionItem::Ptr> &changes)
 
     this->targetVcsItemsSource.onBeforeResetState();
 
+    auto targetItems = this->createTargetItemsIndex();
     for (const auto &item : changes)
     {
-        this->resetChangedItemToState(item);
+        this->resetChangedItemToState(item, targetItems);
     }
 
     this->targetVcsItemsSource.onResetState();
     return true;
 }
 
-void Head::checkoutItem(RevisionItem::Ptr stateItem)
+void Head::checkoutItem(RevisionItem::Ptr stateItem, TrackedItemsIndex &targetItems)
 {
     // Changed и Added RevisionItem'ы нужно применять через resetStateTo
-    TrackedItem *targetItem = nullptr;
-    
     // ищем в проекте айтем с соответствующим уидом
-    for (int j = 0; j < this->targetVcsItemsSource.getNumTrackedItems(); ++j)
-    {
-        TrackedItem *item = this->targetVcsItemsSource.getTrackedItem(j);
-
-        if (item->getUuid() == stateItem->getUuid())
-        {
-            targetItem = item;
-            break;
-        }
-    }
+    TrackedItem *targetItem = findTrackedItem(targetItems, stateItem->getUuid());
 
     if (stateItem->getType() == RevisionItem::Type::Changed)
     {
@@ -397,7 +379,10 @@ void Head::checkoutItem(RevisionItem::Ptr stateItem)
             
             const Identifier logicType(stateItem->getDiffLogic()->getType());
             const Uuid id(stateItem->getUuid());
-            this->targetVcsItemsSource.initTrackedItem(logicType, id, *stateItem);
+            if (auto *newItem = this->targetVcsItemsSource.initTrackedItem(logicType, id, *stateItem))
+            {
+                targetItems[id] = newItem;
+            }
         }
         else
         {
@@ -408,6 +393,7 @@ void Head::checkoutItem(RevisionItem::Ptr stateItem)
     {
         if (targetItem)
         {
+            targetItems.erase(stateItem->getUuid());
             this->targetVcsItemsSource.deleteTrackedItem(targetItem);
         }
     }
@@ -440,6 +426,26 @@ void Head::rebuildDiffNow()
 //===----------------------------------------------------------------------===//
 
 SerializedData Head::serialize() const
+{
+    return this->serializeWith(nullptr);
+}
+
+SerializedData Head::serialize(BlobStorage &blobs) const
+{
+    return this->serializeWith(&blobs);
+}
+
+void Head::deserialize(const SerializedData &data)
+{
+    this->deserializeWith(data, nullptr);
+}
+
+void Head::deserialize(const SerializedData &data, const BlobStorage &blobs)
+{
+    this->deserializeWith(data, &blobs);
+}
+
+SerializedData Head::serializeWith(BlobStorage *blobs) const
 {
     SerializedData tree(Serialization::VCS::head);
     SerializedData snapshotNode(Serialization::VCS::snapshot);
@@ -450,7 +456,8 @@ SerializedData Head::serialize() const
         for (int i = 0; i < this->state->getNumTrackedItems(); ++i)
         {
             const RevisionItem::Ptr stateItem = static_cast<RevisionItem *>(this->state->getTrackedItem(i));
-            const auto serializedItem = stateItem->serialize();
+            const auto serializedItem = blobs != nullptr ?
+                stateItem->serialize(*blobs) : stateItem->serialize();
             snapshotNode.appendChild(serializedItem);
         }
     }
@@ -459,7 +466,7 @@ SerializedData Head::serialize() const
     return tree;
 }
 
-void Head::deserialize(const SerializedData &data)
+void Head::deserializeWith(const SerializedData &data, const BlobStorage *blobs)
 {
     this->reset();
     
@@ -474,13 +481,22 @@ void Head::deserialize(const SerializedData &data)
     forEachChildWithType(snapshotNode, stateElement, Serialization::VCS::revisionItem)
     {
         RevisionItem::Ptr snapshotItem(new RevisionItem(RevisionItem::Type::Added, nullptr));
-        snapshotItem->deserialize(stateElement);
+        if (blobs != nullptr)
+        {
+            snapshotItem->deserialize(stateElement, *blobs);
+        }
+        else
+        {
+            snapshotItem->deserialize(stateElement);
+        }
+
         this->state->addItem(snapshotItem);
     }
 }
 
 void Head::reset()
 {
+    this->keyframes.clear();
     this->state = make<Snapshot>();
     this->setDiffOutdated(true);
 }
@@ -515,6 +531,8 @@ void Head::run()
 
     const ScopedReadLock threadStateLock(this->stateLock);
 
+    const auto targetItems = this->createTargetItemsIndex();
+
     for (int i = 0; i < this->state->getNumTrackedItems(); ++i)
     {
         if (this->threadShouldExit())
@@ -524,43 +542,28 @@ void Head::run()
             return;
         }
 
-        bool foundItemInTarget = false;
         const RevisionItem::Ptr stateItem = static_cast<RevisionItem *>(this->state->getTrackedItem(i));
 
         // will check `removed` records later
         if (stateItem->getType() == RevisionItem::Type::Removed) { continue; }
 
-        for (int j = 0; j < this->targetVcsItemsSource.getNumTrackedItems(); ++j)
-        {
-            if (this->threadShouldExit())
-            {
-                this->setRebuildingDiffMode(false);
-                this->sendChangeMessage();
-                return;
-            }
+        // i.e. MidiTrackNode
+        auto *targetItem = findTrackedItem(targetItems, stateItem->getUuid());
 
-            TrackedItem *targetItem = this->targetVcsItemsSource.getTrackedItem(j); // i.e. LayerTreeItem
+        // state item exists in project, adding `changed` record, if needed
+        if (targetItem != nullptr)
+        {
+            UniquePointer<Diff> itemDiff(targetItem->getDiffLogic()->createDiff(*stateItem));
 
-            // state item exists in project, adding `changed` record, if needed
-            if (stateItem->getUuid() == targetItem->getUuid())
+            if (itemDiff->hasAnyChanges())
             {
-                foundItemInTarget = true;
-
-                UniquePointer<Diff> itemDiff(targetItem->getDiffLogic()->createDiff(*stateItem));
-
-                if (itemDiff->hasAnyChanges())
-                {
-                    RevisionItem::Ptr revisionRecord(new RevisionItem(RevisionItem::Type::Changed, itemDiff.get()));
-                    const ScopedWriteLock itemDiffLock(this->diffLock);
-                    this->diff->addItem(revisionRecord);
-                }
-
-                break;
+                RevisionItem::Ptr revisionRecord(new RevisionItem(RevisionItem::Type::Changed, itemDiff.get()));
+                const ScopedWriteLock itemDiffLock(this->diffLock);
+                this->diff->addItem(revisionRecord);
             }
         }
-
         // state item was not found in project, adding `removed` record
-        if (! foundItemInTarget)
+        else
         {
             auto emptyDiff = make<Diff>(*stateItem);
             RevisionItem::Ptr revisionRecord(new RevisionItem(RevisionItem::Type::Removed, emptyDiff.get()));
@@ -579,21 +582,11 @@ void Head::run()
             return;
         }
 
-        bool foundItemInState = false;
         TrackedItem *targetItem = this->targetVcsItemsSource.getTrackedItem(i);
 
-        for (int j = 0; j < this->state->getNumTrackedItems(); ++j)
-        {
-            const RevisionItem::Ptr stateItem = static_cast<RevisionItem *>(this->state->getTrackedItem(j));
-
-            if (stateItem->getType() == RevisionItem::Type::Removed) { continue; }
-
-            if (stateItem->getUuid() == targetItem->getUuid())
-            {
-                foundItemInState = true;
-                break;
-            }
-        }
+        const auto stateItem = this->state->getItemWithUuid(targetItem->getUuid());
+        const bool foundItemInState = stateItem != nullptr &&
+            stateItem->getType() != RevisionItem::Type::Removed;
 
         // copy deltas from targetItem and add `added` record
         if (! foundItemInState)
@@ -627,38 +620,32 @@ void Head::rebuildDiffSynchronously()
     
     const ScopedReadLock rebuildStateLock(this->stateLock);
     
+    const auto targetItems = this->createTargetItemsIndex();
+    
     for (int i = 0; i < this->state->getNumTrackedItems(); ++i)
     {
-        bool foundItemInTarget = false;
         const RevisionItem::Ptr stateItem = static_cast<RevisionItem *>(this->state->getTrackedItem(i));
         
         // will check `removed` records later
         if (stateItem->getType() == RevisionItem::Type::Removed) { continue; }
         
-        for (int j = 0; j < this->targetVcsItemsSource.getNumTrackedItems(); ++j)
+        // i.e. MidiTrackNode
+        auto *targetItem = findTrackedItem(targetItems, stateItem->getUuid());
+        
+        // state item exists in project, adding `changed` record, if needed
+        if (targetItem != nullptr)
         {
-            auto *targetItem = this->targetVcsItemsSource.getTrackedItem(j); // i.e. MidiTrckNode
+            UniquePointer<Diff> itemDiff(targetItem->getDiffLogic()->createDiff(*stateItem));
             
-            // state item exists in project, adding `changed` record, if needed
-            if (stateItem->getUuid() == targetItem->getUuid())
+            if (itemDiff->hasAnyChanges())
             {
-                foundItemInTarget = true;
-                
-                UniquePointer<Diff> itemDiff(targetItem->getDiffLogic()->createDiff(*stateItem));
-                
-                if (itemDiff->hasAnyChanges())
-                {
-                    RevisionItem::Ptr revisionRecord(new RevisionItem(RevisionItem::Type::Changed, itemDiff.get()));
-                    const ScopedWriteLock lock(this->diffLock);
-                    this->diff->addItem(revisionRecord);
-                }
-                
-                break;
+                RevisionItem::Ptr revisionRecord(new RevisionItem(RevisionItem::Type::Changed, itemDiff.get()));
+                const ScopedWriteLock lock(this->diffLock);
+                this->diff->addItem(revisionRecord);
             }
         }
-        
         // state item was not found in project, adding `removed` record
-        if (! foundItemInTarget)
+        else
         {
             auto emptyDiff = make<Diff>(*stateItem);
             RevisionItem::Ptr revisionRecord(new RevisionItem(RevisionItem::Type::Removed, emptyDiff.get()));
@@ -670,21 +657,11 @@ void Head::rebuildDiffSynchronously()
     // search for project item that are missing (or deleted) in the state
     for (int i = 0; i < this->targetVcsItemsSource.getNumTrackedItems(); ++i)
     {
-        bool foundItemInState = false;
         TrackedItem *targetItem = this->targetVcsItemsSource.getTrackedItem(i);
         
-        for (int j = 0; j < this->state->getNumTrackedItems(); ++j)
-        {
-            const RevisionItem::Ptr stateItem = static_cast<RevisionItem *>(this->state->getTrackedItem(j));
-            
-            if (stateItem->getType() == RevisionItem::Type::Removed) { continue; }
-            
-            if (stateItem->getUuid() == targetItem->getUuid())
-            {
-                foundItemInState = true;
-                break;
-            }
-        }
+        const auto stateItem = this->state->getItemWithUuid(targetItem->getUuid());
+        const bool foundItemInState = stateItem != nullptr &&
+            stateItem->getType() != RevisionItem::Type::Removed;
         
         // copy deltas from targetItem and add `added` record
         if (! foundItemInState)
@@ -24,6 +24,7 @@ namespace VCS
 {
     class TrackedItem;
     class TrackedItemsSource;
+    class BlobStorage;
 
     class Head :
         private Thread,
@@ -52,6 +53,10 @@ namespace VCS
         bool moveTo(const Revision::Ptr revision); // rebuilds state index
         void pointTo(const Revision::Ptr revision); // does not rebuild index
 
+        // needs to be called whenever any existing revisions are modified
+        // (e.g. amended, replaced or fetched), since their snapshots are cached
+        void resetKeyframes();
+
         void checkout();
         void cherryPick(const Array<Uuid> uuids);
         void cherryPickAll();
@@ -68,6 +73,9 @@ namespace VCS
         SerializedData serialize() const override;
         void deserialize(const SerializedData &data) override;
         void reset() override;
+
+        SerializedData serialize(BlobStorage &blobs) const;
+        void deserialize(const SerializedData &data, const BlobStorage &blobs);
         
         //===--------------------------------------------------------------===//
         // ChangeListener
@@ -77,13 +85,23 @@ namespace VCS
 
     private:
 
+        SerializedData serializeWith(BlobStorage *blobs) const;
+        void deserializeWith(const SerializedData &data, const BlobStorage *blobs);
+
         //===--------------------------------------------------------------===//
         // Thread
         //===--------------------------------------------------------------===//
 
         void run() override;
-        void checkoutItem(RevisionItem::Ptr stateItem);
-        bool resetChangedItemToState(const RevisionItem::Ptr diffItem);
+
+        // project items by uuid, collected once per checkout, reset
+        // or diff rebuild, so that matching them against the state
+        // items doesn't take a linear search for each of them
+        using TrackedItemsIndex = FlatHashMap<Uuid, TrackedItem *, UuidHash>;
+        TrackedItemsIndex createTargetItemsIndex() const;
+
+        void checkoutItem(RevisionItem::Ptr stateItem, TrackedItemsIndex &targetItems);
+        bool resetChangedItemToState(const RevisionItem::Ptr diffItem, TrackedItemsIndex &targetItems);
 
         static constexpr auto diffRebuildThreadStopTimeoutMs = 5000;
 
@@ -102,6 +120,9 @@ namespace VCS
         ReadWriteLock stateLock;
         UniquePointer<Snapshot> state;
 
+        // only accessed by moveTo, so no locking here
+        SnapshotKeyframes keyframes;
+
     private:
 
         TrackedItemsSource &targetVcsItemsSource;
@@ -157,6 +157,26 @@ void Revision::deserializeDeltas(SerializedData data)
 }
 
 SerializedData Revision::serialize() const
+{
+    return this->serializeWith(nullptr);
+}
+
+SerializedData Revision::serialize(BlobStorage &blobs) const
+{
+    return this->serializeWith(&blobs);
+}
+
+void Revision::deserialize(const SerializedData &data)
+{
+    this->deserializeWith(data, nullptr);
+}
+
+void Revision::deserialize(const SerializedData &data, const BlobStorage &blobs)
+{
+    this->deserializeWith(data, &blobs);
+}
+
+SerializedData Revision::serializeWith(BlobStorage *blobs) const
 {
     SerializedData tree(Serialization::VCS::revision);
 
@@ -166,18 +186,18 @@ SerializedData Revision::serialize() const
 
     for (const auto *revItem : this->deltas)
     {
-        tree.appendChild(revItem->serialize());
+        tree.appendChild(blobs != nullptr ? revItem->serialize(*blobs) : revItem->serialize());
     }
 
     for (const auto *child : this->children)
     {
-        tree.appendChild(child->serialize());
+        tree.appendChild(child->serializeWith(blobs));
     }
 
     return tree;
 }
 
-void Revision::deserialize(const SerializedData &data)
+void Revision::deserializeWith(const SerializedData &data, const BlobStorage *blobs)
 {
     this->reset();
 
@@ -196,13 +216,21 @@ void Revision::deserialize(const SerializedData &data)
         if (e.hasType(Serialization::VCS::revision))
         {
             Revision::Ptr child(new Revision());
-            child->deserialize(e);
+            child->deserializeWith(e, blobs);
             this->addChild(child);
         }
         else if (e.hasType(Serialization::VCS::revisionItem))
         {
             RevisionItem::Ptr item(new RevisionItem(RevisionItem::Type::Undefined, nullptr));
-            item->deserialize(e);
+            if (blobs != nullptr)
+            {
+                item->deserialize(e, *blobs);
+            }
+            else
+            {
+                item->deserialize(e);
+            }
+
             this->addItem(item);
         }
     }
@@ -77,8 +77,15 @@ namespace VCS
         void deserialize(const SerializedData &data);
         void reset();
 
+        // the whole subtree with deltas data kept in the blob storage
+        SerializedData serialize(BlobStorage &blobs) const;
+        void deserialize(const SerializedData &data, const BlobStorage &blobs);
+
     private:
 
+        SerializedData serializeWith(BlobStorage *blobs) const;
+        void deserializeWith(const SerializedData &data, const BlobStorage *blobs);
+
         WeakReference<Revision> parent;
 
         String id;
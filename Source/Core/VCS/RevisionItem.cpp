@@ -17,6 +17,7 @@
 
 #include "Common.h"
 #include "RevisionItem.h"
+#include "BlobStorage.h"
 
 namespace VCS
 {
@@ -112,6 +113,26 @@ DiffLogic *RevisionItem::getDiffLogic() const noexcept
 //===----------------------------------------------------------------------===//
 
 SerializedData RevisionItem::serialize() const
+{
+    return this->serializeWith(nullptr);
+}
+
+SerializedData RevisionItem::serialize(BlobStorage &blobs) const
+{
+    return this->serializeWith(&blobs);
+}
+
+void RevisionItem::deserialize(const SerializedData &data)
+{
+    this->deserializeWith(data, nullptr);
+}
+
+void RevisionItem::deserialize(const SerializedData &data, const BlobStorage &blobs)
+{
+    this->deserializeWith(data, &blobs);
+}
+
+SerializedData RevisionItem::serializeWith(BlobStorage *blobs) const
 {
     SerializedData tree(Serialization::VCS::revisionItem);
 
@@ -127,9 +148,14 @@ SerializedData RevisionItem::serialize() const
         SerializedData deltaNode(delta->serialize());
         const SerializedData deltaData(this->getDeltaData(i));
 
+        if (deltaData.isValid() && blobs != nullptr)
+        {
+            deltaNode.setProperty(Serialization::VCS::deltaDataKey, blobs->put(deltaData));
+            tree.appendChild(deltaNode);
+        }
         // sometimes we need to create copy since serialized data cannot be shared between two parents
         // but Snapshot seems to share revision items on checkout; need to fix this someday:
-        if (deltaData.isValid())
+        else if (deltaData.isValid())
         {
             deltaNode.appendChild(deltaData.getParent().isValid() ? deltaData.createCopy() : deltaData);
             tree.appendChild(deltaNode);
@@ -139,7 +165,7 @@ SerializedData RevisionItem::serialize() const
     return tree;
 }
 
-void RevisionItem::deserialize(const SerializedData &data)
+void RevisionItem::deserializeWith(const SerializedData &data, const BlobStorage *blobs)
 {
     this->reset();
 
@@ -166,10 +192,22 @@ void RevisionItem::deserialize(const SerializedData &data)
         UniquePointer<Delta> delta(new Delta({}, {}));
         delta->deserialize(e);
 
-        jassert(e.getNumChildren() == 1);
-        if (e.getNumChildren() == 1)
+        if (blobs != nullptr && e.hasProperty(Serialization::VCS::deltaDataKey))
+        {
+            const auto deltaData = blobs->get(e.getProperty(Serialization::VCS::deltaDataKey));
+            jassert(deltaData.isValid());
+            if (deltaData.isValid())
+            {
+                this->deltasData.add(deltaData);
+            }
+        }
+        else
         {
-            this->deltasData.add(e.getChild(0));
+            jassert(e.getNumChildren() == 1);
+            if (e.getNumChildren() == 1)
+            {
+                this->deltasData.add(e.getChild(0));
+            }
         }
 
         this->deltas.add(delta.release());
@@ -21,6 +21,8 @@
 
 namespace VCS
 {
+    class BlobStorage;
+
     class RevisionItem final :
         public TrackedItem,
         public Serializable,
@@ -62,10 +64,18 @@ namespace VCS
         void deserialize(const SerializedData &data) override;
         void reset() override;
 
+        // same as above, but with the deltas data kept in the blob storage,
+        // and only referenced by keys; used for the whole history tree
+        SerializedData serialize(BlobStorage &blobs) const;
+        void deserialize(const SerializedData &data, const BlobStorage &blobs);
+
         using Ptr = ReferenceCountedObjectPtr<RevisionItem>;
 
     private:
 
+        SerializedData serializeWith(BlobStorage *blobs) const;
+        void deserializeWith(const SerializedData &data, const BlobStorage *blobs);
+
         OwnedArray<Delta> deltas;
         Array<SerializedData> deltasData;
         UniquePointer<DiffLogic> logic;
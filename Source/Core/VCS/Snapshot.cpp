@@ -23,40 +23,42 @@ namespace VCS
 {
 
 Snapshot::Snapshot(const Snapshot &other) :
-    items(other.items) {}
+    items(other.items),
+    itemsIndex(other.itemsIndex),
+    itemsPositions(other.itemsPositions) {}
 
 Snapshot::Snapshot(const Snapshot *other) :
-    items(other->items) {}
+    items(other->items),
+    itemsIndex(other->itemsIndex),
+    itemsPositions(other->itemsPositions) {}
 
 void Snapshot::addItem(RevisionItem::Ptr item)
 {
-    RevisionItem::Ptr ownItem = this->getItemWithSameUuid(item);
-
-    if (ownItem == nullptr)
-    {
-        this->items.addIfNotAlreadyThere(item);
-    }
-    else
-    {
-        // ситуация, когда в состоянии есть removed запись, которую нужно заменить на added
-        this->items.removeAllInstancesOf(ownItem);
-        this->items.addIfNotAlreadyThere(item);
-    }
+    // ситуация, когда в состоянии есть removed запись, которую нужно заменить на added
+    this->setItem(item);
 }
 
 void Snapshot::removeItem(RevisionItem::Ptr item)
 {
-    this->items.removeAllInstancesOf(item);
-
-    RevisionItem::Ptr ownItem = this->getItemWithSameUuid(item);
+    // removed-запись
+    this->setItem(item);
+}
 
-    if (ownItem != nullptr)
+void Snapshot::setItem(RevisionItem::Ptr item)
+{
+    const auto uuid = item->getUuid();
+    const auto foundPosition = this->itemsPositions.find(uuid);
+    if (foundPosition != this->itemsPositions.end())
     {
-        this->items.removeAllInstancesOf(ownItem);
+        this->items.set(foundPosition->second, item);
+    }
+    else
+    {
+        this->itemsPositions[uuid] = this->items.size();
+        this->items.add(item);
     }
 
-    // removed-запись
-    this->items.addIfNotAlreadyThere(item);
+    this->itemsIndex[uuid] = item;
 }
 
 void Snapshot::mergeItem(RevisionItem::Ptr newItem)
@@ -70,8 +72,7 @@ void Snapshot::mergeItem(RevisionItem::Ptr newItem)
         if (diff->hasAnyChanges())
         {
             RevisionItem::Ptr mergedItem(new RevisionItem(stateItem->getType(), diff.get()));
-            this->items.removeAllInstancesOf(stateItem);
-            this->items.add(mergedItem);
+            this->setItem(mergedItem);
         }
     }
     else
@@ -102,15 +103,164 @@ RevisionItem::Ptr Snapshot::getItemWithSameUuid(RevisionItem::Ptr item) const
 
 RevisionItem::Ptr Snapshot::getItemWithUuid(const Uuid &uuid) const
 {
-    for (auto &item : this->items)
+    const auto found = this->itemsIndex.find(uuid);
+    if (found == this->itemsIndex.end())
     {
-        if (item->getUuid() == uuid)
+        return nullptr;
+    }
+
+    return found->second;
+}
+
+//===----------------------------------------------------------------------===//
+// SnapshotKeyframes
+//===----------------------------------------------------------------------===//
+
+const Snapshot *SnapshotKeyframes::find(const String &revisionId)
+{
+    const auto found = this->keyframesIndex.find(revisionId);
+    if (found == this->keyframesIndex.end())
+    {
+        return nullptr;
+    }
+
+    found->second->lastUsed = ++this->usageCounter;
+    return &found->second->snapshot;
+}
+
+void SnapshotKeyframes::add(const String &revisionId, const Snapshot &snapshot)
+{
+    if (this->find(revisionId) != nullptr)
+    {
+        return; // revisions are immutable, so is their keyframe
+    }
+
+    if (this->keyframes.size() >= SnapshotKeyframes::maxNumKeyframes)
+    {
+        auto *leastRecentlyUsed = this->keyframes.getFirst();
+        for (auto *keyframe : this->keyframes)
         {
-            return item;
+            if (keyframe->lastUsed < leastRecentlyUsed->lastUsed)
+            {
+                leastRecentlyUsed = keyframe;
+            }
         }
+
+        this->keyframesIndex.erase(leastRecentlyUsed->revisionId);
+        this->keyframes.removeObject(leastRecentlyUsed);
     }
 
-    return nullptr;
+    auto *keyframe = this->keyframes.add(new Keyframe(revisionId, snapshot));
+    keyframe->lastUsed = ++this->usageCounter;
+    this->keyframesIndex[revisionId] = keyframe;
 }
 
+void SnapshotKeyframes::clear()
+{
+    this->keyframesIndex.clear();
+    this->keyframes.clear();
+}
+
+//===----------------------------------------------------------------------===//
+// Tests
+//===----------------------------------------------------------------------===//
+
+#if JUCE_UNIT_TESTS
+
+class SnapshotTests final : public UnitTest
+{
+public:
+
+    SnapshotTests() : UnitTest("VCS snapshot tests", UnitTestCategories::helio) {}
+
+    void runTest() override
+    {
+        SnapshotKeyframes keyframes;
+        Snapshot snapshot;
+
+        beginTest("Keyframes lookup");
+
+        expect(keyframes.find("0") == nullptr);
+        keyframes.add("0", snapshot);
+        expect(keyframes.find("0") != nullptr);
+
+        beginTest("Least recently used keyframes eviction");
+
+        for (int i = 1; i < SnapshotKeyframes::maxNumKeyframes; ++i)
+        {
+            keyframes.add(String(i), snapshot);
+        }
+
+        // all fit, mark the first one as recently used, so that the second one
+        // is the least recently used now and will be dropped by the next add
+        expect(keyframes.find("0") != nullptr);
+        keyframes.add(String(SnapshotKeyframes::maxNumKeyframes), snapshot);
+
+        expect(keyframes.find("0") != nullptr);
+        expect(keyframes.find("1") == nullptr);
+        expect(keyframes.find("2") != nullptr);
+        expect(keyframes.find(String(SnapshotKeyframes::maxNumKeyframes)) != nullptr);
+
+        keyframes.clear();
+        expect(keyframes.find("0") == nullptr);
+
+        beginTest("Snapshot items replaced by uuid");
+
+        RevisionItem::Ptr first(new RevisionItem(RevisionItem::Type::Added, nullptr));
+        RevisionItem::Ptr second(new RevisionItem(RevisionItem::Type::Added, nullptr));
+        RevisionItem::Ptr firstRemoved(new RevisionItem(RevisionItem::Type::Removed, nullptr));
+        firstRemoved->setVCSUuid(first->getUuid());
+
+        snapshot.addItem(first);
+        snapshot.addItem(second);
+        snapshot.removeItem(firstRemoved);
+
+        // the replaced item keeps its position
+        expectEquals(snapshot.getNumTrackedItems(), 2);
+        expect(snapshot.getTrackedItem(0) == firstRemoved.get());
+        expect(snapshot.getTrackedItem(1) == second.get());
+        expect(snapshot.getItemWithUuid(first->getUuid()) == firstRemoved);
+        expect(snapshot.getItemWithUuid(second->getUuid()) == second);
+        expect(snapshot.getItemWithUuid(Uuid()) == nullptr);
+
+        const Snapshot copy(snapshot);
+        expect(copy.getItemWithUuid(second->getUuid()) == second);
+
+        beginTest("Large snapshot items replaced in place");
+
+        static constexpr auto numItems = 10000;
+
+        Snapshot largeSnapshot;
+        Array<RevisionItem::Ptr> addedItems;
+        for (int i = 0; i < numItems; ++i)
+        {
+            RevisionItem::Ptr item(new RevisionItem(RevisionItem::Type::Added, nullptr));
+            largeSnapshot.addItem(item);
+            addedItems.add(item);
+        }
+
+        // replace every other item, like a reset or a cherry-pick would do
+        Array<RevisionItem::Ptr> expectedItems(addedItems);
+        for (int i = 0; i < numItems; i += 2)
+        {
+            RevisionItem::Ptr removedItem(new RevisionItem(RevisionItem::Type::Removed, nullptr));
+            removedItem->setVCSUuid(addedItems[i]->getUuid());
+            largeSnapshot.removeItem(removedItem);
+            expectedItems.set(i, removedItem);
+        }
+
+        expectEquals(largeSnapshot.getNumTrackedItems(), numItems);
+        for (int i = 0; i < numItems; ++i)
+        {
+            const auto &expectedItem = expectedItems.getReference(i);
+            expect(largeSnapshot.getTrackedItem(i) == expectedItem.get());
+            expect(largeSnapshot.getItemWithUuid(expectedItem->getUuid()) == expectedItem);
+        }
+    }
+};
+
+static SnapshotTests snapshotTests;
+
+#endif
+
 }
@@ -57,6 +57,52 @@ namespace VCS
 
         Array<RevisionItem::Ptr> items;
 
+        // each uuid is present in items only once, and a replaced
+        // item takes the place of the old one, so positions are stable
+        FlatHashMap<Uuid, RevisionItem::Ptr, UuidHash> itemsIndex;
+        FlatHashMap<Uuid, int, UuidHash> itemsPositions;
+
+        void setItem(RevisionItem::Ptr item);
+
         JUCE_LEAK_DETECTOR(Snapshot);
     };
+
+    // Materialized snapshots of some revisions, so that moving the head
+    // doesn't have to replay the whole history from the root revision:
+    // the head keeps every Nth revision on its way and the recently visited
+    // ones, and the least recently used keyframes are dropped over the limit;
+    // copying a snapshot is cheap, since the revision items are shared
+
+    class SnapshotKeyframes final
+    {
+    public:
+
+        SnapshotKeyframes() = default;
+
+        // returns nullptr if there's no keyframe for this revision
+        const Snapshot *find(const String &revisionId);
+        void add(const String &revisionId, const Snapshot &snapshot);
+        void clear();
+
+        static constexpr auto keyframeInterval = 16;
+        static constexpr auto maxNumKeyframes = 32;
+
+    private:
+
+        struct Keyframe final
+        {
+            Keyframe(const String &revisionId, const Snapshot &snapshot) :
+                revisionId(revisionId), snapshot(snapshot) {}
+
+            const String revisionId;
+            const Snapshot snapshot;
+            uint64 lastUsed = 0;
+        };
+
+        OwnedArray<Keyframe> keyframes;
+        FlatHashMap<String, Keyframe *, StringHash> keyframesIndex;
+        uint64 usageCounter = 0;
+
+        JUCE_DECLARE_NON_COPYABLE(SnapshotKeyframes)
+    };
 } // namespace VCS
@@ -90,23 +90,45 @@ void StashesRepository::resetQuickStash()
 //===----------------------------------------------------------------------===//
 
 SerializedData StashesRepository::serialize() const
+{
+    return this->serializeWith(nullptr);
+}
+
+SerializedData StashesRepository::serialize(BlobStorage &blobs) const
+{
+    return this->serializeWith(&blobs);
+}
+
+void StashesRepository::deserialize(const SerializedData &data)
+{
+    this->deserializeWith(data, nullptr);
+}
+
+void StashesRepository::deserialize(const SerializedData &data, const BlobStorage &blobs)
+{
+    this->deserializeWith(data, &blobs);
+}
+
+SerializedData StashesRepository::serializeWith(BlobStorage *blobs) const
 {
     SerializedData tree(Serialization::VCS::stashesRepository);
     
     SerializedData userStashesXml(Serialization::VCS::userStashes);
     tree.appendChild(userStashesXml);
     
-    userStashesXml.appendChild(this->userStashes->serialize());
+    userStashesXml.appendChild(blobs != nullptr ?
+        this->userStashes->serialize(*blobs) : this->userStashes->serialize());
 
     SerializedData quickStashXml(Serialization::VCS::quickStash);
     tree.appendChild(quickStashXml);
 
-    quickStashXml.appendChild(this->quickStash->serialize());
+    quickStashXml.appendChild(blobs != nullptr ?
+        this->quickStash->serialize(*blobs) : this->quickStash->serialize());
     
     return tree;
 }
 
-void StashesRepository::deserialize(const SerializedData &data)
+void StashesRepository::deserializeWith(const SerializedData &data, const BlobStorage *blobs)
 {
     this->reset();
 
@@ -118,13 +140,27 @@ void StashesRepository::deserialize(const SerializedData &data)
     const auto userStashesParams = root.getChildWithName(Serialization::VCS::userStashes);
     if (userStashesParams.isValid())
     {
-        this->userStashes->deserialize(userStashesParams);
+        if (blobs != nullptr)
+        {
+            this->userStashes->deserialize(userStashesParams, *blobs);
+        }
+        else
+        {
+            this->userStashes->deserialize(userStashesParams);
+        }
     }
 
     const auto quickStashParams = root.getChildWithName(Serialization::VCS::quickStash);
     if (quickStashParams.isValid())
     {
-        this->quickStash->deserialize(quickStashParams);
+        if (blobs != nullptr)
+        {
+            this->quickStash->deserialize(quickStashParams, *blobs);
+        }
+        else
+        {
+            this->quickStash->deserialize(quickStashParams);
+        }
     }
 }
 
@@ -48,10 +48,16 @@ namespace VCS
         void deserialize(const SerializedData &data) override;
         void reset() override;
 
+        SerializedData serialize(BlobStorage &blobs) const;
+        void deserialize(const SerializedData &data, const BlobStorage &blobs);
+
         using Ptr = ReferenceCountedObjectPtr<StashesRepository>;
 
     private:
 
+        SerializedData serializeWith(BlobStorage *blobs) const;
+        void deserializeWith(const SerializedData &data, const BlobStorage *blobs);
+
         // root node for the stashes
         Revision::Ptr userStashes;
 
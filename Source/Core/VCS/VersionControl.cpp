@@ -29,6 +29,7 @@ VersionControl::VersionControl(VCS::TrackedItemsSource &parent) :
 {
     MessageManagerLock lock;
     this->addChangeListener(&this->head);
+    this->indexRevisions(this->rootRevision);
     this->head.moveTo(this->rootRevision);
 }
 
@@ -84,7 +85,10 @@ void VersionControl::replaceHistory(const VCS::Revision::Ptr root)
     // which means we're cloning project and replacing stub root with valid one:
     DBG("Replacing history tree");
     this->rootRevision = root;
+    this->revisionsIndex.clear();
+    this->indexRevisions(this->rootRevision);
     // make sure head doesn't point to replaced revision:
+    this->head.resetKeyframes();
     this->head.moveTo(this->rootRevision);
     this->sendChangeMessage();
 }
@@ -92,20 +96,22 @@ void VersionControl::replaceHistory(const VCS::Revision::Ptr root)
 void VersionControl::appendSubtree(const VCS::Revision::Ptr subtree, const String &appendRevisionId)
 {
     jassert(appendRevisionId.isNotEmpty());
-    if (auto targetRevision = this->getRevisionById(this->rootRevision, appendRevisionId))
+    if (auto targetRevision = this->getRevisionById(appendRevisionId))
     {
         targetRevision->addChild(subtree);
+        this->indexRevisions(subtree);
         this->sendChangeMessage();
     }
 }
 
 VCS::Revision::Ptr VersionControl::updateShallowRevisionData(const String &id, const SerializedData &data)
 {
-    if (auto revision = this->getRevisionById(this->rootRevision, id))
+    if (auto revision = this->getRevisionById(id))
     {
         if (revision->isShallowCopy())
         {
             revision->deserializeDeltas(data);
+            this->head.resetKeyframes();
             this->sendChangeMessage();
         }
 
@@ -122,6 +128,7 @@ void VersionControl::quickAmendItem(VCS::TrackedItem *targetItem)
     // changes and deletions to committed items will not work:
     VCS::RevisionItem::Ptr revisionRecord(new VCS::RevisionItem(VCS::RevisionItem::Type::Added, targetItem));
     this->head.getHeadingRevision()->addItem(revisionRecord);
+    this->head.resetKeyframes();
     this->head.moveTo(this->head.getHeadingRevision());
     this->sendChangeMessage();
 }
@@ -181,6 +188,7 @@ bool VersionControl::commit(SparseSet<int> selectedItems, const String &message)
     if (headingRevision == nullptr) { return false; }
 
     headingRevision->addChild(newRevision);
+    this->indexRevisions(newRevision);
     this->head.moveTo(newRevision);
 
     this->sendChangeMessage();
@@ -384,9 +392,14 @@ SerializedData VersionControl::serialize() const
     tree.setProperty(Serialization::VCS::headRevisionId, this->head.getHeadingRevision()->getUuid());
     tree.setProperty(Serialization::VCS::diffFormatVersion, VersionControl::diffFormatVersion);
 
-    tree.appendChild(this->rootRevision->serialize());
-    tree.appendChild(this->stashes->serialize());
-    tree.appendChild(this->head.serialize());
+    // all revisions, stashes and the snapshot only keep
+    // the keys of their deltas data, which is stored once:
+    this->blobs.beginSaving();
+    tree.appendChild(this->rootRevision->serialize(this->blobs));
+    tree.appendChild(this->stashes->serialize(this->blobs));
+    tree.appendChild(this->head.serialize(this->blobs));
+    this->blobs.removeUnused();
+    tree.appendChild(this->blobs.serialize());
 
 #if !NO_NETWORK
     tree.appendChild(this->remoteCache.serialize());
@@ -406,8 +419,13 @@ void VersionControl::deserialize(const SerializedData &data)
 
     const String headId = root.getProperty(Serialization::VCS::headRevisionId);
 
-    this->rootRevision->deserialize(root);
-    this->stashes->deserialize(root);
+    // the projects saved before blob storage was introduced
+    // have the deltas data inlined, and will be loaded as well
+    this->blobs.deserialize(root);
+
+    this->rootRevision->deserialize(root, this->blobs);
+    this->indexRevisions(this->rootRevision);
+    this->stashes->deserialize(root, this->blobs);
 
 #if !NO_NETWORK
     this->remoteCache.deserialize(root);
@@ -417,11 +435,11 @@ void VersionControl::deserialize(const SerializedData &data)
 #if DEBUG
         const double headLoadStart = Time::getMillisecondCounterHiRes();
 #endif
-        this->head.deserialize(root);
+        this->head.deserialize(root, this->blobs);
         DBG("Loading VCS snapshot done in " + String(Time::getMillisecondCounterHiRes() - headLoadStart) + "ms");
     }
     
-    if (auto headRevision = this->getRevisionById(this->rootRevision, headId))
+    if (auto headRevision = this->getRevisionById(headId))
     {
         // head keeps a snapshot node, which is the result of applying all deltas
         // from the start (moveTo() does this), in other words, the "project state" of
@@ -452,8 +470,11 @@ void VersionControl::deserialize(const SerializedData &data)
 void VersionControl::reset()
 {
     this->rootRevision->reset();
+    this->revisionsIndex.clear();
+    this->indexRevisions(this->rootRevision);
     this->head.reset();
     this->stashes->reset();
+    this->blobs.reset();
 #if !NO_NETWORK
     this->remoteCache.reset();
 #endif
@@ -463,7 +484,9 @@ void VersionControl::reset()
 // Private
 //===----------------------------------------------------------------------===//
 
-VCS::Revision::Ptr VersionControl::getRevisionById(const VCS::Revision::Ptr startFrom, const String &id) const
+#if JUCE_DEBUG
+
+static VCS::Revision::Ptr findRevisionById(const VCS::Revision::Ptr startFrom, const String &id)
 {
     if (startFrom->getUuid() == id)
     {
@@ -472,7 +495,7 @@ VCS::Revision::Ptr VersionControl::getRevisionById(const VCS::Revision::Ptr star
 
     for (auto *child : startFrom->getChildren())
     {
-        if (auto search = this->getRevisionById(child, id))
+        if (auto search = findRevisionById(child, id))
         {
             return search;
         }
@@ -480,3 +503,30 @@ VCS::Revision::Ptr VersionControl::getRevisionById(const VCS::Revision::Ptr star
 
     return nullptr;
 }
+
+#endif
+
+VCS::Revision::Ptr VersionControl::getRevisionById(const String &id) const
+{
+    // all the places where the tree is changed update the index,
+    // so it's safe to assume the revision is missing if it's not indexed
+    const auto found = this->revisionsIndex.find(id);
+    if (found != this->revisionsIndex.end() &&
+        found->second != nullptr && found->second->getUuid() == id)
+    {
+        return found->second.get();
+    }
+
+    jassert(findRevisionById(this->rootRevision, id) == nullptr);
+    return nullptr;
+}
+
+void VersionControl::indexRevisions(const VCS::Revision::Ptr subtree)
+{
+    this->revisionsIndex[subtree->getUuid()] = subtree.get();
+
+    for (auto *child : subtree->getChildren())
+    {
+        this->indexRevisions(child);
+    }
+}
@@ -29,6 +29,7 @@ class VersionControlEditor;
 #include "Head.h"
 #include "RemoteCache.h"
 #include "StashesRepository.h"
+#include "BlobStorage.h"
 
 class VersionControl final :
     public Serializable,
@@ -111,7 +112,7 @@ public:
     
 protected:
 
-    VCS::Revision::Ptr getRevisionById(const VCS::Revision::Ptr startFrom, const String &id) const;
+    VCS::Revision::Ptr getRevisionById(const String &id) const;
 
     VCS::Head head;
     VCS::StashesRepository::Ptr stashes;
@@ -120,12 +121,23 @@ protected:
     VCS::RemoteCache remoteCache;
 #endif
 
-    static constexpr int diffFormatVersion = 0x0309;
+    // kept between saves and loads, so that saving only hashes the new deltas
+    mutable VCS::BlobStorage blobs;
+    friend class ProjectBenchmarks;
+
+    // 0x030a: deltas data is stored in the blob storage and referenced by keys
+    static constexpr int diffFormatVersion = 0x030a;
 
 private:
 
     VCS::TrackedItemsSource &parent;
 
+    // revisions by id, updated on commits, appended subtrees and whenever
+    // the tree is replaced or reloaded; the lookups never walk the tree,
+    // so the revisions missing in the index are considered missing
+    FlatHashMap<String, WeakReference<VCS::Revision>, StringHash> revisionsIndex;
+    void indexRevisions(const VCS::Revision::Ptr subtree);
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(VersionControl)
     JUCE_DECLARE_WEAK_REFERENCEABLE(VersionControl)
 };
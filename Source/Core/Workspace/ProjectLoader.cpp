@@ -0,0 +1,212 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "Common.h"
+#include "ProjectLoader.h"
+#include "ProjectNode.h"
+#include "DocumentHelpers.h"
+#include "ProgressTooltip.h"
+
+ProjectLoader::ProjectLoader() : Thread("ProjectLoader") {}
+
+ProjectLoader::~ProjectLoader()
+{
+    this->cancel();
+
+    // the parsers give up quickly when the thread is asked to exit
+    this->stopThread(ProjectLoader::threadExitTimeoutMs);
+    this->cancelPendingUpdate();
+}
+
+void ProjectLoader::loadAsync(const File &targetFile,
+    OpenCallback openCallback, LoadedCallback loadedCallback)
+{
+    this->cancel();
+
+    this->lastRequestId++;
+    this->file = targetFile;
+    this->onOpen = std::move(openCallback);
+    this->onLoaded = std::move(loadedCallback);
+
+    this->startTimeMs = Time::getMillisecondCounter();
+    this->startTimer(ProjectLoader::showProgressDelayMs);
+    this->startParsingIfIdle();
+}
+
+void ProjectLoader::cancel()
+{
+    // doesn't wait for the parsing thread to stop,
+    // its result will be discarded in handleAsyncUpdate
+    this->signalThreadShouldExit();
+
+    this->stopTimer();
+    this->hideProgress();
+
+    this->onOpen = nullptr;
+    this->onLoaded = nullptr;
+
+    // the partially restored project is not saved on deletion
+    if (auto *unfinishedProject = this->project.get())
+    {
+        delete unfinishedProject;
+    }
+
+    this->project = nullptr;
+}
+
+bool ProjectLoader::isLoading() const noexcept
+{
+    return this->onLoaded != nullptr;
+}
+
+void ProjectLoader::startParsingIfIdle()
+{
+    // if the previous file is still being parsed, or its result is pending,
+    // this request will be picked up in handleAsyncUpdate
+    if (this->isThreadRunning() || this->isUpdatePending())
+    {
+        this->signalThreadShouldExit();
+        return;
+    }
+
+    this->parsingRequestId = this->lastRequestId;
+    this->fileToParse = this->file;
+    this->startThread();
+}
+
+void ProjectLoader::run()
+{
+    auto data = DocumentHelpers::load(this->fileToParse);
+
+    if (!this->threadShouldExit())
+    {
+        const ScopedLock lock(this->resultLock);
+        this->result = std::move(data);
+    }
+
+    // always notify, even if cancelled, so that the next request can start
+    this->triggerAsyncUpdate();
+}
+
+void ProjectLoader::handleAsyncUpdate()
+{
+    // the thread has done its job by now and is just about to exit
+    this->waitForThreadToExit(ProjectLoader::threadExitTimeoutMs);
+
+    SerializedData data;
+
+    {
+        const ScopedLock lock(this->resultLock);
+        data = std::move(this->result);
+        this->result = {};
+    }
+
+    if (!this->isLoading() || this->onOpen == nullptr)
+    {
+        return;
+    }
+
+    if (this->parsingRequestId != this->lastRequestId)
+    {
+        this->startParsingIfIdle();
+        return;
+    }
+
+    // the callback might as well start loading another project
+    const auto openCallback = std::move(this->onOpen);
+    this->onOpen = nullptr;
+
+    auto *openedProject = openCallback(this->file, data);
+    if (openedProject == nullptr || !openedProject->isLoading())
+    {
+        if (this->parsingRequestId == this->lastRequestId)
+        {
+            this->cancel();
+        }
+
+        return;
+    }
+
+    this->project = openedProject;
+    this->startTimer(ProjectLoader::loadingStepIntervalMs);
+}
+
+void ProjectLoader::timerCallback()
+{
+    if (!this->isShowingProgress &&
+        Time::getMillisecondCounter() - this->startTimeMs >=
+            uint32(ProjectLoader::showProgressDelayMs))
+    {
+        this->showProgress();
+    }
+
+    auto *loadingProject = dynamic_cast<ProjectNode *>(this->project.get());
+    if (loadingProject == nullptr)
+    {
+        if (this->onOpen == nullptr)
+        {
+            // the project was deleted halfway
+            this->cancel();
+        }
+
+        return;
+    }
+
+    if (!loadingProject->loadNextChildren(ProjectLoader::loadingStepTimeBudgetMs))
+    {
+        this->finishLoading();
+    }
+}
+
+void ProjectLoader::finishLoading()
+{
+    auto *loadedProject = dynamic_cast<ProjectNode *>(this->project.get());
+    jassert(loadedProject != nullptr);
+
+    this->stopTimer();
+    this->hideProgress();
+
+    loadedProject->finishLoading();
+    this->project = nullptr;
+
+    // the callback might as well start loading another project
+    const auto loadedCallback = std::move(this->onLoaded);
+    this->onLoaded = nullptr;
+
+    loadedCallback(*loadedProject);
+}
+
+void ProjectLoader::showProgress()
+{
+    this->isShowingProgress = true;
+    App::showModalComponent(ProgressTooltip::cancellable([this]()
+    {
+        // the tooltip dismisses itself after this callback
+        this->isShowingProgress = false;
+        this->cancel();
+    }));
+}
+
+void ProjectLoader::hideProgress()
+{
+    if (this->isShowingProgress)
+    {
+        this->isShowingProgress = false;
+        App::dismissAllModalComponents();
+    }
+}
@@ -0,0 +1,88 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+class TreeNode;
+class ProjectNode;
+
+// Opens projects without freezing the message thread: the file is read
+// and parsed on a background thread, and then the project content is restored
+// on the message thread in steps, a few tracks at a time; if loading takes
+// noticeable time, it shows a progress tooltip, which can be cancelled by the user
+
+class ProjectLoader final : private Thread, private Timer, private AsyncUpdater
+{
+public:
+
+    ProjectLoader();
+    ~ProjectLoader() override;
+
+    // called with the parsed data, which is invalid if the file failed to load;
+    // expected to return a new project which has started loading the data
+    // (see ProjectNode::startLoading), or nullptr if there's nothing to load
+    using OpenCallback = Function<ProjectNode *(const File &file, const SerializedData &data)>;
+
+    // called when the project content is fully restored,
+    // not called at all if the loading was cancelled
+    using LoadedCallback = Function<void(ProjectNode &project)>;
+
+    // cancels the previous loading, if any
+    void loadAsync(const File &file, OpenCallback onOpen, LoadedCallback onLoaded);
+    void cancel();
+
+    bool isLoading() const noexcept;
+
+private:
+
+    void run() override;
+    void timerCallback() override;
+    void handleAsyncUpdate() override;
+
+    void startParsingIfIdle();
+    void finishLoading();
+
+    void showProgress();
+    void hideProgress();
+
+    File file;
+    OpenCallback onOpen;
+    LoadedCallback onLoaded;
+
+    // requests are counted to tell if the parsed data is stale,
+    // i.e. if another file was requested while the previous one was parsed
+    int lastRequestId = 0;
+    int parsingRequestId = 0;
+    File fileToParse;
+
+    CriticalSection resultLock;
+    SerializedData result;
+
+    // the project which content is being restored in steps
+    WeakReference<TreeNode> project;
+
+    uint32 startTimeMs = 0;
+    bool isShowingProgress = false;
+
+    static constexpr auto showProgressDelayMs = 250;
+    static constexpr auto loadingStepIntervalMs = 1;
+    static constexpr auto loadingStepTimeBudgetMs = 15.0;
+    static constexpr auto threadExitTimeoutMs = 1000;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ProjectLoader)
+};
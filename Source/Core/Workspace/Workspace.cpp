@@ -25,6 +25,9 @@
 #include "SettingsNode.h"
 #include "OrchestraPitNode.h"
 #include "ProjectNode.h"
+#include "ProjectLoader.h"
+#include "PianoTrackNode.h"
+#include "PatternEditorNode.h"
 #include "SerializationKeys.h"
 #include "CommandPaletteProjectsList.h"
 #include "MainLayout.h"
@@ -45,6 +48,7 @@ void Workspace::init()
         this->treeRoot = make<RootNode>("Workspace");
 
         this->consoleProjectsList = make<CommandPaletteProjectsList>(*this);
+        this->projectLoader = make<ProjectLoader>();
 
         if (! this->autoload())
         {
@@ -58,6 +62,35 @@ void Workspace::init()
     }
 }
 
+static void waitForBuiltInInstruments(AudioCore &audioCore, Function<void()> callback)
+{
+    if (audioCore.getDefaultInstrument() != nullptr &&
+        audioCore.getMetronomeInstrument() != nullptr)
+    {
+        callback();
+        return;
+    }
+
+    Timer::callAfterDelay(10, [&audioCore, callback]()
+    {
+        waitForBuiltInInstruments(audioCore, callback);
+    });
+}
+
+void Workspace::initHeadless(Function<void()> onReady)
+{
+    jassert(! this->wasInitialized);
+
+    this->audioCore = make<AudioCore>();
+    this->pluginManager = make<PluginScanner>();
+    this->treeRoot = make<RootNode>("Workspace");
+
+    // not marking the workspace as initialized, so that it
+    // won't be saved on shutdown, overwriting the user's one
+    this->audioCore->initBuiltInInstrumentsIfNeeded();
+    waitForBuiltInInstruments(*this->audioCore, onReady);
+}
+
 bool Workspace::isInitialized() const noexcept
 {
     return this->wasInitialized;
@@ -67,6 +100,8 @@ void Workspace::shutdown()
 {
     if (this->wasInitialized)
     {
+        this->projectLoader = nullptr;
+
         this->autosave();
 
         // To cleanup properly, remove all projects first (before instruments etc).
@@ -180,7 +215,27 @@ bool Workspace::loadRecentProject(RecentProjectInfo::Ptr info)
     const File file(info->getLocalFile());
     if (file.existsAsFile())
     {
-        return this->treeRoot->openProject(file) != nullptr;
+        const auto projectId = info->getProjectId();
+        this->projectLoader->loadAsync(file,
+            [this, projectId](const File &loadedFile, const SerializedData &data) -> ProjectNode *
+        {
+            if (!data.isValid())
+            {
+                // same as the callers do when this method returns false
+                this->userProfile.deleteProjectLocally(projectId);
+                return nullptr;
+            }
+
+            return this->treeRoot->openProject(loadedFile, data);
+        },
+            [this](ProjectNode &project)
+        {
+            this->userProfile.onProjectLocalInfoUpdated(project.getId(),
+                project.getName(), project.getDocument()->getFullPath());
+            project.selectFirstChildOfType<PianoTrackNode, PatternEditorNode>();
+        });
+
+        return true;
     }
 #if !NO_NETWORK
     else if (info->hasRemoteCopy()) // and not present locally
@@ -386,12 +441,18 @@ void Workspace::importProject(const String &filePattern)
         }
         else
         {
-            if (auto *p = this->treeRoot->openProject(file))
+            this->projectLoader->loadAsync(file,
+                [this](const File &loadedFile, const SerializedData &data)
             {
-                this->userProfile.onProjectLocalInfoUpdated(p->getId(),
-                    p->getName(), p->getDocument()->getFullPath());
+                return this->treeRoot->openProject(loadedFile, data);
+            },
+                [this](ProjectNode &project)
+            {
+                this->userProfile.onProjectLocalInfoUpdated(project.getId(),
+                    project.getName(), project.getDocument()->getFullPath());
+                project.selectFirstChildOfType<PianoTrackNode, PatternEditorNode>();
                 this->autosave();
-            }
+            });
         }
     });
 }
@@ -22,6 +22,7 @@ class ProjectNode;
 class RootNode;
 class PluginScanner;
 class CommandPaletteProjectsList;
+class ProjectLoader;
 
 #include "DocumentOwner.h"
 #include "UserProfile.h"
@@ -37,6 +38,12 @@ public:
 
     void init();
     void shutdown();
+
+    // creates the audio core and the built-in instruments without
+    // opening any devices or loading the saved workspace, and calls back
+    // when the instruments are ready (they are initialized asynchronously)
+    void initHeadless(Function<void()> onReady);
+
     bool isInitialized() const noexcept;
     void stopPlaybackForAllProjects(); // on app suspend / shutdown
 
@@ -56,6 +63,9 @@ public:
     //===------------------------------------------------------------------===//
 
     void createEmptyProject();
+
+    // returns true if the project is present and started loading,
+    // which takes place in background, see ProjectLoader
     bool loadRecentProject(RecentProjectInfo::Ptr file);
     Array<ProjectNode *> getLoadedProjects() const;
     bool hasLoadedProject(const RecentProjectInfo::Ptr file) const;
@@ -97,6 +107,8 @@ private:
 
     UniquePointer<CommandPaletteProjectsList> consoleProjectsList;
 
+    UniquePointer<ProjectLoader> projectLoader;
+
     UniquePointer<FileChooser> newProjectFileChooser;
     UniquePointer<FileChooser> importFileChooser;
 
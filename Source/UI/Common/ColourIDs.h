@@ -162,6 +162,7 @@ namespace ColourIDs
     namespace AudioMonitor
     {
         static const int foreground             = 0x2001700;
+        static const int overrun                = 0x2001701;
     }
 
     namespace RenderProgressBar
@@ -43,13 +43,13 @@ void DashboardMenu::resized()
 
 void DashboardMenu::loadFile(RecentProjectInfo::Ptr project)
 {
+    // the project is loaded in background, and the list is updated
+    // by the dashboard when the user profile changes, i.e. when it's done
     if (!this->workspace.loadRecentProject(project))
     {
         // TODO test if it would be better to just remove the project from the list
         this->workspace.getUserProfile().deleteProjectLocally(project->getProjectId());
     }
-
-    this->updateListContent();
 }
 
 void DashboardMenu::unloadFile(RecentProjectInfo::Ptr project)
@@ -264,12 +264,12 @@ void KeyboardMappingPage::changeListenerCallback(ChangeBroadcaster *source)
 
 void KeyboardMappingPage::stopAllSound()
 {
-    auto &midiCollector = this->instrument->getProcessorPlayer().getMidiMessageCollector();
+    auto &midiQueue = this->instrument->getProcessorPlayer().getMidiMessageQueue();
     for (int i = 1; i < Globals::numChannels; ++i)
     {
         auto notesOff = MidiMessage::allNotesOff(i);
         notesOff.setTimeStamp(Time::getMillisecondCounterHiRes() * 0.001);
-        midiCollector.addMessageToQueue(notesOff);
+        midiQueue.addMessageToQueue(notesOff);
     }
 }
 
@@ -280,11 +280,11 @@ void KeyboardMappingPage::onKeyPreview(int i)
     const auto mapped = keyMap->map(key);
 
     const auto time = Time::getMillisecondCounterHiRes() * 0.001;
-    auto &midiCollector = this->instrument->getProcessorPlayer().getMidiMessageCollector();
+    auto &midiQueue = this->instrument->getProcessorPlayer().getMidiMessageQueue();
 
     auto message = MidiMessage::noteOn(mapped.channel, mapped.key, 0.5f);
     message.setTimeStamp(time + 0.01);
-    midiCollector.addMessageToQueue(message);
+    midiQueue.addMessageToQueue(message);
 }
 
 void KeyboardMappingPage::onKeyMappingUpdated(int i)
@@ -0,0 +1,233 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "Common.h"
+#include "AudioLoadSettings.h"
+#include "AudioCore.h"
+#include "DocumentHelpers.h"
+#include "MainLayout.h"
+#include "ColourIDs.h"
+
+AudioLoadSettings::AudioLoadSettings(AudioCore &audioCore) :
+    audioCore(audioCore)
+{
+    this->setFocusContainerType(Component::FocusContainerType::none);
+    this->setWantsKeyboardFocus(false);
+    this->setPaintingIsUnclipped(true);
+
+    this->instrumentsList = make<ListBox>();
+    this->addAndMakeVisible(this->instrumentsList.get());
+
+    this->saveReportButton = make<TextButton>();
+    this->addAndMakeVisible(this->saveReportButton.get());
+    this->saveReportButton->setButtonText(TRANS(I18n::Settings::audioLoadSaveReport));
+    this->saveReportButton->onClick = [this]()
+    {
+        this->saveReport();
+    };
+
+    this->updateStatistics();
+
+    this->setSize(100, AudioLoadSettings::summaryHeight +
+        AudioLoadSettings::rowHeight * AudioLoadSettings::numVisibleRows +
+        AudioLoadSettings::buttonHeight + 8);
+
+    this->instrumentsList->setModel(this);
+    this->instrumentsList->setRowHeight(AudioLoadSettings::rowHeight);
+    this->instrumentsList->getViewport()->setScrollBarsShown(true, false);
+
+    this->startTimerHz(AudioLoadSettings::updatesPerSecond);
+}
+
+AudioLoadSettings::~AudioLoadSettings()
+{
+    this->stopTimer();
+}
+
+//===----------------------------------------------------------------------===//
+// Component
+//===----------------------------------------------------------------------===//
+
+void AudioLoadSettings::paint(Graphics &g)
+{
+    g.setColour(findDefaultColour(Label::textColourId));
+    g.setFont(Globals::UI::Fonts::S);
+    g.drawText(this->deviceSummary,
+        8, 0, this->getWidth() - 16, AudioLoadSettings::summaryHeight,
+        Justification::centredLeft, true);
+}
+
+void AudioLoadSettings::resized()
+{
+    this->instrumentsList->setBounds(0, AudioLoadSettings::summaryHeight,
+        this->getWidth(), AudioLoadSettings::rowHeight * AudioLoadSettings::numVisibleRows);
+
+    constexpr auto leftMargin = 48;
+    constexpr auto rightMargin = 16;
+    this->saveReportButton->setBounds(leftMargin,
+        this->getHeight() - AudioLoadSettings::buttonHeight - 2,
+        this->getWidth() - (leftMargin + rightMargin), AudioLoadSettings::buttonHeight);
+}
+
+//===----------------------------------------------------------------------===//
+// ListBoxModel
+//===----------------------------------------------------------------------===//
+
+int AudioLoadSettings::getNumRows()
+{
+    return this->instrumentLoads.size();
+}
+
+void AudioLoadSettings::paintListBoxItem(int rowNumber, Graphics &g,
+    int width, int height, bool rowIsSelected)
+{
+    if (!isPositiveAndBelow(rowNumber, this->instrumentLoads.size()))
+    {
+        return;
+    }
+
+    const auto &load = this->instrumentLoads.getReference(rowNumber);
+    const auto &statistics = load.statistics;
+    const auto textColour = findDefaultColour(Label::textColourId);
+    const auto barColour = findDefaultColour(ColourIDs::AudioMonitor::foreground).withAlpha(0.5f);
+    const auto overrunColour = findDefaultColour(ColourIDs::AudioMonitor::overrun);
+
+    // the histogram of the recent blocks is on the right,
+    // the last bin, the blocks which took longer than their duration,
+    // is highlighted, since these are the ones to blame for glitches
+    constexpr auto barWidth = 4;
+    constexpr auto barGap = 1;
+    constexpr auto histogramWidth = AudioLoadMeter::numHistogramBins * (barWidth + barGap);
+    const auto histogramX = width - histogramWidth - 8;
+    const auto maxBarHeight = height - 8;
+
+    int maxBinCount = 1;
+    for (const auto count : statistics.histogram)
+    {
+        maxBinCount = jmax(maxBinCount, count);
+    }
+
+    for (int i = 0; i < AudioLoadMeter::numHistogramBins; ++i)
+    {
+        const auto isOverrunBin = i == AudioLoadMeter::numHistogramBins - 1;
+        g.setColour(isOverrunBin && statistics.histogram[i] > 0 ?
+            overrunColour : barColour);
+
+        const auto barHeight = statistics.histogram[i] == 0 ? 0 :
+            jmax(1, maxBarHeight * statistics.histogram[i] / maxBinCount);
+
+        g.fillRect(histogramX + i * (barWidth + barGap),
+            height - 4 - barHeight, barWidth, barHeight);
+    }
+
+    const auto toPercent = [](float load)
+    {
+        return String(roundToInt(load * 100.f)) + "%";
+    };
+
+    auto numbers =
+        TRANS(I18n::Settings::audioLoadAverage) + ": " + toPercent(statistics.averageLoad) + ", " +
+        TRANS(I18n::Settings::audioLoadPeak) + ": " + toPercent(statistics.peakLoad) + ", " +
+        TRANS(I18n::Settings::audioLoadOverruns) + ": " + String(statistics.numOverruns);
+
+    // hardly ever happens, so only shown when it does
+    if (load.numDroppedMidiMessages > 0)
+    {
+        numbers << ", " << TRANS(I18n::Settings::audioLoadDroppedMidi)
+            << ": " << String(load.numDroppedMidiMessages);
+    }
+
+    const auto textWidth = histogramX - 16;
+    const auto nameWidth = textWidth / 3;
+
+    g.setColour(textColour);
+    g.setFont(Globals::UI::Fonts::S);
+    g.drawText(load.name, 8, 0, nameWidth, height, Justification::centredLeft, true);
+
+    g.setColour(textColour.withAlpha(0.75f));
+    g.drawText(numbers, 8 + nameWidth, 0, textWidth - nameWidth, height,
+        Justification::centredLeft, true);
+}
+
+//===----------------------------------------------------------------------===//
+// Timer
+//===----------------------------------------------------------------------===//
+
+void AudioLoadSettings::timerCallback()
+{
+    if (!this->isShowing())
+    {
+        return;
+    }
+
+    this->updateStatistics();
+    this->instrumentsList->updateContent();
+    this->instrumentsList->repaint();
+    this->repaint(0, 0, this->getWidth(), AudioLoadSettings::summaryHeight);
+}
+
+void AudioLoadSettings::updateStatistics()
+{
+    this->instrumentLoads.clearQuick();
+
+    for (auto *instrument : this->audioCore.getInstruments())
+    {
+        auto &player = instrument->getProcessorPlayer();
+        this->instrumentLoads.add({ instrument->getName(),
+            player.getLoadMeter().getStatistics(false),
+            player.getMidiMessageQueue().getNumDroppedMessages() });
+    }
+
+    auto &deviceManager = this->audioCore.getDevice();
+    this->deviceSummary = TRANS(I18n::Settings::audioLoadDevice) + ": " +
+        String(roundToInt(deviceManager.getCpuUsage() * 100.0)) + "%";
+
+    if (auto *device = deviceManager.getCurrentAudioDevice())
+    {
+        const auto numXruns = device->getXRunCount();
+        if (numXruns >= 0) // -1 means the device can't tell
+        {
+            this->deviceSummary << ", " << TRANS(I18n::Settings::audioLoadXruns)
+                << ": " << String(numXruns);
+        }
+    }
+}
+
+void AudioLoadSettings::saveReport()
+{
+    const auto defaultFileName = "audio-load-" +
+        Time::getCurrentTime().formatted("%Y-%m-%d-%H-%M-%S") + ".json";
+
+    this->reportFileChooser = make<FileChooser>(TRANS(I18n::Settings::audioLoadSaveReport),
+        File::getSpecialLocation(File::userDocumentsDirectory).getChildFile(defaultFileName),
+        "*.json", true);
+
+    DocumentHelpers::showFileChooser(this->reportFileChooser,
+        Globals::UI::FileChooser::forFileToSave,
+        [this](URL &url)
+    {
+        if (!url.isLocalFile())
+        {
+            return;
+        }
+
+        const auto result = this->audioCore.saveLoadStatistics(url.getLocalFile());
+        App::Layout().showTooltip(result.getErrorMessage(), result.wasOk() ?
+            MainLayout::TooltipIcon::Success : MainLayout::TooltipIcon::Failure);
+    });
+}
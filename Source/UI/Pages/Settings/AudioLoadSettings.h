@@ -0,0 +1,88 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+class AudioCore;
+
+#include "AudioLoadMeter.h"
+
+// Shows how much of each block's time budget the instruments take,
+// and saves the detailed report into a file to investigate glitches
+
+class AudioLoadSettings final : public Component,
+    public ListBoxModel, private Timer
+{
+public:
+
+    explicit AudioLoadSettings(AudioCore &audioCore);
+    ~AudioLoadSettings() override;
+
+    //===------------------------------------------------------------------===//
+    // ListBoxModel
+    //===------------------------------------------------------------------===//
+
+    int getNumRows() override;
+    void paintListBoxItem(int rowNumber, Graphics &g,
+        int width, int height, bool rowIsSelected) override;
+
+    //===------------------------------------------------------------------===//
+    // Component
+    //===------------------------------------------------------------------===//
+
+    void paint(Graphics &g) override;
+    void resized() override;
+
+private:
+
+    void timerCallback() override;
+
+    void updateStatistics();
+    void saveReport();
+
+    AudioCore &audioCore;
+
+    struct InstrumentLoad final
+    {
+        String name;
+        AudioLoadMeter::Statistics statistics;
+        // the messages which didn't fit into the instrument's midi queue
+        int numDroppedMidiMessages = 0;
+    };
+
+    Array<InstrumentLoad> instrumentLoads;
+
+    String deviceSummary;
+
+#if PLATFORM_DESKTOP
+    static constexpr auto rowHeight = 32;
+#elif PLATFORM_MOBILE
+    static constexpr auto rowHeight = 48;
+#endif
+
+    static constexpr auto numVisibleRows = 5;
+    static constexpr auto summaryHeight = 32;
+    static constexpr auto buttonHeight = 32;
+    static constexpr auto updatesPerSecond = 4;
+
+    UniquePointer<ListBox> instrumentsList;
+    UniquePointer<TextButton> saveReportButton;
+    UniquePointer<FileChooser> reportFileChooser;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AudioLoadSettings)
+};
@@ -106,7 +106,57 @@ void HistoryComponent::clearSelection()
 
 void HistoryComponent::rebuildRevisionTree()
 {
-    this->revisionTree = new RevisionTreeComponent(this->vcs);
+    RevisionTreeLayout::Ptr newLayout(new RevisionTreeLayout(this->vcs.getRoot()));
+
+    if (this->pendingLayout != nullptr &&
+        this->pendingLayout->hasSameTopologyAs(*newLayout))
+    {
+        return; // the same one is being computed right now
+    }
+
+    if (this->layout != nullptr &&
+        this->layout->hasSameTopologyAs(*newLayout))
+    {
+        this->pendingLayout = nullptr;
+
+        // the head or sync states might have changed
+        if (this->revisionTree != nullptr)
+        {
+            this->revisionTree->repaint();
+        }
+        else
+        {
+            this->showRevisionTree(this->layout);
+        }
+
+        return;
+    }
+
+    if (newLayout->getNumRevisions() < RevisionTreeLayout::asyncThreshold)
+    {
+        this->pendingLayout = nullptr;
+        newLayout->compute();
+        this->showRevisionTree(newLayout);
+        return;
+    }
+
+    // the previous tree, if any, stays visible until the new one is ready
+    this->pendingLayout = newLayout;
+    this->layoutWorker.computeAsync(newLayout,
+        [self = SafePointer<HistoryComponent>(this)](RevisionTreeLayout::Ptr computedLayout)
+    {
+        if (self != nullptr && self->pendingLayout == computedLayout)
+        {
+            self->pendingLayout = nullptr;
+            self->showRevisionTree(computedLayout);
+        }
+    });
+}
+
+void HistoryComponent::showRevisionTree(RevisionTreeLayout::Ptr newLayout)
+{
+    this->layout = newLayout;
+    this->revisionTree = new RevisionTreeComponent(this->vcs, newLayout);
     auto *alignerProxy = new ViewportFitProxyComponent(*this->revisionViewport, this->revisionTree, true); // owns revisionTree
     this->revisionViewport->setViewedComponent(alignerProxy, true); // owns alignerProxy
     alignerProxy->centerTargetToViewport();
@@ -21,6 +21,7 @@ class VersionControl;
 class RevisionTreeComponent;
 
 #include "HeadlineItemDataSource.h"
+#include "RevisionTreeLayout.h"
 #include "SeparatorHorizontalFadingReversed.h"
 
 class HistoryComponent final : public Component, public HeadlineItemDataSource
@@ -53,9 +54,17 @@ public:
 
 private:
 
+    void showRevisionTree(RevisionTreeLayout::Ptr layout);
+
     VersionControl &vcs;
     SafePointer<RevisionTreeComponent> revisionTree;
 
+    // the layout is only recomputed when the history topology changes,
+    // not on every project change, which also triggers rebuilding the tree
+    RevisionTreeLayout::Ptr layout;
+    RevisionTreeLayout::Ptr pendingLayout;
+    RevisionTreeLayout::Worker layoutWorker;
+
     UniquePointer<Viewport> revisionViewport;
     UniquePointer<Label> revisionTreeLabel;
     UniquePointer<SeparatorHorizontalFadingReversed> separator;
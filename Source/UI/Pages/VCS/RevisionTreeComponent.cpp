@@ -20,44 +20,36 @@
 #include "CommandIDs.h"
 #include "VersionControl.h"
 #include "HistoryComponent.h"
-#include "RevisionComponent.h"
-#include "RevisionConnectorComponent.h"
+#include "HeadlineContextMenuController.h"
+#include "ColourIDs.h"
+#include "Icons.h"
 
-RevisionTreeComponent::RevisionTreeComponent(VersionControl &owner) :
-    vcs(owner)
+RevisionTreeComponent::RevisionTreeComponent(VersionControl &owner,
+    RevisionTreeLayout::Ptr layout) :
+    vcs(owner),
+    layout(layout)
 {
-    this->setInterceptsMouseClicks(false, true);
-    this->setSize(1, 1);
+    // hitTest() only lets through the clicks on revisions,
+    // so that the rest is handled by the viewport's drag proxy
+    this->setInterceptsMouseClicks(true, false);
+    this->setMouseClickGrabsKeyboardFocus(false);
 
-    auto *root = this->initComponents(1, this->vcs.getRoot(), nullptr);
-    auto *dt = this->firstWalk(root);
-    
-    float min = -1;
-    min = this->secondWalk(dt, min);
+    this->contextMenuController = make<HeadlineContextMenuController>(*this);
 
-    if (min < 0)
-    {
-        this->thirdWalk(dt, -min);
-    }
-
-    this->postWalk(root);
+    const auto treeBounds = this->layout->getBounds();
+    this->setSize(jmax(1, treeBounds.getWidth()), jmax(1, treeBounds.getHeight()));
 }
 
-RevisionTreeComponent::~RevisionTreeComponent()
-{
-    this->deleteAllChildren();
-}
+RevisionTreeComponent::~RevisionTreeComponent() = default;
 
 void RevisionTreeComponent::deselectAll(bool sendNotification)
 {
-    for (auto *child : this->getChildren())
+    if (this->selectedIndex >= 0)
     {
-        if (auto *revChild = dynamic_cast<RevisionComponent *>(child))
-        {
-            revChild->setSelected(false);
-        }
+        this->repaint(this->layout->getRevisionBounds(this->selectedIndex));
     }
 
+    this->selectedIndex = -1;
     this->selectedRevision = nullptr;
 
     auto *editor = this->findParentEditor();
@@ -67,23 +59,20 @@ void RevisionTreeComponent::deselectAll(bool sendNotification)
     }
 }
 
-void RevisionTreeComponent::selectComponent(RevisionComponent *revComponent,
-    bool deselectOthers, bool sendNotification)
+void RevisionTreeComponent::selectRevision(int index, bool sendNotification)
 {
     // If already selected, deselect (may remove that later):
-    if (this->selectedRevision == revComponent->revision)
+    if (this->selectedIndex == index)
     {
         this->deselectAll(true);
         return;
     }
 
-    if (deselectOthers)
-    {
-        this->deselectAll(false);
-    }
+    this->deselectAll(false);
 
-    revComponent->setSelected(true);
-    this->selectedRevision = revComponent->revision;
+    this->selectedIndex = index;
+    this->selectedRevision = this->layout->getRevision(index);
+    this->repaint(this->layout->getRevisionBounds(index));
 
     auto *editor = this->findParentEditor();
     if (editor != nullptr && sendNotification)
@@ -92,251 +81,139 @@ void RevisionTreeComponent::selectComponent(RevisionComponent *revComponent,
     }
 }
 
-void RevisionTreeComponent::handleCommandMessage(int commandId)
-{
-    if (commandId == CommandIDs::StartDragViewport ||
-        commandId == CommandIDs::EndDragViewport)
-    {
-        this->deselectAll(true);
-    }
-}
-
 VCS::Revision::Ptr RevisionTreeComponent::getSelectedRevision() const noexcept
 {
     return this->selectedRevision;
 }
 
 //===----------------------------------------------------------------------===//
-// Buchheim tree layout functions
+// Component
 //===----------------------------------------------------------------------===//
 
-RevisionComponent *RevisionTreeComponent::initComponents(int depth,
-    const VCS::Revision::Ptr revision, RevisionComponent *parentRevisionComponent)
+void RevisionTreeComponent::paint(Graphics &g)
 {
-#if NO_NETWORK
-    const auto state = VCS::Revision::SyncState::NoSync;
-#else
-    const auto state = this->vcs.getRevisionSyncState(revision);
-#endif
-    const bool isHead = (this->vcs.getHead().getHeadingRevision() == revision);
-
-    auto *revisionComponent = new RevisionComponent(this->vcs, revision, state, isHead);
-    revisionComponent->parent = parentRevisionComponent;
-    revisionComponent->y = float(depth);
-    revisionComponent->number = depth;
-    revisionComponent->ancestor = revisionComponent;
-
-    this->addAndMakeVisible(revisionComponent);
+    this->layout->findRevisionsIn(g.getClipBounds(), this->visibleRevisions);
 
-    for (const auto childRevision : revision->getChildren())
+    g.setColour(findDefaultColour(ColourIDs::VersionControl::connector));
+    for (const auto index : this->visibleRevisions)
     {
-        auto *childComponent = this->initComponents(depth + 1, childRevision, revisionComponent);
-        revisionComponent->children.add(childComponent);
-    }
-
-    return revisionComponent;
-}
-
-RevisionComponent *RevisionTreeComponent::firstWalk(RevisionComponent *v, float distance)
-{
-    if (v->children.size() == 0)
-    {
-        if (v->getLeftmostSibling() != nullptr)
-        {
-            v->x = v->getLeftBrother()->x + distance;
-        }
-        else
+        if (this->layout->hasParent(index))
         {
-            v->x = 0;
+            g.fillPath(this->layout->getConnectorPath(index));
         }
     }
-    else
-    {
-        auto *default_ancestor = v->children[0];
-
-        for (auto *child : v->children)
-        {
-            firstWalk(child);
-            default_ancestor = apportion(child, default_ancestor, distance);
-        }
-
-        executeShifts(v);
-
-        float midpoint = (v->children.getFirst()->x + v->children.getLast()->x) / 2.f;
-
-        auto *w = v->getLeftBrother();
 
-        if (w)
-        {
-            v->x = w->x + distance;
-            v->mod = v->x - midpoint;
-        }
-        else
-        {
-            v->x = midpoint;
-        }
+    const auto headRevision = this->vcs.getHead().getHeadingRevision();
+    for (const auto index : this->visibleRevisions)
+    {
+        this->paintRevision(g, index, this->layout->getRevision(index) == headRevision);
     }
-
-    return v;
 }
 
-RevisionComponent *RevisionTreeComponent::apportion(RevisionComponent *v,
-    RevisionComponent *default_ancestor, float distance)
+void RevisionTreeComponent::paintRevision(Graphics &g, int index, bool isHead) const
 {
-    RevisionComponent *w = v->getLeftBrother();
+    const auto revision = this->layout->getRevision(index);
+    const auto bounds = this->layout->getRevisionBounds(index);
+    const auto x = bounds.getX();
+    const auto y = bounds.getY();
+    const auto w = bounds.getWidth();
+    const auto h = bounds.getHeight();
+
+    g.setColour(findDefaultColour(ColourIDs::VersionControl::outline));
 
-    if (w != nullptr)
+    if (isHead)
     {
-        //in buchheim notation:
-        //i == inner; o == outer; r == right; l == left;
-        RevisionComponent *vir = v;
-        RevisionComponent *vor = v;
-        RevisionComponent *vil = w;
+        g.drawRoundedRectangle(bounds.toFloat(), 9.000f, 1.0f);
+    }
 
-        RevisionComponent *vol = v->getLeftmostSibling();
+    if (index == this->selectedIndex)
+    {
+        g.fillRoundedRectangle(bounds.toFloat().reduced(1.f), 7.000f);
+    }
 
-        float sir = v->mod;
-        float sor = v->mod;
+    // the fading separators above and below
+    const auto paintFadingLine = [&g, x, w](int lineY, Colour colour)
+    {
+        g.setGradientFill(ColourGradient(colour,
+            float(x + w / 2), float(lineY),
+            colour.withAlpha(0.f),
+            float(x + 8), float(lineY),
+            true));
 
-        float sil = vil->mod;
-        float sol = vol->mod;
+        g.fillRect(x + 8, lineY, w - 16, 1);
+    };
 
-        while (vil->right() && vir->left())
-        {
-            vil = vil->right();
-            vir = vir->left();
-            vol = vol->left();
-            vor = vor->right();
-            vor->ancestor = v;
-
-            float shift = (vil->x + sil) - (vir->x + sir) + distance;
-
-            if (shift > 0)
-            {
-                RevisionComponent *a = ancestor(vil, v, default_ancestor);
-                moveSubtree(a, v, shift);
-                sir = sir + shift;
-                sor = sor + shift;
-            }
-
-            sil += vil->mod;
-            sir += vir->mod;
-            sol += vol->mod;
-            sor += vor->mod;
-        }
+    paintFadingLine(y, Colour(0x15ffffff));
+    paintFadingLine(y + 1, Colour(0x35000000));
+    paintFadingLine(y + h - 2, Colour(0x35000000));
+    paintFadingLine(y + h - 1, Colour(0x15ffffff));
 
-        if (vil->right() && !vor->right())
-        {
-            vor->wired = vil->right();
-            vor->mod += sil - sor;
-        }
-        else
-        {
-            if (vir->left() && !vol->left())
-            {
-                vol->wired = vir->left();
-                vol->mod += sir - sol;
-            }
+    const auto textColour = findDefaultColour(Label::textColourId);
 
-            default_ancestor = v;
-        }
-    }
+    g.setColour(textColour);
+    g.setFont(Globals::UI::Fonts::M);
+    g.drawFittedText(revision->getMessage(),
+        x + 9, y + 2, w - 18, 18, Justification::centred, 1, 1.f);
 
-    return default_ancestor;
-}
+    g.setColour(textColour.withMultipliedAlpha(0.5f));
+    g.setFont(Globals::UI::Fonts::XS);
+    g.drawFittedText(App::getHumanReadableDate(Time(revision->getTimeStamp())),
+        x + 21, y + 21, w - 42, 12, Justification::centred, 1, 1.f);
 
-void RevisionTreeComponent::moveSubtree(RevisionComponent *wl, RevisionComponent *wr, float shift)
-{
-    int subtrees = wr->number - wl->number;
-    if (subtrees != 0)
-    {
-        wr->change -= shift / subtrees;
-    }
+#if !NO_NETWORK
 
-    wr->shift += shift;
-    if (subtrees != 0)
-    {
-        wl->change += shift / subtrees;
-    }
+    constexpr auto iconSize = 8;
+    const auto syncState = this->vcs.getRevisionSyncState(revision);
 
-    wr->x += shift;
-    wr->mod += shift;
-}
+    g.setColour(textColour.withMultipliedAlpha(syncState == VCS::Revision::NoSync ? 0.15f : 1.f));
+    Icons::drawImageRetinaAware(Icons::findByName(Icons::remote, iconSize),
+        g, x + w / 2 - 8, y + 40);
 
-void RevisionTreeComponent::executeShifts(RevisionComponent *v)
-{
-    float shift = 0;
-    float change = 0;
+    g.setColour(textColour.withMultipliedAlpha(syncState == VCS::Revision::ShallowCopy ? 0.15f : 1.f));
+    Icons::drawImageRetinaAware(Icons::findByName(Icons::local, iconSize),
+        g, x + w / 2 + 8, y + 40);
 
-    for (auto *w : v->children)
-    {
-        w->x += shift;
-        w->mod += shift;
-        change += w->change;
-        shift += w->shift + change;
-    }
+#endif
 }
 
-RevisionComponent *RevisionTreeComponent::ancestor(RevisionComponent *vil,
-    RevisionComponent *v, RevisionComponent *default_ancestor)
+bool RevisionTreeComponent::hitTest(int x, int y)
 {
-    for (auto *child : v->children)
-    {
-        if (child == vil->ancestor)
-        {
-            return vil->ancestor;
-        }
-    }
-
-    return default_ancestor;
+    return this->layout->findRevisionAt({ x, y }) >= 0;
 }
 
-float RevisionTreeComponent::secondWalk(RevisionComponent *v, float &min, float m, float depth)
+void RevisionTreeComponent::mouseDown(const MouseEvent &e)
 {
-    v->x += m;
-    v->y = depth;
-    this->treeDepth = jmax(this->treeDepth, v->y);
-
-    if ((min < 0) || (v->x < min))
+    const auto index = this->layout->findRevisionAt(e.getPosition());
+    if (index < 0)
     {
-        min = v->x;
+        return;
     }
 
-    for (auto *child : v->children)
+    if (e.mods.isRightButtonDown() && index == this->selectedIndex)
     {
-        min = this->secondWalk(child, min, m + v->mod, depth + 1);
+        return;
     }
 
-    return min;
+    this->selectRevision(index);
 }
 
-void RevisionTreeComponent::thirdWalk(RevisionComponent *v, float n)
+void RevisionTreeComponent::mouseUp(const MouseEvent &e)
 {
-    v->x += n;
-
-    for (auto *w : v->children)
+    if (e.mods.isRightButtonDown() &&
+        e.getOffsetFromDragStart().isOrigin() &&
+        this->selectedIndex >= 0 &&
+        this->layout->findRevisionAt(e.getPosition()) == this->selectedIndex)
     {
-        this->thirdWalk(w, n);
+        this->contextMenuController->showMenu(e);
     }
 }
 
-void RevisionTreeComponent::postWalk(RevisionComponent *v)
+void RevisionTreeComponent::handleCommandMessage(int commandId)
 {
-    const int vx = int(v->x * (v->getWidth() + 10));
-    const int vy = int((this->treeDepth - v->y) * (v->getHeight() + RevisionTreeComponent::connectorHeight));
-
-    const int newWidth = jmax(this->getWidth(), vx + v->getWidth());
-    const int newHeight = jmax(this->getHeight(), vy + v->getHeight());
-
-    this->setSize(newWidth, newHeight);
-    v->setTopLeftPosition(vx, vy);
-
-    for (auto *child : v->children)
+    if (commandId == CommandIDs::StartDragViewport ||
+        commandId == CommandIDs::EndDragViewport)
     {
-        this->postWalk(child);
-        auto revisionConnector = make<RevisionConnectorComponent>(v, child);
-        revisionConnector->resizeToFit();
-        this->addAndMakeVisible(revisionConnector.release());
+        this->deselectAll(true);
     }
 }
 
@@ -18,58 +18,54 @@
 #pragma once
 
 class VersionControl;
-class RevisionComponent;
 class HistoryComponent;
+class HeadlineContextMenuController;
 
-#include "Revision.h"
+#include "RevisionTreeLayout.h"
+
+// Only paints the revisions and connectors within the clip bounds,
+// which, inside a viewport, are limited to the visible area,
+// so that long histories don't need a component per revision
 
 class RevisionTreeComponent final : public Component
 {
 public:
 
-    explicit RevisionTreeComponent(VersionControl &owner);
+    RevisionTreeComponent(VersionControl &owner, RevisionTreeLayout::Ptr layout);
     ~RevisionTreeComponent() override;
 
     void deselectAll(bool sendNotification = true);
-    void selectComponent(RevisionComponent *revComponent, bool deselectOthers, bool sendNotification = true);
+    void selectRevision(int index, bool sendNotification = true);
 
     VCS::Revision::Ptr getSelectedRevision() const noexcept;
 
-    void handleCommandMessage(int commandId) override;
-
-private:
-
-    // Tree layout methods:
-
-    RevisionComponent *initComponents(int depth,
-        const VCS::Revision::Ptr revision, RevisionComponent *parentRevisionComponent);
-
-    RevisionComponent *firstWalk(RevisionComponent *v, float distance = 1.f);
-
-    RevisionComponent *apportion(RevisionComponent *v,
-        RevisionComponent *default_ancestor, float distance);
+    //===------------------------------------------------------------------===//
+    // Component
+    //===------------------------------------------------------------------===//
 
-    void moveSubtree(RevisionComponent *wl, RevisionComponent *wr, float shift);
-    void executeShifts(RevisionComponent *v);
-
-    RevisionComponent *ancestor(RevisionComponent *vil,
-        RevisionComponent *v, RevisionComponent *default_ancestor);
-
-    float secondWalk(RevisionComponent *v, float &min, float m = 0.f, float depth = 0.f);
-    void thirdWalk(RevisionComponent *v, float n);
-    void postWalk(RevisionComponent *v);
-
-    float treeDepth = 0.f;
+    void paint(Graphics &g) override;
+    bool hitTest(int x, int y) override;
+    void mouseDown(const MouseEvent &e) override;
+    void mouseUp(const MouseEvent &e) override;
+    void handleCommandMessage(int commandId) override;
 
 private:
 
-    static constexpr auto connectorHeight = 18;
+    void paintRevision(Graphics &g, int index, bool isHead) const;
 
     HistoryComponent *findParentEditor() const;
 
     VersionControl &vcs;
+    const RevisionTreeLayout::Ptr layout;
+
+    int selectedIndex = -1;
     VCS::Revision::Ptr selectedRevision;
 
+    // reused between paint calls
+    Array<int> visibleRevisions;
+
+    UniquePointer<HeadlineContextMenuController> contextMenuController;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RevisionTreeComponent)
 
 };
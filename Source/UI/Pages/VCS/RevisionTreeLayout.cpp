@@ -0,0 +1,705 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Common.h"
+#include "RevisionTreeLayout.h"
+
+RevisionTreeLayout::RevisionTreeLayout(const VCS::Revision::Ptr root)
+{
+    if (root == nullptr)
+    {
+        return;
+    }
+
+    struct Item final
+    {
+        VCS::Revision *revision;
+        int parent;
+        int depth;
+    };
+
+    // not recursive, since linear histories may be thousands of revisions deep
+    Array<Item> stack;
+    stack.add({ root.get(), -1, 0 });
+
+    while (!stack.isEmpty())
+    {
+        const auto item = stack.removeAndReturn(stack.size() - 1);
+        const int index = this->nodes.size();
+
+        Node node;
+        node.parent = item.parent;
+        node.depth = item.depth;
+        node.ancestor = index;
+
+        if (item.parent >= 0)
+        {
+            auto &parent = this->nodes.getReference(item.parent);
+            parent.children.add(index);
+            node.number = parent.children.size();
+        }
+
+        this->nodes.add(move(node));
+        this->revisions.add(item.revision);
+
+        // pushed in reverse, so that children are popped left to right
+        const auto &children = item.revision->getChildren();
+        for (int i = children.size(); --i >= 0;)
+        {
+            stack.add({ children.getUnchecked(i).get(), index, item.depth + 1 });
+        }
+    }
+}
+
+bool RevisionTreeLayout::hasSameTopologyAs(const RevisionTreeLayout &other) const noexcept
+{
+    if (this->nodes.size() != other.nodes.size())
+    {
+        return false;
+    }
+
+    // the pre-order sequence of revisions with their parents
+    // is enough to tell if the trees are the same
+    for (int i = 0; i < this->nodes.size(); ++i)
+    {
+        if (this->revisions.getUnchecked(i) != other.revisions.getUnchecked(i) ||
+            this->nodes.getReference(i).parent != other.nodes.getReference(i).parent)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//===----------------------------------------------------------------------===//
+// Accessors
+//===----------------------------------------------------------------------===//
+
+int RevisionTreeLayout::getNumRevisions() const noexcept
+{
+    return this->nodes.size();
+}
+
+VCS::Revision::Ptr RevisionTreeLayout::getRevision(int index) const noexcept
+{
+    return this->revisions[index];
+}
+
+bool RevisionTreeLayout::hasParent(int index) const noexcept
+{
+    return this->nodes.getReference(index).parent >= 0;
+}
+
+Rectangle<int> RevisionTreeLayout::getRevisionBounds(int index) const noexcept
+{
+    return this->nodes.getReference(index).bounds;
+}
+
+Rectangle<int> RevisionTreeLayout::getConnectorBounds(int index) const noexcept
+{
+    const auto &node = this->nodes.getReference(index);
+    if (node.parent < 0)
+    {
+        return {};
+    }
+
+    // from the bottom of the revision to the top of its parent,
+    // since parents are placed below their children
+    const auto &parentBounds = this->nodes.getReference(node.parent).bounds;
+    const int x1 = parentBounds.getCentreX();
+    const int x2 = node.bounds.getCentreX();
+
+    return Rectangle<int>::leftTopRightBottom(jmin(x1, x2) - 4,
+        node.bounds.getBottom() - 4, jmax(x1, x2) + 4, parentBounds.getY() + 4);
+}
+
+Path RevisionTreeLayout::getConnectorPath(int index) const
+{
+    Path path;
+
+    const auto &node = this->nodes.getReference(index);
+    if (node.parent < 0)
+    {
+        return path;
+    }
+
+    const auto &parentBounds = this->nodes.getReference(node.parent).bounds;
+    const float x1 = float(parentBounds.getCentreX());
+    const float y1 = float(parentBounds.getY());
+    const float x2 = float(node.bounds.getCentreX());
+    const float y2 = float(node.bounds.getBottom());
+
+    const float dy = (y2 - y1);
+    const float dx = (x2 - x1);
+
+    const float curveX = (1.f - (fabsf(dx) / float(this->bounds.getWidth()))) * 1.5f;
+    const float curveY = (fabsf(dy) / float(this->bounds.getHeight())) * 1.5f;
+    const float curve = (curveX + curveY) / 2.f;
+
+    path.startNewSubPath(x1, y1);
+    path.cubicTo(x1, y1 + dy * (curve),
+        x2, y1 + dy * (1.f - curve),
+        x2, y2);
+
+    static const float dashes[] = { 4.f, 3.f };
+    PathStrokeType stroke(1.f, PathStrokeType::beveled, PathStrokeType::butt);
+    stroke.createDashedStroke(path, path, dashes, 2);
+
+    path.setUsingNonZeroWinding(false);
+    return path;
+}
+
+Rectangle<int> RevisionTreeLayout::getBounds() const noexcept
+{
+    return this->bounds;
+}
+
+//===----------------------------------------------------------------------===//
+// Spatial index
+//===----------------------------------------------------------------------===//
+
+int RevisionTreeLayout::findRevisionAt(Point<int> position) const
+{
+    if (!this->bounds.contains(position))
+    {
+        return -1;
+    }
+
+    const int cell = (position.y / cellSize) * this->numColumns + (position.x / cellSize);
+    for (int i = this->cellStarts[cell]; i < this->cellStarts[cell + 1]; ++i)
+    {
+        const int index = this->cellItems.getUnchecked(i);
+        if (this->nodes.getReference(index).bounds.contains(position))
+        {
+            return index;
+        }
+    }
+
+    return -1;
+}
+
+void RevisionTreeLayout::findRevisionsIn(const Rectangle<int> &area, Array<int> &result) const
+{
+    result.clearQuick();
+
+    const auto cells = this->getCellRange(area);
+    for (int row = cells.getY(); row < cells.getBottom(); ++row)
+    {
+        for (int column = cells.getX(); column < cells.getRight(); ++column)
+        {
+            const int cell = row * this->numColumns + column;
+            for (int i = this->cellStarts[cell]; i < this->cellStarts[cell + 1]; ++i)
+            {
+                const int index = this->cellItems.getUnchecked(i);
+                if (this->nodes.getReference(index).bounds.intersects(area) ||
+                    this->getConnectorBounds(index).intersects(area))
+                {
+                    result.add(index);
+                }
+            }
+        }
+    }
+
+    // the items spanning several cells are found more than once
+    if (cells.getWidth() > 1 || cells.getHeight() > 1)
+    {
+        std::sort(result.begin(), result.end());
+        result.removeRange(int(std::unique(result.begin(), result.end()) - result.begin()), result.size());
+    }
+}
+
+Rectangle<int> RevisionTreeLayout::getCellRange(const Rectangle<int> &area) const noexcept
+{
+    const auto clippedArea = area.getIntersection(this->bounds);
+    if (clippedArea.isEmpty())
+    {
+        return {};
+    }
+
+    return Rectangle<int>::leftTopRightBottom(clippedArea.getX() / cellSize,
+        clippedArea.getY() / cellSize,
+        (clippedArea.getRight() - 1) / cellSize + 1,
+        (clippedArea.getBottom() - 1) / cellSize + 1);
+}
+
+void RevisionTreeLayout::buildIndex()
+{
+    this->numColumns = (this->bounds.getRight() - 1) / cellSize + 1;
+    this->numRows = (this->bounds.getBottom() - 1) / cellSize + 1;
+    const int numCells = this->numColumns * this->numRows;
+
+    const auto forEachCell = [this](int index, auto &&callback)
+    {
+        const auto itemBounds = this->nodes.getReference(index).bounds
+            .getUnion(this->getConnectorBounds(index));
+
+        const auto cells = this->getCellRange(itemBounds);
+        for (int row = cells.getY(); row < cells.getBottom(); ++row)
+        {
+            for (int column = cells.getX(); column < cells.getRight(); ++column)
+            {
+                callback(row * this->numColumns + column);
+            }
+        }
+    };
+
+    // counting first, so that all the items are stored in one array
+    this->cellStarts.clearQuick();
+    this->cellStarts.insertMultiple(0, 0, numCells + 1);
+    for (int i = 0; i < this->nodes.size(); ++i)
+    {
+        forEachCell(i, [this](int cell) { this->cellStarts.getReference(cell + 1)++; });
+    }
+
+    for (int cell = 0; cell < numCells; ++cell)
+    {
+        this->cellStarts.getReference(cell + 1) += this->cellStarts.getUnchecked(cell);
+    }
+
+    auto positions = this->cellStarts;
+    this->cellItems.clearQuick();
+    this->cellItems.insertMultiple(0, -1, this->cellStarts.getLast());
+    for (int i = 0; i < this->nodes.size(); ++i)
+    {
+        forEachCell(i, [this, i, &positions](int cell)
+        {
+            this->cellItems.set(positions.getReference(cell)++, i);
+        });
+    }
+}
+
+//===----------------------------------------------------------------------===//
+// Buchheim tree layout
+//===----------------------------------------------------------------------===//
+
+bool RevisionTreeLayout::compute()
+{
+    if (this->nodes.isEmpty())
+    {
+        return true;
+    }
+
+    // nullptr on the message thread, which is never asked to exit
+    const auto *thread = Thread::getCurrentThread();
+    const auto isCancelled = [thread]()
+    {
+        return thread != nullptr && thread->threadShouldExit();
+    };
+
+    constexpr auto distance = 1.f;
+
+    // the first walk is not recursive either: nodes are visited in reverse
+    // pre-order, so that all subtrees of a node are laid out before the node,
+    // and each node places its children, left to right, because each child's
+    // position depends on its left brother, which may be moved by apportion()
+    for (int v = this->nodes.size(); --v >= 0;)
+    {
+        auto &node = this->nodes.getReference(v);
+        if (node.children.isEmpty())
+        {
+            continue;
+        }
+
+        if (isCancelled())
+        {
+            return false;
+        }
+
+        int defaultAncestor = node.children.getFirst();
+        for (const auto child : node.children)
+        {
+            this->place(child, distance);
+            defaultAncestor = this->apportion(child, defaultAncestor, distance);
+        }
+
+        this->executeShifts(v);
+
+        node.midpoint = (this->nodes.getReference(node.children.getFirst()).x +
+            this->nodes.getReference(node.children.getLast()).x) / 2.f;
+    }
+
+    this->place(0, distance);
+
+    // the second walk sums up the modifiers, parents go first in pre-order,
+    // so each node's mod is replaced with the sum of mods of its ancestors
+    if (isCancelled())
+    {
+        return false;
+    }
+
+    float minX = 0.f;
+    int treeDepth = 0;
+    for (int v = 0; v < this->nodes.size(); ++v)
+    {
+        auto &node = this->nodes.getReference(v);
+        if (node.parent >= 0)
+        {
+            const auto parentMod = this->nodes.getReference(node.parent).mod;
+            node.x += parentMod;
+            node.mod += parentMod;
+        }
+
+        minX = jmin(minX, node.x);
+        treeDepth = jmax(treeDepth, node.depth);
+    }
+
+    // the third walk
+    this->bounds = { 0, 0, 1, 1 };
+    for (auto &node : this->nodes)
+    {
+        const int vx = int((node.x - minX) * (revisionWidth + horizontalMargin));
+        const int vy = int((treeDepth - node.depth) * (revisionHeight + connectorHeight));
+        node.bounds = { vx, vy, revisionWidth, revisionHeight };
+        this->bounds = this->bounds.getUnion(node.bounds);
+    }
+
+    if (isCancelled())
+    {
+        return false;
+    }
+
+    this->buildIndex();
+    return true;
+}
+
+void RevisionTreeLayout::place(int v, float distance)
+{
+    const int w = this->getLeftBrother(v);
+    auto &node = this->nodes.getReference(v);
+
+    if (node.children.isEmpty())
+    {
+        node.x = (w >= 0) ? this->nodes.getReference(w).x + distance : 0.f;
+    }
+    else if (w >= 0)
+    {
+        node.x = this->nodes.getReference(w).x + distance;
+        node.mod = node.x - node.midpoint;
+    }
+    else
+    {
+        node.x = node.midpoint;
+    }
+}
+
+int RevisionTreeLayout::apportion(int v, int defaultAncestor, float distance)
+{
+    const int w = this->getLeftBrother(v);
+    if (w < 0)
+    {
+        return defaultAncestor;
+    }
+
+    // in buchheim notation:
+    // i == inner; o == outer; r == right; l == left;
+    int vir = v;
+    int vor = v;
+    int vil = w;
+    int vol = this->getLeftmostSibling(v);
+
+    float sir = this->nodes.getReference(vir).mod;
+    float sor = this->nodes.getReference(vor).mod;
+    float sil = this->nodes.getReference(vil).mod;
+    float sol = this->nodes.getReference(vol).mod;
+
+    while (this->getRight(vil) >= 0 && this->getLeft(vir) >= 0)
+    {
+        vil = this->getRight(vil);
+        vir = this->getLeft(vir);
+        vol = this->getLeft(vol);
+        vor = this->getRight(vor);
+        this->nodes.getReference(vor).ancestor = v;
+
+        const float shift = (this->nodes.getReference(vil).x + sil) -
+            (this->nodes.getReference(vir).x + sir) + distance;
+
+        if (shift > 0)
+        {
+            const int a = this->findAncestor(vil, v, defaultAncestor);
+            this->moveSubtree(a, v, shift);
+            sir += shift;
+            sor += shift;
+        }
+
+        sil += this->nodes.getReference(vil).mod;
+        sir += this->nodes.getReference(vir).mod;
+        sol += this->nodes.getReference(vol).mod;
+        sor += this->nodes.getReference(vor).mod;
+    }
+
+    if (this->getRight(vil) >= 0 && this->getRight(vor) < 0)
+    {
+        auto &node = this->nodes.getReference(vor);
+        node.thread = this->getRight(vil);
+        node.mod += sil - sor;
+    }
+    else
+    {
+        if (this->getLeft(vir) >= 0 && this->getLeft(vol) < 0)
+        {
+            auto &node = this->nodes.getReference(vol);
+            node.thread = this->getLeft(vir);
+            node.mod += sir - sol;
+        }
+
+        defaultAncestor = v;
+    }
+
+    return defaultAncestor;
+}
+
+int RevisionTreeLayout::findAncestor(int vil, int v, int defaultAncestor) const noexcept
+{
+    const int ancestor = this->nodes.getReference(vil).ancestor;
+    if (this->nodes.getReference(ancestor).parent == this->nodes.getReference(v).parent)
+    {
+        return ancestor;
+    }
+
+    return defaultAncestor;
+}
+
+void RevisionTreeLayout::moveSubtree(int wl, int wr, float shift)
+{
+    auto &left = this->nodes.getReference(wl);
+    auto &right = this->nodes.getReference(wr);
+
+    const int subtrees = right.number - left.number;
+    if (subtrees != 0)
+    {
+        right.change -= shift / subtrees;
+        left.change += shift / subtrees;
+    }
+
+    right.shift += shift;
+    right.x += shift;
+    right.mod += shift;
+}
+
+void RevisionTreeLayout::executeShifts(int v)
+{
+    float shift = 0.f;
+    float change = 0.f;
+
+    const auto &children = this->nodes.getReference(v).children;
+    for (int i = children.size(); --i >= 0;)
+    {
+        auto &w = this->nodes.getReference(children.getUnchecked(i));
+        w.x += shift;
+        w.mod += shift;
+        change += w.change;
+        shift += w.shift + change;
+    }
+}
+
+int RevisionTreeLayout::getLeft(int v) const noexcept
+{
+    const auto &node = this->nodes.getReference(v);
+    return node.children.isEmpty() ? node.thread : node.children.getFirst();
+}
+
+int RevisionTreeLayout::getRight(int v) const noexcept
+{
+    const auto &node = this->nodes.getReference(v);
+    return node.children.isEmpty() ? node.thread : node.children.getLast();
+}
+
+int RevisionTreeLayout::getLeftBrother(int v) const noexcept
+{
+    const auto &node = this->nodes.getReference(v);
+    if (node.parent < 0 || node.number <= 1)
+    {
+        return -1;
+    }
+
+    return this->nodes.getReference(node.parent).children.getUnchecked(node.number - 2);
+}
+
+int RevisionTreeLayout::getLeftmostSibling(int v) const noexcept
+{
+    const auto &node = this->nodes.getReference(v);
+    if (node.parent < 0 || node.number <= 1)
+    {
+        return -1;
+    }
+
+    return this->nodes.getReference(node.parent).children.getFirst();
+}
+
+//===----------------------------------------------------------------------===//
+// Worker
+//===----------------------------------------------------------------------===//
+
+RevisionTreeLayout::Worker::Worker() : Thread("RevisionTreeLayout") {}
+
+RevisionTreeLayout::Worker::~Worker()
+{
+    // the layout walks give up quickly when the thread is asked to exit
+    this->stopThread(Worker::threadExitTimeoutMs);
+    this->cancelPendingUpdate();
+}
+
+void RevisionTreeLayout::Worker::computeAsync(RevisionTreeLayout::Ptr targetLayout, Callback targetCallback)
+{
+    this->nextLayout = targetLayout;
+    this->nextCallback = move(targetCallback);
+    this->startNextIfIdle();
+}
+
+void RevisionTreeLayout::Worker::startNextIfIdle()
+{
+    // the previous layout, if any, is outdated anyway, so it is interrupted,
+    // and the next one starts when its thread is done, see handleAsyncUpdate
+    if (this->isThreadRunning() || this->isUpdatePending())
+    {
+        this->signalThreadShouldExit();
+        return;
+    }
+
+    this->layout = move(this->nextLayout);
+    this->callback = move(this->nextCallback);
+    this->nextLayout = nullptr;
+    this->nextCallback = nullptr;
+
+    this->hasCompleted = false;
+    this->startThread();
+}
+
+void RevisionTreeLayout::Worker::run()
+{
+    this->hasCompleted = this->layout->compute();
+
+    // always notify, even if interrupted, so that the next layout can start
+    this->triggerAsyncUpdate();
+}
+
+void RevisionTreeLayout::Worker::handleAsyncUpdate()
+{
+    // the thread has done its job by now and is just about to exit
+    this->waitForThreadToExit(Worker::threadExitTimeoutMs);
+
+    if (this->nextLayout != nullptr)
+    {
+        this->startNextIfIdle();
+        return;
+    }
+
+    if (this->hasCompleted && this->callback != nullptr)
+    {
+        this->callback(this->layout);
+    }
+}
+
+//===----------------------------------------------------------------------===//
+// Tests
+//===----------------------------------------------------------------------===//
+
+#if JUCE_UNIT_TESTS
+
+class RevisionTreeLayoutTests final : public UnitTest
+{
+public:
+    RevisionTreeLayoutTests() : UnitTest("Revision tree layout tests", UnitTestCategories::helio) {}
+
+    void runTest() override
+    {
+        Random random(1);
+
+        VCS::Revision::Ptr root(new VCS::Revision("root"));
+        Array<VCS::Revision::Ptr> allRevisions;
+        allRevisions.add(root);
+
+        // mostly linear history with occasional branches
+        for (int i = 0; i < 2000; ++i)
+        {
+            const auto parent = random.nextInt(10) == 0 ?
+                allRevisions[random.nextInt(allRevisions.size())] : allRevisions.getLast();
+
+            VCS::Revision::Ptr child(new VCS::Revision(String(i)));
+            parent->addChild(child);
+            allRevisions.add(child);
+        }
+
+        RevisionTreeLayout layout(root);
+        layout.compute();
+
+        beginTest("Revisions don't overlap, parents are below children");
+        {
+            expectEquals(layout.getNumRevisions(), allRevisions.size());
+
+            FlatHashMap<int, Array<Rectangle<int>>> rows;
+            for (int i = 0; i < layout.getNumRevisions(); ++i)
+            {
+                const auto bounds = layout.getRevisionBounds(i);
+                expect(layout.getBounds().contains(bounds));
+
+                for (const auto &other : rows[bounds.getY()])
+                {
+                    expect(!other.intersects(bounds));
+                }
+
+                rows[bounds.getY()].add(bounds);
+
+                if (layout.hasParent(i))
+                {
+                    const auto connector = layout.getConnectorBounds(i);
+                    expect(connector.getY() < bounds.getBottom());
+                    expect(connector.getBottom() > bounds.getBottom() + RevisionTreeLayout::connectorHeight);
+                }
+            }
+        }
+
+        beginTest("Spatial index lookups");
+        {
+            for (int i = 0; i < layout.getNumRevisions(); ++i)
+            {
+                const auto bounds = layout.getRevisionBounds(i);
+                expectEquals(layout.findRevisionAt(bounds.getCentre()), i);
+                expectEquals(layout.findRevisionAt(bounds.getTopLeft() - Point<int>(1, 1)), -1);
+            }
+
+            Array<int> found;
+            layout.findRevisionsIn(layout.getBounds(), found);
+            expectEquals(found.size(), layout.getNumRevisions());
+
+            const Rectangle<int> area(300, 500, 400, 300);
+            layout.findRevisionsIn(area, found);
+
+            for (int i = 0; i < layout.getNumRevisions(); ++i)
+            {
+                const bool isVisible = layout.getRevisionBounds(i).intersects(area) ||
+                    layout.getConnectorBounds(i).intersects(area);
+                expect(isVisible == found.contains(i));
+            }
+        }
+
+        beginTest("Topology comparison");
+        {
+            RevisionTreeLayout sameLayout(root);
+            expect(sameLayout.hasSameTopologyAs(layout));
+
+            allRevisions[5]->addChild(VCS::Revision::Ptr(new VCS::Revision("new")));
+            RevisionTreeLayout changedLayout(root);
+            expect(!changedLayout.hasSameTopologyAs(layout));
+        }
+    }
+};
+
+static RevisionTreeLayoutTests revisionTreeLayoutTests;
+
+#endif
@@ -0,0 +1,157 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "Revision.h"
+
+// The revision tree geometry, computed with Buchheim's tidy tree algorithm
+// and kept separately from the view, so that it can be computed on a background
+// thread and reused for as long as the history topology doesn't change;
+// revision positions are bucketed in a uniform grid, so that the view
+// can find the revisions to paint or to click in a given area
+// without iterating the whole history
+
+class RevisionTreeLayout final : public ReferenceCountedObject
+{
+public:
+
+    // collects the topology only, which is a quick walk
+    // through the history, so it is done on the message thread
+    explicit RevisionTreeLayout(const VCS::Revision::Ptr root);
+
+    bool hasSameTopologyAs(const RevisionTreeLayout &other) const noexcept;
+
+    // only touches the layout's own data, so it may run on any thread;
+    // on a background thread, it gives up as soon as the thread is asked
+    // to exit, and returns false, leaving the layout incomplete
+    bool compute();
+
+    int getNumRevisions() const noexcept;
+    VCS::Revision::Ptr getRevision(int index) const noexcept;
+
+    bool hasParent(int index) const noexcept;
+    Rectangle<int> getRevisionBounds(int index) const noexcept;
+    Rectangle<int> getConnectorBounds(int index) const noexcept;
+    Path getConnectorPath(int index) const;
+
+    Rectangle<int> getBounds() const noexcept;
+
+    // returns -1 if there's no revision at the given position
+    int findRevisionAt(Point<int> position) const;
+
+    // the indices of revisions which bounds, or which connector's bounds,
+    // intersect a given area, in the pre-order, i.e. parents before children
+    void findRevisionsIn(const Rectangle<int> &area, Array<int> &result) const;
+
+    static constexpr auto revisionWidth = 165;
+    static constexpr auto revisionHeight = 50;
+    static constexpr auto horizontalMargin = 10;
+    static constexpr auto connectorHeight = 18;
+
+    // smaller histories are laid out synchronously
+    static constexpr auto asyncThreshold = 500;
+
+    using Ptr = ReferenceCountedObjectPtr<RevisionTreeLayout>;
+
+    // computes one layout at a time on a background thread,
+    // and passes it to the callback on the message thread;
+    // a new request interrupts the previous one without waiting for it,
+    // and it starts as soon as the previous thread has finished
+    class Worker final : private Thread, private AsyncUpdater
+    {
+    public:
+
+        using Callback = Function<void(RevisionTreeLayout::Ptr layout)>;
+
+        Worker();
+        ~Worker() override;
+
+        void computeAsync(RevisionTreeLayout::Ptr layout, Callback callback);
+
+    private:
+
+        void run() override;
+        void handleAsyncUpdate() override;
+
+        void startNextIfIdle();
+
+        RevisionTreeLayout::Ptr layout;
+        Callback callback;
+        bool hasCompleted = false;
+
+        RevisionTreeLayout::Ptr nextLayout;
+        Callback nextCallback;
+
+        static constexpr auto threadExitTimeoutMs = 1000;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Worker)
+    };
+
+private:
+
+    struct Node final
+    {
+        int parent = -1;
+        Array<int> children;
+
+        int depth = 0;
+        int number = 1; // 1-based index among siblings
+
+        // Buchheim helpers:
+        float x = 0.f;
+        float mod = 0.f;
+        float shift = 0.f;
+        float change = 0.f;
+        float midpoint = 0.f;
+        int ancestor = -1;
+        int thread = -1;
+
+        Rectangle<int> bounds;
+    };
+
+    // in pre-order, so that every parent goes before its children
+    Array<Node> nodes;
+    Array<VCS::Revision::Ptr> revisions;
+
+    Rectangle<int> bounds;
+
+    int getLeft(int v) const noexcept;
+    int getRight(int v) const noexcept;
+    int getLeftBrother(int v) const noexcept;
+    int getLeftmostSibling(int v) const noexcept;
+
+    void place(int v, float distance);
+    int apportion(int v, int defaultAncestor, float distance);
+    int findAncestor(int vil, int v, int defaultAncestor) const noexcept;
+    void moveSubtree(int wl, int wr, float shift);
+    void executeShifts(int v);
+
+    // the spatial index: for each cell, the indices of revisions
+    // which bounds or connector bounds intersect that cell, stored
+    // contiguously, cell by cell, with cellStarts pointing into them
+    static constexpr auto cellSize = 256;
+    int numColumns = 0;
+    int numRows = 0;
+    Array<int> cellStarts;
+    Array<int> cellItems;
+
+    void buildIndex();
+    Rectangle<int> getCellRange(const Rectangle<int> &area) const noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RevisionTreeLayout)
+};
@@ -40,9 +40,9 @@ Playhead::Playhead(RollBase &parentRoll,
     this->setAlwaysOnTop(true);
     this->setSize(width + 2, 1); // add some horizontal padding, trying to avoid glitches
 
-    this->lastCorrectPosition = this->transport.getSeekBeat();
-    this->timerStartPosition = this->lastCorrectPosition;
-    this->timerStartTime = Time::getMillisecondCounterHiRes();
+    this->isPlaying = this->transport.isPlaying();
+    this->lastPosition = this->transport.getPlaybackState().read()
+        .getEstimatedBeat(Time::getMillisecondCounterHiRes());
 
     this->transport.addTransportListener(this);
 }
@@ -58,33 +58,20 @@ Playhead::~Playhead()
 
 void Playhead::onSeek(float beatPosition, double currentTimeMs, double totalTimeMs)
 {
-    this->lastCorrectPosition = beatPosition;
-
-    this->triggerAsyncUpdate();
-
-    if (this->isTimerRunning())
+    if (!this->isPlaying)
     {
-        this->timerStartTime = Time::getMillisecondCounterHiRes();
-        this->timerStartPosition = this->lastCorrectPosition;
+        this->updatePosition(beatPosition);
     }
 }
 
-void Playhead::onTempoChanged(double msPerQuarter)
+void Playhead::onPlaybackFrame(double estimatedBeat)
 {
-    this->msPerQuarterNote = jmax(msPerQuarter, 0.01);
-        
-    if (this->isTimerRunning())
-    {
-        this->timerStartTime = Time::getMillisecondCounterHiRes();
-        this->timerStartPosition = this->lastCorrectPosition;
-    }
+    this->updatePosition(estimatedBeat);
 }
 
 void Playhead::onPlay()
 {
-    this->timerStartTime = Time::getMillisecondCounterHiRes();
-    this->timerStartPosition = this->lastCorrectPosition;
-    this->startTimerHz(60);
+    this->isPlaying = true;
 }
 
 void Playhead::onRecord()
@@ -95,39 +82,10 @@ void Playhead::onRecord()
 
 void Playhead::onStop()
 {
+    this->isPlaying = false;
+
     this->currentColour = this->playbackColour;
     this->repaint();
-
-    this->stopTimer();
-
-    this->timerStartTime = 0.0;
-    this->timerStartPosition = 0.0;
-    this->msPerQuarterNote = Globals::Defaults::msPerBeat;
-}
-
-//===----------------------------------------------------------------------===//
-// Timer
-//===----------------------------------------------------------------------===//
-
-void Playhead::timerCallback()
-{
-    this->triggerAsyncUpdate();
-}
-
-//===----------------------------------------------------------------------===//
-// AsyncUpdater
-//===----------------------------------------------------------------------===//
-
-void Playhead::handleAsyncUpdate()
-{
-    if (this->isTimerRunning())
-    {
-        this->tick();
-    }
-    else
-    {
-        this->updatePosition(this->lastCorrectPosition.get());
-    }
 }
 
 //===----------------------------------------------------------------------===//
@@ -158,14 +116,10 @@ void Playhead::parentChanged()
     if (this->getParentComponent() != nullptr)
     {
         this->setSize(this->getWidth(), this->getParentHeight());
-        
-        if (this->isTimerRunning())
-        {
-            this->tick();
-        }
-        else
+        this->updatePosition(this->lastPosition);
+
+        if (!this->isPlaying)
         {
-            this->updatePosition(this->lastCorrectPosition.get());
             this->toFront(false);
         }
     }
@@ -173,6 +127,8 @@ void Playhead::parentChanged()
 
 void Playhead::updatePosition(double position)
 {
+    this->lastPosition = position;
+
     const int newX = this->roll.getPlayheadPositionByBeat(position, double(this->getParentWidth()));
     this->setTopLeftPosition(newX, 0);
 
@@ -181,11 +137,3 @@ void Playhead::updatePosition(double position)
         this->listener->onPlayheadMoved(newX);
     }
 }
-
-void Playhead::tick()
-{
-    const double timeOffsetMs = Time::getMillisecondCounterHiRes() - this->timerStartTime.get();
-    const double positionOffset = timeOffsetMs / this->msPerQuarterNote.get();
-    const double estimatedPosition = this->timerStartPosition.get() + positionOffset;
-    this->updatePosition(estimatedPosition);
-}
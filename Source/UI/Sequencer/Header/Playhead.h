@@ -24,9 +24,7 @@ class RollBase;
 
 class Playhead final :
     public Component,
-    public TransportListener,
-    private AsyncUpdater,
-    private Timer
+    public TransportListener
 {
 public:
 
@@ -49,9 +47,10 @@ public:
     //===------------------------------------------------------------------===//
 
     void onSeek(float beat, double currentTimeMs, double totalTimeMs) override;
-    void onTempoChanged(double msPerQuarter) override;
+    void onTempoChanged(double msPerQuarter) override {}
     void onTotalTimeChanged(double timeMs) override {}
     void onLoopModeChanged(bool hasLoop, float start, float end) override {}
+    void onPlaybackFrame(double estimatedBeat) override;
 
     void onPlay() override;
     void onRecord() override;
@@ -72,36 +71,20 @@ protected:
 
 private:
 
-    //===------------------------------------------------------------------===//
-    // Timer
-    //===------------------------------------------------------------------===//
-
-    void timerCallback() override;
-    void tick();
-
     void parentChanged();
-
-    Atomic<float> timerStartPosition = 0.f;
-    Atomic<double> timerStartTime = 0.0;
-    Atomic<double> msPerQuarterNote = Globals::Defaults::msPerBeat;
-
-private:
-
-    //===------------------------------------------------------------------===//
-    // AsyncUpdater
-    //===------------------------------------------------------------------===//
-
-    void handleAsyncUpdate() override;
     void updatePosition(double position);
 
+    // while playing, the position is estimated by the transport
+    // at each frame, and the seeks only reset it when stopped
+    bool isPlaying = false;
+    double lastPosition = 0.0;
+
     Colour currentColour;
 
     const Colour shadeColour;
     const Colour playbackColour;
     const Colour recordingColour;
 
-    Atomic<float> lastCorrectPosition = 0.f;
-
     Listener *listener = nullptr;
 
 };
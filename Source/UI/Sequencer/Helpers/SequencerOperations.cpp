@@ -32,6 +32,7 @@
 #include "AutomationTrackNode.h"
 
 #include "PianoSequence.h"
+#include "NoteTransforms.h"
 #include "AutomationSequence.h"
 #include "AnnotationsSequence.h"
 #include "KeySignaturesSequence.h"
@@ -40,6 +41,7 @@
 
 #include "UndoStack.h"
 #include "AutomationTrackActions.h"
+#include "CompactNotes.h"
 
 #include "ColourIDs.h"
 
@@ -260,6 +262,19 @@ PianoSequence *SequencerOperations::getPianoSequence(const Clip &targetClip)
     return static_cast<PianoSequence *>(targetClip.getPattern()->getTrack()->getSequence());
 }
 
+Array<Note> SequencerOperations::getSelectedNotes(const Lasso &selection)
+{
+    Array<Note> result;
+    result.ensureStorageAllocated(selection.getNumSelected());
+
+    for (int i = 0; i < selection.getNumSelected(); ++i)
+    {
+        result.add(selection.getItemAs<NoteComponent>(i)->getNote());
+    }
+
+    return result;
+}
+
 float SequencerOperations::findStartBeat(const Lasso &selection)
 {
     if (selection.getNumSelected() == 0)
@@ -352,218 +367,8 @@ void SequencerOperations::cleanupOverlaps(Lasso &selection, bool shouldCheckpoin
     }
 
     bool didCheckpoint = !shouldCheckpoint;
-
-    // 1 convert this
-    //    ----
-    // ------------
-    // into this
-    //    ---------
-    // ------------
-    
-    // todo repeat while does any changes
-    
-    bool step1HasChanges = false;
-    
-    do
-    {
-        PianoChangeGroup group1Before, group1After;
-
-        for (int i = 0; i < selection.getNumSelected(); ++i)
-        {
-            const auto *nc = static_cast<NoteComponent *>(selection.getSelectedItem(i));
-            
-            // для каждой ноты найти ноту, которая полностью перекрывает ее на максимальную длину
-            
-            float deltaBeats = -FLT_MAX;
-            const Note *overlappingNote = nullptr;
-            
-            for (int j = 0; j < selection.getNumSelected(); ++j)
-            {
-                auto *nc2 = static_cast<NoteComponent *>(selection.getSelectedItem(j));
-                
-                if (nc->getKey() == nc2->getKey() &&
-                    nc->getBeat() > nc2->getBeat() &&
-                    (nc->getBeat() + nc->getLength()) < (nc2->getBeat() + nc2->getLength()))
-                {
-                    const float currentDelta = (nc2->getBeat() + nc2->getLength()) - (nc->getBeat() + nc->getLength());
-                    
-                    if (deltaBeats < currentDelta)
-                    {
-                        deltaBeats = currentDelta;
-                        overlappingNote = &nc2->getNote();
-                    }
-                }
-            }
-            
-            if (overlappingNote != nullptr)
-            {
-                const float newLength = nc->getLength() + deltaBeats;
-                group1Before.add(nc->getNote());
-                group1After.add(nc->getNote().withLength(newLength));
-            }
-        }
-        
-        step1HasChanges = applyPianoChanges(group1Before, group1After, didCheckpoint);
-    }
-    while (step1HasChanges);
-    
-    
-    // 1 convert this
-    //    -------------
-    // ------------
-    // into this
-    //    -------------
-    // ----------------
-    
-    bool step2HasChanges = false;
-
-    do
-    {
-        PianoChangeGroup group2Before, group2After;
-        
-        for (int i = 0; i < selection.getNumSelected(); ++i)
-        {
-            const auto *nc = static_cast<NoteComponent *>(selection.getSelectedItem(i));
-            
-            // для каждой ноты найти ноту, которая полностью перекрывает ее на максимальную длину
-            
-            float deltaBeats = -FLT_MAX;
-            const NoteComponent *overlappingNote = nullptr;
-            
-            for (int j = 0; j < selection.getNumSelected(); ++j)
-            {
-                auto *nc2 = static_cast<NoteComponent *>(selection.getSelectedItem(j));
-                
-                if (nc->getKey() == nc2->getKey() &&
-                    nc->getBeat() > nc2->getBeat() &&
-                    nc->getBeat() < (nc2->getBeat() + nc2->getLength()) &&
-                    (nc->getBeat() + nc->getLength()) > (nc2->getBeat() + nc2->getLength()))
-                {
-                    const float currentDelta = (nc->getBeat() + nc->getLength()) - (nc2->getBeat() + nc2->getLength());
-                    
-                    if (deltaBeats < currentDelta)
-                    {
-                        deltaBeats = currentDelta;
-                        overlappingNote = nc2;
-                    }
-                }
-            }
-            
-            if (overlappingNote != nullptr)
-            {
-                group2Before.add(overlappingNote->getNote());
-                group2After.add(overlappingNote->getNote().withDeltaLength(deltaBeats));
-            }
-        }
-        
-        step2HasChanges = applyPianoChanges(group2Before, group2After, didCheckpoint);
-    }
-    while (step2HasChanges);
-    
-    
-    // 3 convert this
-    // ------------       ---------
-    //    ---------    ------------
-    // into this
-    // ---                ---------
-    //    ---------    ---         
-    
-    bool step3HasChanges = false;
-
-    do
-    {
-        PianoChangeGroup group3Before, group3After;
-        
-        for (int i = 0; i < selection.getNumSelected(); ++i)
-        {
-            const auto *nc = static_cast<NoteComponent *>(selection.getSelectedItem(i));
-            
-            // для каждой ноты найти ноту, которая перекрывает ее максимально
-            
-            float overlappingBeats = -FLT_MAX;
-            const NoteComponent *overlappingNote = nullptr;
-            
-            for (int j = 0; j < selection.getNumSelected(); ++j)
-            {
-                auto *nc2 = static_cast<NoteComponent *>(selection.getSelectedItem(j));
-                
-                if (nc->getKey() == nc2->getKey() &&
-                    nc->getBeat() < nc2->getBeat() &&
-                    (nc->getBeat() + nc->getLength()) >= (nc2->getBeat() + nc2->getLength()))
-                {
-                    // >0 : has overlap
-                    const float overlapsWith = (nc->getBeat() + nc->getLength()) - nc2->getBeat();
-                    
-                    if (overlapsWith > overlappingBeats)
-                    {
-                        overlappingBeats = overlapsWith;
-                        overlappingNote = nc2;
-                    }
-                }
-            }
-            
-            if (overlappingNote != nullptr)
-            {
-                const float newLength = nc->getLength() - overlappingBeats;
-                group3Before.add(nc->getNote());
-                group3After.add(nc->getNote().withLength(newLength));
-            }
-        }
-        
-        step3HasChanges = applyPianoChanges(group3Before, group3After, didCheckpoint);
-    }
-    while (step3HasChanges);
-    
-    
-    // remove duplicates
-    
-    FlatHashMap<MidiEvent::Id, Note> deferredRemoval;
-    FlatHashMap<MidiEvent::Id, Note> unremovableNotes;
-    
-    for (int i = 0; i < selection.getNumSelected(); ++i)
-    {
-        const auto *nc = static_cast<NoteComponent *>(selection.getSelectedItem(i));
-        
-        for (int j = 0; j < selection.getNumSelected(); ++j)
-        {
-            if (i == j)
-            {
-                continue;
-            }
-            
-            const auto *nc2 = static_cast<NoteComponent *>(selection.getSelectedItem(j));
-            
-            // full overlap
-            //const bool isOverlappingNote = (nc->getKey() == nc2->getKey() &&
-            //                                nc->getBeat() >= nc2->getBeat() &&
-            //                                (nc->getBeat() + nc->getLength()) <= (nc2->getBeat() + nc2->getLength()));
-
-            // partial overlaps also
-            const bool isOverlappingNote = (nc->getKey() == nc2->getKey() &&
-                                            nc->getBeat() >= nc2->getBeat() &&
-                                            nc->getBeat() < (nc2->getBeat() + nc2->getLength()));
-            
-            const bool startsFromTheSameBeat = (nc->getKey() == nc2->getKey() &&
-                                                nc->getBeat() == nc2->getBeat());
-            
-            const bool isOriginalNote = unremovableNotes.contains(nc2->getNote().getId());
-            
-            if (! isOriginalNote &&
-                (isOverlappingNote || startsFromTheSameBeat))
-            {
-                unremovableNotes[nc->getNote().getId()] = nc->getNote();
-                deferredRemoval[nc2->getNote().getId()] = nc2->getNote();
-            }
-        }
-    }
-    
-    PianoChangeGroup removalGroup;
-    for (const auto &deferredRemovalIterator : deferredRemoval)
-    {
-        removalGroup.add(deferredRemovalIterator.second);
-    }
-
-    applyPianoRemovals(removalGroup, didCheckpoint);
+    auto result = NoteTransforms::cleanupOverlaps(getSelectedNotes(selection));
+    result.apply(*getPianoSequence(selection), didCheckpoint);
 }
 
 //make notes staccato (custom length applies)
@@ -609,171 +414,17 @@ void SequencerOperations::makeStaccato(Lasso &selection, float newLength, bool s
     pianoSequence->changeGroup(groupBefore, groupAfter, true);
 }
 
-//a very ugly legato function. For now, it works well. I promise I will clean this up!
-bool SequencerOperations::makeLegato(const Lasso& selection, float overlap, bool shouldCheckpoint /*= true*/)   //extends each note to the note that follows (target note is bottommost note that is to the right)
+// extends each note to the next onset
+bool SequencerOperations::makeLegato(const Lasso &selection, float overlap, bool shouldCheckpoint /*= true*/)
 {
     if (selection.getNumSelected() == 0)
-    {
-        DBG("no notes selected!");
-        return false;
-    }
-
-    auto* sequence = getPianoSequence(selection);
-    jassert(sequence);
-
-    //the sequence isn't neccecarily serial (organized from left to right)
-    //therefore, we will need to continuously re-target the bottommost note that is to the right of the current subject
-    //additionally, we will continuously need to pick the next subject that is the bottommost leftmost note that is above the subject
-
-    PianoChangeGroup removals;
-    PianoChangeGroup groupBefore, groupAfter;
-
-    int selectionSize = selection.getNumSelected(); //for use in various for loops
-
-    auto* subject = selection.getFirstAs<NoteComponent>(); //subject = the note we are currently extending
-    auto* candidate = selection.getItemAs<NoteComponent>(selectionSize - 1); //candidate = the current note being considered to replace the current best candidate
-    auto* target = selection.getItemAs<NoteComponent>(selectionSize - 1); //the note we are extending our subject to
-    auto* bestCandidate = selection.getItemAs<NoteComponent>(selectionSize - 1); //the current best candidate (note that fits our selection criteria)
-
-    //initializing various things
-    float subjectBeat = -1 * FLT_MAX;
-    int subjectKey = -1 * INT_MAX;
-    float candidateBeat = FLT_MAX;
-    int candidateKey = INT_MAX;
-    float bestCandidateBeat = FLT_MAX;
-    int bestCandidateKey = INT_MAX;
-    float targetBeat = FLT_MAX;
-    int targetKey = INT_MAX;
-
-    for (int i = 0; i < selection.getNumSelected(); ++i) //iterate through the selection to get the first subject (leftmost, bottommost note)
-    {
-        //re-initialize candidate variables
-        candidate = selection.getItemAs<NoteComponent>(i);
-        candidateBeat = candidate->getBeat();
-        candidateKey = candidate->getKey();
-
-        //if the candidate is to the left of the last best note, OR if it is equal but lower in key
-        if ((candidateBeat < bestCandidateBeat) || (candidateBeat == bestCandidateBeat && candidateKey < bestCandidateKey))
-        {
-            bestCandidate = candidate;
-            bestCandidateBeat = candidate->getBeat();
-            bestCandidateKey = candidate->getKey();
-        }
-    }
-
-    //subject is now the leftmost bottommost note in the selection
-    //we're setting all this afterward just to make the code more readable later
-    subject = bestCandidate;
-    subjectBeat = bestCandidate->getBeat();
-    subjectKey = bestCandidate->getKey();
-
-    for (int notes = 0; notes < selection.getNumSelected(); ++notes) //since we have set our first subject (before beginning our proper loop), now we commence through the "real" legato loop.
-    {
-        //re-init best candidate variables
-        bestCandidateBeat = FLT_MAX;
-        bestCandidateKey = INT_MAX;
-
-        for (int i = 0; i < selection.getNumSelected(); ++i) //iterate through the selection to get the target note(leftmost, bottommost note that is to the right of the subject)
-        {
-            //re-initialize candidate variables
-            candidate = selection.getItemAs<NoteComponent>(i);
-            candidateBeat = candidate->getBeat();
-            candidateKey = candidate->getKey();
-
-            //if the candidate is to the left of the last best note, OR if it is equal but lower in key, AND it is to the right of the subject
-            if (candidateBeat < bestCandidateBeat && candidateBeat > subjectBeat)
-            {
-                bestCandidate = candidate;
-                bestCandidateBeat = candidate->getBeat();
-                bestCandidateKey = candidate->getKey();
-            }
-            if (candidateBeat == bestCandidateBeat && candidateKey < bestCandidateKey && candidateBeat > subjectBeat)
-            {
-                bestCandidate = candidate;
-                bestCandidateBeat = candidate->getBeat();
-                bestCandidateKey = candidate->getKey();
-            }
-        }
-
-        //the target is now the leftmost note that is 1) to the right of the subject AND 2) among multilbe targets of the same beat, the lowest one
-        target = bestCandidate;
-        targetBeat = bestCandidate->getBeat();
-        targetKey = bestCandidate->getKey();
-
-        float newLength = subject->getLength(); //initialize as subject length (just in case)
-
-        if (targetBeat != subjectBeat && targetKey != subjectKey) //only change length if target is not of the same beat (dirty hack)
-        {
-            newLength = targetBeat - subjectBeat + overlap; //new length is the new length + the overlap specified by overlap
-        }
-        if (targetBeat != subjectBeat && targetKey == subjectKey) //add slight buffer if they're the same key (so note on/off signals dont occur on the same beat (screws with some vsts)
-        {
-            newLength = targetBeat - subjectBeat - Globals::minNoteLength; // 64'th note
-        }
-
-        groupBefore.add(subject->getNote());
-
-        groupAfter.add(subject->getNote().withLength(newLength)); //use fineMode is true
-
-        //re-init best candidate variables
-        bestCandidateBeat = FLT_MAX;
-        bestCandidateKey = INT_MAX;
-
-        for (int i = 0; i < selection.getNumSelected(); ++i) //set the next subject in the same way as before, but is must be at least above our last subject, or to the right.
-        {
-            candidate = selection.getItemAs<NoteComponent>(i); //re-initialize candidate variables
-            candidateBeat = candidate->getBeat();
-            candidateKey = candidate->getKey();
-
-            if (candidateBeat < bestCandidateBeat && candidateBeat > subjectBeat)   //if its to the left of the prior while being greater than the subject
-            {
-                bestCandidate = candidate;
-                bestCandidateBeat = candidate->getBeat();
-                bestCandidateKey = candidate->getKey();
-            }
-            if (candidateBeat == bestCandidateBeat && candidateKey < bestCandidateKey && candidateKey > subjectKey) //if it's the same as the prior
-            {
-                bestCandidate = candidate;
-                bestCandidateBeat = candidate->getBeat();
-                bestCandidateKey = candidate->getKey();
-            }
-            if (candidateBeat == subjectBeat && candidateKey < bestCandidateKey && candidateKey > subjectKey)   //if it's the same beat as the prior
-            {
-                bestCandidate = candidate;
-                bestCandidateBeat = candidate->getBeat();
-                bestCandidateKey = candidate->getKey();
-            }
-        }
-
-        subject = bestCandidate; //our subject is now the bottommost leftmost note that is to the right of the subject or at least above it in key
-        subjectBeat = bestCandidate->getBeat();
-        subjectKey = bestCandidate->getKey();
-    }
-
-
-    if (groupBefore.isEmpty() && removals.isEmpty()) //ditch if either of the groups are empty
     {
         return false;
     }
 
-    if (shouldCheckpoint) //undo checkpoint
-    {
-        sequence->checkpoint();
-    }
-
-    if (!groupBefore.isEmpty())
-    {
-        sequence->changeGroup(groupBefore, groupAfter, true);
-    }
-
-    if (!removals.isEmpty())
-    {
-        sequence->removeGroup(removals, true);
-    }
-
-    sequence->changeGroup(groupBefore, groupAfter, true);
-
-    return true;
+    bool didCheckpoint = !shouldCheckpoint;
+    auto result = NoteTransforms::legato(getSelectedNotes(selection), overlap);
+    return result.apply(*getPianoSequence(selection), didCheckpoint);
 }
 
 void SequencerOperations::retrograde(Lasso &selection, bool shouldCheckpoint /*= true*/)
@@ -1210,30 +861,22 @@ void SequencerOperations::copyToClipboard(Clipboard &clipboard, const Lasso &sel
         return;
     }
 
-    SerializedData tree(Serialization::Clipboard::clipboard);
-
-    float firstBeat = FLT_MAX;
-
     auto *pianoSequence = getPianoSequence(selection);
     jassert(pianoSequence);
-    const auto trackId = pianoSequence->getTrackId();
 
-    SerializedData trackRoot(Serialization::Clipboard::track);
+    Array<Note> notes;
+    notes.ensureStorageAllocated(selection.getNumSelected());
 
     // at the moment, copy-paste only works in the piano roll
     for (int i = 0; i < selection.getNumSelected(); ++i)
     {
         if (const auto *noteComponent = dynamic_cast<NoteComponent *>(selection.getSelectedItem(i)))
         {
-            trackRoot.appendChild(noteComponent->getNote().serialize());
-            firstBeat = jmin(firstBeat, noteComponent->getBeat());
+            notes.add(noteComponent->getNote());
         }
     }
 
-    tree.appendChild(trackRoot);
-
-    tree.setProperty(Serialization::Clipboard::firstBeat, firstBeat);
-    clipboard.copy(tree, false);
+    clipboard.copyNotes(notes, pianoSequence->getTrackId());
 }
 
 void SequencerOperations::pasteFromClipboard(Clipboard &clipboard, ProjectNode &project,
@@ -1241,6 +884,26 @@ void SequencerOperations::pasteFromClipboard(Clipboard &clipboard, ProjectNode &
 {
     if (selectedTrack == nullptr) { return; }
 
+    if (clipboard.hasNotes())
+    {
+        auto *pianoSequence = dynamic_cast<PianoSequence *>(selectedTrack->getSequence());
+        if (pianoSequence == nullptr) { return; }
+
+        const float targetBeat = roundf(targetBeatPosition * 1000.f) / 1000.f;
+        const float deltaBeat = (targetBeat - roundBeat(clipboard.getNotesFirstBeat()));
+
+        // no deserialization here, and the new ids are allocated at once
+        auto pastedNotes = clipboard.getNotes().getNotesWithNewIds(*pianoSequence, deltaBeat);
+
+        if (shouldCheckpoint)
+        {
+            pianoSequence->checkpoint();
+        }
+
+        pianoSequence->insertGroup(pastedNotes, true);
+        return;
+    }
+
     const auto root = clipboard.getData().hasType(Serialization::Clipboard::clipboard) ?
         clipboard.getData() : clipboard.getData().getChildWithName(Serialization::Clipboard::clipboard);
 
@@ -1704,23 +1367,6 @@ void SequencerOperations::applyTuplets(Lasso &selection, Note::Tuplet tuplet, bo
     sequence->changeGroup(groupBefore, groupAfter, true);
 }
 
-static inline void doQuantize(float &startBeat, float &length, float bar)
-{
-    // todo for the future:
-    // align with time signature events
-
-    jassert(bar != 0.f);
-    const float q = bar / float(Globals::beatsPerBar);
-    const auto endBeat = startBeat + length;
-
-    startBeat = roundf(startBeat * q) / q;
-    const auto endBeatRound = roundf(endBeat * q) / q;
-
-    // make sure the returned length is not too short:
-    const auto minQuantizedBeat = (1.f / bar) * float(Globals::beatsPerBar);
-    length = jmax(minQuantizedBeat, endBeatRound - startBeat);
-}
-
 bool SequencerOperations::quantize(const Lasso &selection, float bar, bool shouldCheckpoint /*= true*/)
 {
     if (selection.getNumSelected() == 0)
@@ -1728,143 +1374,23 @@ bool SequencerOperations::quantize(const Lasso &selection, float bar, bool shoul
         return false;
     }
 
-    auto *sequence = getPianoSequence(selection);
-    jassert(sequence);
-
-    PianoChangeGroup removals;
-    PianoChangeGroup groupBefore, groupAfter;
-    for (int i = 0; i < selection.getNumSelected(); ++i)
-    {
-        const auto *nc = selection.getItemAs<NoteComponent>(i);
-        float startBeat = nc->getBeat();
-        float length = nc->getLength();
-
-        doQuantize(startBeat, length, bar);
-
-        if (startBeat == nc->getBeat() && length == nc->getLength())
-        {
-            continue;
-        }
-
-        bool duplicateFound = false;
-        for (const auto &other : groupAfter)
-        {
-            if (nc->getKey() == other.getKey() &&
-                startBeat == other.getBeat() &&
-                length == other.getLength())
-            {
-                duplicateFound = true;
-                break;
-            }
-        }
-
-        if (duplicateFound)
-        {
-            removals.add(nc->getNote());
-            continue;
-        }
-
-        groupBefore.add(nc->getNote());
-        groupAfter.add(nc->getNote().withBeat(startBeat).withLength(length));
-    }
-
-    if (groupBefore.isEmpty() && removals.isEmpty())
-    {
-        return false;
-    }
-
-    if (shouldCheckpoint)
-    {
-        sequence->checkpoint();
-    }
-
-    if (!groupBefore.isEmpty())
-    {
-        sequence->changeGroup(groupBefore, groupAfter, true);
-    }
-
-    if (!removals.isEmpty())
-    {
-        sequence->removeGroup(removals, true);
-    }
-
-    sequence->changeGroup(groupBefore, groupAfter, true);
-    return true;
+    bool didCheckpoint = !shouldCheckpoint;
+    auto result = NoteTransforms::quantize(getSelectedNotes(selection), bar);
+    return result.apply(*getPianoSequence(selection), didCheckpoint);
 }
 
 bool SequencerOperations::quantize(WeakReference<MidiTrack> track,
     float bar, bool shouldCheckpoint /*= true*/)
 {
-    if (track->getSequence()->size() == 0)
-    {
-        return false;
-    }
-
     auto *sequence = dynamic_cast<PianoSequence *>(track->getSequence());
-    if (sequence == nullptr)
-    {
-        return false;
-    }
-
-    
-    PianoChangeGroup removals;
-    PianoChangeGroup groupBefore, groupAfter;
-    for (int i = 0; i < sequence->size(); ++i)
-    {
-        auto *note = static_cast<Note *>(sequence->getUnchecked(i));
-        float startBeat = note->getBeat();
-        float length = note->getLength();
-
-        doQuantize(startBeat, length, bar);
-
-        if (startBeat == note->getBeat() && length == note->getLength())
-        {
-            continue;
-        }
-
-        bool duplicateFound = false;
-        for (const auto &other : groupAfter)
-        {
-            if (note->getKey() == other.getKey() &&
-                startBeat == other.getBeat() &&
-                length == other.getLength())
-            {
-                duplicateFound = true;
-                break;
-            }
-        }
-
-        if (duplicateFound)
-        {
-            removals.add(*note);
-            continue;
-        }
-
-        groupBefore.add(*note);
-        groupAfter.add(note->withBeat(startBeat).withLength(length));
-    }
-
-    if (groupBefore.isEmpty() && removals.isEmpty())
+    if (sequence == nullptr || sequence->isEmpty())
     {
         return false;
     }
 
-    if (shouldCheckpoint)
-    {
-        sequence->checkpoint();
-    }
-
-    if (!groupBefore.isEmpty())
-    {
-        sequence->changeGroup(groupBefore, groupAfter, true);
-    }
-
-    if (!removals.isEmpty())
-    {
-        sequence->removeGroup(removals, true);
-    }
-
-    return true;
+    bool didCheckpoint = !shouldCheckpoint;
+    auto result = NoteTransforms::quantize(NoteTransforms::collectNotes(*sequence), bar);
+    return result.apply(*sequence, didCheckpoint);
 }
 
 int SequencerOperations::findAbsoluteRootKey(const Temperament::Ptr temperament,
@@ -1924,66 +1450,181 @@ void SequencerOperations::rescale(Lasso &selection, Note::Key rootKey,
     sequence->changeGroup(groupBefore, groupAfter, true);
 }
 
-bool SequencerOperations::rescale(const ProjectNode &project, float startBeat, float endBeat,
-    Note::Key rootKey, Scale::Ptr scaleA, Scale::Ptr scaleB, bool shouldCheckpoint /*= true*/)
+//===----------------------------------------------------------------------===//
+// Project-wide harmonic transforms
+//===----------------------------------------------------------------------===//
+
+// the changes for each track are computed independently, reading the
+// sequences and patterns without modifying them, so that this can be done
+// in parallel, and then applied on the message thread in one transaction
+
+struct TrackChangeSet final
 {
-    bool hasMadeChanges = false;
-    bool didCheckpoint = !shouldCheckpoint;
+    explicit TrackChangeSet(const PianoTrackNode &track) :
+        sequence(static_cast<PianoSequence *>(track.getSequence())),
+        pattern(track.getPattern()) {}
+
+    PianoSequence *const sequence;
+    Pattern *const pattern;
+
+    PianoChangeGroup notesBefore;
+    PianoChangeGroup notesAfter;
+    Array<Clip> clipsBefore;
+    Array<Clip> clipsAfter;
+};
 
-    const auto pianoTracks = project.findChildrenOfType<PianoTrackNode>();
-    for (const auto *track : pianoTracks)
+using TrackChangeSetBuilder = Function<void(TrackChangeSet &changes)>;
+
+struct TrackChangeSetJob final : public ThreadPoolJob
+{
+    TrackChangeSetJob(TrackChangeSet &changes, const TrackChangeSetBuilder &builder) :
+        ThreadPoolJob("Track changes job"), changes(changes), builder(builder) {}
+
+    JobStatus runJob() override
     {
-        auto *sequence = static_cast<PianoSequence *>(track->getSequence());
+        this->builder(this->changes);
+        return jobHasFinished;
+    }
+
+    TrackChangeSet &changes;
+    const TrackChangeSetBuilder &builder;
+};
 
-        PianoChangeGroup groupBefore, groupAfter;
+static OwnedArray<TrackChangeSet> buildTrackChangeSets(const ProjectNode &project,
+    const TrackChangeSetBuilder &builder)
+{
+    // for smaller projects, spinning up the threads takes longer than the job itself
+    static constexpr auto minNotesToRunInParallel = 4096;
 
-        // find events in between (only consider events of one clip!),
-        // skipping clips of the same track if already processed any other:
+    OwnedArray<TrackChangeSet> changeSets;
 
-        FlatHashSet<MidiEvent::Id> usedClips;
+    int numNotes = 0;
+    for (const auto *track : project.findChildrenOfType<PianoTrackNode>())
+    {
+        const auto *changes = changeSets.add(new TrackChangeSet(*track));
+        numNotes += changes->sequence->size();
+    }
 
-        for (int i = 0; i < sequence->size(); ++i)
+    if (changeSets.size() < 2 || numNotes < minNotesToRunInParallel)
+    {
+        for (auto *changes : changeSets)
         {
-            const auto *note = static_cast<Note *>(sequence->getUnchecked(i));
-            for (const auto *clip : track->getPattern()->getClips())
-            {
-                if (usedClips.contains(clip->getId()) || usedClips.size() == 0)
-                {
-                    if ((note->getBeat() + clip->getBeat()) >= startBeat &&
-                        (note->getBeat() + clip->getBeat()) < endBeat)
-                    {
-                        const auto keyOffset = rootKey - clip->getKey();
-                        doRescaleLogic(groupBefore, groupAfter, *note, keyOffset, scaleA, scaleB);
-                        usedClips.insert(clip->getId());
-                    }
-                }
-            }
+            builder(*changes);
         }
 
-        if (groupBefore.size() == 0)
+        return changeSets;
+    }
+
+    OwnedArray<TrackChangeSetJob> jobs;
+    ThreadPool pool(jlimit(1, changeSets.size(), SystemStats::getNumCpus()));
+
+    for (auto *changes : changeSets)
+    {
+        auto *job = jobs.add(new TrackChangeSetJob(*changes, builder));
+        pool.addJob(job, false);
+    }
+
+    for (auto *job : jobs)
+    {
+        pool.waitForJobToFinish(job, -1);
+    }
+
+    return changeSets;
+}
+
+static bool applyTrackChangeSets(const OwnedArray<TrackChangeSet> &changeSets, bool shouldCheckpoint)
+{
+    bool hasMadeChanges = false;
+    bool didCheckpoint = !shouldCheckpoint;
+
+    for (const auto *changes : changeSets)
+    {
+        if (changes->notesBefore.isEmpty() && changes->clipsBefore.isEmpty())
         {
             continue;
         }
 
         if (!didCheckpoint)
         {
-            sequence->checkpoint();
+            changes->sequence->checkpoint();
             didCheckpoint = true;
         }
 
         hasMadeChanges = true;
-        sequence->changeGroup(groupBefore, groupAfter, true);
+
+        if (!changes->notesBefore.isEmpty())
+        {
+            changes->sequence->changeGroup(changes->notesBefore, changes->notesAfter, true);
+        }
+
+        if (!changes->clipsBefore.isEmpty())
+        {
+            changes->pattern->changeGroup(changes->clipsBefore, changes->clipsAfter, true);
+        }
     }
 
     return hasMadeChanges;
 }
 
+// the index of the first event in the sorted sequence,
+// which, when played in a given clip, starts at or after a given beat
+static int findFirstEventInClipFrom(const MidiSequence &sequence, const Clip &clip, float beat)
+{
+    const auto clipBeat = clip.getBeat();
+    const auto *found = std::partition_point(sequence.begin(), sequence.end(),
+        [clipBeat, beat](const MidiEvent *event)
+        {
+            return (event->getBeat() + clipBeat) < beat;
+        });
+
+    return int(found - sequence.begin());
+}
+
+bool SequencerOperations::rescale(const ProjectNode &project, float startBeat, float endBeat,
+    Note::Key rootKey, Scale::Ptr scaleA, Scale::Ptr scaleB, bool shouldCheckpoint /*= true*/)
+{
+    const auto changeSets = buildTrackChangeSets(project,
+        [startBeat, endBeat, rootKey, scaleA, scaleB](TrackChangeSet &changes)
+    {
+        const auto &sequence = *changes.sequence;
+
+        // find events in between, but only consider events of one clip,
+        // the one which has the earliest note in range:
+        const Clip *targetClip = nullptr;
+        int firstIndex = sequence.size();
+
+        for (const auto *clip : changes.pattern->getClips())
+        {
+            const auto index = findFirstEventInClipFrom(sequence, *clip, startBeat);
+            if (index < firstIndex &&
+                (sequence.getUnchecked(index)->getBeat() + clip->getBeat()) < endBeat)
+            {
+                targetClip = clip;
+                firstIndex = index;
+            }
+        }
+
+        if (targetClip == nullptr)
+        {
+            return;
+        }
+
+        const auto lastIndex = findFirstEventInClipFrom(sequence, *targetClip, endBeat);
+        const auto keyOffset = rootKey - targetClip->getKey();
+
+        for (int i = firstIndex; i < lastIndex; ++i)
+        {
+            const auto *note = static_cast<Note *>(sequence.getUnchecked(i));
+            doRescaleLogic(changes.notesBefore, changes.notesAfter, *note, keyOffset, scaleA, scaleB);
+        }
+    });
+
+    return applyTrackChangeSets(changeSets, shouldCheckpoint);
+}
+
 bool SequencerOperations::remapNotesToTemperament(const ProjectNode &project,
     Temperament::Ptr temperament, bool shouldCheckpoint)
 {
-    bool hasMadeChanges = false;
-    bool didCheckpoint = !shouldCheckpoint;
-
     const auto currentTemperament = project.getProjectInfo()->getTemperament();
     const auto chromaticMapFrom = currentTemperament->getChromaticMap();
     const auto chromaticMapTo = temperament->getChromaticMap();
@@ -2000,7 +1641,7 @@ bool SequencerOperations::remapNotesToTemperament(const ProjectNode &project,
 
     // a helper to find a key signature at certain beat
     // works similarly to findHarmonicContext, but simpler:
-    auto *keySignatures = project.getTimeline()->getKeySignatures()->getSequence();
+    const auto *keySignatures = project.getTimeline()->getKeySignatures()->getSequence();
     const auto findRootKey = [keySignatures](float beat)
     {
         if (keySignatures->size() == 0)
@@ -2008,45 +1649,29 @@ bool SequencerOperations::remapNotesToTemperament(const ProjectNode &project,
             return 0;
         }
 
-        const KeySignatureEvent *context = nullptr;
+        // the last one starting before the beat, or the first one
+        // no matter where it resides, if all of them are after the beat
+        const auto *next = std::partition_point(keySignatures->begin(), keySignatures->end(),
+            [beat](const MidiEvent *ks) { return ks->getBeat() <= beat; });
 
-        for (int i = 0; i < keySignatures->size(); ++i)
-        {
-            auto *ks = keySignatures->getUnchecked(i);
-            if (context == nullptr || ks->getBeat() <= beat)
-            {
-                // take the first one no matter where it resides;
-                // if event is still before the sequence beat, update the context anyway:
-                context = static_cast<KeySignatureEvent *>(ks);
-            }
-            else if (ks->getBeat() >= beat)
-            {
-                // no need to look further
-                break;
-            }
-        }
-
-        if (context != nullptr)
-        {
-            // we've found the only context that doesn't change within a sequence:
-            return context->getRootKey();
-        }
-
-        return 0;
+        const auto *context = (next == keySignatures->begin()) ? next : (next - 1);
+        return static_cast<KeySignatureEvent *>(*context)->getRootKey();
     };
 
-    const auto pianoTracks = project.findChildrenOfType<PianoTrackNode>();
-    for (const auto *track : pianoTracks)
+    const auto changeSets = buildTrackChangeSets(project,
+        [&](TrackChangeSet &changes)
     {
         // upscaling temperament from twelve-tone is really straightforward,
         // but we'll also support downscaling from larger temperament to smaller one:
         // for that we'll just round each key to the nearest key of chromatic approximation scale
-        auto *sequence = static_cast<PianoSequence *>(track->getSequence());
+        const auto &sequence = *changes.sequence;
+
+        changes.notesBefore.ensureStorageAllocated(sequence.size());
+        changes.notesAfter.ensureStorageAllocated(sequence.size());
 
-        Array<Note> notesBefore, notesAfter;
-        for (int n = 0; n < sequence->size(); ++n)
+        for (int n = 0; n < sequence.size(); ++n)
         {
-            const auto *note = static_cast<Note *>(sequence->getUnchecked(n));
+            const auto *note = static_cast<Note *>(sequence.getUnchecked(n));
 
             const auto rootKeyBefore = findRootKey(note->getBeat());
             const auto rootIndexInChromaticMap = chromaticMapFrom->getNearestScaleKey(rootKeyBefore);
@@ -2061,15 +1686,13 @@ bool SequencerOperations::remapNotesToTemperament(const ProjectNode &project,
             const auto newRelativeKey = chromaticMapTo->getChromaticKey(keyIndexInChromaticMap, rootKeyAfter, false);
             const auto newKey = periodNum * periodSizeAfter + newRelativeKey;
 
-            notesBefore.add(*note);
-            notesAfter.add(note->withKey(newKey));
+            changes.notesBefore.add(*note);
+            changes.notesAfter.add(note->withKey(newKey));
         }
 
         // same mapping rules apply to any keys, so we will adjust clip key offsets as well
 
-        auto *pattern = track->getPattern();
-
-        Array<Clip> clipsBefore, clipsAfter;
+        const auto *pattern = changes.pattern;
 
         for (int i = 0; i < pattern->size(); ++i)
         {
@@ -2084,37 +1707,12 @@ bool SequencerOperations::remapNotesToTemperament(const ProjectNode &project,
             const auto newRelativeKey = chromaticMapTo->getChromaticKey(keyIndexInChromaticMap, 0, false);
             const auto newKey = periodNum * periodSizeAfter + newRelativeKey * keySign;
 
-            clipsBefore.add(*clip);
-            clipsAfter.add(clip->withKey(newKey));
-        }
-
-        // now just apply changes
-
-        if (notesBefore.isEmpty() && clipsBefore.isEmpty())
-        {
-            continue;
-        }
-
-        if (!didCheckpoint)
-        {
-            sequence->checkpoint();
-            didCheckpoint = true;
-        }
-
-        hasMadeChanges = true;
-
-        if (!notesBefore.isEmpty())
-        {
-            sequence->changeGroup(notesBefore, notesAfter, true);
-        }
-
-        if (!clipsBefore.isEmpty())
-        {
-            pattern->changeGroup(clipsBefore, clipsAfter, true);
+            changes.clipsBefore.add(*clip);
+            changes.clipsAfter.add(clip->withKey(newKey));
         }
-    }
+    });
 
-    return hasMadeChanges;
+    return applyTrackChangeSets(changeSets, shouldCheckpoint);
 }
 
 bool SequencerOperations::remapKeySignaturesToTemperament(KeySignaturesSequence *keySignatures,
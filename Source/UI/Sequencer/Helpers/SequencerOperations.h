@@ -46,6 +46,7 @@ struct SequencerOperations final
 
     static PianoSequence *getPianoSequence(const Lasso &selection);
     static PianoSequence *getPianoSequence(const Clip &targetClip);
+    static Array<Note> getSelectedNotes(const Lasso &selection);
 
     static bool arpeggiate(Lasso &selection,
         const Temperament::Ptr temperament,
@@ -97,7 +98,7 @@ struct SequencerOperations final
     static void melodicInversion(Lasso &selection, bool shouldCheckpoint = true);
 
     static void makeStaccato(Lasso &selection, float newLength, bool shouldCheckpoint = true);
-    static bool makeLegato(const Lasso& selection, float overlap, bool shouldCheckpoint = true);
+    static bool makeLegato(const Lasso &selection, float overlap, bool shouldCheckpoint = true);
 
     static void applyTuplets(Lasso &selection, Note::Tuplet tuplet, bool shouldCheckpoint = true);
     static bool quantize(const Lasso &selection, float bar, bool shouldCheckpoint = true);
@@ -26,6 +26,7 @@
 #include "SelectionComponent.h"
 #include "SequencerOperations.h"
 #include "ColourIDs.h"
+#include "NotesPaintBatch.h"
 
 NoteComponent::NoteComponent(PianoRoll &editor, const Note &event, const Clip &clip, bool ghostMode) noexcept :
     MidiEventComponent(editor, ghostMode),
@@ -591,70 +592,14 @@ void NoteComponent::mouseDoubleClick(const MouseEvent &e)
 // Notes painting
 //===----------------------------------------------------------------------===//
 
-// Always use only either drawHorizontalLine/drawVerticalLine,
-// or fillRect - these are the ones with minimal overhead:
+// The piano roll paints all visible notes at once, and the note
+// components are not a part of its paint traversal (see NoteComponentsLayer),
+// so this is only used for the notes being faded in or out
 void NoteComponent::paint(Graphics &g) noexcept
 {
-    const float w = this->floatLocalBounds.getWidth() - .5f; // a small gap between notes
-    const float h = this->floatLocalBounds.getHeight();
-    const float x = this->floatLocalBounds.getX();
-    const float y = this->floatLocalBounds.getY();
-    
-    g.setColour(this->colour);
-    g.fillRect(x + 0.5f, y + h / 6.f, 0.5f, h / 1.5f);
-
-    if (w >= 1.25f)
-    {
-        g.fillRect(x + w - 0.75f, y + h / 6.f, 0.5f, h / 1.5f);
-        g.fillRect(x + 0.75f, y + 0.75f, w - 1.25f, h - 1.5f);
-    }
-
-    if (w >= 2.25f)
-    {
-        g.setColour(this->colourLighter);
-        g.fillRect(x + 1.25f, roundf(y), w - 2.25f, 1.f);
-
-        g.setColour(this->colourDarker);
-        g.fillRect(x + 1.25f, roundf(y + h - 1), w - 2.25f, 1.f);
-    }
-
-    if (w >= 6.f)
-    {
-        g.setColour(this->colourVolume);
-        const float sx = x + 2.f;
-        const float sh = jmin(h - 2.f, 4.f);
-        const float sy = h - sh - 1.f;
-        const float sw1 = (w - 4.f) * this->note.getVelocity();
-        const float sw2 = (w - 4.f) * this->note.getVelocity() * this->clip.getVelocity();
-
-        g.fillRect(sx, sy, sw1, sh);
-        g.fillRect(sx, sy, sw2, sh);
-
-        g.fillRect(sx + sw1, sy + 1.f, 1.f, sh - 1.f);
-        g.fillRect(sx + sw2, sy + 1.f, 1.f, sh - 1.f);
-    }
-
-    const auto tuplet = this->note.getTuplet();
-    if (tuplet > 1 && this->getWidth() > 25)
-    {
-        g.setColour(this->colourLighter);
-        for (int i = 1; i < tuplet; ++i)
-        {
-            g.fillRect(x + i * (w / tuplet) - 1.f, y, 1.f, h);
-        }
-
-        g.setColour(this->colourVolume);
-        for (int i = 1; i < tuplet; ++i)
-        {
-            g.fillRect(x + i * (w / tuplet), y, 1.5f, h);
-        }
-    }
-
-    // debug
-    //g.setColour(Colours::orangered);
-    //const auto edge = this->getResizableEdge();
-    //g.fillRect(0, 0, edge, this->getHeight());
-    //g.fillRect(this->getWidth() - edge, 0, edge, this->getHeight());
+    NotesPaintBatch batch;
+    batch.addNote(*this, {});
+    batch.fill(g);
 }
 
 //===----------------------------------------------------------------------===//
@@ -205,6 +205,7 @@ private:
     Colour colourVolume;
 
     friend class PianoRoll;
+    friend class NotesPaintBatch;
     friend class NoteResizerLeft;
     friend class NoteResizerRight;
     friend struct SequencerOperations;
@@ -0,0 +1,76 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include "NoteComponent.h"
+
+// A transparent layer which holds the piano roll's note components,
+// so that they still receive mouse events, but are never painted
+// by themselves: the roll paints all notes at once, and the layer's
+// cached image skips the paint traversal of the note components,
+// only painting the proxies added by the fader to fade the notes out
+
+class NoteComponentsLayer final : public Component
+{
+public:
+
+    explicit NoteComponentsLayer(const ComponentAnimator &fader) : fader(fader)
+    {
+        this->setInterceptsMouseClicks(false, true);
+        this->setCachedComponentImage(new NoChildrenImage(*this));
+    }
+
+private:
+
+    struct NoChildrenImage final : public CachedComponentImage
+    {
+        explicit NoChildrenImage(NoteComponentsLayer &layer) noexcept : layer(layer) {}
+
+        void paint(Graphics &g) override
+        {
+            if (!this->layer.fader.isAnimating())
+            {
+                return;
+            }
+
+            for (int i = 0; i < this->layer.getNumChildComponents(); ++i)
+            {
+                auto *child = this->layer.getChildComponent(i);
+                if (child->isVisible() && dynamic_cast<NoteComponent *>(child) == nullptr)
+                {
+                    Graphics::ScopedSaveState state(g);
+                    g.setOrigin(child->getPosition());
+                    child->paintEntireComponent(g, false);
+                }
+            }
+        }
+
+        // nothing is cached really, so the repaints
+        // should reach the roll, which paints the notes:
+        bool invalidateAll() override { return true; }
+        bool invalidate(const Rectangle<int> &) override { return true; }
+        void releaseResources() override {}
+
+        NoteComponentsLayer &layer;
+    };
+
+    const ComponentAnimator &fader;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(NoteComponentsLayer)
+};
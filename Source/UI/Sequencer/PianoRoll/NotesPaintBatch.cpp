@@ -0,0 +1,329 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Common.h"
+#include "NotesPaintBatch.h"
+#include "NoteComponent.h"
+
+void NotesPaintBatch::addNote(const NoteComponent &nc, const Point<float> &origin)
+{
+    const auto &bounds = nc.floatLocalBounds;
+    const float w = bounds.getWidth() - .5f; // a small gap between notes
+    const float h = bounds.getHeight();
+    const float x = origin.x + bounds.getX();
+    const float y = origin.y + bounds.getY();
+
+    auto &body = this->getRectangles(Stage::body, nc.colour);
+    body.addWithoutMerging({ x + 0.5f, y + h / 6.f, 0.5f, h / 1.5f });
+
+    if (w >= 1.25f)
+    {
+        body.addWithoutMerging({ x + w - 0.75f, y + h / 6.f, 0.5f, h / 1.5f });
+        body.addWithoutMerging({ x + 0.75f, y + 0.75f, w - 1.25f, h - 1.5f });
+    }
+
+    if (w >= 2.25f)
+    {
+        this->getRectangles(Stage::borders, nc.colourLighter)
+            .addWithoutMerging({ x + 1.25f, roundf(y), w - 2.25f, 1.f });
+
+        this->getRectangles(Stage::borders, nc.colourDarker)
+            .addWithoutMerging({ x + 1.25f, roundf(y + h - 1), w - 2.25f, 1.f });
+    }
+
+    const bool hasVolume = !nc.colourVolume.isTransparent();
+
+    if (w >= 6.f && hasVolume)
+    {
+        const float sx = x + 2.f;
+        const float sh = jmin(h - 2.f, 4.f);
+        const float sy = origin.y + h - sh - 1.f;
+        const float sw1 = (w - 4.f) * nc.getNote().getVelocity();
+        const float sw2 = sw1 * nc.getClip().getVelocity();
+
+        // the two velocity bars overlap, and the overlapping
+        // part is expected to look darker, hence two stages
+        auto &velocity = this->getRectangles(Stage::velocity, nc.colourVolume);
+        velocity.addWithoutMerging({ sx, sy, sw1, sh });
+        velocity.addWithoutMerging({ sx + sw1, sy + 1.f, 1.f, sh - 1.f });
+
+        auto &clipVelocity = this->getRectangles(Stage::clipVelocity, nc.colourVolume);
+        clipVelocity.addWithoutMerging({ sx, sy, sw2, sh });
+        clipVelocity.addWithoutMerging({ sx + sw2, sy + 1.f, 1.f, sh - 1.f });
+    }
+
+    const auto tuplet = nc.getNote().getTuplet();
+    if (tuplet > 1 && bounds.getWidth() > 25.f)
+    {
+        auto &tuplets = this->getRectangles(Stage::tuplets, nc.colourLighter);
+        for (int i = 1; i < tuplet; ++i)
+        {
+            tuplets.addWithoutMerging({ x + i * (w / tuplet) - 1.f, y, 1.f, h });
+        }
+
+        if (hasVolume)
+        {
+            auto &shadows = this->getRectangles(Stage::tupletShadows, nc.colourVolume);
+            for (int i = 1; i < tuplet; ++i)
+            {
+                shadows.addWithoutMerging({ x + i * (w / tuplet), y, 1.5f, h });
+            }
+        }
+    }
+}
+
+void NotesPaintBatch::addNoteDensity(const NoteComponent &nc, const Point<float> &origin)
+{
+    const auto &bounds = nc.floatLocalBounds;
+    const float x = origin.x + bounds.getX();
+    const float y = origin.y + bounds.getY();
+    const float w = jmax(bounds.getWidth(), 1.f);
+    this->addDensity(nc.colour, { x, y, w, bounds.getHeight() });
+}
+
+void NotesPaintBatch::addDensity(Colour colour, const Rectangle<float> &area)
+{
+    const float x = area.getX();
+    const float y = area.getY();
+    const float w = area.getWidth();
+
+    auto &cells = this->getDensityCells(colour);
+
+    const auto rowKey = int64(roundToInt(y)) << 32;
+    const auto firstCell = int(floorf(x / densityCellWidth));
+    const auto lastCell = int(floorf((x + w) / densityCellWidth));
+
+    for (int i = firstCell; i <= lastCell; ++i)
+    {
+        const float cellStart = float(i * densityCellWidth);
+        const float coverage = jmin(x + w, cellStart + densityCellWidth) - jmax(x, cellStart);
+        if (coverage <= 0.f)
+        {
+            continue;
+        }
+
+        auto &cell = cells[rowKey | uint32(i)];
+        cell.y = y;
+        cell.height = area.getHeight();
+        cell.coverage += coverage;
+    }
+}
+
+void NotesPaintBatch::fill(Graphics &g)
+{
+    this->flushDensityCells();
+
+    for (auto &stageLayers : this->layers)
+    {
+        for (int i = 0; i < stageLayers.size();)
+        {
+            auto *layer = stageLayers.getUnchecked(i);
+            if (layer->rectangles.isEmpty())
+            {
+                // not used since the last frame, most likely
+                // the colours have changed, e.g. after deselection
+                stageLayers.remove(i);
+                continue;
+            }
+
+            g.setColour(layer->colour);
+            g.fillRectList(layer->rectangles);
+            layer->rectangles.clear();
+            ++i;
+        }
+    }
+}
+
+RectangleList<float> &NotesPaintBatch::getRectangles(Stage stage, Colour colour)
+{
+    auto &stageLayers = this->layers[stage];
+    auto &lastUsedLayer = this->lastUsedLayers[stage];
+
+    // most of the time, the notes of the same track
+    // and the same selection state come in a row
+    if (lastUsedLayer < stageLayers.size() &&
+        stageLayers.getUnchecked(lastUsedLayer)->colour == colour)
+    {
+        return stageLayers.getUnchecked(lastUsedLayer)->rectangles;
+    }
+
+    for (int i = 0; i < stageLayers.size(); ++i)
+    {
+        if (stageLayers.getUnchecked(i)->colour == colour)
+        {
+            lastUsedLayer = i;
+            return stageLayers.getUnchecked(i)->rectangles;
+        }
+    }
+
+    lastUsedLayer = stageLayers.size();
+    return stageLayers.add(new Layer(colour))->rectangles;
+}
+
+//===----------------------------------------------------------------------===//
+// Density bars
+//===----------------------------------------------------------------------===//
+
+NotesPaintBatch::DensityCells &NotesPaintBatch::getDensityCells(Colour colour)
+{
+    if (this->lastUsedDensityLayer < this->densityLayers.size() &&
+        this->densityLayers.getUnchecked(this->lastUsedDensityLayer)->colour == colour)
+    {
+        return this->densityLayers.getUnchecked(this->lastUsedDensityLayer)->cells;
+    }
+
+    for (int i = 0; i < this->densityLayers.size(); ++i)
+    {
+        if (this->densityLayers.getUnchecked(i)->colour == colour)
+        {
+            this->lastUsedDensityLayer = i;
+            return this->densityLayers.getUnchecked(i)->cells;
+        }
+    }
+
+    this->lastUsedDensityLayer = this->densityLayers.size();
+    return this->densityLayers.add(new DensityLayer(colour))->cells;
+}
+
+void NotesPaintBatch::flushDensityCells()
+{
+    for (const auto *densityLayer : this->densityLayers)
+    {
+        Colour levelColours[numDensityLevels];
+        for (int level = 0; level < numDensityLevels; ++level)
+        {
+            levelColours[level] = densityLayer->colour
+                .withMultipliedAlpha(float(level + 1) / float(numDensityLevels));
+        }
+
+        for (const auto &it : densityLayer->cells)
+        {
+            const auto &cell = it.second;
+            const auto cellIndex = int(uint32(it.first & 0xffffffff));
+            const auto density = cell.coverage / float(densityCellWidth);
+            const auto level = jlimit(0, numDensityLevels - 1,
+                int(ceilf(density * numDensityLevels)) - 1);
+
+            this->getRectangles(Stage::body, levelColours[level])
+                .addWithoutMerging({ float(cellIndex * densityCellWidth),
+                    cell.y, float(densityCellWidth) - 0.5f, cell.height });
+        }
+    }
+
+    // the density layers are re-created each frame, since
+    // unlike the rectangle lists, the hash maps won't shrink
+    this->densityLayers.clearQuick(true);
+    this->lastUsedDensityLayer = 0;
+}
+
+//===----------------------------------------------------------------------===//
+// Tests
+//===----------------------------------------------------------------------===//
+
+#if JUCE_UNIT_TESTS
+
+class NotesPaintBatchTests final : public UnitTest
+{
+public:
+    NotesPaintBatchTests() : UnitTest("Notes paint batch tests", UnitTestCategories::helio) {}
+
+    void runTest() override
+    {
+        const auto red = Colours::red;
+        const auto blue = Colours::blue;
+
+        beginTest("Rectangles are grouped by stage and colour");
+        {
+            NotesPaintBatch batch;
+
+            auto &redBodies = batch.getRectangles(NotesPaintBatch::body, red);
+            auto &blueBodies = batch.getRectangles(NotesPaintBatch::body, blue);
+            expect(&redBodies != &blueBodies);
+            expect(&batch.getRectangles(NotesPaintBatch::body, red) == &redBodies);
+            expect(&batch.getRectangles(NotesPaintBatch::borders, red) != &redBodies);
+
+            redBodies.addWithoutMerging({ 0.f, 0.f, 4.f, 4.f });
+            redBodies.addWithoutMerging({ 8.f, 0.f, 4.f, 4.f });
+            blueBodies.addWithoutMerging({ 0.f, 8.f, 4.f, 4.f });
+
+            expectEquals(batch.layers[NotesPaintBatch::body].size(), 2);
+            expectEquals(batch.layers[NotesPaintBatch::borders].size(), 1);
+
+            Image image(Image::ARGB, 16, 16, true);
+            {
+                Graphics g(image);
+                batch.fill(g);
+            }
+
+            expect(image.getPixelAt(1, 1) == red);
+            expect(image.getPixelAt(9, 1) == red);
+            expect(image.getPixelAt(1, 9) == blue);
+            expect(image.getPixelAt(5, 1).isTransparent());
+
+            // filled rectangles are cleared, and the empty border layer is gone
+            expect(redBodies.isEmpty());
+            expectEquals(batch.layers[NotesPaintBatch::body].size(), 2);
+            expectEquals(batch.layers[NotesPaintBatch::borders].size(), 0);
+
+            // the layers not used since the last frame are removed
+            batch.getRectangles(NotesPaintBatch::body, blue)
+                .addWithoutMerging({ 0.f, 8.f, 4.f, 4.f });
+
+            {
+                Graphics g(image);
+                batch.fill(g);
+            }
+
+            expectEquals(batch.layers[NotesPaintBatch::body].size(), 1);
+        }
+
+        beginTest("Density cells opacity depends on coverage");
+        {
+            NotesPaintBatch batch;
+            const auto cellWidth = float(NotesPaintBatch::densityCellWidth);
+
+            // the first cell is fully covered by two adjacent notes,
+            // the second one is only covered by a single pixel
+            batch.addDensity(red, { 0.f, 0.f, cellWidth / 2.f, 4.f });
+            batch.addDensity(red, { cellWidth / 2.f, 0.f, cellWidth / 2.f + 1.f, 4.f });
+
+            // another row
+            batch.addDensity(red, { 0.f, 8.f, cellWidth, 4.f });
+
+            expectEquals(batch.densityLayers.size(), 1);
+            expectEquals(int(batch.densityLayers.getFirst()->cells.size()), 3);
+
+            Image image(Image::ARGB, 16, 16, true);
+            {
+                Graphics g(image);
+                batch.fill(g);
+            }
+
+            expectEquals(batch.densityLayers.size(), 0);
+
+            const auto minAlpha = uint8(255 / NotesPaintBatch::numDensityLevels);
+            expectEquals(int(image.getPixelAt(1, 1).getAlpha()), 255);
+            expectEquals(int(image.getPixelAt(1, 9).getAlpha()), 255);
+            expect(image.getPixelAt(int(cellWidth) + 1, 1).getAlpha() <= minAlpha + 1);
+            expect(image.getPixelAt(1, 5).isTransparent());
+        }
+    }
+};
+
+static NotesPaintBatchTests notesPaintBatchTests;
+
+#endif
@@ -0,0 +1,99 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+class NoteComponent;
+
+// Instead of letting each note component paint itself, with its own
+// clip region and a dozen of colour changes, the piano roll collects
+// the rectangles of all visible notes, grouped by colour, and fills
+// each group with a single call; at extreme zoom-out, the notes are
+// collapsed into density bars: each row is divided into cells, and
+// each cell is filled more opaque the more of it is covered by notes
+
+class NotesPaintBatch final
+{
+public:
+
+    NotesPaintBatch() = default;
+
+    // the origin is the position of the note component's
+    // parent coordinate space in the target graphics context
+    void addNote(const NoteComponent &nc, const Point<float> &origin);
+    void addNoteDensity(const NoteComponent &nc, const Point<float> &origin);
+
+    void fill(Graphics &g);
+
+private:
+
+    // the stages are filled in this order, so that
+    // the details are painted on top of the note bodies
+    enum Stage
+    {
+        body,
+        borders,
+        velocity,
+        clipVelocity,
+        tuplets,
+        tupletShadows,
+        numStages
+    };
+
+    struct Layer final
+    {
+        explicit Layer(Colour colour) : colour(colour) {}
+        const Colour colour;
+        RectangleList<float> rectangles;
+    };
+
+    OwnedArray<Layer> layers[Stage::numStages];
+    int lastUsedLayers[Stage::numStages] = {};
+
+    RectangleList<float> &getRectangles(Stage stage, Colour colour);
+
+    static constexpr auto densityCellWidth = 4;
+    static constexpr auto numDensityLevels = 4;
+
+    struct DensityCell final
+    {
+        float y = 0.f;
+        float height = 0.f;
+        float coverage = 0.f;
+    };
+
+    // cells are keyed by row position and cell index
+    using DensityCells = FlatHashMap<int64, DensityCell>;
+
+    struct DensityLayer final
+    {
+        explicit DensityLayer(Colour colour) : colour(colour) {}
+        const Colour colour;
+        DensityCells cells;
+    };
+
+    OwnedArray<DensityLayer> densityLayers;
+    int lastUsedDensityLayer = 0;
+
+    void addDensity(Colour colour, const Rectangle<float> &area);
+    DensityCells &getDensityCells(Colour colour);
+    void flushDensityCells();
+
+    friend class NotesPaintBatchTests;
+
+    JUCE_DECLARE_NON_COPYABLE(NotesPaintBatch)
+};
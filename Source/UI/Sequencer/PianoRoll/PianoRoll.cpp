@@ -30,6 +30,7 @@
 #include "ProjectMetadata.h"
 #include "Note.h"
 #include "NoteComponent.h"
+#include "NoteComponentsLayer.h"
 #include "NoteNameGuidesBar.h"
 #include "NotesTuningPanel.h"
 #include "HelperRectangle.h"
@@ -85,6 +86,9 @@ PianoRoll::PianoRoll(ProjectNode &project, Viewport &viewport, WeakReference<Aud
     this->selectionListeners.add(new PianoRollSelectionMenuManager(&this->selection, this->project));
     this->selectionListeners.add(new PianoRollSelectionRangeIndicatorController(&this->selection, *this));
 
+    this->notesLayer = make<NoteComponentsLayer>(this->fader);
+    this->addAndMakeVisible(this->notesLayer.get());
+
     this->draggingHelper = make<HelperRectangleHorizontal>();
     this->addChildComponent(this->draggingHelper.get());
 
@@ -144,7 +148,7 @@ void PianoRoll::loadTrack(const MidiTrack *const track)
                 (*sequenceMap)[*note] = UniquePointer<NoteComponent>(nc);
                 const bool isActive = nc->belongsTo(this->activeTrack, this->activeClip);
                 nc->setActive(isActive, true);
-                this->addAndMakeVisible(nc);
+                this->notesLayer->addAndMakeVisible(nc);
                 nc->setFloatBounds(this->getEventBounds(nc));
             }
         }
@@ -264,7 +268,7 @@ void PianoRoll::showGhostNoteFor(NoteComponent *target)
     //component->setAlpha(0.2f); // setAlpha makes everything slower
     component->setGhostMode(); // use this, Luke.
 
-    this->addAndMakeVisible(component);
+    this->notesLayer->addAndMakeVisible(component);
     this->ghostNotes.add(component);
 
     this->triggerBatchRepaintFor(component);
@@ -548,7 +552,7 @@ void PianoRoll::onAddMidiEvent(const MidiEvent &event)
             const Clip *realClip = track->getPattern()->getUnchecked(i);
             auto *component = new NoteComponent(*this, note, *realClip);
             sequenceMap[note] = UniquePointer<NoteComponent>(component);
-            this->addAndMakeVisible(component);
+            this->notesLayer->addAndMakeVisible(component);
 
             this->fader.fadeIn(component, Globals::UI::fadeInLong);
 
@@ -645,7 +649,7 @@ void PianoRoll::onAddClip(const Clip &clip)
         const auto &note = e.second.get()->getNote();
         auto *component = new NoteComponent(*this, note, clip);
         (*sequenceMap)[note] = UniquePointer<NoteComponent>(component);
-        this->addAndMakeVisible(component);
+        this->notesLayer->addAndMakeVisible(component);
 
         const bool isActive = component->belongsTo(this->activeTrack, this->activeClip);
         component->setActive(isActive);
@@ -882,6 +886,21 @@ void PianoRoll::onChangeViewEditableScope(MidiTrack *const newActiveTrack,
     this->noteNameGuides->toFront(false);
 }
 
+void PianoRoll::onChangeRecordingNotes(const Clip &clip, const Array<Note> &notes)
+{
+    // only a few notes are held at a time, so simply re-create them
+    this->recordingNotes.clearQuick(true);
+
+    for (const auto &note : notes)
+    {
+        auto *component = new NoteComponent(*this, note, clip, true);
+        component->setEnabled(false);
+        component->setFloatBounds(this->getEventBounds(component));
+        this->notesLayer->addAndMakeVisible(component);
+        this->recordingNotes.add(component);
+    }
+}
+
 //===----------------------------------------------------------------------===//
 // LassoSource
 //===----------------------------------------------------------------------===//
@@ -1186,13 +1205,24 @@ void PianoRoll::handleCommandMessage(int commandId)
         SequencerOperations::makeStaccato(this->selection, Globals::minNoteLength, true);
         break;
     case CommandIDs::MakeLegato:
-        SequencerOperations::makeLegato(this->getLassoSelection(), 0.0f);
+        if (!this->transformSelectionAsync([](const Array<Note> &notes)
+            { return NoteTransforms::legato(notes, 0.f); }))
+        {
+            SequencerOperations::makeLegato(this->getLassoSelection(), 0.0f);
+        }
         break;
     case CommandIDs::MakeLegatoOverlapping:
-        SequencerOperations::makeLegato(this->getLassoSelection(), Globals::minNoteLength);
+        if (!this->transformSelectionAsync([](const Array<Note> &notes)
+            { return NoteTransforms::legato(notes, Globals::minNoteLength); }))
+        {
+            SequencerOperations::makeLegato(this->getLassoSelection(), Globals::minNoteLength);
+        }
         break;
     case CommandIDs::CleanupOverlaps:
-        SequencerOperations::cleanupOverlaps(this->selection);
+        if (!this->transformSelectionAsync(NoteTransforms::cleanupOverlaps))
+        {
+            SequencerOperations::cleanupOverlaps(this->selection);
+        }
         break;
     case CommandIDs::MelodicInversion:
         SequencerOperations::melodicInversion(this->selection);
@@ -1359,28 +1389,22 @@ void PianoRoll::handleCommandMessage(int commandId)
         SequencerOperations::applyTuplets(this->selection, 9);
         break;
     case CommandIDs::QuantizeTo1_1:
-        if (this->selection.getNumSelected() == 0) { this->selectAll(); }
-        SequencerOperations::quantize(this->selection, 1.f);
+        this->quantizeSelection(1.f);
         break;
     case CommandIDs::QuantizeTo1_2:
-        if (this->selection.getNumSelected() == 0) { this->selectAll(); }
-        SequencerOperations::quantize(this->selection, 2.f);
+        this->quantizeSelection(2.f);
         break;
     case CommandIDs::QuantizeTo1_4:
-        if (this->selection.getNumSelected() == 0) { this->selectAll(); }
-        SequencerOperations::quantize(this->selection, 4.f);
+        this->quantizeSelection(4.f);
         break;
     case CommandIDs::QuantizeTo1_8:
-        if (this->selection.getNumSelected() == 0) { this->selectAll(); }
-        SequencerOperations::quantize(this->selection, 8.f);
+        this->quantizeSelection(8.f);
         break;
     case CommandIDs::QuantizeTo1_16:
-        if (this->selection.getNumSelected() == 0) { this->selectAll(); }
-        SequencerOperations::quantize(this->selection, 16.f);
+        this->quantizeSelection(16.f);
         break;
     case CommandIDs::QuantizeTo1_32:
-        if (this->selection.getNumSelected() == 0) { this->selectAll(); }
-        SequencerOperations::quantize(this->selection, 32.f);
+        this->quantizeSelection(32.f);
         break;
     default:
         break;
@@ -1398,6 +1422,8 @@ void PianoRoll::resized()
 
     ROLL_BATCH_REPAINT_START
 
+    this->notesLayer->setBounds(this->getLocalBounds());
+
     forEachEventComponent(this->patternMap, e)
     {
         const auto component = e.second.get();
@@ -1409,6 +1435,11 @@ void PianoRoll::resized()
         component->setFloatBounds(this->getEventBounds(component));
     }
 
+    for (const auto component : this->recordingNotes)
+    {
+        component->setFloatBounds(this->getEventBounds(component));
+    }
+
     if (this->knifeToolHelper != nullptr)
     {
         this->knifeToolHelper->updateBounds();
@@ -1474,8 +1505,8 @@ void PianoRoll::paint(Graphics &g)
 
         if (beatX >= paintEndX)
         {
-            RollBase::paint(g);
-            return;
+            prevBeatX = paintEndX;
+            break;
         }
 
         prevBeatX = beatX;
@@ -1493,8 +1524,68 @@ void PianoRoll::paint(Graphics &g)
             g.setFillType({ fillImage, AffineTransform::translation(0.f, float(i)) });
             g.fillRect(prevBeatX, i, paintEndX - prevBeatX, periodHeight);
         }
+    }
+
+    RollBase::paint(g);
+
+    this->paintNotes(g);
+}
+
+void PianoRoll::paintNotes(Graphics &g)
+{
+    const auto clipBounds = g.getClipBounds();
+    const bool densityMode = this->beatWidth < PianoRoll::densityBarsMaxBeatWidth;
+
+    // the ones being faded in are painted one by one, on top
+    Array<NoteComponent *> fadingNotes;
+
+    const auto addNote = [&clipBounds, &fadingNotes, densityMode](NotesPaintBatch &batch, NoteComponent *nc)
+    {
+        if (!nc->isVisible() || !nc->getBounds().intersects(clipBounds))
+        {
+            return;
+        }
 
-        RollBase::paint(g);
+        if (nc->getAlpha() < 1.f)
+        {
+            fadingNotes.add(nc);
+            return;
+        }
+
+        if (densityMode)
+        {
+            batch.addNoteDensity(*nc, nc->getPosition().toFloat());
+        }
+        else
+        {
+            batch.addNote(*nc, nc->getPosition().toFloat());
+        }
+    };
+
+    forEachEventComponent(this->patternMap, e)
+    {
+        auto *nc = e.second.get();
+        addNote(nc->isActive() ? this->activeNotesBatch : this->inactiveNotesBatch, nc);
+    }
+
+    for (auto *nc : this->ghostNotes)
+    {
+        addNote(this->activeNotesBatch, nc);
+    }
+
+    for (auto *nc : this->recordingNotes)
+    {
+        addNote(this->activeNotesBatch, nc);
+    }
+
+    this->inactiveNotesBatch.fill(g);
+    this->activeNotesBatch.fill(g);
+
+    for (auto *nc : fadingNotes)
+    {
+        Graphics::ScopedSaveState state(g);
+        g.setOrigin(nc->getPosition());
+        nc->paintEntireComponent(g, false);
     }
 }
 
@@ -2062,6 +2153,38 @@ void PianoRoll::showChordTool(ToolType type, Point<int> position)
     }
 }
 
+bool PianoRoll::transformSelectionAsync(NoteTransforms::Transform transform)
+{
+    if (this->selection.getNumSelected() < NoteTransforms::asyncThreshold)
+    {
+        return false;
+    }
+
+    if (this->noteTransforms == nullptr)
+    {
+        this->noteTransforms = make<NoteTransforms::Worker>();
+    }
+
+    this->noteTransforms->transformAsync(*SequencerOperations::getPianoSequence(this->selection),
+        SequencerOperations::getSelectedNotes(this->selection), move(transform));
+
+    return true;
+}
+
+void PianoRoll::quantizeSelection(float bar)
+{
+    if (this->selection.getNumSelected() == 0)
+    {
+        this->selectAll();
+    }
+
+    if (!this->transformSelectionAsync([bar](const Array<Note> &notes)
+        { return NoteTransforms::quantize(notes, bar); }))
+    {
+        SequencerOperations::quantize(this->selection, bar);
+    }
+}
+
 //===----------------------------------------------------------------------===//
 // UserInterfaceFlags::Listener
 //===----------------------------------------------------------------------===//
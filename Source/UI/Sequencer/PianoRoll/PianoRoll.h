@@ -25,6 +25,7 @@ class HelperRectangle;
 class KnifeToolHelper;
 class MergingNotesConnector;
 class NoteNameGuidesBar;
+class NoteComponentsLayer;
 
 #include "Note.h"
 #include "Clip.h"
@@ -35,6 +36,8 @@ class NoteNameGuidesBar;
 #include "HighlightingScheme.h"
 #include "CommandPaletteModel.h"
 #include "MidiTrack.h"
+#include "NoteTransforms.h"
+#include "NotesPaintBatch.h"
 
 class PianoRoll final : public RollBase, public CommandPaletteModel
 {
@@ -117,6 +120,7 @@ public:
     void onChangeProjectBeatRange(float firstBeat, float lastBeat) override;
     void onChangeViewEditableScope(MidiTrack *const track,
         const Clip &clip, bool shouldFocus) override;
+    void onChangeRecordingNotes(const Clip &clip, const Array<Note> &notes) override;
 
     //===------------------------------------------------------------------===//
     // UserInterfaceFlags::Listener
@@ -240,6 +244,13 @@ private:
 
     void showChordTool(ToolType type, Point<int> position);
 
+private:
+
+    // large selections are transformed in a background thread
+    UniquePointer<NoteTransforms::Worker> noteTransforms;
+    bool transformSelectionAsync(NoteTransforms::Transform transform);
+    void quantizeSelection(float bar);
+
 private:
 
     void updateBackgroundCachesAndRepaint();
@@ -258,9 +269,33 @@ private:
     friend class NoteNameGuidesBar;
     UniquePointer<NoteNameGuidesBar> noteNameGuides;
 
+private:
+
+    // all visible notes are painted by the roll in a single pass,
+    // the inactive ones first, so that the active ones are on top;
+    // note that this is done in the roll's own paint(), so the notes
+    // are always below the roll's child components, e.g. the header
+    // shadow and the dragging helpers, and within each batch, all note
+    // bodies are painted before all borders and velocity bars
+    void paintNotes(Graphics &g);
+    NotesPaintBatch inactiveNotesBatch;
+    NotesPaintBatch activeNotesBatch;
+
+    // the note components are only used for hit-testing,
+    // this layer keeps them out of the paint traversal
+    UniquePointer<NoteComponentsLayer> notesLayer;
+
+    // below this zoom level, the notes are painted as density bars
+    static constexpr auto densityBarsMaxBeatWidth = 3.f;
+    friend class ProjectBenchmarks;
+
 private:
     
     OwnedArray<NoteComponent> ghostNotes;
+
+    // the notes which are held while recording, displayed
+    // until they are released and added to the sequence
+    OwnedArray<NoteComponent> recordingNotes;
     UniquePointer<HelperRectangle> draggingHelper;
 
     UniquePointer<NoteResizerLeft> noteResizerLeft;
@@ -311,7 +311,7 @@ protected:
     void onRecord() override;
     void onStop() override;
 
-    Atomic<float> lastPlayheadBeat = 0.f; // modified from the player thread
+    Atomic<float> lastPlayheadBeat = 0.f; // the last polled position, not estimated
 
     enum class PlayheadFollowMode { None, Once, Always };
     PlayheadFollowMode playheadFollowMode = PlayheadFollowMode::None;
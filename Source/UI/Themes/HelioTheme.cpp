@@ -927,6 +927,7 @@ void HelioTheme::initColours(const ::ColourScheme::Ptr s)
 
     this->setColour(ColourIDs::Logo::fill, textColour.withMultipliedAlpha(0.25f));
     this->setColour(ColourIDs::AudioMonitor::foreground, textColour);
+    this->setColour(ColourIDs::AudioMonitor::overrun, textColour.interpolatedWith(Colours::red, 0.75f));
 
     this->setColour(ColourIDs::VersionControl::connector, textColour.withAlpha(0.2f));
     this->setColour(ColourIDs::VersionControl::outline, textColour.withAlpha(0.3f));